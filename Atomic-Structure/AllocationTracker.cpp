@@ -0,0 +1,62 @@
+#include "headers/AllocationTracker.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<uint64_t> allocations(0), frees(0), bytes(0);
+    std::atomic<AllocationTracker::Hook> hook(nullptr);
+    // set while the hook runs, so what it allocates itself is not reported back to it
+    thread_local bool inHook = false;
+
+    void* allocate(size_t size) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        bytes.fetch_add(size, std::memory_order_relaxed);
+        AllocationTracker::Hook call = hook.load(std::memory_order_relaxed);
+        if (call && !inHook) {
+            inHook = true;
+            call(size);
+            inHook = false;
+        }
+        return malloc(size ? size : 1);
+    }
+
+    void release(void* pointer) {
+        if (!pointer) return;
+        frees.fetch_add(1, std::memory_order_relaxed);
+        free(pointer);
+    }
+
+    void* allocateOrThrow(size_t size) {
+        void* pointer = allocate(size);
+        if (!pointer) throw std::bad_alloc();
+        return pointer;
+    }
+}
+
+AllocationCounts AllocationTracker::GetCounts() {
+    AllocationCounts counts;
+    counts.allocations = allocations.load(std::memory_order_relaxed);
+    counts.frees = frees.load(std::memory_order_relaxed);
+    counts.bytes = bytes.load(std::memory_order_relaxed);
+    return counts;
+}
+
+void AllocationTracker::SetHook(Hook newHook) {
+    hook.store(newHook);
+}
+
+//======================================================================================
+// Replacements of the global operator new and delete
+//======================================================================================
+void* operator new(size_t size) { return allocateOrThrow(size); }
+void* operator new[](size_t size) { return allocateOrThrow(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void operator delete(void* pointer) noexcept { release(pointer); }
+void operator delete[](void* pointer) noexcept { release(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { release(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { release(pointer); }
+void operator delete(void* pointer, size_t) noexcept { release(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { release(pointer); }
@@ -0,0 +1,268 @@
+#include "headers/AtomApi.h"
+#include "headers/AtomScene.hpp"
+#include "headers/ElectronOrbits.hpp"
+#include "headers/Elements.hpp"
+#include "headers/FrameRing.hpp"
+#include "headers/RadialSolver.hpp"
+#include "headers/RayTracer.hpp"
+#include "headers/SceneFile.hpp"
+#include "headers/SoftwareRasterizer.hpp"
+#include "headers/StructureImporter.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+static_assert(sizeof(AtomCamera) == sizeof(RenderCamera), "AtomCamera must mirror RenderCamera");
+
+struct AtomRenderer {
+    std::unique_ptr<SoftwareRasterizer> rasterizer;  // one of the two
+    std::unique_ptr<RayTracer> tracer;
+    RenderBackend* backend;
+
+    std::vector<Electron> electrons;
+    bool sceneMode;
+    SceneFile sceneFile;
+    SceneData importedScene;
+    SceneView scene;
+
+    RenderCamera camera;
+    bool lighting;
+    FrameRing ring;
+    std::string error;
+
+    AtomRenderer() : backend(nullptr), sceneMode(false), scene(), camera(), lighting(true) {}
+
+    bool fail(const std::string& message) {
+        error = message;
+        return false;
+    }
+
+    bool setTarget(uint8_t* memory, size_t rowBytes) {
+        return rasterizer ? rasterizer->SetTarget(memory, rowBytes) : tracer->SetTarget(memory, rowBytes);
+    }
+};
+
+struct AtomRing {
+    FrameRing ring;
+};
+
+namespace {
+    const float kLightPosition[3] = { 2.0f, 5.0f, 2.0f };
+
+    bool endsWith(const std::string& text, const char* suffix) {
+        size_t length = strlen(suffix);
+        return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+    }
+
+    // The view's single-atom camera, or the scene bounds from the front like fitCamera()
+    void fitCamera(AtomRenderer& r) {
+        RenderCamera& camera = r.camera;
+        const RenderCamera atomCamera = {
+            {0.0f, 0.0f, 3.0f}, {0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f},
+            45.0f, 0.1f, 100.0f
+        };
+        camera = atomCamera;
+        if (!r.sceneMode || r.scene.atomCount == 0) return;
+
+        float low[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, high[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for (size_t i = 0; i < r.scene.atomCount; ++i) {
+            float center[3], radius, color[3];
+            sceneAtomWorld(r.scene, i, center, radius, color);
+            for (int k = 0; k < 3; ++k) {
+                low[k] = std::min(low[k], center[k] - radius);
+                high[k] = std::max(high[k], center[k] + radius);
+            }
+        }
+        float extent = 0.0f;
+        for (int k = 0; k < 3; ++k) {
+            camera.target[k] = 0.5f * (low[k] + high[k]);
+            extent = std::max(extent, high[k] - low[k]);
+        }
+        float distance = std::max(extent * (0.5f / tanf(22.5f * float(M_PI) / 180.0f) + 0.5f), 1.0f);
+        camera.eye[0] = camera.target[0];
+        camera.eye[1] = camera.target[1];
+        camera.eye[2] = camera.target[2] + distance;
+        camera.farPlane = std::max(100.0f, distance + 2.0f * extent);
+    }
+
+    void renderFrame(AtomRenderer& r) {
+        RenderBackend& backend = *r.backend;
+        backend.SetLight(kLightPosition, true);
+        backend.SetLighting(r.lighting);
+        backend.BeginFrame(r.camera, kClearColor);
+        if (r.sceneMode) {
+            const float noOffset[3] = { 0.0f, 0.0f, 0.0f };
+            submitSceneAtoms(backend, r.scene, noOffset);
+        } else {
+            submitNucleus(backend);
+            submitElectrons(backend, r.electrons);
+        }
+        backend.EndFrame();
+    }
+}
+
+//======================================================================================
+// Renderer
+//======================================================================================
+AtomRenderer* atom_create(int width, int height, AtomBackend backend, int threads) {
+    if (width < 1 || height < 1) return nullptr;
+    std::unique_ptr<AtomRenderer> r(new AtomRenderer());
+    if (backend == ATOM_BACKEND_RAYTRACE) {
+        r->tracer.reset(new RayTracer(width, height, threads));
+        r->backend = r->tracer.get();
+    } else {
+        r->rasterizer.reset(new SoftwareRasterizer(width, height, threads));
+        r->backend = r->rasterizer.get();
+    }
+    fitCamera(*r);
+    return r.release();
+}
+
+void atom_destroy(AtomRenderer* renderer) {
+    delete renderer;
+}
+
+int atom_resize(AtomRenderer* renderer, int width, int height) {
+    if (width < 1 || height < 1) return renderer->fail("size must be positive");
+    renderer->ring.Close();
+    renderer->backend->Resize(width, height);
+    return 1;
+}
+
+int atom_set_element(AtomRenderer* renderer, int atomicNumber) {
+    if (atomicNumber < 1 || atomicNumber > kElementCount) return renderer->fail("no element " + std::to_string(atomicNumber));
+    ElementShells shells;
+    RadialSolver::SolveElement(atomicNumber, shells);  // one element, cheaper than the cached table
+    buildElectrons(shells, renderer->electrons);
+
+    renderer->sceneMode = false;
+    renderer->sceneFile.Close();
+    renderer->importedScene.Clear();
+    renderer->scene = SceneView();
+    fitCamera(*renderer);
+    return 1;
+}
+
+int atom_load_scene(AtomRenderer* renderer, const char* path) {
+    AtomRenderer& r = *renderer;
+    r.sceneFile.Close();
+    r.importedScene.Clear();
+    r.scene = SceneView();
+    r.sceneMode = true;
+    r.electrons.clear();
+
+    std::string name = path ? path : "";
+    if (endsWith(name, ".atoms")) {
+        if (!r.sceneFile.Open(name)) return r.fail("cannot open scene " + name);
+        r.scene = r.sceneFile.GetView();
+    } else {
+        StructureImporter importer;
+        if (!importer.Start(name, StructureImporter::Format::Unknown, true)) return r.fail("cannot import " + name);
+        importer.Wait();
+        importer.Poll(r.importedScene);
+        if (importer.Failed() || r.importedScene.atoms.empty()) return r.fail("no atoms in " + name);
+        r.scene = r.importedScene.GetView();
+    }
+    fitCamera(r);
+    return 1;
+}
+
+void atom_set_camera(AtomRenderer* renderer, const AtomCamera* camera) {
+    memcpy(&renderer->camera, camera, sizeof(RenderCamera));
+}
+
+void atom_get_camera(const AtomRenderer* renderer, AtomCamera* camera) {
+    memcpy(camera, &renderer->camera, sizeof(RenderCamera));
+}
+
+void atom_reset_camera(AtomRenderer* renderer) {
+    fitCamera(*renderer);
+}
+
+void atom_set_lighting(AtomRenderer* renderer, int enabled) {
+    renderer->lighting = enabled != 0;
+}
+
+void atom_step(AtomRenderer* renderer, int frames) {
+    for (int i = 0; i < frames; ++i) advanceElectrons(renderer->electrons);
+}
+
+int atom_render(AtomRenderer* renderer, uint8_t* pixels, size_t rowBytes) {
+    if (!renderer->setTarget(pixels, rowBytes)) {
+        return renderer->fail("rowBytes " + std::to_string(rowBytes) + " is less than 4 * width");
+    }
+    renderFrame(*renderer);
+    renderer->setTarget(nullptr, 0);  // atom_pixels is the renderer's own buffer again
+    return 1;
+}
+
+const uint8_t* atom_pixels(const AtomRenderer* renderer, size_t* rowBytes) {
+    if (renderer->rasterizer) {
+        if (rowBytes) *rowBytes = renderer->rasterizer->GetRowBytes();
+        return renderer->rasterizer->GetPixels();
+    }
+    if (rowBytes) *rowBytes = renderer->tracer->GetRowBytes();
+    return renderer->tracer->GetPixels();
+}
+
+int atom_open_ring(AtomRenderer* renderer, const char* name, int slots) {
+    int width = renderer->rasterizer ? renderer->rasterizer->GetWidth() : renderer->tracer->GetWidth();
+    int height = renderer->rasterizer ? renderer->rasterizer->GetHeight() : renderer->tracer->GetHeight();
+    if (!name || !renderer->ring.Create(name, width, height, slots)) {
+        return renderer->fail(std::string("cannot create ring ") + (name ? name : ""));
+    }
+    return 1;
+}
+
+int atom_publish(AtomRenderer* renderer) {
+    uint8_t* slot = renderer->ring.BeginWrite();
+    if (!slot) return renderer->fail("no ring open");
+    renderer->setTarget(slot, renderer->ring.GetRowBytes());
+    renderFrame(*renderer);
+    renderer->ring.Publish();
+    renderer->setTarget(nullptr, 0);  // the slot belongs to consumers now
+    return 1;
+}
+
+void atom_close_ring(AtomRenderer* renderer) {
+    renderer->ring.Close();
+}
+
+const char* atom_last_error(const AtomRenderer* renderer) {
+    return renderer ? renderer->error.c_str() : "no renderer";
+}
+
+//======================================================================================
+// Ring consumer
+//======================================================================================
+AtomRing* atom_ring_open(const char* name) {
+    std::unique_ptr<AtomRing> ring(new AtomRing());
+    if (!name || !ring->ring.Open(name)) return nullptr;
+    return ring.release();
+}
+
+int atom_ring_latest(AtomRing* ring, AtomFrame* frame) {
+    FrameRingToken token;
+    const uint8_t* pixels = ring->ring.Latest(token);
+    if (!pixels) return 0;
+    frame->pixels = pixels;
+    frame->width = ring->ring.GetWidth();
+    frame->height = ring->ring.GetHeight();
+    frame->rowBytes = ring->ring.GetRowBytes();
+    frame->frame = token.frame;
+    frame->slot = token.slot;
+    frame->sequence = token.sequence;
+    return 1;
+}
+
+int atom_ring_still_valid(const AtomRing* ring, const AtomFrame* frame) {
+    FrameRingToken token = { frame->frame, frame->slot, frame->sequence };
+    return ring->ring.StillValid(token) ? 1 : 0;
+}
+
+void atom_ring_close(AtomRing* ring) {
+    delete ring;
+}
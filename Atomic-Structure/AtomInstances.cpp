@@ -0,0 +1,156 @@
+#include "headers/AtomInstances.hpp"
+#include "headers/Elements.hpp"
+#include "headers/SphereMesh.hpp"
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <climits>
+#include <iostream>
+
+AtomInstances::AtomInstances(const char* vertPath, const char* fragPath)
+    : VAO(0), meshVBO(0), meshEBO(0), atomVBO(0), elementVBO(0), colorVBO(0),
+    meshIndexCount(0), atomCount(0), model(1.0f), repeat{ 1, 1, 1 }, cellCount(1), initialized(false) {
+    cellVectors[0] = cellVectors[1] = cellVectors[2] = glm::vec3(0.0f);
+
+    // atoms in large structures cover a few pixels each, 320 triangles is plenty
+    SphereMesh mesh(SphereType::Icosphere, 16, 12);
+    std::vector<uint16_t> shortIndices(mesh.GetIndices().begin(), mesh.GetIndices().end());
+    meshIndexCount = static_cast<unsigned int>(shortIndices.size());
+
+    glGenVertexArrays(1, &VAO);
+    GLuint buffers[5];
+    glGenBuffers(5, buffers);
+    meshVBO = buffers[0]; meshEBO = buffers[1]; atomVBO = buffers[2]; elementVBO = buffers[3]; colorVBO = buffers[4];
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, meshVBO);
+    glBufferData(GL_ARRAY_BUFFER, mesh.GetVertices().size() * sizeof(SphereVertex), mesh.GetVertices().data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, sizeof(SphereVertex), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(uint16_t), shortIndices.data(), GL_STATIC_DRAW);
+
+    // the three scene arrays, in their file layout
+    glBindBuffer(GL_ARRAY_BUFFER, atomVBO);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(SceneAtom), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    glBindBuffer(GL_ARRAY_BUFFER, elementVBO);
+    glVertexAttribIPointer(2, 1, GL_UNSIGNED_SHORT, sizeof(uint16_t), (void*)0);
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+    glBindBuffer(GL_ARRAY_BUFFER, colorVBO);
+    glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(uint32_t), (void*)0);
+    glVertexAttribDivisor(3, 1);
+    // attribute 3 stays disabled without overrides; its constant alpha of 0 means "element colour"
+    glVertexAttrib4f(3, 0.0f, 0.0f, 0.0f, 0.0f);
+
+    glBindVertexArray(0);
+
+    try {
+        shader = std::make_unique<Shader>(vertPath, fragPath);
+        initialized = true;
+        std::cout << "Atom instance shader compilation successful" << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cout << "Failed to create atom instance shader: " << e.what() << std::endl;
+        return;
+    }
+
+    // element palette, index 0 is the "unknown" colour
+    glm::vec3 palette[kElementCount + 1];
+    for (int z = 0; z <= kElementCount; ++z) {
+        const float* c = GetElement(z).color;
+        palette[z] = glm::vec3(c[0], c[1], c[2]);
+    }
+    shader->use();
+    glUniform3fv(glGetUniformLocation(shader->ID, "elementColors"), kElementCount + 1, glm::value_ptr(palette[0]));
+}
+
+void AtomInstances::SetScene(const SceneView& scene) {
+    atomCount = scene.atomCount;
+    model = scene.transform ? glm::make_mat4(scene.transform) : glm::mat4(1.0f);
+
+    glBindBuffer(GL_ARRAY_BUFFER, atomVBO);
+    glBufferData(GL_ARRAY_BUFFER, atomCount * sizeof(SceneAtom), scene.atoms, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, elementVBO);
+    glBufferData(GL_ARRAY_BUFFER, atomCount * sizeof(uint16_t), scene.elements, GL_STATIC_DRAW);
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, colorVBO);
+    if (scene.colors) {
+        glBufferData(GL_ARRAY_BUFFER, atomCount * sizeof(uint32_t), scene.colors, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(3);
+    }
+    else {
+        glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_STATIC_DRAW);
+        glDisableVertexAttribArray(3);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+bool AtomInstances::SetRepeat(const float cell[9], const int repeat[3]) {
+    size_t cells = size_t(std::max(repeat[0], 1)) * std::max(repeat[1], 1) * std::max(repeat[2], 1);
+    if (atomCount * cells > size_t(INT_MAX)) {
+        std::cout << "ERROR::ATOM_INSTANCES::TOO_MANY_INSTANCES " << atomCount * cells << std::endl;
+        return false;
+    }
+    for (int i = 0; i < 3; ++i) {
+        cellVectors[i] = glm::vec3(cell[i * 3], cell[i * 3 + 1], cell[i * 3 + 2]);
+        this->repeat[i] = std::max(repeat[i], 1);
+    }
+    cellCount = cells;
+
+    // every atom attribute advances once per cellCount instances
+    glBindVertexArray(VAO);
+    for (GLuint attribute = 1; attribute <= 3; ++attribute) {
+        glVertexAttribDivisor(attribute, static_cast<GLuint>(cellCount));
+    }
+    glBindVertexArray(0);
+    return true;
+}
+
+void AtomInstances::SetRepeatUniforms(const Shader& program) const {
+    program.setVec3("cellA", cellVectors[0]);
+    program.setVec3("cellB", cellVectors[1]);
+    program.setVec3("cellC", cellVectors[2]);
+    program.setInt("repeatX", repeat[0]);
+    program.setInt("repeatY", repeat[1]);
+    program.setInt("cellCount", static_cast<int>(cellCount));
+}
+
+void AtomInstances::UpdateAtoms(const SceneAtom* atoms, size_t first, size_t count) {
+    if (first >= atomCount) return;
+    count = std::min(count, atomCount - first);
+    glBindBuffer(GL_ARRAY_BUFFER, atomVBO);
+    glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(SceneAtom), count * sizeof(SceneAtom), atoms + first);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void AtomInstances::Render(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPos,
+    const glm::vec3& lightPos) {
+    if (!initialized) {
+        std::cout << "Warning: Attempting to render uninitialized atom instances" << std::endl;
+        return;
+    }
+    if (atomCount == 0) return;
+
+    shader->use();
+    shader->setMat4("model", model);
+    shader->setMat4("view", view);
+    shader->setMat4("projection", projection);
+    shader->setVec3("viewPos", viewPos);
+    shader->setVec3("lightPos", lightPos);
+    SetRepeatUniforms(*shader);
+
+    glBindVertexArray(VAO);
+    glDrawElementsInstanced(GL_TRIANGLES, meshIndexCount, GL_UNSIGNED_SHORT, 0, static_cast<GLsizei>(atomCount * cellCount));
+    glBindVertexArray(0);
+}
+
+AtomInstances::~AtomInstances() {
+    glDeleteVertexArrays(1, &VAO);
+    GLuint buffers[5] = { meshVBO, meshEBO, atomVBO, elementVBO, colorVBO };
+    glDeleteBuffers(5, buffers);
+}
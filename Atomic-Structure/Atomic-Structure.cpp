@@ -1,8 +1,39 @@
 #include <GL/glut.h>  // for windowing and input functionality
+#ifdef FREEGLUT
+#include <GL/freeglut_ext.h> // glutGetProcAddress, for the export mode's GL 3 entry points
+#endif
 #include <cmath>      
 #include <vector>     
 #include <ctime>      // Time functions for random seed
 #include <iostream>
+#include <chrono>
+#include <cstring>
+#include <cfloat>
+#include <algorithm>
+#include <thread>
+#include "headers/FrameCapture.hpp" // deterministic capture/replay for benchmarks
+#include "headers/SoftwareRasterizer.hpp" // CPU renderer for machines without a GPU
+#include "headers/RayTracer.hpp"          // offline high-quality CPU renderer
+#include "headers/OffscreenCapture.hpp"   // offscreen target + async PBO readback
+#include "headers/FrameExporter.hpp"      // background image / encoder writing
+#include "headers/SceneFile.hpp"          // memory-mapped multi-atom structures
+#include "headers/StructureImporter.hpp"  // streaming XYZ/PDB/CIF loading
+#include "headers/TrajectoryPlayer.hpp"   // XYZ/DCD playback with prefetch
+#include "headers/Lattice.hpp"            // generated crystal lattices
+#include "headers/Bonds.hpp"              // cell-list bond search
+#include "headers/PickBuffer.hpp"         // per-pixel object IDs for hover info
+#include "headers/LayerCache.hpp"         // static layers kept between frames
+#include "headers/DynamicResolution.hpp"  // render scale from GPU frame time
+#include "headers/FramePacer.hpp"          // frames-ahead limit, input latency
+#include "headers/RadialSolver.hpp"        // shell radii from the Schrodinger equation
+#include "headers/PhotonSystem.hpp"        // pooled photons from electron transitions
+#include "headers/ElectronOrbits.hpp"      // electron layout and motion, shared with the bench
+#include "headers/AtomScene.hpp"           // scene submission, shared with the bench and the library
+#include "headers/AllocationTracker.hpp"   // heap allocations per frame
+#include "headers/FrameArena.hpp"          // scratch memory that lives for a frame
+#include "headers/FrameServer.hpp"         // frames to browsers over WebSocket
+#include "headers/TileDelta.hpp"           // changed tiles only, coded on the workers
+#include "headers/Elements.hpp"
 
 //======================================================================================
 // INITIAL CAMERA PARAMETERS
@@ -22,130 +53,212 @@ bool lightingEnabled = true;  // Toggle for lighting effects
 // The fourth parameter (1.0f) indicates a positional light (0.0f would be directional)
 GLfloat lightPos[] = {2.0f, 5.0f, 2.0f, 1.0f}; 
 
-//======================================================================================
-// ATOMIC NUCLEUS CONFIGURATION
-//======================================================================================
-// Pre-defined positions for nucleus particles (protons/neutrons)
-// Each vector represents a 3D coordinate {x, y, z}
-const std::vector<std::vector<float>> nuclearPositions = {
-    {0.0f, 0.0f, 0.0f},     // Center
-    {0.12f, 0.12f, 0.12f},  // Upper octant 1
-    {-0.12f, 0.12f, 0.12f}, // Upper octant 2
-    {0.12f, -0.12f, 0.12f}, // Lower octant 1
-    {-0.12f, -0.12f, 0.12f},// Lower octant 2
-    {0.12f, 0.12f, -0.12f}, // Upper octant 3
-    {-0.12f, 0.12f, -0.12f},// Upper octant 4
-    {0.12f, -0.12f, -0.12f},// Lower octant 3
-    {-0.12f, -0.12f, -0.12f},// Lower octant 4
-    {0.16f, 0.0f, 0.0f},    // Along x-axis
-    {-0.16f, 0.0f, 0.0f},   // Along x-axis
-    {0.0f, 0.16f, 0.0f},    // Along y-axis
-    {0.0f, -0.16f, 0.0f},   // Along y-axis
-    {0.0f, 0.0f, 0.16f},    // Along z-axis
-    {0.0f, 0.0f, -0.16f}    // Along z-axis
-};
-
 //======================================================================================
 // ELECTRON DATA STRUCTURE AND CONFIGURATION
 //======================================================================================
-// Structure to hold properties of each electron
-struct Electron {
-    float radius;    // Distance from nucleus (orbital radius)
-    float angle;     // Current position in the orbital (in degrees)
-    float speed;     // Rotation speed in degrees per frame
-    float normal[3]; // Vector perpendicular to orbital plane (defines orientation)
-    float color[3];  // RGB color values for the electron
-};
-
 // Array to store all electrons
 std::vector<Electron> electrons;
 
+// Orbit radii and speeds come from each subshell's <r> and energy, solved for all elements
+// on first use and kept in shellCachePath (--shell-cache file, --no-shell-cache), by
+// default in the user's cache directory
+RadialSolver radialSolver;
+std::string shellCachePath;
+bool shellCacheGiven = false;
+
+//======================================================================================
+// LOADED STRUCTURE
+//======================================================================================
+// --scene file draws a whole structure (one sphere per atom, element colours) in place of
+// the single animated atom. .atoms files are memory-mapped; .xyz/.pdb/.cif are imported on
+// a background thread and drawn while they load. --save-scene converts them to .atoms.
+// --lattice fcc:Cu (sc, bcc, fcc, hcp, diamond) generates a unit cell instead, and
+// --repeat NxMxK draws that many copies of any periodic scene's cell.
+bool sceneMode = false;
+SceneFile sceneFile;
+StructureImporter importer;
+SceneData importedScene;
+bool importing = false;
+std::string saveScenePath;
+SceneView scene = {};
+float sceneMin[3], sceneMax[3];   // bounds before the scene transform
+size_t expectedAtoms = 0;         // picks the tessellation
+const size_t sceneBlock = 4096;   // atoms per display list, the unit recompiled when atoms move
+std::vector<GLuint> sceneLists;   // one per block; the last one grows while an import runs
+std::vector<bool> staleLists;     // blocks to recompile before drawing
+size_t listedAtoms = 0;
+GLuint sceneSphere = 0;           // unit sphere every atom scales
+int sceneRepeat[3] = {1, 1, 1};
+GLuint latticeLists = 0;          // cell, row, plane, block: each level repeats the one below,
+size_t latticeBlocks = 0;         // so a lattice of any size is N+M+K list calls
+float farPlane = 100.0f;          // grown to fit large structures
+
+//======================================================================================
+// TRAJECTORY PLAYBACK
+//======================================================================================
+// --trajectory file.xyz|dcd animates the loaded structure; an .xyz trajectory is its own
+// structure when there is no --scene. p plays/pauses, ',' and '.' step a frame, '<' and '>'
+// jump 100. Playback never waits for the disk except when capturing, so scrubbing stays at
+// the display rate and frames that aren't loaded yet are simply shown late.
+TrajectoryPlayer trajectory;
+bool trajectoryPlaying = true;
+long long trajectoryFrame = 0;    // frame wanted on screen
+long long shownFrame = -1;        // frame whose positions are in the scene
+std::vector<AtomRange> movedAtoms;
+
+//======================================================================================
+// BONDS
+//======================================================================================
+// --bonds (or b) draws a cylinder between atoms closer than 1.2x their covalent radii, each
+// half in its atom's colour. The bonds of block b's atoms are compiled into block b's list,
+// so a trajectory frame only recompiles the blocks around the atoms that moved.
+bool showBonds = false;
+BondFinder* bondFinder = nullptr;  // created the first time bonds are shown
+GLuint bondCylinder = 0;           // unit cylinder along z every bond half scales
+const float bondRadius = 0.12f;
+
+//======================================================================================
+// PICKING
+//======================================================================================
+// i shows what is under the cursor (atom, bond, electron or nucleus) in the window title.
+// The frame is then drawn into a PickBuffer, which stores an object ID per pixel next to
+// the colour, and only the pixel under the cursor is read back, asynchronously, a frame
+// later; hovering costs the same for ten atoms or ten million. --pick X,Y reports the
+// pixel of the last frame in the software modes, with one ray through the ray tracer's BVH.
+bool hoverInfo = false;
+PickBuffer* pickBuffer = nullptr;
+int mouseX = -1, mouseY = -1;     // window pixels, top-left origin
+uint32_t hoveredID = 0;
+int pickX = -1, pickY = -1;
+
+//======================================================================================
+// ON-DEMAND RENDERING
+//======================================================================================
+// The window is only redrawn while something moves (electrons, a playing trajectory, an
+// import, a capture) or after input; the rest of the time the idle callback is removed and
+// GLUT sleeps. p pauses the electrons when there is no trajectory. While the camera is
+// still, the nucleus, orbits and structure come from a LayerCache and only the electrons
+// are drawn each frame; --no-layer-cache draws everything every frame.
+bool electronsPlaying = true;
+bool useLayerCache = true;
+LayerCache* layerCache = nullptr;
+
+//======================================================================================
+// DYNAMIC RESOLUTION
+//======================================================================================
+// The scene is drawn below the window's resolution, then sharpened up to it, whenever the
+// GPU takes longer than --frame-budget ms (default 60 Hz). The scale follows the measured
+// GPU time down to half size and back. Replays, exports and hover picking always draw at
+// full size. --no-dynamic-resolution turns it off.
+bool useDynamicResolution = true;
+float frameBudgetMs = 1000.0f / 60.0f;
+DynamicResolution* dynamicResolution = nullptr;
+
+//======================================================================================
+// INPUT LATENCY
+//======================================================================================
+// The CPU runs at most --frames-ahead N frames (default 1) ahead of the GPU, waiting right
+// after the swap so the input that arrives meanwhile makes it into the next frame. The time
+// from an input event to the GPU finishing the first frame that shows it is summarised on
+// exit; --latency file.csv writes every sample.
+int framesAhead = 1;
+std::string latencyPath;
+FramePacer* framePacer = nullptr;
+
+//======================================================================================
+// EXCITATION AND EMISSION
+//======================================================================================
+// e (or --photons N) excites the atom: its outermost electron jumps up its Rydberg series
+// and falls back a level at a time, each fall a flash of photons coloured by the line's
+// wavelength. In a structure, random atoms emit instead. N photons per frame on average
+// (default 4000) live in a fixed pool; the software renderers don't draw them.
+bool emitting = false;
+int photonRate = 4000;
+PhotonSystem* photons = nullptr;
+std::vector<RydbergSeries> spectra;  // per element, from the solved shells
+struct Excitation {
+    int electron;  // -1 while the atom is in its ground state
+    int level;     // n the electron is on
+    int timer;     // frames until it falls
+    float groundRadius, groundSpeed;
+} excitation = { -1, 0, 0, 0.0f, 0.0f };
+const int excitedFrames = 30;  // time an excited electron spends on each level
+
+//======================================================================================
+// CAPTURE / REPLAY
+//======================================================================================
+// --record writes the camera of every frame, --replay draws those frames again in order,
+// ignoring live input, and reports per-frame timings (--timings file.csv, --hash for image hashes)
+const double fixedStep = 1.0 / 60.0; // the animation advances a fixed amount per frame
+CaptureRecorder recorder;
+CaptureReplay replay;
+FrameStats frameStats;
+std::string timingsPath;
+bool hashFrames = false;
+std::vector<unsigned char> framePixels;
+// heap allocations of every frame, reported with the timings; the steady state should have none
+FrameAllocations frameAllocations;
+// scratch memory for the frame being drawn, taken back when the next one starts
+FrameArena frameArena;
+
+//======================================================================================
+// SOFTWARE RENDERING
+//======================================================================================
+// --software renders with the CPU rasterizer, no window and no GL context needed;
+// --raytrace does the same with the ray tracer (shadows, ambient occlusion, --samples N)
+bool softwareMode = false;
+bool rayTraceMode = false;
+int rayTraceSamples = 4;
+int softwareWidth = 1920, softwareHeight = 1080;
+int softwareFrames = 600;    // when not replaying a capture
+std::string softwareOutput;  // prefix for numbered .ppm frames, empty = don't write
+
+//======================================================================================
+// FRAME STREAMING
+//======================================================================================
+// --serve [host:]port renders like --software and streams the frames to browsers at
+// http://host:port/ (127.0.0.1 unless a host is given); they send camera and element
+// commands back. Nothing is rendered while no one watches. --serve-origin lets pages
+// from another origin connect too; on 0.0.0.0 it is required, even for the server's own page
+std::string serveAddress;
+std::vector<std::string> serveOrigins;
+int serveFps = 30;
+
+//======================================================================================
+// VIDEO EXPORT
+//======================================================================================
+// --export prefix / --export-pipe "command" render --size frames offscreen with the GPU and
+// read them back asynchronously; the window only shows a preview. Without a replay the
+// camera does one turntable orbit over --frames frames.
+std::string exportPrefix;
+std::string exportPipe;
+OffscreenCapture* exportTarget = nullptr;
+FrameExporter exporter;
+int exportFrame = 0;
+std::chrono::steady_clock::time_point exportStart;
+
 //======================================================================================
 // ELECTRON INITIALIZATION FUNCTION
 //======================================================================================
+// Solves (or reads back) the shells of every element once, and their emission spectra
+void solveShells() {
+    if (radialSolver.IsSolved()) return;
+    radialSolver.Solve(shellCachePath);
+    if (radialSolver.LoadedFromCache()) std::cout << "Shell radii read from " << shellCachePath;
+    else std::cout << "Solved the shells of " << kElementCount << " elements on " << radialSolver.GetThreadCount() << " thread(s)";
+    std::cout << " in " << radialSolver.GetLastMs() << " ms" << std::endl;
+    spectra.resize(kElementCount);
+    for (int z = 1; z <= kElementCount; z++) spectra[z - 1] = RydbergSeries::FromShells(radialSolver.Get(z));
+}
+
 void initElectrons(int atomicNumber) {
     // Seed the random number generator with current time
     srand(time(NULL));
-    
-    // Base radius for electron orbits - will be scaled for each shell
-    const float baseRadius = 0.8f;
-    
-    // rgb for the shells
-    const float shellColors[7][3] = {
-        {0.2f, 0.4f, 1.0f}, // Shell 1: Blue
-        {0.2f, 0.8f, 0.8f}, // Shell 2: Cyan
-        {0.2f, 0.8f, 0.2f}, // Shell 3: Green
-        {0.8f, 0.8f, 0.2f}, // Shell 4: Yellow
-        {1.0f, 0.6f, 0.2f}, // Shell 5: Orange
-        {1.0f, 0.2f, 0.2f}, // Shell 6: Red
-        {0.8f, 0.2f, 0.8f}  // Shell 7: Magenta
-    };
-    
-    int remaining = atomicNumber;  // Electrons left to distribute
-    int shell = 1;                 // Current shell number
-    
-    // Clearing any existing electrons
-    electrons.clear();
-    
-    while (remaining > 0 && shell <= 7) {  // Limit to 7 shells for visualization
-        // Calculate maximum electrons for current shell using 2n^2 formula
-        int max_e = 2 * shell * shell;
-        
-        // Determine how many electrons go into this shell
-        int electronsInShell = std::min(max_e, remaining);
-        
-        // color for this shell
-        int colorIndex = (shell - 1) % 7;
-        float r = shellColors[colorIndex][0];  
-        float g = shellColors[colorIndex][1]; 
-        float b = shellColors[colorIndex][2];  
-        
-        // Creating electrons for this shell
-        for(int i = 0; i < electronsInShell; i++) {
-            Electron e;
-            
-            // Set radius based on shell number (grows quadratically)
-            e.radius = baseRadius + (shell * shell * 0.4f);
-            
-            // Set orbital speed (electrons in outer shells move slower)
-            e.speed = 45.0f / shell;
-            
-            // Calculate positioning angles for 3D distribution
-            float angleStep = 180.0f / electronsInShell;
-            float phi = i * angleStep;  // Vertical angle
-            
-            // Theta creates variation in horizontal angle based on shell number
-            float theta = (i % shell) * (180.0f / shell) + (shell * 20.0f);
-            
-            // Initial angle in orbital path
-            e.angle = (360.0f / electronsInShell) * i;
-            
-            // Calculate normal vector for orbital plane orientation
-            e.normal[0] = sin(phi * M_PI/180) * cos(theta * M_PI/180);
-            e.normal[1] = sin(phi * M_PI/180) * sin(theta * M_PI/180);
-            e.normal[2] = cos(phi * M_PI/180);
-            
-            // Normalize the vector to ensure unit length
-            float length = sqrt(e.normal[0]*e.normal[0] +
-                               e.normal[1]*e.normal[1] +
-                               e.normal[2]*e.normal[2]);
-            e.normal[0] /= length;
-            e.normal[1] /= length;
-            e.normal[2] /= length;
-            
-            // Assign color from the palette
-            e.color[0] = r;
-            e.color[1] = g;
-            e.color[2] = b;
-            
-            // Add the electron to our collection
-            electrons.push_back(e);
-        }
-        
-        // Update counters for next shell
-        remaining -= electronsInShell;
-        shell++;
-    }
+    solveShells();
+
+    // Replaces the electrons with the element's, laid out from its solved subshells
+    buildElectrons(radialSolver.Get(atomicNumber), electrons);
+    excitation.electron = -1;
 }
 
 //======================================================================================
@@ -234,12 +347,779 @@ void drawOrbit(const Electron &e) {
 }
 
 //======================================================================================
-// MAIN DISPLAY FUNCTION - CALLED TO RENDER EACH FRAME
+// LOADED STRUCTURE HELPERS
 //======================================================================================
-void display() {
-    // Clear color and depth buffers
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+// Atom i of the loaded scene in world space
+void sceneAtom(size_t i, float center[3], float &radius, float color[3]) {
+    sceneAtomWorld(scene, i, center, radius, color);
+}
+
+bool repeating() {
+    return scene.cell && (long long)sceneRepeat[0] * sceneRepeat[1] * sceneRepeat[2] > 1;
+}
+
+// Grows the bounds by atoms [first, last)
+void growBounds(size_t first, size_t last) {
+    for(size_t i = first; i < last; i++) {
+        const SceneAtom &atom = scene.atoms[i];
+        for(int k = 0; k < 3; k++) {
+            sceneMin[k] = std::min(sceneMin[k], atom.position[k] - atom.radius);
+            sceneMax[k] = std::max(sceneMax[k], atom.position[k] + atom.radius);
+        }
+    }
+}
+
+// Looks at the scene bounds from the front, far enough back to see all of it
+void fitCamera() {
+    float center[3], extent = 0.0f;
+    for(int i = 0; i < 3; i++) {
+        // the repeated cells stretch the bounds along each cell vector
+        float low = sceneMin[i], high = sceneMax[i];
+        for(int v = 0; repeating() && v < 3; v++) {
+            float stretch = (sceneRepeat[v] - 1) * scene.cell[v*3 + i];
+            low += std::min(stretch, 0.0f);
+            high += std::max(stretch, 0.0f);
+        }
+        center[i] = 0.5f * (low + high);
+        extent = std::max(extent, high - low);
+    }
+    const float *m = scene.transform;
+    float scale = sqrtf(m[0]*m[0] + m[1]*m[1] + m[2]*m[2]);
+    lookX = m[0]*center[0] + m[4]*center[1] + m[8]*center[2] + m[12];
+    lookY = m[1]*center[0] + m[5]*center[1] + m[9]*center[2] + m[13];
+    lookZ = m[2]*center[0] + m[6]*center[1] + m[10]*center[2] + m[14];
+    extent *= scale;
+    
+    // far enough back that the front of the bounding box fits the 45 degree view
+    float distance = std::max(extent * (0.5f / tanf(22.5f * M_PI/180) + 0.5f), 1.0f);
+    camX = lookX; camY = lookY; camZ = lookZ + distance;
+    angleX = 0.0f; angleY = -90.0f;
+    farPlane = std::max(100.0f, distance + 2.0f * extent);
+}
+
+// Every block's list shows its bonds (or stops showing them) when next drawn
+void markAllStale() {
+    staleLists.assign(staleLists.size(), true);
+}
+
+// Full bond search over the scene as it is now
+void buildBonds() {
+    if (!bondFinder) bondFinder = new BondFinder();
+    bondFinder->Build(scene);
+    std::cout << "Found " << bondFinder->GetBonds().size() << " bonds in " << bondFinder->GetLastMs() << " ms" << std::endl;
+    markAllStale();
+}
+
+// Picks up atoms the importer parsed since the last frame
+void pollImport() {
+    bool finished = importer.IsDone();  // read first, so nothing published before it is missed
+    size_t before = importedScene.atoms.size();
+    if (importer.Poll(importedScene)) {
+        scene = importedScene.GetView();
+        growBounds(before, scene.atomCount);
+        if (before == 0 && !replay.IsActive()) fitCamera();
+    }
+    if (!finished) return;
+    
+    importing = false;
+    std::cout << "Imported " << scene.atomCount << " atoms";
+    size_t frames = importer.GetFrameOffsets().size();
+    if (frames > 1 && !trajectory.IsOpen()) std::cout << " (first of " << frames << " frames)";
+    std::cout << std::endl;
+    if (!replay.IsActive() && !exportTarget) fitCamera();  // the first batch may have been a small part
+    if (!saveScenePath.empty()) SceneFile::Write(saveScenePath, scene);
+    if (showBonds) buildBonds();
+}
+
+// .atoms files are mapped at once, anything else starts a background import
+// (of just the first frame when a trajectory player takes care of the rest)
+bool loadScene(const char *path, bool firstFrameOnly = false) {
+    sceneMode = true;
+    for(int i = 0; i < 3; i++) {
+        sceneMin[i] = FLT_MAX;
+        sceneMax[i] = -FLT_MAX;
+    }
+    
+    std::string name = path;
+    if (name.size() < 6 || name.compare(name.size() - 6, 6, ".atoms") != 0) {
+        if (!importer.Start(path, StructureImporter::Format::Unknown, firstFrameOnly)) return false;
+        importing = true;
+        scene = importedScene.GetView();
+        expectedAtoms = size_t(importer.GetFileSize() / 60);  // rough line length of PDB/XYZ
+        return true;
+    }
+    
+    if (!sceneFile.Open(path)) return false;
+    scene = sceneFile.GetView();
+    expectedAtoms = scene.atomCount;
+    const SceneFileHeader &header = sceneFile.GetHeader();
+    for(int i = 0; i < 3; i++) {
+        sceneMin[i] = header.boundsMin[i];
+        sceneMax[i] = header.boundsMax[i];
+    }
+    fitCamera();
+    std::cout << "Loaded " << scene.atomCount << " atoms from " << path << std::endl;
+    if (!saveScenePath.empty()) SceneFile::Write(saveScenePath, scene);
+    return true;
+}
+
+// One unit cell of a generated lattice, repeated by --repeat
+bool buildLattice(const char *spec) {
+    Lattice lattice;
+    if (!Lattice::Parse(spec, lattice)) return false;
+    sceneMode = true;
+    lattice.FillCell(importedScene);
+    scene = importedScene.GetView();
+    expectedAtoms = scene.atomCount;
+    for(int i = 0; i < 3; i++) {
+        sceneMin[i] = FLT_MAX;
+        sceneMax[i] = -FLT_MAX;
+    }
+    growBounds(0, scene.atomCount);
+    fitCamera();
+    std::cout << "Lattice " << spec << ": " << scene.atomCount << " atoms per cell, "
+              << (long long)scene.atomCount * sceneRepeat[0] * sceneRepeat[1] * sceneRepeat[2] << " in all" << std::endl;
+    if (!saveScenePath.empty()) SceneFile::Write(saveScenePath, scene);
+    return true;
+}
+
+// Cell vector v with the scene transform's rotation and scale
+void worldCellVector(int v, float out[3]) {
+    const float *m = scene.transform, *c = scene.cell + v*3;
+    for(int r = 0; r < 3; r++) out[r] = m[r]*c[0] + m[4+r]*c[1] + m[8+r]*c[2];
+}
+
+void buildLatticeLists() {
+    if (!latticeLists) latticeLists = glGenLists(4);
+    glNewList(latticeLists, GL_COMPILE);
+    for(GLuint list : sceneLists) glCallList(list);
+    glEndList();
+    for(int level = 1; level <= 3; level++) {
+        float step[3];
+        worldCellVector(level - 1, step);
+        glNewList(latticeLists + level, GL_COMPILE);
+        glPushMatrix();
+        for(int n = 0; n < sceneRepeat[level - 1]; n++) {
+            glCallList(latticeLists + level - 1);
+            glTranslatef(step[0], step[1], step[2]);
+        }
+        glPopMatrix();
+        glEndList();
+    }
+    latticeBlocks = sceneLists.size();
+}
+
+void sceneMaterial(const float color[3]) {
+    GLfloat matAmbient[] = {color[0]*0.3f, color[1]*0.3f, color[2]*0.3f, 1.0f};
+    GLfloat matDiffuse[] = {color[0], color[1], color[2], 1.0f};
+    glMaterialfv(GL_FRONT, GL_AMBIENT, matAmbient);
+    glMaterialfv(GL_FRONT, GL_DIFFUSE, matDiffuse);
+    glColor3fv(color);
+}
+
+// Cylinder of the given radius from one point to another, the unit cylinder turned onto
+// the direction the way drawOrbit turns its circle onto the normal
+void drawBondHalf(const float from[3], const float to[3], float radius) {
+    float d[3] = {to[0] - from[0], to[1] - from[1], to[2] - from[2]};
+    float length = sqrtf(d[0]*d[0] + d[1]*d[1] + d[2]*d[2]);
+    if (length < 1e-6f) return;
+    glPushMatrix();
+    glTranslatef(from[0], from[1], from[2]);
+    if (fabsf(d[0]) + fabsf(d[1]) > 1e-6f * length) {
+        glRotatef(acosf(std::min(std::max(d[2] / length, -1.0f), 1.0f)) * 180/M_PI, -d[1], d[0], 0.0f);
+    }
+    else if (d[2] < 0.0f) glRotatef(180.0f, 1.0f, 0.0f, 0.0f);
+    glScalef(radius, radius, length);
+    glCallList(bondCylinder);
+    glPopMatrix();
+}
+
+// Bonds with their first atom in atoms [first, last)
+std::vector<Bond>::const_iterator firstBond(size_t first) {
+    const std::vector<Bond> &bonds = bondFinder->GetBonds();
+    return std::lower_bound(bonds.begin(), bonds.end(), uint32_t(first),
+                            [](const Bond &bond, uint32_t atom) { return bond.a < atom; });
+}
+
+void compileSceneBlock(size_t block) {
+    glNewList(sceneLists[block], GL_COMPILE);
+    size_t first = block * sceneBlock, last = std::min((block + 1) * sceneBlock, scene.atomCount);
+    for(size_t i = first; i < last; i++) {
+        float center[3], radius, color[3];
+        sceneAtom(i, center, radius, color);
+        sceneMaterial(color);
+        PickBuffer::TagFixedFunction(MakePickID(PickKind::Atom, uint32_t(i)));
+        glPushMatrix();
+        glTranslatef(center[0], center[1], center[2]);
+        glScalef(radius, radius, radius);
+        glCallList(sceneSphere);
+        glPopMatrix();
+    }
+    if (showBonds && bondFinder) {
+        const float *m = scene.transform;
+        float radius = bondRadius * sqrtf(m[0]*m[0] + m[1]*m[1] + m[2]*m[2]);
+        for(auto bond = firstBond(first); bond != bondFinder->GetBonds().end() && bond->a < last; ++bond) {
+            float a[3], b[3], middle[3], colorA[3], colorB[3], unused;
+            sceneAtom(bond->a, a, unused, colorA);
+            sceneAtom(bond->b, b, unused, colorB);
+            for(int k = 0; k < 3; k++) middle[k] = 0.5f * (a[k] + b[k]);
+            PickBuffer::TagFixedFunction(MakePickID(PickKind::Bond, uint32_t(bond - bondFinder->GetBonds().begin())));
+            sceneMaterial(colorA);
+            drawBondHalf(a, middle, radius);
+            sceneMaterial(colorB);
+            drawBondHalf(middle, b, radius);
+        }
+    }
+    PickBuffer::TagFixedFunction(0);
+    glEndList();
+}
+
+void drawScene() {
+    if (!sceneSphere) {
+        // tessellation drops with size so huge structures still draw at interactive rates
+        double drawn = double(expectedAtoms) * (repeating() ? sceneRepeat[0] * sceneRepeat[1] * sceneRepeat[2] : 1);
+        int slices = drawn > 100000 ? 6 : drawn > 10000 ? 8 : 16;
+        sceneSphere = glGenLists(1);
+        glNewList(sceneSphere, GL_COMPILE);
+        glutSolidSphere(1.0, slices, slices / 2 + 2);
+        glEndList();
+        
+        GLUquadric *quadric = gluNewQuadric();
+        bondCylinder = glGenLists(1);
+        glNewList(bondCylinder, GL_COMPILE);
+        gluCylinder(quadric, 1.0, 1.0, 1.0, slices, 1);  // open ends, the atoms cover them
+        glEndList();
+        gluDeleteQuadric(quadric);
+    }
+    if (listedAtoms < scene.atomCount) {
+        // new atoms fill up the last block and start new ones
+        size_t blocks = (scene.atomCount + sceneBlock - 1) / sceneBlock;
+        if (listedAtoms % sceneBlock) staleLists[listedAtoms / sceneBlock] = true;
+        staleLists.resize(blocks, true);
+        while(sceneLists.size() < blocks) sceneLists.push_back(glGenLists(1));
+        listedAtoms = scene.atomCount;
+    }
+    for(size_t b = 0; b < sceneLists.size(); b++) {
+        if (staleLists[b]) {
+            compileSceneBlock(b);
+            staleLists[b] = false;
+        }
+        if (!repeating()) glCallList(sceneLists[b]);
+    }
+    if (repeating()) {
+        // the nested lists call the block lists by name, so recompiled blocks show up in
+        // every cell without touching them; only new blocks need a new cell list
+        if (latticeBlocks != sceneLists.size()) buildLatticeLists();
+        glCallList(latticeLists + 3);
+    }
+}
+
+//======================================================================================
+// TRAJECTORY HELPERS
+//======================================================================================
+bool openTrajectory(const char *path, bool asScene) {
+    if (!trajectory.Open(path)) return false;
+    if (!asScene) return true;
+    if (TrajectoryPlayer::DetectFormat(path) != TrajectoryPlayer::Format::XYZ) {
+        std::cout << "ERROR::TRAJECTORY::NEEDS_SCENE a DCD has no elements, give the structure with --scene" << std::endl;
+        return false;
+    }
+    return loadScene(path, true);
+}
+
+// Moves trajectoryFrame by delta, wrapping once the whole trajectory is indexed
+void stepTrajectory(long long delta) {
+    long long frames = trajectory.GetFrameCount();
+    if (frames == 0) return;
+    long long next = trajectoryFrame + delta;
+    if (trajectory.IsIndexed()) next = ((next % frames) + frames) % frames;
+    else next = std::min(std::max(next, 0LL), frames - 1);
+    trajectoryFrame = next;
+}
+
+// Puts trajectoryFrame on screen if it has been loaded (wait: block until it is) and marks
+// the display lists of the atoms that moved, and of the bonds that moved with them
+void updateTrajectory(bool wait) {
+    if (!trajectory.IsOpen() || importing) return;
+    if (shownFrame < 0) {
+        if (scene.atomCount != trajectory.GetAtomCount()) {
+            std::cout << "ERROR::TRAJECTORY::ATOM_COUNT_MISMATCH structure has " << scene.atomCount
+                      << " atoms, trajectory " << trajectory.GetAtomCount() << std::endl;
+            trajectory.Close();
+            return;
+        }
+        if (scene.atoms != importedScene.atoms.data()) {
+            // a mapped .atoms file is read-only, the positions need a copy to change
+            importedScene.atoms.assign(scene.atoms, scene.atoms + scene.atomCount);
+            importedScene.elements.assign(scene.elements, scene.elements + scene.atomCount);
+            if (scene.colors) importedScene.colors.assign(scene.colors, scene.colors + scene.atomCount);
+            memcpy(importedScene.transform, scene.transform, sizeof(importedScene.transform));
+            if (scene.cell) memcpy(importedScene.cell, scene.cell, sizeof(importedScene.cell));
+            importedScene.periodic = scene.cell != nullptr;
+            scene = importedScene.GetView();
+        }
+    }
+    else if (trajectoryPlaying && shownFrame == trajectoryFrame) stepTrajectory(1);
+    if (trajectoryFrame == shownFrame) return;
     
+    trajectory.Seek(trajectoryFrame);
+    movedAtoms.clear();
+    if (!trajectory.Apply(trajectoryFrame, importedScene.atoms.data(), importedScene.atoms.size(), movedAtoms, wait)) return;
+    shownFrame = trajectoryFrame;
+    for(const AtomRange &range : movedAtoms) {
+        size_t first = range.first / sceneBlock, last = (range.first + range.count - 1) / sceneBlock;
+        for(size_t b = first; b <= last && b < staleLists.size(); b++) staleLists[b] = true;
+    }
+    
+    if (!showBonds || !bondFinder) return;
+    if (bondFinder->Update(scene, movedAtoms)) markAllStale();
+    else if (!staleLists.empty()) {
+        // a bond is compiled with its first atom, which can sit in an earlier block than
+        // the second one that moved
+        bool *moved = frameArena.AllocateArray<bool>(staleLists.size());
+        std::copy(staleLists.begin(), staleLists.end(), moved);
+        for(const Bond &bond : bondFinder->GetBonds()) {
+            if (moved[bond.b / sceneBlock]) staleLists[bond.a / sceneBlock] = true;
+        }
+    }
+}
+
+//======================================================================================
+// SCENE SUBMISSION FOR THE SOFTWARE RENDERER
+//======================================================================================
+// Same scene as display(), through the backend interface
+void submitScene(RenderBackend &renderer) {
+    RenderCamera camera = {
+        {camX, camY, camZ}, {lookX, lookY, lookZ}, {0.0f, 1.0f, 0.0f},
+        45.0f, 0.1f, farPlane
+    };
+    renderer.SetLight(lightPos, true);  // set under an identity modelview in initGL
+    renderer.SetLighting(lightingEnabled);
+    renderer.BeginFrame(camera, kClearColor);
+    
+    long long cells = repeating() ? (long long)sceneRepeat[0] * sceneRepeat[1] * sceneRepeat[2] : 1;
+    float cellVectors[3][3] = {};
+    for(int v = 0; v < 3 && cells > 1; v++) worldCellVector(v, cellVectors[v]);
+    for(long long c = 0; c < cells; c++) {
+        long long index[3] = {c % sceneRepeat[0], (c / sceneRepeat[0]) % sceneRepeat[1], c / (sceneRepeat[0] * sceneRepeat[1])};
+        float offset[3];
+        for(int k = 0; k < 3; k++) {
+            offset[k] = index[0]*cellVectors[0][k] + index[1]*cellVectors[1][k] + index[2]*cellVectors[2][k];
+        }
+        submitSceneAtoms(renderer, scene, offset);
+        // the backends have no cylinder primitive, bonds are drawn as lines
+        for(size_t i = 0; showBonds && bondFinder && i < bondFinder->GetBonds().size(); i++) {
+            const Bond &bond = bondFinder->GetBonds()[i];
+            float a[3], b[3], middle[3], colorA[3], colorB[3], unused;
+            sceneAtom(bond.a, a, unused, colorA);
+            sceneAtom(bond.b, b, unused, colorB);
+            for(int k = 0; k < 3; k++) {
+                a[k] += offset[k];
+                b[k] += offset[k];
+                middle[k] = 0.5f * (a[k] + b[k]);
+            }
+            renderer.SetPickID(MakePickID(PickKind::Bond, uint32_t(i)));
+            renderer.DrawLine(a, middle, colorA);
+            renderer.DrawLine(middle, b, colorB);
+        }
+    }
+    
+    if (!sceneMode) submitNucleus(renderer);
+    submitElectrons(renderer, electrons);
+    
+    renderer.EndFrame();
+}
+
+// Advance the animation by one frame
+void stepElectrons() {
+    if (!electronsPlaying) return;
+    advanceElectrons(electrons);
+}
+
+//======================================================================================
+// EXCITATION AND EMISSION HELPERS
+//======================================================================================
+// Puts the excited electron on level n of its series; the ground level gives it back its
+// solved orbit and ends the excitation
+void setExcitedLevel(int level) {
+    const RydbergSeries &series = spectra[atomicNumber - 1];
+    Electron &e = electrons[excitation.electron];
+    excitation.level = level;
+    excitation.timer = excitedFrames;
+    if (level == series.groundN) {
+        e.radius = excitation.groundRadius;
+        e.speed = excitation.groundSpeed;
+        excitation.electron = -1;
+        return;
+    }
+    e.radius = orbitRadius(series.MeanRadius(level));
+    e.speed = orbitSpeed(series.Energy(level), series.MeanRadius(level));
+}
+
+// The atom's outermost electron climbs to a random level, then falls one random line at a
+// time, flashing a frame's worth of photons per frame it spent up there
+void stepExcitation() {
+    if (electrons.empty()) return;
+    const RydbergSeries &series = spectra[atomicNumber - 1];
+    if (excitation.electron < 0) {
+        int outer = 0;
+        for(size_t i = 1; i < electrons.size(); i++) {
+            if (electrons[i].radius > electrons[outer].radius) outer = int(i);
+        }
+        excitation.electron = outer;
+        excitation.groundRadius = electrons[outer].radius;
+        excitation.groundSpeed = electrons[outer].speed;
+        setExcitedLevel(series.groundN + 1 + int(photons->Random() % (RydbergSeries::kLevels - 1)));
+        return;
+    }
+    if (--excitation.timer > 0) return;
+
+    int upper = excitation.level - series.groundN;
+    int lower = int(photons->Random() % upper);
+    float origin[3];
+    const Electron &e = electrons[excitation.electron];
+    orbitPoint(e, e.angle, origin);
+    photons->Emit(origin, series.color[upper][lower], size_t(photonRate) * excitedFrames, 0.05f);
+    setExcitedLevel(series.groundN + lower);
+}
+
+// Bursts from random atoms of the structure, each a random line of the atom's element
+void emitFromScene() {
+    if (scene.atomCount == 0) return;
+    const int burst = 64;
+    float diagonal = sqrtf((sceneMax[0] - sceneMin[0]) * (sceneMax[0] - sceneMin[0]) +
+                           (sceneMax[1] - sceneMin[1]) * (sceneMax[1] - sceneMin[1]) +
+                           (sceneMax[2] - sceneMin[2]) * (sceneMax[2] - sceneMin[2]));
+    for(int emitted = 0; emitted < photonRate; emitted += burst) {
+        size_t atom = photons->Random() % scene.atomCount;
+        float center[3], radius, color[3];
+        sceneAtom(atom, center, radius, color);
+        int element = std::min(std::max(int(scene.elements[atom]), 1), kElementCount);
+        const RydbergSeries &series = spectra[element - 1];
+        int upper = 1 + int(photons->Random() % (RydbergSeries::kLevels - 1));
+        int lower = int(photons->Random() % upper);
+        photons->Emit(center, series.color[upper][lower], size_t(std::min(burst, photonRate - emitted)), 0.005f * diagonal);
+    }
+}
+
+// One frame of emission and photon flight; pausing the electrons freezes the light too
+void stepPhotons() {
+    if (!electronsPlaying) return;
+    if (emitting && !photons) {
+        solveShells();
+        photons = new PhotonSystem();
+    }
+    if (!photons) return;
+    if (emitting) {
+        if (sceneMode) emitFromScene();
+        else stepExcitation();
+    }
+    photons->Step();
+}
+
+// Additive points: they light up what's behind them and never hide it
+void drawPhotons() {
+    size_t first[2], count[2];
+    int ranges = photons ? photons->GetRanges(first, count) : 0;
+    if (ranges == 0) return;
+    PickBuffer::TagFixedFunction(0);
+    glDisable(GL_LIGHTING);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+    glDepthMask(GL_FALSE);
+    glPointSize(2.0f);
+    glInterleavedArrays(GL_C4UB_V3F, 0, photons->GetVertices());
+    for(int r = 0; r < ranges; r++) glDrawArrays(GL_POINTS, GLint(first[r]), GLsizei(count[r]));
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glPointSize(1.0f);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+    if (lightingEnabled) glEnable(GL_LIGHTING);
+}
+
+//======================================================================================
+// CAPTURE / REPLAY HELPERS
+//======================================================================================
+void finishExport();
+
+void finishCapture() {
+    recorder.End();
+    finishExport();
+    if (framePacer && framePacer->GetLatency().Size() > 0) {
+        std::cout << "Input to GPU finish, " << framePacer->GetFramesAhead() << " frame(s) ahead: ";
+        if (!latencyPath.empty()) framePacer->GetLatency().Write(latencyPath);
+        else std::cout << framePacer->GetLatency().Summary() << std::endl;
+    }
+    if (photons) {
+        std::cout << "Photons: " << photons->GetLiveCount() << " live of " << photons->GetCapacity() << ", "
+                  << photons->GetDropped() << " dropped, last step " << photons->GetLastMs() << " ms" << std::endl;
+    }
+    if (layerCache && layerCache->GetLayerDraws() > 0) {
+        std::cout << "Layer cache: drawn " << layerCache->GetLayerDraws() << " times, reused for "
+                  << layerCache->GetReusedFrames() << " frames" << std::endl;
+    }
+    if (frameStats.Size() > 0) {
+        if (!timingsPath.empty()) frameStats.Write(timingsPath);
+        else std::cout << frameStats.Summary() << std::endl;
+    }
+    if (frameAllocations.GetFrameCount() > 0) std::cout << frameAllocations.Summary() << std::endl;
+}
+
+// Snapshot of everything a frame depends on besides the electron animation
+CameraSample currentSample() {
+    CameraSample s;
+    s.frame = 0;
+    s.element = atomicNumber;
+    s.position[0] = camX; s.position[1] = camY; s.position[2] = camZ;
+    s.target[0] = lookX; s.target[1] = lookY; s.target[2] = lookZ;
+    s.yaw = angleY;
+    s.pitch = angleX;
+    s.zoom = 45.0f;
+    s.flags = (lightingEnabled ? uint32_t(CAPTURE_LIGHTING) : 0u) | (electronsPlaying ? 0u : uint32_t(CAPTURE_PAUSED)) |
+              (emitting ? uint32_t(CAPTURE_EMITTING) : 0u);
+    return s;
+}
+
+void applySample(const CameraSample& s) {
+    camX = s.position[0]; camY = s.position[1]; camZ = s.position[2];
+    lookX = s.target[0]; lookY = s.target[1]; lookZ = s.target[2];
+    angleY = s.yaw;
+    angleX = s.pitch;
+    lightingEnabled = (s.flags & CAPTURE_LIGHTING) != 0;
+    electronsPlaying = (s.flags & CAPTURE_PAUSED) == 0;
+    emitting = (s.flags & CAPTURE_EMITTING) != 0;
+    // an element switch restarts the electrons, exactly as the key press did
+    if (s.element != atomicNumber) {
+        atomicNumber = s.element;
+        initElectrons(atomicNumber);
+    }
+}
+
+//======================================================================================
+// EXPORT HELPERS
+//======================================================================================
+// Places the camera on a circle around the look-at point, at the starting distance and height
+void orbitCamera(float degrees) {
+    static const float startX = camX - lookX, startY = camY, startZ = camZ - lookZ;
+    float rad = degrees * M_PI / 180.0f;
+    camX = lookX + startX * cos(rad) + startZ * sin(rad);
+    camY = startY;
+    camZ = lookZ - startX * sin(rad) + startZ * cos(rad);
+}
+
+// Hands finished readbacks to the exporter, waiting for the oldest waitFor of them
+void collectExported(int waitFor) {
+    while (exportTarget->GetPending() > 0) {
+        uint8_t* buffer = exporter.AcquireBuffer();
+        if (!exportTarget->Collect(buffer, waitFor-- > 0)) {
+            exporter.Release(buffer);
+            break;
+        }
+        exporter.Submit(buffer);
+    }
+}
+
+OffscreenCapture::GLProc loadGLProc(const char* name) {
+#ifdef FREEGLUT
+    return reinterpret_cast<OffscreenCapture::GLProc>(glutGetProcAddress(name));
+#else
+    (void)name;
+    return nullptr;
+#endif
+}
+
+bool startExport() {
+    exportTarget = new OffscreenCapture(softwareWidth, softwareHeight, loadGLProc);
+    if (!exportTarget->IsSupported()) {
+        std::cout << "ERROR::EXPORT::OFFSCREEN_RENDERING_UNSUPPORTED" << std::endl;
+        return false;
+    }
+    bool opened = exportPipe.empty()
+        ? exporter.OpenImages(exportPrefix, softwareWidth, softwareHeight, std::max(2, (int)std::thread::hardware_concurrency() / 2))
+        : exporter.OpenPipe(exportPipe, softwareWidth, softwareHeight);
+    if (!opened) return false;
+    std::cout << "Exporting " << softwareWidth << "x" << softwareHeight << " to "
+              << (exportPipe.empty() ? exportPrefix + "_*.ppm" : exportPipe) << std::endl;
+    exportStart = std::chrono::steady_clock::now();
+    return true;
+}
+
+void finishExport() {
+    if (!exportTarget) return;
+    collectExported(exportTarget->GetPending());
+    exporter.Finish();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - exportStart).count();
+    std::cout << "Exported " << exporter.GetFramesWritten() << " frames in " << seconds << " s ("
+              << exporter.GetFramesWritten() / seconds << " fps), " << exporter.GetBlockedMs()
+              << " ms waiting on the writers" << std::endl;
+    delete exportTarget;
+    exportTarget = nullptr;
+}
+
+//======================================================================================
+// PICKING HELPERS
+//======================================================================================
+// What a pick ID names, for the title bar and --pick
+// Writes what the ID is into text, "" for nothing; the hover title changes often enough
+// that it is built without a std::string
+const char *describePick(uint32_t id, char *text, size_t size) {
+    uint32_t index = GetPickIndex(id);
+    switch(GetPickKind(id)) {
+        case PickKind::Atom:
+            if (index >= scene.atomCount) break;
+            {
+                const float *p = scene.atoms[index].position;
+                int element = scene.elements[index];
+                snprintf(text, size, "atom %u: %s (Z=%d) at (%.3f, %.3f, %.3f)",
+                         index, GetElement(element).symbol, element, p[0], p[1], p[2]);
+            }
+            return text;
+        case PickKind::Bond:
+            if (!bondFinder || index >= bondFinder->GetBonds().size()) break;
+            {
+                const Bond &bond = bondFinder->GetBonds()[index];
+                const float *a = scene.atoms[bond.a].position, *b = scene.atoms[bond.b].position;
+                float length = sqrtf((a[0]-b[0])*(a[0]-b[0]) + (a[1]-b[1])*(a[1]-b[1]) + (a[2]-b[2])*(a[2]-b[2]));
+                snprintf(text, size, "bond %s %u - %s %u, %.3f A",
+                         GetElement(scene.elements[bond.a]).symbol, bond.a,
+                         GetElement(scene.elements[bond.b]).symbol, bond.b, length);
+            }
+            return text;
+        case PickKind::Electron:
+            if (index >= electrons.size()) break;
+            snprintf(text, size, "electron %u of %s: shell n=%d (%d%c), orbit radius %.2f",
+                     index + 1, GetElement(atomicNumber).symbol, electrons[index].shell, electrons[index].shell,
+                     "spdf"[electrons[index].l], electrons[index].radius);
+            return text;
+        case PickKind::Nucleus:
+            snprintf(text, size, "nucleus of %s (Z=%d)", GetElement(atomicNumber).symbol, atomicNumber);
+            return text;
+        default:
+            break;
+    }
+    text[0] = '\0';
+    return text;
+}
+
+void setHoverTitle() {
+    char info[200], title[240];
+    describePick(hoveredID, info, sizeof(info));
+    snprintf(title, sizeof(title), "Atomic Structure Visualizer - %s", info);
+    glutSetWindowTitle(info[0] ? title : "Atomic Structure Visualizer");
+}
+
+// Takes the ID under the cursor from the readbacks that have finished
+void pollHover() {
+    uint32_t picked;
+    if (pickBuffer && pickBuffer->Poll(picked) && hoverInfo && picked != hoveredID) {
+        hoveredID = picked;
+        setHoverTitle();
+    }
+}
+
+bool startHoverInfo() {
+    if (!pickBuffer) {
+        pickBuffer = new PickBuffer(glutGet(GLUT_WINDOW_WIDTH), glutGet(GLUT_WINDOW_HEIGHT), loadGLProc);
+        if (!pickBuffer->IsSupported()) {
+            std::cout << "ERROR::PICKING::ID_BUFFER_UNSUPPORTED" << std::endl;
+            delete pickBuffer;
+            pickBuffer = nullptr;
+            return false;
+        }
+    }
+    return true;
+}
+
+// --pick in the software modes. The ray tracer still has the frame's BVH; the rasterizer
+// keeps no IDs, so the frame goes once more through a ray tracer, at one sample per pixel
+// without shadows or occlusion, for its BVH.
+uint32_t pickPixel(RayTracer &renderer) {
+    return renderer.Pick(pickX + 0.5f, pickY + 0.5f);
+}
+
+uint32_t pickPixel(SoftwareRasterizer &) {
+    RayTracer picker(softwareWidth, softwareHeight);
+    RayTracer::Settings settings = picker.GetSettings();
+    settings.samplesPerPixel = 1;
+    settings.aoSamples = 0;
+    settings.shadows = false;
+    picker.SetSettings(settings);
+    submitScene(picker);
+    return picker.Pick(pickX + 0.5f, pickY + 0.5f);
+}
+
+//======================================================================================
+// ON-DEMAND RENDERING HELPERS
+//======================================================================================
+// Anything that keeps the picture changing without input
+bool animating() {
+    bool lit = emitting || (photons && photons->GetLiveCount() > 0);
+    return (electronsPlaying && (!electrons.empty() || lit)) || importing || exportTarget || replay.IsActive() ||
+           (trajectory.IsOpen() && (trajectoryPlaying || shownFrame != trajectoryFrame));
+}
+
+// Installed after every frame; removes itself once nothing moves, so GLUT blocks on input
+void idle() {
+    // hover results still arrive a frame or two after the last redraw
+    if (pickBuffer && pickBuffer->GetPending() > 0) pollHover();
+    if (animating()) glutPostRedisplay();
+    else if (!pickBuffer || pickBuffer->GetPending() == 0) glutIdleFunc(nullptr);
+}
+
+// Atoms the next drawScene() will compile
+bool sceneListsStale() {
+    return listedAtoms < scene.atomCount || std::find(staleLists.begin(), staleLists.end(), true) != staleLists.end();
+}
+
+// True when the static layers differ from the last frame's: camera, lighting or element
+// (what currentSample() records), the window, the projection, the atoms or the excited
+// electron's orbit
+bool staticLayersChanged() {
+    static CameraSample last = {};
+    static int lastWidth = 0, lastHeight = 0;
+    static float lastFarPlane = 0.0f;
+    static int lastExcited = -1, lastLevel = 0;
+    CameraSample now = currentSample();
+    now.flags &= ~(CAPTURE_PAUSED | CAPTURE_EMITTING);
+    int width = glutGet(GLUT_WINDOW_WIDTH), height = glutGet(GLUT_WINDOW_HEIGHT);
+    bool changed = memcmp(&now, &last, sizeof(now)) != 0 || width != lastWidth || height != lastHeight ||
+                   farPlane != lastFarPlane || (sceneMode && sceneListsStale()) ||
+                   excitation.electron != lastExcited || excitation.level != lastLevel;
+    last = now;
+    lastWidth = width;
+    lastHeight = height;
+    lastFarPlane = farPlane;
+    lastExcited = excitation.electron;
+    lastLevel = excitation.level;
+    return changed;
+}
+
+void startDynamicResolution() {
+    dynamicResolution = new DynamicResolution(glutGet(GLUT_WINDOW_WIDTH), glutGet(GLUT_WINDOW_HEIGHT), loadGLProc, frameBudgetMs);
+    if (!dynamicResolution->IsSupported()) {
+        delete dynamicResolution;
+        dynamicResolution = nullptr;
+    }
+}
+
+void startFramePacer() {
+    framePacer = new FramePacer(loadGLProc, framesAhead);
+    if (!framePacer->IsSupported()) {
+        delete framePacer;
+        framePacer = nullptr;
+    }
+}
+
+void startLayerCache() {
+    layerCache = new LayerCache(glutGet(GLUT_WINDOW_WIDTH), glutGet(GLUT_WINDOW_HEIGHT), loadGLProc);
+    if (!layerCache->IsSupported()) {
+        delete layerCache;
+        layerCache = nullptr;
+    }
+}
+
+void applyCamera() {
     // Work with modelview matrix (for 3D transformations)
     glMatrixMode(GL_MODELVIEW);
     
@@ -250,34 +1130,171 @@ void display() {
     gluLookAt(camX, camY, camZ,     // Eye position
               lookX, lookY, lookZ,  // Look-at point (target)
               0.0f, 1.0f, 0.0f);    // Up vector (world's "up" direction)
+}
 
-    // Draw nucleus particles
-    glColor3f(0.8f, 0.3f, 0.2f);  // Reddish color for nucleus
-    for(const auto &pos : nuclearPositions) {
-        glPushMatrix();                            // Save transformation state
-        glTranslatef(pos[0], pos[1], pos[2]);      // Move to particle position
-        drawSphere(0.8f, 0.3f, 0.2f);              // Draw particle as colored sphere
-        glPopMatrix();                             // Restore transformation state
+// Everything that only changes with the camera: the nucleus or structure and the orbits
+void drawStaticLayers() {
+    // A loaded structure replaces the nucleus (and has no electrons)
+    if (sceneMode) drawScene();
+    else {
+        // Draw nucleus particles
+        glColor3f(0.8f, 0.3f, 0.2f);  // Reddish color for nucleus
+        for(size_t i = 0; i < kNucleonCount; i++) {
+            const float *pos = kNucleusPositions[i];
+            PickBuffer::TagFixedFunction(MakePickID(PickKind::Nucleus, uint32_t(i)));
+            glPushMatrix();                            // Save transformation state
+            glTranslatef(pos[0], pos[1], pos[2]);      // Move to particle position
+            drawSphere(0.8f, 0.3f, 0.2f);              // Draw particle as colored sphere
+            glPopMatrix();                             // Restore transformation state
+        }
     }
     
-    // Draw electrons and their orbitals
-    for(auto &e : electrons) {
-        drawElectron(e);      // Draw the electron itself
-        drawOrbit(e);         // Draw its orbital path
-        
-        // Update electron position for next frame (animation)
-        e.angle += e.speed * 0.025f;  // 0.016 seconds = ~60 FPS
-        if(e.angle > 360) e.angle -= 360;  // Keep angle in 0-360 range
+    // Draw the orbital paths
+    PickBuffer::TagFixedFunction(0);
+    for(const Electron &e : electrons) drawOrbit(e);
+}
+
+void drawElectrons() {
+    for(size_t i = 0; i < electrons.size(); i++) {
+        PickBuffer::TagFixedFunction(MakePickID(PickKind::Electron, uint32_t(i)));
+        drawElectron(electrons[i]);
     }
+}
+
+//======================================================================================
+// MAIN DISPLAY FUNCTION - CALLED TO RENDER EACH FRAME
+//======================================================================================
+void display() {
+    auto frameStart = std::chrono::steady_clock::now();
+    frameAllocations.BeginFrame();
+    frameArena.Reset();
+    // exports want throughput, not latency, and keep their own readback ring busy
+    bool pacing = framePacer && !exportTarget;
+    if (pacing) framePacer->BeginFrame();
+    if (importing) pollImport();
+    // captures must show every frame, so only they wait for the loaders
+    updateTrajectory(replay.IsActive() || exportTarget);
+    if (exportTarget && !replay.IsActive()) {
+        if (exportFrame == softwareFrames) {
+            finishCapture();
+            exit(0);
+        }
+        orbitCamera(360.0f * exportFrame / softwareFrames);
+    }
+    if (replay.IsActive()) {
+        CameraSample sample;
+        if (!replay.Next(sample)) {
+            finishCapture();
+            exit(0);
+        }
+        applySample(sample);
+        if (lightingEnabled) glEnable(GL_LIGHTING);
+        else glDisable(GL_LIGHTING);
+    }
+    recorder.Record(currentSample());
     
+    // the ID under the cursor a frame or two ago
+    pollHover();
+    bool picking = hoverInfo && pickBuffer && !exportTarget;
+    
+    // The static layers come from the cache once they have stayed the same for a frame, so
+    // a moving camera doesn't pay for filling it. The ID buffer needs every object each
+    // frame, and exports have their own target, so neither uses it.
+    bool scaling = dynamicResolution && !picking && !exportTarget && !replay.IsActive();
+    int frameWidth = glutGet(GLUT_WINDOW_WIDTH), frameHeight = glutGet(GLUT_WINDOW_HEIGHT);
+    if (scaling) {
+        // binds the scaled target, or the window at full scale
+        dynamicResolution->Begin();
+        frameWidth = dynamicResolution->GetRenderWidth();
+        frameHeight = dynamicResolution->GetRenderHeight();
+    }
+    
+    bool layersChanged = staticLayersChanged();
+    if (layerCache) {
+        layerCache->Resize(frameWidth, frameHeight);
+        if (layersChanged) layerCache->Invalidate();
+    }
+    bool cached = layerCache && !layersChanged && !picking && !exportTarget;
+    if (cached && !layerCache->IsValid()) {
+        layerCache->BeginLayers();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        applyCamera();
+        drawStaticLayers();
+        layerCache->EndLayers();
+    }
+
+    if (exportTarget) {
+        exportTarget->Bind();
+        glMatrixMode(GL_PROJECTION);
+        glLoadIdentity();
+        gluPerspective(45.0, (float)softwareWidth/softwareHeight, 0.1, farPlane);
+    }
+    else if (cached) layerCache->BeginFrame();
+    else if (picking) pickBuffer->Bind();
+
+    // Clear color and depth buffers (a cached frame starts from the layers instead)
+    if (!cached) glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    if (picking) pickBuffer->BeginIDs(true);
+    
+    applyCamera();
+    if (!cached) drawStaticLayers();
+    drawElectrons();
+    drawPhotons();
+    
+    if (picking) {
+        pickBuffer->EndIDs();
+        // a full ring just skips this frame's request
+        pickBuffer->Request(mouseX, pickBuffer->GetHeight() - 1 - mouseY);
+        pickBuffer->BlitToWindow(glutGet(GLUT_WINDOW_WIDTH), glutGet(GLUT_WINDOW_HEIGHT));
+    }
+    else if (cached) layerCache->Present(frameWidth, frameHeight, scaling ? dynamicResolution->GetFramebuffer() : 0);
+    if (scaling) dynamicResolution->End();
+    
+    // Update electron positions for next frame (animation)
+    stepElectrons();
+    stepPhotons();
+    
+    if (exportTarget) {
+        // pick up whatever earlier readbacks are done; only a full ring makes us wait
+        collectExported(0);
+        if (!exportTarget->Queue()) {
+            collectExported(1);
+            exportTarget->Queue();
+        }
+        exportFrame++;
+        exportTarget->BlitToWindow(glutGet(GLUT_WINDOW_WIDTH), glutGet(GLUT_WINDOW_HEIGHT));
+    }
+    else if (replay.IsActive()) {
+        uint64_t hash = 0;
+        if (hashFrames) {
+            GLint viewport[4];
+            glGetIntegerv(GL_VIEWPORT, viewport);
+            framePixels.resize(size_t(viewport[2]) * viewport[3] * 4);
+            glReadBuffer(GL_BACK);
+            glReadPixels(0, 0, viewport[2], viewport[3], GL_RGBA, GL_UNSIGNED_BYTE, framePixels.data());
+            hash = FrameStats::HashPixels(framePixels.data(), framePixels.size());
+        }
+        // wait for the GPU so the time is the frame's real cost, not just submission
+        glFinish();
+        frameStats.Add(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count(), hash);
+    }
+
     // Swap back and front buffers (double buffering)
     glutSwapBuffers();
+    if (pacing) framePacer->EndFrame();
+    frameAllocations.EndFrame();
+    
+    // keep drawing while anything moves; idle() stops once nothing does
+    glutIdleFunc(idle);
 }
 
 //======================================================================================
 // WINDOW RESIZE HANDLER
 //======================================================================================
 void reshape(int w, int h) {
+    if (pickBuffer) pickBuffer->Resize(w, h);
+    if (dynamicResolution) dynamicResolution->Resize(w, h);
+    
     // Update viewport to cover entire window
     glViewport(0, 0, w, h);
     
@@ -287,8 +1304,8 @@ void reshape(int w, int h) {
     
     // Set perspective projection with:
     // 45° field of view, aspect ratio based on window dimensions,
-    // near clipping plane at 0.1, far clipping plane at 100.0
-    gluPerspective(45.0, (float)w/h, 0.1, 100.0);
+    // near clipping plane at 0.1, far clipping plane at farPlane (100 unless a large structure is loaded)
+    gluPerspective(45.0, (float)w/h, 0.1, farPlane);
 }
 
 //======================================================================================
@@ -314,9 +1331,14 @@ void keyboard(unsigned char key, int x, int y) {
     // Track mouse capture state
     static bool mouseCaptured = false;
     
+    // During replay the capture drives the camera, only ESC is honoured
+    if (replay.IsActive() && key != 27) return;
+    if (framePacer) framePacer->NoteInput();
+    
     // Handle different key presses
     switch(key) {
         case 27: // ESC key - exit program
+            finishCapture();
             exit(0);
             break;
         case 'w': // Move forward
@@ -368,6 +1390,41 @@ void keyboard(unsigned char key, int x, int y) {
             if(lightingEnabled) glEnable(GL_LIGHTING);
             else glDisable(GL_LIGHTING);
             break;
+        case '+': // Next element
+        case '=':
+            if (atomicNumber < 118) initElectrons(++atomicNumber);
+            break;
+        case '-': // Previous element
+            if (atomicNumber > 1) initElectrons(--atomicNumber);
+            break;
+        case 'p': // Play / pause the trajectory, or the electrons
+            if (trajectory.IsOpen()) trajectoryPlaying = !trajectoryPlaying;
+            else electronsPlaying = !electronsPlaying;
+            break;
+        case '.': // Step the trajectory
+        case ',':
+            trajectoryPlaying = false;
+            stepTrajectory(key == '.' ? 1 : -1);
+            break;
+        case '>': // Scrub the trajectory
+        case '<':
+            stepTrajectory(key == '>' ? 100 : -100);
+            break;
+        case 'i': // Toggle hover info
+            hoverInfo = !hoverInfo && startHoverInfo();
+            hoveredID = 0;
+            setHoverTitle();
+            break;
+        case 'e': // Excite the atom / structure and emit photons
+            emitting = !emitting;
+            break;
+        case 'b': // Toggle bonds
+            if (!sceneMode) break;
+            showBonds = !showBonds;
+            // the atoms may have moved while the bonds were hidden
+            if (showBonds && !importing) buildBonds();
+            else markAllStale();
+            break;
     }
     
     // Request a redraw with updated camera position
@@ -386,6 +1443,11 @@ void mouseMotion(int x, int y) {
     static bool firstMouse = true;  // Flag for first mouse movement
     static bool mouseCaptured = false;
     
+    mouseX = x;
+    mouseY = y;
+    if (replay.IsActive()) return;
+    if (framePacer) framePacer->NoteInput();
+    
     // Get window dimensions
     int windowWidth = glutGet(GLUT_WINDOW_WIDTH);
     int windowHeight = glutGet(GLUT_WINDOW_HEIGHT);
@@ -472,14 +1534,276 @@ void initGL() {
     
     // Enable smooth shading (gradual color transition across polygons)
     glShadeModel(GL_SMOOTH);
+    
+    // structure atoms are a scaled unit sphere, so their normals need renormalizing
+    glEnable(GL_NORMALIZE);
+}
+
+//======================================================================================
+// HEADLESS SOFTWARE LOOP
+//======================================================================================
+template <typename Backend>
+void runSoftware(Backend &renderer) {
+    std::cout << (rayTraceMode ? "Ray tracer: " : "Software renderer: ") << softwareWidth << "x" << softwareHeight << ", "
+              << renderer.GetThreadCount() << " threads" << std::endl;
+    
+    int frames = replay.IsActive() ? static_cast<int>(replay.GetFrameCount()) : softwareFrames;
+    frameStats.Reserve(frames);
+    for(int frame = 0; frame < frames; frame++) {
+        auto frameStart = std::chrono::steady_clock::now();
+        frameAllocations.BeginFrame();
+        frameArena.Reset();
+        CameraSample sample;
+        if (replay.Next(sample)) applySample(sample);
+        recorder.Record(currentSample());
+        
+        updateTrajectory(true);
+        submitScene(renderer);
+        stepElectrons();
+        
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+        uint64_t hash = 0;
+        if (hashFrames) {
+            hash = FrameStats::HashPixels(renderer.GetPixels(), size_t(softwareWidth) * softwareHeight * 4);
+        }
+        frameStats.Add(ms, hash);
+        
+        if (!softwareOutput.empty()) {
+            char name[32];
+            snprintf(name, sizeof(name), "_%05d.ppm", frame);
+            renderer.WritePPM(softwareOutput + name);
+        }
+        frameAllocations.EndFrame();
+    }
+    if (pickX >= 0) {
+        char info[200];
+        describePick(pickPixel(renderer), info, sizeof(info));
+        std::cout << "Pixel " << pickX << "," << pickY << ": " << (info[0] ? info : "nothing") << std::endl;
+    }
+    finishCapture();
+}
+
+//======================================================================================
+// STREAMING SERVER LOOP
+//======================================================================================
+// Turns the camera around the look-at point: yaw about the world up, pitch short of the poles
+void turnCamera(float yawDegrees, float pitchDegrees) {
+    float dx = camX - lookX, dy = camY - lookY, dz = camZ - lookZ;
+    float distance = sqrtf(dx*dx + dy*dy + dz*dz);
+    float yaw = atan2f(dx, dz) - yawDegrees * float(M_PI) / 180.0f;
+    float pitch = asinf(std::min(std::max(dy / distance, -1.0f), 1.0f)) + pitchDegrees * float(M_PI) / 180.0f;
+    pitch = std::min(std::max(pitch, -1.55f), 1.55f);
+    camX = lookX + distance * cosf(pitch) * sinf(yaw);
+    camY = lookY + distance * sinf(pitch);
+    camZ = lookZ + distance * cosf(pitch) * cosf(yaw);
+}
+
+void zoomCamera(float factor) {
+    float dx = camX - lookX, dy = camY - lookY, dz = camZ - lookZ;
+    float distance = sqrtf(dx*dx + dy*dy + dz*dz);
+    float scale = std::min(std::max(distance * factor, 0.3f), 0.5f * farPlane) / distance;
+    camX = lookX + dx * scale;
+    camY = lookY + dy * scale;
+    camZ = lookZ + dz * scale;
+}
+
+// One command from a viewer: orbit DX DY, zoom F, element Z, lighting 0|1, pause
+void applyCommand(const std::string &command) {
+    float a = 0.0f, b = 0.0f;
+    int n = 0;
+    if (sscanf(command.c_str(), "orbit %f %f", &a, &b) == 2) turnCamera(a, b);
+    else if (sscanf(command.c_str(), "zoom %f", &a) == 1 && a > 0.0f) zoomCamera(a);
+    else if (sscanf(command.c_str(), "element %d", &n) == 1) {
+        if (!sceneMode && n >= 1 && n <= 118 && n != atomicNumber) initElectrons(atomicNumber = n);
+    }
+    else if (sscanf(command.c_str(), "lighting %d", &n) == 1) lightingEnabled = n != 0;
+    else if (command == "pause") electronsPlaying = !electronsPlaying;
+    else std::cout << "ERROR::SERVER::UNKNOWN_COMMAND " << command << std::endl;
+}
+
+// Renders while viewers are connected, at most serveFps frames a second, and sends each
+// frame's changed tiles to all of them. maxFrames = 0 serves until the process is killed
+template <typename Backend>
+bool runServer(Backend &renderer, int maxFrames) {
+    std::string host = "127.0.0.1";
+    size_t colon = serveAddress.rfind(':');
+    if (colon != std::string::npos) host = serveAddress.substr(0, colon);
+    int port = atoi(serveAddress.c_str() + (colon == std::string::npos ? 0 : colon + 1));
+    
+    if (host == "0.0.0.0" && serveOrigins.empty()) {
+        std::cout << "ERROR::SERVER::NO_ORIGIN --serve 0.0.0.0 needs --serve-origin http://<name>:" << port
+                  << " for the name viewers use" << std::endl;
+        return false;
+    }
+    FrameServer server;
+    if (!server.Start(host, port)) return false;
+    for (const std::string& origin : serveOrigins) server.AllowOrigin(origin);
+    TileDeltaEncoder encoder(softwareWidth, softwareHeight);
+    std::cout << "Serving http://" << host << ":" << port << "/ at up to " << serveFps << " fps, "
+              << softwareWidth << "x" << softwareHeight << " in " << encoder.GetTileCount() << " tiles, "
+              << renderer.GetThreadCount() << " threads" << std::endl;
+    
+    std::vector<std::string> commands;
+    const auto frameTime = std::chrono::microseconds(1000000 / std::max(serveFps, 1));
+    auto nextFrame = std::chrono::steady_clock::now();
+    auto reportStart = nextFrame;
+    // since the last report
+    int frames = 0, dirtyTiles = 0;
+    double renderMs = 0.0, encodeMs = 0.0;
+    uint64_t bytesBefore = 0;
+    for(int frame = 0; maxFrames == 0 || frame < maxFrames;) {
+        server.Poll(commands);
+        for(const std::string &command : commands) {
+            if (command == "keyframe") encoder.RequestKeyframe();
+            else applyCommand(command);
+        }
+        commands.clear();
+        if (server.GetClientCount() == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            nextFrame = std::chrono::steady_clock::now();
+            continue;
+        }
+        
+        auto frameStart = std::chrono::steady_clock::now();
+        frameAllocations.BeginFrame();
+        frameArena.Reset();
+        recorder.Record(currentSample());
+        updateTrajectory(false);
+        submitScene(renderer);
+        stepElectrons();
+        renderMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+        
+        if (server.NeedsKeyframe()) encoder.RequestKeyframe();
+        server.Broadcast(encoder.Encode(renderer.GetPixels(), renderer.GetRowBytes()), encoder.WasKeyframe());
+        encodeMs += encoder.GetLastMs();
+        dirtyTiles += encoder.GetDirtyTiles();
+        frameAllocations.EndFrame();
+        frames++;
+        frame++;
+        
+        auto now = std::chrono::steady_clock::now();
+        if (now - reportStart >= std::chrono::seconds(5) || frame == maxFrames) {
+            uint64_t bytes = server.GetBytesSent() - bytesBefore;
+            char report[200];
+            snprintf(report, sizeof(report), "%d frames to %d viewer(s): %.1f KB/frame, %d of %d tiles changed, render %.2f ms, encode %.2f ms, %llu dropped",
+                     frames, server.GetClientCount(), bytes / 1024.0 / frames, dirtyTiles / frames, encoder.GetTileCount(),
+                     renderMs / frames, encodeMs / frames, (unsigned long long)server.GetFramesDropped());
+            std::cout << report << std::endl;
+            reportStart = now;
+            bytesBefore = server.GetBytesSent();
+            frames = dirtyTiles = 0;
+            renderMs = encodeMs = 0.0;
+        }
+        nextFrame += frameTime;
+        if (nextFrame > now) std::this_thread::sleep_until(nextFrame);
+        else nextFrame = now;  // behind: don't try to catch up
+    }
+    finishCapture();
+    return true;
 }
 
 //======================================================================================
 // MAIN FUNCTION
 //======================================================================================
 int main(int argc, char** argv) {
-    // Get atomic number from user
-    do {
+    // no window system in software mode, so GLUT must not be initialised
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--software")) softwareMode = true;
+        if (!strcmp(argv[i], "--raytrace")) softwareMode = rayTraceMode = true;
+        if (!strcmp(argv[i], "--serve")) softwareMode = true;
+    }
+    if (!softwareMode) glutInit(&argc, argv); // strips the GLUT options, the rest are ours
+
+    bool elementGiven = false;
+    bool framesGiven = false;
+    const char* scenePath = nullptr;
+    const char* trajectoryPath = nullptr;
+    const char* latticeSpec = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--record") && i + 1 < argc) recorder.Begin(argv[++i], fixedStep);
+        else if (!strcmp(argv[i], "--replay") && i + 1 < argc) {
+            if (!replay.Load(argv[++i])) return 1;
+            frameStats.Reserve(replay.GetFrameCount());
+        }
+        else if (!strcmp(argv[i], "--timings") && i + 1 < argc) timingsPath = argv[++i];
+        else if (!strcmp(argv[i], "--hash")) hashFrames = true;
+        else if (!strcmp(argv[i], "--software") || !strcmp(argv[i], "--raytrace")) continue;
+        else if (!strcmp(argv[i], "--samples") && i + 1 < argc) rayTraceSamples = std::max(atoi(argv[++i]), 1);
+        else if (!strcmp(argv[i], "--size") && i + 1 < argc) sscanf(argv[++i], "%dx%d", &softwareWidth, &softwareHeight);
+        else if (!strcmp(argv[i], "--frames") && i + 1 < argc) {
+            softwareFrames = atoi(argv[++i]);
+            framesGiven = true;
+        }
+        else if (!strcmp(argv[i], "--serve") && i + 1 < argc) serveAddress = argv[++i];
+        else if (!strcmp(argv[i], "--serve-fps") && i + 1 < argc) serveFps = std::max(atoi(argv[++i]), 1);
+        else if (!strcmp(argv[i], "--serve-origin") && i + 1 < argc) serveOrigins.push_back(argv[++i]);
+        else if (!strcmp(argv[i], "--output") && i + 1 < argc) softwareOutput = argv[++i];
+        else if (!strcmp(argv[i], "--export") && i + 1 < argc) exportPrefix = argv[++i];
+        else if (!strcmp(argv[i], "--export-pipe") && i + 1 < argc) exportPipe = argv[++i];
+        else if (!strcmp(argv[i], "--scene") && i + 1 < argc) {
+            scenePath = argv[++i];
+            elementGiven = true;  // the structure replaces the single atom
+        }
+        else if (!strcmp(argv[i], "--save-scene") && i + 1 < argc) saveScenePath = argv[++i];
+        else if (!strcmp(argv[i], "--lattice") && i + 1 < argc) {
+            latticeSpec = argv[++i];
+            elementGiven = true;
+        }
+        else if (!strcmp(argv[i], "--repeat") && i + 1 < argc) {
+            sscanf(argv[++i], "%dx%dx%d", &sceneRepeat[0], &sceneRepeat[1], &sceneRepeat[2]);
+            for(int &n : sceneRepeat) n = std::max(n, 1);
+        }
+        else if (!strcmp(argv[i], "--bonds")) showBonds = true;
+        else if (!strcmp(argv[i], "--pick") && i + 1 < argc) sscanf(argv[++i], "%d,%d", &pickX, &pickY);
+        else if (!strcmp(argv[i], "--no-layer-cache")) useLayerCache = false;
+        else if (!strcmp(argv[i], "--no-dynamic-resolution")) useDynamicResolution = false;
+        else if (!strcmp(argv[i], "--frame-budget") && i + 1 < argc) frameBudgetMs = std::max(float(atof(argv[++i])), 1.0f);
+        else if (!strcmp(argv[i], "--frames-ahead") && i + 1 < argc) framesAhead = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--latency") && i + 1 < argc) latencyPath = argv[++i];
+        else if (!strcmp(argv[i], "--shell-cache") && i + 1 < argc) {
+            shellCachePath = argv[++i];
+            shellCacheGiven = true;
+        }
+        else if (!strcmp(argv[i], "--no-shell-cache")) {
+            shellCachePath.clear();
+            shellCacheGiven = true;
+        }
+        else if (!strcmp(argv[i], "--photons") && i + 1 < argc) {
+            photonRate = std::max(atoi(argv[++i]), 1);
+            emitting = true;
+        }
+        else if (!strcmp(argv[i], "--trajectory") && i + 1 < argc) {
+            trajectoryPath = argv[++i];
+            elementGiven = true;
+        }
+        else if (!strcmp(argv[i], "--element") && i + 1 < argc) {
+            atomicNumber = std::min(std::max(atoi(argv[++i]), 1), 118);
+            elementGiven = true;
+        }
+        else {
+            std::cout << "Usage: " << argv[0] << " [--element N | --scene file.atoms|xyz|pdb|cif | --lattice fcc:Cu[:a]] [--repeat NxMxK] [--bonds] [--save-scene out.atoms]\n"
+                      << "       [--trajectory file.xyz|dcd] [--record file] [--replay file [--timings file.csv] [--hash]]\n"
+                      << "       [--software | --raytrace [--samples N]] [--size WxH] [--frames N] [--output prefix] [--pick X,Y]\n"
+                      << "       [--serve [host:]port [--serve-fps N] [--serve-origin URL]]\n"
+                      << "       [--export prefix | --export-pipe \"ffmpeg -f rawvideo -pix_fmt rgba -s WxH -i - out.mp4\"]\n"
+                      << "       [--no-layer-cache] [--no-dynamic-resolution] [--frame-budget ms]\n"
+                      << "       [--frames-ahead N] [--latency file.csv] [--shell-cache file | --no-shell-cache] [--photons N]\n";
+            return 1;
+        }
+    }
+    if (!shellCacheGiven) shellCachePath = RadialSolver::DefaultCachePath();
+
+    if (latticeSpec) {
+        if (!buildLattice(latticeSpec)) return 1;
+    }
+    else if (scenePath && !loadScene(scenePath, trajectoryPath != nullptr)) return 1;
+    if (trajectoryPath && !openTrajectory(trajectoryPath, !scenePath && !latticeSpec)) return 1;
+    if (showBonds && sceneMode && !importing) buildBonds();  // imports find theirs when done
+
+    // Get atomic number from user (a replay already knows it)
+    if (replay.IsActive()) atomicNumber = replay.First().element;
+    else if (!elementGiven && !serveAddress.empty()) atomicNumber = 1;  // viewers pick the element
+    else if (!elementGiven) do {
         std::cout << "Enter atomic number (1-118): ";
         std::cin >> atomicNumber;
         if(std::cin.fail() || atomicNumber < 1 || atomicNumber > 118) {
@@ -490,7 +1814,28 @@ int main(int argc, char** argv) {
         else break;
     } while(true);
 
-    glutInit(&argc, argv);
+    if (softwareMode) {
+        if (!sceneMode) initElectrons(atomicNumber);
+        if (importing) {
+            importer.Wait();  // no window to watch it load in
+            pollImport();
+        }
+        if (rayTraceMode) {
+            RayTracer renderer(softwareWidth, softwareHeight);
+            RayTracer::Settings settings = renderer.GetSettings();
+            settings.samplesPerPixel = rayTraceSamples;
+            renderer.SetSettings(settings);
+            if (!serveAddress.empty()) return runServer(renderer, framesGiven ? softwareFrames : 0) ? 0 : 1;
+            runSoftware(renderer);
+        }
+        else {
+            SoftwareRasterizer renderer(softwareWidth, softwareHeight);
+            if (!serveAddress.empty()) return runServer(renderer, framesGiven ? softwareFrames : 0) ? 0 : 1;
+            runSoftware(renderer);
+        }
+        return 0;
+    }
+
     // Set up display mode:
     // - GLUT_DOUBLE: double buffering for smooth animation
     // - GLUT_RGB: color mode
@@ -500,7 +1845,11 @@ int main(int argc, char** argv) {
     glutCreateWindow("Atomic Structure Visualizer");
 
     initGL();
-    initElectrons(atomicNumber);
+    if (!sceneMode) initElectrons(atomicNumber);
+    if ((!exportPrefix.empty() || !exportPipe.empty()) && !startExport()) return 1;
+    if (useLayerCache) startLayerCache();
+    if (useDynamicResolution) startDynamicResolution();
+    startFramePacer();
 
     glutDisplayFunc(display);           // Frame rendering
     glutReshapeFunc(reshape);           // Window resize handling
@@ -508,8 +1857,8 @@ int main(int argc, char** argv) {
     glutMotionFunc(mouseMotion);        // Mouse movement with button pressed
     glutPassiveMotionFunc(mouseMotion); // Mouse movement without button press
 
-    // Set up continuous animation (call display function whenever possible)
-    glutIdleFunc([](){ glutPostRedisplay(); });
+    // Redraw continuously while something animates, sleep otherwise (see idle())
+    glutIdleFunc(idle);
 
     glutMainLoop();
     return 0;
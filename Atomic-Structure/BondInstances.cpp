@@ -0,0 +1,121 @@
+#include "headers/BondInstances.hpp"
+#include "headers/CylinderMesh.hpp"
+#include "headers/Elements.hpp"
+#include <glm/gtc/type_ptr.hpp>
+#include <iostream>
+
+BondInstances::BondInstances(const AtomInstances& atoms, const char* vertPath, const char* fragPath)
+    : atoms(atoms), VAO(0), meshVBO(0), meshEBO(0), bondVBO(0), atomTexture(0), elementTexture(0),
+    meshIndexCount(0), bondCount(0), bondCapacity(0), divisor(1), bondRadius(0.12f), initialized(false) {
+    CylinderMesh mesh;
+    meshIndexCount = static_cast<unsigned int>(mesh.GetIndices().size());
+
+    glGenVertexArrays(1, &VAO);
+    GLuint buffers[3];
+    glGenBuffers(3, buffers);
+    meshVBO = buffers[0]; meshEBO = buffers[1]; bondVBO = buffers[2];
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, meshVBO);
+    glBufferData(GL_ARRAY_BUFFER, mesh.GetVertices().size() * sizeof(SphereVertex), mesh.GetVertices().data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, sizeof(SphereVertex), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.GetIndices().size() * sizeof(uint16_t), mesh.GetIndices().data(), GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ARRAY_BUFFER, bondVBO);
+    glVertexAttribIPointer(1, 2, GL_UNSIGNED_INT, sizeof(Bond), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // views of the atoms' instance buffers; a texture buffer follows its buffer's storage,
+    // so these stay valid when AtomInstances re-uploads the scene
+    glGenTextures(1, &atomTexture);
+    glBindTexture(GL_TEXTURE_BUFFER, atomTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, atoms.GetAtomBuffer());
+    glGenTextures(1, &elementTexture);
+    glBindTexture(GL_TEXTURE_BUFFER, elementTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R16UI, atoms.GetElementBuffer());
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+    try {
+        shader = std::make_unique<Shader>(vertPath, fragPath);
+        initialized = true;
+        std::cout << "Bond instance shader compilation successful" << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cout << "Failed to create bond instance shader: " << e.what() << std::endl;
+        return;
+    }
+
+    glm::vec3 palette[kElementCount + 1];
+    for (int z = 0; z <= kElementCount; ++z) {
+        const float* c = GetElement(z).color;
+        palette[z] = glm::vec3(c[0], c[1], c[2]);
+    }
+    shader->use();
+    glUniform3fv(glGetUniformLocation(shader->ID, "elementColors"), kElementCount + 1, glm::value_ptr(palette[0]));
+    shader->setInt("atomData", 0);
+    shader->setInt("atomElements", 1);
+}
+
+void BondInstances::SetBonds(const std::vector<Bond>& bonds) {
+    bondCount = bonds.size();
+    glBindBuffer(GL_ARRAY_BUFFER, bondVBO);
+    // trajectories change a few bonds per frame, keep the storage while it fits
+    if (bondCount > bondCapacity || bondCount < bondCapacity / 4) {
+        bondCapacity = bondCount + bondCount / 4;
+        glBufferData(GL_ARRAY_BUFFER, bondCapacity * sizeof(Bond), nullptr, GL_DYNAMIC_DRAW);
+    }
+    if (bondCount > 0) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bondCount * sizeof(Bond), bonds.data());
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void BondInstances::Render(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPos,
+    const glm::vec3& lightPos) {
+    if (!initialized) {
+        std::cout << "Warning: Attempting to render uninitialized bond instances" << std::endl;
+        return;
+    }
+    if (bondCount == 0 || atoms.GetAtomCount() == 0) return;
+
+    glBindVertexArray(VAO);
+    if (divisor != atoms.GetCellCount()) {
+        divisor = atoms.GetCellCount();
+        glVertexAttribDivisor(1, static_cast<GLuint>(divisor));
+    }
+
+    shader->use();
+    shader->setMat4("model", atoms.GetModel());
+    shader->setMat4("view", view);
+    shader->setMat4("projection", projection);
+    shader->setVec3("viewPos", viewPos);
+    shader->setVec3("lightPos", lightPos);
+    shader->setFloat("bondRadius", bondRadius);
+    atoms.SetRepeatUniforms(*shader);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, atomTexture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, elementTexture);
+
+    glDrawElementsInstanced(GL_TRIANGLES, meshIndexCount, GL_UNSIGNED_SHORT, 0, static_cast<GLsizei>(bondCount * divisor));
+
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+BondInstances::~BondInstances() {
+    glDeleteVertexArrays(1, &VAO);
+    GLuint buffers[3] = { meshVBO, meshEBO, bondVBO };
+    glDeleteBuffers(3, buffers);
+    GLuint textures[2] = { atomTexture, elementTexture };
+    glDeleteTextures(2, textures);
+}
@@ -0,0 +1,168 @@
+#include "headers/Bonds.hpp"
+#include "headers/Elements.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cstring>
+
+namespace {
+    // closer than this is a duplicated atom, not a bond
+    const float kMinDistanceSq = 0.1f * 0.1f;
+
+    float distanceSq(const float* p, const float* q) {
+        float dx = p[0] - q[0], dy = p[1] - q[1], dz = p[2] - q[2];
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    // Teschner et al. 2003 spatial hash
+    uint32_t cellHash(int x, int y, int z, uint32_t mask) {
+        return ((uint32_t(x) * 73856093u) ^ (uint32_t(y) * 19349663u) ^ (uint32_t(z) * 83492791u)) & mask;
+    }
+
+    // Concatenates the first count per-job results in job order
+    void gather(const std::vector<std::vector<Bond>>& parts, int count, std::vector<Bond>& out) {
+        size_t total = 0;
+        for (int i = 0; i < count; ++i) total += parts[i].size();
+        out.clear();
+        // headroom, so a count that wobbles from frame to frame doesn't reallocate each time
+        if (out.capacity() < total) out.reserve(total + total / 4);
+        for (int i = 0; i < count; ++i) out.insert(out.end(), parts[i].begin(), parts[i].end());
+    }
+}
+
+BondFinder::BondFinder(int threads, float tolerance, float skin)
+    : pool(threads), tolerance(tolerance), skin(skin), lastMs(0.0), lastSearched(false) {}
+
+void BondFinder::Build(const SceneView& scene) {
+    auto start = std::chrono::steady_clock::now();
+    scratch.Reset();
+    search(scene);
+    filter(scene);
+    lastSearched = true;
+    lastMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool BondFinder::Update(const SceneView& scene, const std::vector<AtomRange>& moved) {
+    if (scene.atomCount * 3 != searchPositions.size()) {
+        Build(scene);
+        return true;
+    }
+    if (moved.empty()) return false;
+    auto start = std::chrono::steady_clock::now();
+    scratch.Reset();
+
+    // the candidates still hold every bond until an atom has moved half the skin
+    const float limitSq = 0.25f * skin * skin;
+    bool stale = false;
+    for (const AtomRange& range : moved) {
+        for (size_t i = range.first; i < range.first + range.count && !stale; ++i) {
+            stale = distanceSq(scene.atoms[i].position, &searchPositions[i * 3]) > limitSq;
+        }
+    }
+    if (stale) search(scene);
+
+    previousBonds.swap(bonds);
+    filter(scene);
+    lastSearched = stale;
+    lastMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return previousBonds.size() != bonds.size() ||
+        (!bonds.empty() && memcmp(previousBonds.data(), bonds.data(), bonds.size() * sizeof(Bond)) != 0);
+}
+
+void BondFinder::search(const SceneView& scene) {
+    const size_t n = scene.atomCount;
+    radii.resize(n);
+    searchPositions.resize(n * 3);
+    float maxRadius = 0.0f;
+    float low[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    for (size_t i = 0; i < n; ++i) {
+        radii[i] = GetElement(scene.elements[i]).covalentRadius;
+        maxRadius = std::max(maxRadius, radii[i]);
+        memcpy(&searchPositions[i * 3], scene.atoms[i].position, 3 * sizeof(float));
+        for (int k = 0; k < 3; ++k) low[k] = std::min(low[k], scene.atoms[i].position[k]);
+    }
+    candidates.clear();
+    if (n < 2) return;
+
+    // a cell as wide as the longest candidate pair, so neighbours are at most one cell away
+    const float inverseCell = 1.0f / (tolerance * 2.0f * maxRadius + skin);
+    uint32_t tableSize = 1024;
+    while (tableSize < 2 * n && tableSize < (1u << 30)) tableSize <<= 1;
+    const uint32_t mask = tableSize - 1;
+    auto cellOf = [&](const float* p, int cell[3]) {
+        for (int k = 0; k < 3; ++k) cell[k] = int((p[k] - low[k]) * inverseCell);
+    };
+
+    const int threads = pool.GetThreadCount();
+    const int chunks = int(std::min<size_t>(size_t(threads) * 8, n / 1024 + 1));
+    keys.resize(n);
+    pool.Run(chunks, [&](int chunk) {
+        size_t first = n * chunk / chunks, last = n * (chunk + 1) / chunks;
+        for (size_t i = first; i < last; ++i) {
+            int cell[3];
+            cellOf(&searchPositions[i * 3], cell);
+            keys[i] = cellHash(cell[0], cell[1], cell[2], mask);
+        }
+    });
+
+    // counting sort by bucket; atoms stay in index order inside a bucket
+    cellStart.assign(size_t(tableSize) + 1, 0);
+    for (size_t i = 0; i < n; ++i) cellStart[keys[i] + 1]++;
+    for (uint32_t k = 0; k < tableSize; ++k) cellStart[k + 1] += cellStart[k];
+    cellAtoms.resize(n);
+    uint32_t* cursor = scratch.AllocateArray<uint32_t>(tableSize);
+    std::copy(cellStart.begin(), cellStart.end() - 1, cursor);
+    for (size_t i = 0; i < n; ++i) cellAtoms[cursor[keys[i]]++] = uint32_t(i);
+
+    // each job takes a run of atoms, so the joined results come out sorted by a. The search
+    // and the filter split differently; the list only grows so both keep their capacity
+    if (jobResults.size() < size_t(chunks)) jobResults.resize(size_t(chunks));
+    pool.Run(chunks, [&](int chunk) {
+        std::vector<Bond>& out = jobResults[chunk];
+        out.clear();
+        size_t first = n * chunk / chunks, last = n * (chunk + 1) / chunks;
+        for (size_t i = first; i < last; ++i) {
+            const float* p = &searchPositions[i * 3];
+            int cell[3];
+            cellOf(p, cell);
+            uint32_t visited[27];
+            int visitedCount = 0;
+            for (int dz = -1; dz <= 1; ++dz) {
+                for (int dy = -1; dy <= 1; ++dy) {
+                    for (int dx = -1; dx <= 1; ++dx) {
+                        uint32_t key = cellHash(cell[0] + dx, cell[1] + dy, cell[2] + dz, mask);
+                        // two neighbour cells can share a bucket, scan it once
+                        if (std::find(visited, visited + visitedCount, key) != visited + visitedCount) continue;
+                        visited[visitedCount++] = key;
+                        for (uint32_t s = cellStart[key]; s < cellStart[key + 1]; ++s) {
+                            uint32_t j = cellAtoms[s];
+                            if (j <= i) continue;
+                            float reach = tolerance * (radii[i] + radii[j]) + skin;
+                            float d = distanceSq(p, &searchPositions[size_t(j) * 3]);
+                            if (d < reach * reach) out.push_back({ uint32_t(i), j });
+                        }
+                    }
+                }
+            }
+        }
+    });
+    gather(jobResults, chunks, candidates);
+}
+
+void BondFinder::filter(const SceneView& scene) {
+    const size_t count = candidates.size();
+    const int chunks = int(std::min<size_t>(size_t(pool.GetThreadCount()) * 4, count / 4096 + 1));
+    if (jobResults.size() < size_t(chunks)) jobResults.resize(size_t(chunks));
+    pool.Run(chunks, [&](int chunk) {
+        std::vector<Bond>& out = jobResults[chunk];
+        out.clear();
+        size_t first = count * chunk / chunks, last = count * (chunk + 1) / chunks;
+        for (size_t c = first; c < last; ++c) {
+            const Bond& pair = candidates[c];
+            float reach = tolerance * (radii[pair.a] + radii[pair.b]);
+            float d = distanceSq(scene.atoms[pair.a].position, scene.atoms[pair.b].position);
+            if (d < reach * reach && d > kMinDistanceSq) out.push_back(pair);
+        }
+    });
+    gather(jobResults, chunks, bonds);
+}
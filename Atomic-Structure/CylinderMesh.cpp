@@ -0,0 +1,24 @@
+#include "headers/CylinderMesh.hpp"
+#include <algorithm>
+#include <cmath>
+
+CylinderMesh::CylinderMesh(int sectors) {
+    sectors = std::max(sectors, 3);
+    const float step = 2.0f * 3.14159265f / sectors;
+
+    // one ring at each end, sector by sector; welded around the seam
+    for (int i = 0; i < sectors; ++i) {
+        int16_t x = static_cast<int16_t>(roundf(cosf(i * step) * 32767.0f));
+        int16_t y = static_cast<int16_t>(roundf(sinf(i * step) * 32767.0f));
+        vertices.push_back({ x, y, 0, 0 });
+        vertices.push_back({ x, y, 32767, 0 });
+    }
+
+    // a quad per sector; consecutive quads share an edge, which keeps the cache warm
+    for (int i = 0; i < sectors; ++i) {
+        uint16_t bottom = static_cast<uint16_t>(2 * i), top = static_cast<uint16_t>(2 * i + 1);
+        uint16_t nextBottom = static_cast<uint16_t>(2 * ((i + 1) % sectors)), nextTop = static_cast<uint16_t>(nextBottom + 1);
+        uint16_t quad[6] = { bottom, nextBottom, top, top, nextBottom, nextTop };
+        indices.insert(indices.end(), quad, quad + 6);
+    }
+}
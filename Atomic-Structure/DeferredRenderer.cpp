@@ -0,0 +1,158 @@
+#include "headers/DeferredRenderer.hpp"
+#include <algorithm>
+#include <iostream>
+
+DeferredRenderer::DeferredRenderer(int width, int height, const char* lightingPath,
+    const char* presentVertPath, const char* presentFragPath)
+    : width(width), height(height), gBuffer(0), gPosition(0), gNormal(0), gAlbedo(0), gDepth(0),
+    litColor(0), lightBuffer(0), lightCapacity(0), emptyVAO(0),
+    clearColor(0.05f, 0.05f, 0.05f), initialized(false) {
+    createTargets();
+
+    glGenBuffers(1, &lightBuffer);
+    glGenVertexArrays(1, &emptyVAO);
+
+    try {
+        lightingShader = std::make_unique<ComputeShader>(lightingPath);
+        presentShader = std::make_unique<Shader>(presentVertPath, presentFragPath);
+        initialized = true;
+        std::cout << "Deferred renderer shader compilation successful" << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cout << "Failed to create deferred renderer shaders: " << e.what() << std::endl;
+    }
+}
+
+void DeferredRenderer::createTargets() {
+    glGenFramebuffers(1, &gBuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+
+    auto attach = [&](GLuint& tex, GLenum internalFormat, GLenum attachment) {
+        glGenTextures(1, &tex);
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glTexStorage2D(GL_TEXTURE_2D, 1, internalFormat, width, height);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, tex, 0);
+    };
+
+    // half floats are plenty for the scene's extent (ground is 100 x 100)
+    attach(gPosition, GL_RGBA16F, GL_COLOR_ATTACHMENT0);
+    attach(gNormal, GL_RGBA16F, GL_COLOR_ATTACHMENT1);
+    attach(gAlbedo, GL_RGBA8, GL_COLOR_ATTACHMENT2);
+    // same format as the usual default framebuffer so depth can be blitted for forward passes
+    attach(gDepth, GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL_ATTACHMENT);
+
+    GLenum drawBuffers[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+    glDrawBuffers(3, drawBuffers);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "ERROR::DEFERRED::GBUFFER_INCOMPLETE" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glGenTextures(1, &litColor);
+    glBindTexture(GL_TEXTURE_2D, litColor);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA16F, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void DeferredRenderer::destroyTargets() {
+    GLuint textures[5] = { gPosition, gNormal, gAlbedo, gDepth, litColor };
+    glDeleteTextures(5, textures);
+    glDeleteFramebuffers(1, &gBuffer);
+    gPosition = gNormal = gAlbedo = gDepth = litColor = gBuffer = 0;
+}
+
+void DeferredRenderer::Resize(int newWidth, int newHeight) {
+    if (newWidth == width && newHeight == height) return;
+    width = newWidth;
+    height = newHeight;
+    destroyTargets();
+    createTargets();
+}
+
+void DeferredRenderer::AddLight(const glm::vec3& position, float radius, const glm::vec3& color, float intensity) {
+    lights.push_back({ glm::vec4(position, radius), glm::vec4(color, intensity) });
+}
+
+void DeferredRenderer::uploadLights() {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, lightBuffer);
+    if (lights.size() > lightCapacity || lightCapacity == 0) {
+        // grow geometrically so a slowly growing light count does not reallocate every frame
+        lightCapacity = std::max<size_t>(lights.size() * 2, 64);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, lightCapacity * sizeof(PointLight), nullptr, GL_DYNAMIC_DRAW);
+    }
+    if (!lights.empty()) {
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, lights.size() * sizeof(PointLight), lights.data());
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, lightBuffer);
+}
+
+void DeferredRenderer::BeginGeometryPass() {
+    glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+    glViewport(0, 0, width, height);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glEnable(GL_DEPTH_TEST);
+}
+
+void DeferredRenderer::EndGeometryPass() {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void DeferredRenderer::LightingPass(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPos) {
+    if (!initialized) {
+        std::cout << "Warning: Attempting to light with uninitialized deferred renderer" << std::endl;
+        return;
+    }
+
+    uploadLights();
+
+    lightingShader->use();
+    lightingShader->setInt("lightCount", static_cast<int>(lights.size()));
+    lightingShader->setMat4("view", view);
+    lightingShader->setMat4("inverseProjection", glm::inverse(projection));
+    lightingShader->setVec3("viewPos", viewPos);
+    lightingShader->setVec2("screenSize", glm::vec2(static_cast<float>(width), static_cast<float>(height)));
+    lightingShader->setVec3("clearColor", clearColor);
+
+    GLuint inputs[4] = { gPosition, gNormal, gAlbedo, gDepth };
+    for (int i = 0; i < 4; ++i) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        glBindTexture(GL_TEXTURE_2D, inputs[i]);
+    }
+    glBindImageTexture(0, litColor, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+    lightingShader->dispatch((width + kTileSize - 1) / kTileSize, (height + kTileSize - 1) / kTileSize);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    // present the lit image, then hand the G-buffer depth to the default framebuffer
+    // so unlit forward geometry (electrons, orbit lines) is still depth tested
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, width, height);
+    glDisable(GL_DEPTH_TEST);
+
+    presentShader->use();
+    presentShader->setInt("image", 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, litColor);
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, gBuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glEnable(GL_DEPTH_TEST);
+}
+
+DeferredRenderer::~DeferredRenderer() {
+    destroyTargets();
+    glDeleteBuffers(1, &lightBuffer);
+    glDeleteVertexArrays(1, &emptyVAO);
+}
@@ -0,0 +1,226 @@
+#include "headers/DynamicResolution.hpp"
+#include "headers/GLProcs.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+    // Every how many frames the scale may change, and the steps it takes
+    const int kSettleFrames = 8;
+    const float kStepUp = 0.05f;
+    const float kMaxStepDown = 0.2f;
+    // only climb back once frames are this far under the budget
+    const float kHeadroom = 0.75f;
+
+    // Bilinear upscale with an unsharp mask over the four neighbours, clamped to their range
+    const char* kUpscaleSource =
+        "#version 130\n"
+        "uniform sampler2D frame;\n"
+        "uniform vec2 texel;      // size of one source pixel in texture coordinates\n"
+        "uniform vec2 limit;      // upper corner of the drawn part, half a pixel in\n"
+        "uniform float sharpness;\n"
+        "out vec4 FragColor;\n"
+        "vec3 tap(vec2 uv) { return texture(frame, clamp(uv, 0.5 * texel, limit)).rgb; }\n"
+        "void main() {\n"
+        "    vec2 uv = gl_TexCoord[0].st;\n"
+        "    vec3 c = tap(uv);\n"
+        "    vec3 n = tap(uv + vec2(0.0, texel.y)), s = tap(uv - vec2(0.0, texel.y));\n"
+        "    vec3 e = tap(uv + vec2(texel.x, 0.0)), w = tap(uv - vec2(texel.x, 0.0));\n"
+        "    vec3 sharpened = c + sharpness * (4.0 * c - n - s - e - w) * 0.25;\n"
+        "    vec3 lo = min(c, min(min(n, s), min(e, w))), hi = max(c, max(max(n, s), max(e, w)));\n"
+        "    FragColor = vec4(clamp(sharpened, lo, hi), 1.0);\n"
+        "}\n";
+}
+
+DynamicResolution::DynamicResolution(int width, int height, ProcLoader loader, float budgetMs, float minScale)
+    : width(std::max(width, 1)), height(std::max(height, 1)), renderWidth(this->width), renderHeight(this->height),
+    supported(false), timed(false), budgetMs(budgetMs), minScale(std::min(std::max(minScale, 0.1f), 1.0f)),
+    scale(1.0f), gpuMs(0.0f), framesSinceChange(0), fbo(0), colorTexture(0), depthBuffer(0), program(0),
+    programFailed(false), frameLocation(-1), texelLocation(-1), limitLocation(-1), sharpnessLocation(-1),
+    queryHead(0), queryPending(0), staleQueries(0), queryActive(false) {
+    for (int i = 0; i < kQueries; ++i) queries[i] = 0;
+
+    if (!LoadGLProcs(loader) || !(gl.HasFramebuffers() && gl.HasPrograms() && gl.HasQueries())) {
+        std::cout << "ERROR::DYNAMIC_RESOLUTION::MISSING_GL_FUNCTIONS (needs GL 3.0 or ARB_framebuffer_object)" << std::endl;
+        return;
+    }
+    // the timer is optional, without it the scale just stays at 1
+    timed = gl.HasTimer();
+
+    createTarget();
+    gl.bindFramebuffer(GL_FRAMEBUFFER, fbo);
+    GLenum status = gl.checkFramebufferStatus(GL_FRAMEBUFFER);
+    gl.bindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "ERROR::DYNAMIC_RESOLUTION::FRAMEBUFFER_INCOMPLETE " << status << std::endl;
+        return;
+    }
+    if (timed) gl.genQueries(kQueries, queries);
+    supported = true;
+}
+
+void DynamicResolution::createTarget() {
+    glGenTextures(1, &colorTexture);
+    glBindTexture(GL_TEXTURE_2D, colorTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    gl.genRenderbuffers(1, &depthBuffer);
+    gl.bindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    gl.renderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    gl.bindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    gl.genFramebuffers(1, &fbo);
+    gl.bindFramebuffer(GL_FRAMEBUFFER, fbo);
+    gl.framebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+    gl.framebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    gl.bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void DynamicResolution::destroyTarget() {
+    if (fbo) gl.deleteFramebuffers(1, &fbo);
+    if (depthBuffer) gl.deleteRenderbuffers(1, &depthBuffer);
+    if (colorTexture) glDeleteTextures(1, &colorTexture);
+    fbo = depthBuffer = colorTexture = 0;
+}
+
+void DynamicResolution::Resize(int width, int height) {
+    width = std::max(width, 1);
+    height = std::max(height, 1);
+    if (!supported || (width == this->width && height == this->height)) return;
+    this->width = width;
+    this->height = height;
+    destroyTarget();
+    createTarget();
+}
+
+unsigned int DynamicResolution::GetFramebuffer() const {
+    return supported && scale < 1.0f ? fbo : 0;
+}
+
+bool DynamicResolution::buildProgram() {
+    program = BuildFragmentProgram(kUpscaleSource, "DYNAMIC_RESOLUTION");
+    if (!program) return false;
+    frameLocation = gl.getUniformLocation(program, "frame");
+    texelLocation = gl.getUniformLocation(program, "texel");
+    limitLocation = gl.getUniformLocation(program, "limit");
+    sharpnessLocation = gl.getUniformLocation(program, "sharpness");
+    return true;
+}
+
+void DynamicResolution::Begin() {
+    if (!supported) return;
+    // the upscale needs its program; without one, stay at full size
+    if (scale < 1.0f && !program && !programFailed) programFailed = !buildProgram();
+    if (programFailed) scale = 1.0f;
+
+    renderWidth = std::max(int(width * scale + 0.5f), 1);
+    renderHeight = std::max(int(height * scale + 0.5f), 1);
+    gl.bindFramebuffer(GL_FRAMEBUFFER, GetFramebuffer());
+    glViewport(0, 0, renderWidth, renderHeight);
+
+    // a full ring just leaves this frame untimed
+    if (timed && queryPending < kQueries) {
+        gl.beginQuery(GL_TIME_ELAPSED, queries[queryHead]);
+        queryActive = true;
+    }
+}
+
+void DynamicResolution::End() {
+    if (!supported) return;
+    if (scale < 1.0f) upscale();
+    if (queryActive) {
+        gl.endQuery(GL_TIME_ELAPSED);
+        queryActive = false;
+        queryHead = (queryHead + 1) % kQueries;
+        queryPending++;
+    }
+    collectTimings();
+    adapt();
+}
+
+void DynamicResolution::upscale() {
+    gl.bindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, width, height);
+
+    glPushAttrib(GL_ENABLE_BIT);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_LIGHTING);
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    float u = float(renderWidth) / width, v = float(renderHeight) / height;
+    gl.useProgram(program);
+    gl.uniform1i(frameLocation, 0);
+    gl.uniform2f(texelLocation, 1.0f / width, 1.0f / height);
+    gl.uniform2f(limitLocation, u - 0.5f / width, v - 0.5f / height);
+    // the more the frame is stretched the more detail it lost
+    gl.uniform1f(sharpnessLocation, std::min(2.0f * (1.0f - scale), 1.0f));
+    glBindTexture(GL_TEXTURE_2D, colorTexture);
+    glBegin(GL_QUADS);
+    glTexCoord2f(0.0f, 0.0f); glVertex2f(-1.0f, -1.0f);
+    glTexCoord2f(u, 0.0f);    glVertex2f(1.0f, -1.0f);
+    glTexCoord2f(u, v);       glVertex2f(1.0f, 1.0f);
+    glTexCoord2f(0.0f, v);    glVertex2f(-1.0f, 1.0f);
+    glEnd();
+    glBindTexture(GL_TEXTURE_2D, 0);
+    gl.useProgram(0);
+
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopAttrib();
+}
+
+void DynamicResolution::collectTimings() {
+    while (queryPending > 0) {
+        GLuint query = queries[(queryHead - queryPending + kQueries) % kQueries];
+        GLint available = 0;
+        gl.getQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+        GLuint64 ns = 0;
+        gl.getQueryObjectui64v(query, GL_QUERY_RESULT, &ns);
+        queryPending--;
+        if (staleQueries > 0) {
+            staleQueries--;
+            continue;
+        }
+        float ms = float(ns) * 1e-6f;
+        gpuMs = gpuMs > 0.0f ? gpuMs + 0.2f * (ms - gpuMs) : ms;
+    }
+}
+
+void DynamicResolution::adapt() {
+    if (gpuMs <= 0.0f || ++framesSinceChange < kSettleFrames) return;
+    float next = scale;
+    if (gpuMs > budgetMs) {
+        next = scale * std::sqrt(budgetMs / gpuMs);
+        next = std::max(next, scale - kMaxStepDown);
+    }
+    else if (gpuMs < budgetMs * kHeadroom) {
+        next = scale + kStepUp;
+    }
+    next = std::min(std::max(next, minScale), 1.0f);
+    if (next == scale) return;
+    scale = next;
+    framesSinceChange = 0;
+    // frames timed at the old scale would pull the new one the wrong way
+    gpuMs = 0.0f;
+    staleQueries = queryPending;
+}
+
+DynamicResolution::~DynamicResolution() {
+    if (!colorTexture) return;
+    if (queries[0]) gl.deleteQueries(kQueries, queries);
+    if (program) gl.deleteProgram(program);
+    destroyTarget();
+}
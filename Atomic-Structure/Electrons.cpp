@@ -5,7 +5,7 @@ Electron::Electron(float orbitRadius, float orbitSpeed,
     const glm::vec3& orbitalPlaneNormal, const glm::vec3& color)
     : m_orbitRadius(orbitRadius), m_orbitSpeed(orbitSpeed),
     m_orbitalPlaneNormal(glm::normalize(orbitalPlaneNormal)),
-    m_color(color), m_currentAngle(0.0f),
+    m_color(color), m_pickID(0), m_currentAngle(0.0f),
     m_sphere(0.03f, 16, 16,  // Small radius, low resolution
         "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\Electrons.vert",
         "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\Electrons.frag") {
@@ -16,14 +16,18 @@ void Electron::Update(float deltaTime) {
     if (m_currentAngle > 360.0f) m_currentAngle -= 360.0f;
 }
 
+glm::vec3 Electron::GetPosition() const {
+    glm::vec3 basePosition(m_orbitRadius, 0.0f, 0.0f);
+    return glm::rotate(basePosition,
+        glm::radians(m_currentAngle),
+        m_orbitalPlaneNormal);
+}
+
 // In Electron.cpp - Uncomment and fix the Render method
 void Electron::Render(const glm::mat4& view, const glm::mat4& projection,
     const glm::vec3& viewPos) {
     // Calculate orbital position
-    glm::vec3 basePosition(m_orbitRadius, 0.0f, 0.0f);
-    glm::vec3 rotatedPosition = glm::rotate(basePosition,
-        glm::radians(m_currentAngle),
-        m_orbitalPlaneNormal);
+    glm::vec3 rotatedPosition = GetPosition();
 
     // Create model matrix
     glm::mat4 model(1.0f);
@@ -32,6 +36,7 @@ void Electron::Render(const glm::mat4& view, const glm::mat4& projection,
     // Set custom color
     m_sphere.GetShader().use();
     m_sphere.GetShader().setVec3("objectColor", m_color);
+    m_sphere.GetShader().setUint("pickID", m_pickID);
 
     m_sphere.render(view, projection, viewPos, model);
 }
@@ -0,0 +1,148 @@
+#include "headers/Elements.hpp"
+#include <cctype>
+
+namespace {
+    const ElementInfo kElements[kElementCount + 1] = {
+        { "X", 1.50f, { 1.00f, 0.08f, 0.58f } },
+        { "H", 0.31f, { 1.00f, 1.00f, 1.00f } },
+        { "He", 0.28f, { 0.85f, 1.00f, 1.00f } },
+        { "Li", 1.28f, { 0.80f, 0.50f, 1.00f } },
+        { "Be", 0.96f, { 0.76f, 1.00f, 0.00f } },
+        { "B", 0.84f, { 1.00f, 0.71f, 0.71f } },
+        { "C", 0.76f, { 0.56f, 0.56f, 0.56f } },
+        { "N", 0.71f, { 0.19f, 0.31f, 0.97f } },
+        { "O", 0.66f, { 1.00f, 0.05f, 0.05f } },
+        { "F", 0.57f, { 0.56f, 0.88f, 0.31f } },
+        { "Ne", 0.58f, { 0.70f, 0.89f, 0.96f } },
+        { "Na", 1.66f, { 0.67f, 0.36f, 0.95f } },
+        { "Mg", 1.41f, { 0.54f, 1.00f, 0.00f } },
+        { "Al", 1.21f, { 0.75f, 0.65f, 0.65f } },
+        { "Si", 1.11f, { 0.94f, 0.78f, 0.63f } },
+        { "P", 1.07f, { 1.00f, 0.50f, 0.00f } },
+        { "S", 1.05f, { 1.00f, 1.00f, 0.19f } },
+        { "Cl", 1.02f, { 0.12f, 0.94f, 0.12f } },
+        { "Ar", 1.06f, { 0.50f, 0.82f, 0.89f } },
+        { "K", 2.03f, { 0.56f, 0.25f, 0.83f } },
+        { "Ca", 1.76f, { 0.24f, 1.00f, 0.00f } },
+        { "Sc", 1.70f, { 0.90f, 0.90f, 0.90f } },
+        { "Ti", 1.60f, { 0.75f, 0.76f, 0.78f } },
+        { "V", 1.53f, { 0.65f, 0.65f, 0.67f } },
+        { "Cr", 1.39f, { 0.54f, 0.60f, 0.78f } },
+        { "Mn", 1.39f, { 0.61f, 0.48f, 0.78f } },
+        { "Fe", 1.32f, { 0.88f, 0.40f, 0.20f } },
+        { "Co", 1.26f, { 0.94f, 0.56f, 0.63f } },
+        { "Ni", 1.24f, { 0.31f, 0.82f, 0.31f } },
+        { "Cu", 1.32f, { 0.78f, 0.50f, 0.20f } },
+        { "Zn", 1.22f, { 0.49f, 0.50f, 0.69f } },
+        { "Ga", 1.22f, { 0.76f, 0.56f, 0.56f } },
+        { "Ge", 1.20f, { 0.40f, 0.56f, 0.56f } },
+        { "As", 1.19f, { 0.74f, 0.50f, 0.89f } },
+        { "Se", 1.20f, { 1.00f, 0.63f, 0.00f } },
+        { "Br", 1.20f, { 0.65f, 0.16f, 0.16f } },
+        { "Kr", 1.16f, { 0.36f, 0.72f, 0.82f } },
+        { "Rb", 2.20f, { 0.44f, 0.18f, 0.69f } },
+        { "Sr", 1.95f, { 0.00f, 1.00f, 0.00f } },
+        { "Y", 1.90f, { 0.58f, 1.00f, 1.00f } },
+        { "Zr", 1.75f, { 0.58f, 0.88f, 0.88f } },
+        { "Nb", 1.64f, { 0.45f, 0.76f, 0.79f } },
+        { "Mo", 1.54f, { 0.33f, 0.71f, 0.71f } },
+        { "Tc", 1.47f, { 0.23f, 0.62f, 0.62f } },
+        { "Ru", 1.46f, { 0.14f, 0.56f, 0.56f } },
+        { "Rh", 1.42f, { 0.04f, 0.49f, 0.55f } },
+        { "Pd", 1.39f, { 0.00f, 0.41f, 0.52f } },
+        { "Ag", 1.45f, { 0.75f, 0.75f, 0.75f } },
+        { "Cd", 1.44f, { 1.00f, 0.85f, 0.56f } },
+        { "In", 1.42f, { 0.65f, 0.46f, 0.45f } },
+        { "Sn", 1.39f, { 0.40f, 0.50f, 0.50f } },
+        { "Sb", 1.39f, { 0.62f, 0.39f, 0.71f } },
+        { "Te", 1.38f, { 0.83f, 0.48f, 0.00f } },
+        { "I", 1.39f, { 0.58f, 0.00f, 0.58f } },
+        { "Xe", 1.40f, { 0.26f, 0.62f, 0.69f } },
+        { "Cs", 2.44f, { 0.34f, 0.09f, 0.56f } },
+        { "Ba", 2.15f, { 0.00f, 0.79f, 0.00f } },
+        { "La", 2.07f, { 0.44f, 0.83f, 1.00f } },
+        { "Ce", 2.04f, { 1.00f, 1.00f, 0.78f } },
+        { "Pr", 2.03f, { 0.85f, 1.00f, 0.78f } },
+        { "Nd", 2.01f, { 0.78f, 1.00f, 0.78f } },
+        { "Pm", 1.99f, { 0.64f, 1.00f, 0.78f } },
+        { "Sm", 1.98f, { 0.56f, 1.00f, 0.78f } },
+        { "Eu", 1.98f, { 0.38f, 1.00f, 0.78f } },
+        { "Gd", 1.96f, { 0.27f, 1.00f, 0.78f } },
+        { "Tb", 1.94f, { 0.19f, 1.00f, 0.78f } },
+        { "Dy", 1.92f, { 0.12f, 1.00f, 0.78f } },
+        { "Ho", 1.92f, { 0.00f, 1.00f, 0.61f } },
+        { "Er", 1.89f, { 0.00f, 0.90f, 0.46f } },
+        { "Tm", 1.90f, { 0.00f, 0.83f, 0.32f } },
+        { "Yb", 1.87f, { 0.00f, 0.75f, 0.22f } },
+        { "Lu", 1.87f, { 0.00f, 0.67f, 0.14f } },
+        { "Hf", 1.75f, { 0.30f, 0.76f, 1.00f } },
+        { "Ta", 1.70f, { 0.30f, 0.65f, 1.00f } },
+        { "W", 1.62f, { 0.13f, 0.58f, 0.84f } },
+        { "Re", 1.51f, { 0.15f, 0.49f, 0.67f } },
+        { "Os", 1.44f, { 0.15f, 0.40f, 0.59f } },
+        { "Ir", 1.41f, { 0.09f, 0.33f, 0.53f } },
+        { "Pt", 1.36f, { 0.82f, 0.82f, 0.88f } },
+        { "Au", 1.36f, { 1.00f, 0.82f, 0.14f } },
+        { "Hg", 1.32f, { 0.72f, 0.72f, 0.82f } },
+        { "Tl", 1.45f, { 0.65f, 0.33f, 0.30f } },
+        { "Pb", 1.46f, { 0.34f, 0.35f, 0.38f } },
+        { "Bi", 1.48f, { 0.62f, 0.31f, 0.71f } },
+        { "Po", 1.40f, { 0.67f, 0.36f, 0.00f } },
+        { "At", 1.50f, { 0.46f, 0.31f, 0.27f } },
+        { "Rn", 1.50f, { 0.26f, 0.51f, 0.59f } },
+        { "Fr", 2.60f, { 0.26f, 0.00f, 0.40f } },
+        { "Ra", 2.21f, { 0.00f, 0.49f, 0.00f } },
+        { "Ac", 2.15f, { 0.44f, 0.67f, 0.98f } },
+        { "Th", 2.06f, { 0.00f, 0.73f, 1.00f } },
+        { "Pa", 2.00f, { 0.00f, 0.63f, 1.00f } },
+        { "U", 1.96f, { 0.00f, 0.56f, 1.00f } },
+        { "Np", 1.90f, { 0.00f, 0.50f, 1.00f } },
+        { "Pu", 1.87f, { 0.00f, 0.42f, 1.00f } },
+        { "Am", 1.80f, { 0.33f, 0.36f, 0.95f } },
+        { "Cm", 1.69f, { 0.47f, 0.36f, 0.89f } },
+        { "Bk", 1.50f, { 0.54f, 0.31f, 0.89f } },
+        { "Cf", 1.50f, { 0.63f, 0.21f, 0.83f } },
+        { "Es", 1.50f, { 0.70f, 0.12f, 0.83f } },
+        { "Fm", 1.50f, { 0.70f, 0.12f, 0.73f } },
+        { "Md", 1.50f, { 0.70f, 0.05f, 0.65f } },
+        { "No", 1.50f, { 0.74f, 0.05f, 0.53f } },
+        { "Lr", 1.50f, { 0.78f, 0.00f, 0.40f } },
+        { "Rf", 1.50f, { 0.80f, 0.00f, 0.35f } },
+        { "Db", 1.50f, { 0.82f, 0.00f, 0.31f } },
+        { "Sg", 1.50f, { 0.85f, 0.00f, 0.27f } },
+        { "Bh", 1.50f, { 0.88f, 0.00f, 0.22f } },
+        { "Hs", 1.50f, { 0.90f, 0.00f, 0.18f } },
+        { "Mt", 1.50f, { 0.92f, 0.00f, 0.15f } },
+        { "Ds", 1.50f, { 1.00f, 0.08f, 0.58f } },
+        { "Rg", 1.50f, { 1.00f, 0.08f, 0.58f } },
+        { "Cn", 1.50f, { 1.00f, 0.08f, 0.58f } },
+        { "Nh", 1.50f, { 1.00f, 0.08f, 0.58f } },
+        { "Fl", 1.50f, { 1.00f, 0.08f, 0.58f } },
+        { "Mc", 1.50f, { 1.00f, 0.08f, 0.58f } },
+        { "Lv", 1.50f, { 1.00f, 0.08f, 0.58f } },
+        { "Ts", 1.50f, { 1.00f, 0.08f, 0.58f } },
+        { "Og", 1.50f, { 1.00f, 0.08f, 0.58f } },
+    };
+}
+
+const ElementInfo& GetElement(int atomicNumber) {
+    if (atomicNumber < 1 || atomicNumber > kElementCount) return kElements[0];
+    return kElements[atomicNumber];
+}
+
+int ElementFromSymbol(const char* symbol, size_t length) {
+    char first = 0, second = 0;
+    if (length > 0 && isalpha((unsigned char)symbol[0])) first = (char)toupper((unsigned char)symbol[0]);
+    if (length > 1 && isalpha((unsigned char)symbol[1])) second = (char)tolower((unsigned char)symbol[1]);
+    if (!first) return 0;
+
+    // prefer the two-letter match ("Ca" over "C"), fall back to the single letter
+    int single = 0;
+    for (int z = 1; z <= kElementCount; ++z) {
+        const char* s = kElements[z].symbol;
+        if (s[0] != first) continue;
+        if (second && s[1] == second) return z;
+        if (!s[1]) single = z;
+    }
+    return single;
+}
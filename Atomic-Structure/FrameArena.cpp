@@ -0,0 +1,41 @@
+#include "headers/FrameArena.hpp"
+#include <algorithm>
+
+namespace {
+    size_t alignUp(uintptr_t address, size_t alignment) {
+        return size_t((address + alignment - 1) & ~uintptr_t(alignment - 1));
+    }
+}
+
+FrameArena::FrameArena(size_t capacity)
+    : block(new unsigned char[std::max(capacity, size_t(1))]), capacity(std::max(capacity, size_t(1))), used(0),
+    overflowBytes(0), overflows(0) {
+    overflow.reserve(16);
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment) {
+    uintptr_t base = reinterpret_cast<uintptr_t>(block.get());
+    size_t offset = alignUp(base + used, alignment) - base;
+    if (offset + size <= capacity) {
+        used = offset + size;
+        return block.get() + offset;
+    }
+
+    // out of block for this frame; Reset() makes room for it next time
+    if (overflow.empty()) overflows++;
+    overflow.emplace_back(new unsigned char[size + alignment]);
+    overflowBytes += size + alignment;
+    uintptr_t address = reinterpret_cast<uintptr_t>(overflow.back().get());
+    return reinterpret_cast<void*>(alignUp(address, alignment));
+}
+
+void FrameArena::Reset() {
+    if (!overflow.empty()) {
+        capacity = used + overflowBytes;
+        capacity += capacity / 4;
+        block.reset(new unsigned char[capacity]);
+        overflow.clear();
+        overflowBytes = 0;
+    }
+    used = 0;
+}
@@ -0,0 +1,174 @@
+#include "headers/FrameExporter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+FrameExporter::FrameExporter()
+    : width(0), height(0), open(false), pipe(nullptr), closing(false), failed(false),
+    nextFrame(0), framesWritten(0), blockedMs(0.0) {}
+
+FrameExporter::~FrameExporter() {
+    Finish();
+}
+
+bool FrameExporter::OpenImages(const std::string& prefix, int width, int height, int threads, int bufferCount) {
+    if (open) return false;
+    this->prefix = prefix;
+    this->width = width;
+    this->height = height;
+    start(std::max(threads, 1), bufferCount);
+    return true;
+}
+
+bool FrameExporter::OpenPipe(const std::string& command, int width, int height, int bufferCount) {
+    if (open) return false;
+#ifdef _WIN32
+    pipe = popen(command.c_str(), "wb");
+#else
+    // an encoder that quits early must show up as a write error, not kill the app
+    signal(SIGPIPE, SIG_IGN);
+    pipe = popen(command.c_str(), "w");
+#endif
+    if (!pipe) {
+        std::cout << "ERROR::FRAME_EXPORTER::CANNOT_START " << command << std::endl;
+        return false;
+    }
+    this->width = width;
+    this->height = height;
+    start(1, bufferCount);
+    return true;
+}
+
+void FrameExporter::start(int threads, int bufferCount) {
+    bufferCount = std::max(bufferCount, 2);
+    storage.assign(bufferCount, std::vector<uint8_t>(GetFrameSize()));
+    freeBuffers.clear();
+    for (auto& buffer : storage) freeBuffers.push_back(buffer.data());
+
+    closing = failed = false;
+    nextFrame = framesWritten = 0;
+    blockedMs = 0.0;
+    for (int i = 0; i < threads; ++i) {
+        writers.emplace_back(&FrameExporter::writerLoop, this);
+    }
+    open = true;
+}
+
+uint8_t* FrameExporter::AcquireBuffer() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (freeBuffers.empty()) {
+        auto waitStart = std::chrono::steady_clock::now();
+        bufferReady.wait(lock, [this] { return !freeBuffers.empty(); });
+        blockedMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - waitStart).count();
+    }
+    uint8_t* buffer = freeBuffers.back();
+    freeBuffers.pop_back();
+    return buffer;
+}
+
+void FrameExporter::Submit(uint8_t* buffer) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back({ buffer, nextFrame++ });
+    }
+    workReady.notify_one();
+}
+
+void FrameExporter::Release(uint8_t* buffer) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        freeBuffers.push_back(buffer);
+    }
+    bufferReady.notify_one();
+}
+
+bool FrameExporter::Finish() {
+    if (!open) return !failed;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing = true;
+    }
+    workReady.notify_all();
+    for (auto& writer : writers) writer.join();
+    writers.clear();
+
+    if (pipe) {
+        if (pclose(pipe) != 0) {
+            std::cout << "ERROR::FRAME_EXPORTER::ENCODER_FAILED" << std::endl;
+            failed = true;
+        }
+        pipe = nullptr;
+    }
+    storage.clear();
+    freeBuffers.clear();
+    open = false;
+    return !failed;
+}
+
+void FrameExporter::writerLoop() {
+    for (;;) {
+        Job job;
+        bool skip;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workReady.wait(lock, [this] { return closing || !queue.empty(); });
+            if (queue.empty()) return;
+            job = queue.front();
+            queue.pop_front();
+            // once the encoder is gone the rest of the stream is dropped quietly
+            skip = failed && pipe;
+        }
+
+        bool ok = !skip && (pipe ? writeRaw(job.data) : writeImage(job.data, job.frame));
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            freeBuffers.push_back(job.data);
+            if (ok) framesWritten++;
+            else failed = true;
+        }
+        bufferReady.notify_one();
+    }
+}
+
+bool FrameExporter::writeImage(const uint8_t* data, int frame) {
+    char name[32];
+    snprintf(name, sizeof(name), "_%05d.ppm", frame);
+    std::string path = prefix + name;
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cout << "ERROR::FRAME_EXPORTER::CANNOT_WRITE " << path << std::endl;
+        return false;
+    }
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    std::vector<uint8_t> row(size_t(width) * 3);
+    for (int y = height - 1; y >= 0; --y) {
+        const uint8_t* src = data + size_t(y) * width * 4;
+        for (int x = 0; x < width; ++x) {
+            row[x * 3 + 0] = src[x * 4 + 0];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 2];
+        }
+        fwrite(row.data(), 1, row.size(), file);
+    }
+    bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
+
+bool FrameExporter::writeRaw(const uint8_t* data) {
+    size_t rowSize = size_t(width) * 4;
+    for (int y = height - 1; y >= 0; --y) {
+        if (fwrite(data + size_t(y) * rowSize, 1, rowSize, pipe) != rowSize) {
+            std::cout << "ERROR::FRAME_EXPORTER::PIPE_CLOSED" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
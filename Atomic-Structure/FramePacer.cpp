@@ -0,0 +1,101 @@
+#include "headers/FramePacer.hpp"
+#include "headers/GLProcs.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+    const int kSlots = FramePacer::kMaxFramesAhead + 1;
+}
+
+FramePacer::FramePacer(ProcLoader loader, int maxFramesAhead)
+    : maxFramesAhead(std::min(std::max(maxFramesAhead, 1), int(kMaxFramesAhead))), supported(false), timed(false),
+    head(0), pending(0), inputPending(false), frameHasInput(false) {
+    for (Slot& slot : slots) {
+        slot.fence = nullptr;
+        slot.query = 0;
+        slot.hasInput = false;
+    }
+
+    if (!LoadGLProcs(loader) || !gl.HasSync()) {
+        std::cout << "ERROR::FRAME_PACER::MISSING_GL_FUNCTIONS (needs GL 3.2 or ARB_sync)" << std::endl;
+        return;
+    }
+    // timestamps are optional, the fences alone still pace and time frames roughly
+    timed = gl.HasTimestamps();
+    if (timed) {
+        GLuint queries[kSlots];
+        gl.genQueries(kSlots, queries);
+        for (int i = 0; i < kSlots; ++i) slots[i].query = queries[i];
+    }
+    supported = true;
+}
+
+void FramePacer::NoteInput() {
+    // the first event is the one that has waited longest
+    if (inputPending) return;
+    inputPending = true;
+    inputTime = Clock::now();
+}
+
+void FramePacer::BeginFrame() {
+    frameHasInput = inputPending;
+    frameInput = inputTime;
+    inputPending = false;
+}
+
+void FramePacer::EndFrame() {
+    if (!supported) return;
+    Slot& slot = slots[head];
+    slot.hasInput = frameHasInput;
+    slot.input = frameInput;
+    frameHasInput = false;
+    if (timed) gl.queryCounter(slot.query, GL_TIMESTAMP);
+    slot.fence = gl.fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    head = (head + 1) % kSlots;
+    pending++;
+
+    // finished frames are free to retire, the rest only once there are too many
+    while (pending > 0 && retire(false)) {}
+    while (pending > maxFramesAhead) retire(true);
+}
+
+bool FramePacer::retire(bool wait) {
+    Slot& slot = slots[(head - pending + kSlots) % kSlots];
+    GLsync fence = static_cast<GLsync>(slot.fence);
+    GLenum result;
+    // flush on the check so the fence is guaranteed to signal eventually
+    do {
+        result = gl.clientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? 100000000 : 0);
+    } while (wait && result == GL_TIMEOUT_EXPIRED);
+    if (result == GL_TIMEOUT_EXPIRED) return false;
+    gl.deleteSync(fence);
+    slot.fence = nullptr;
+    pending--;
+
+    Clock::time_point finished = Clock::now();
+    if (timed && result != GL_WAIT_FAILED) {
+        // the GPU clock has its own epoch: read it now and count back to the frame's stamp
+        GLuint64 stamp = 0;
+        GLint64 now = 0;
+        gl.getQueryObjectui64v(slot.query, GL_QUERY_RESULT, &stamp);
+        gl.getInteger64v(GL_TIMESTAMP, &now);
+        Clock::time_point cpuNow = Clock::now();
+        if (now >= GLint64(stamp)) finished = cpuNow - std::chrono::nanoseconds(now - GLint64(stamp));
+    }
+    if (slot.hasInput) {
+        latency.Add(std::max(std::chrono::duration<double, std::milli>(finished - slot.input).count(), 0.0));
+    }
+    return true;
+}
+
+FramePacer::~FramePacer() {
+    if (!supported) return;
+    for (Slot& slot : slots) {
+        if (slot.fence) gl.deleteSync(static_cast<GLsync>(slot.fence));
+    }
+    if (timed) {
+        GLuint queries[kSlots];
+        for (int i = 0; i < kSlots; ++i) queries[i] = slots[i].query;
+        gl.deleteQueries(kSlots, queries);
+    }
+}
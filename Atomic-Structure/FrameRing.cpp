@@ -0,0 +1,196 @@
+#include "headers/FrameRing.hpp"
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const char kRingMagic[8] = { 'A', 'T', 'O', 'M', 'R', 'N', 'G', '\0' };
+    const size_t kPageSize = 4096;
+
+    size_t roundUp(size_t value, size_t multiple) {
+        return (value + multiple - 1) / multiple * multiple;
+    }
+
+#ifndef _WIN32
+    // shm_open wants one leading slash and no others
+    std::string shmName(const std::string& name) {
+        return name.empty() || name[0] != '/' ? "/" + name : name;
+    }
+#endif
+}
+
+FrameRing::FrameRing()
+    : header(nullptr), base(nullptr), mappedSize(0), producer(false), writing(false)
+#ifdef _WIN32
+    , mappingHandle(nullptr)
+#endif
+{}
+
+FrameRing::~FrameRing() {
+    Close();
+}
+
+bool FrameRing::Create(const std::string& name, int width, int height, int slots) {
+    Close();
+    if (width < 1 || height < 1 || slots < 2 || slots > int(FrameRingHeader::kMaxSlots)) {
+        std::cout << "ERROR::FRAME_RING::BAD_SIZE " << width << "x" << height << " x" << slots << std::endl;
+        return false;
+    }
+
+    size_t rowBytes = size_t(width) * 4;
+    size_t slotSize = roundUp(rowBytes * height, kPageSize);
+    size_t dataOffset = roundUp(sizeof(FrameRingHeader), kPageSize);
+    mappedSize = dataOffset + slotSize * slots;
+
+#ifdef _WIN32
+    mappingHandle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+        DWORD(uint64_t(mappedSize) >> 32), DWORD(mappedSize & 0xFFFFFFFFu), name.c_str());
+    if (mappingHandle) base = static_cast<uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, mappedSize));
+#else
+    std::string path = shmName(name);
+    shm_unlink(path.c_str());
+    int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd >= 0) {
+        if (ftruncate(fd, off_t(mappedSize)) == 0) {
+            void* mapped = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (mapped != MAP_FAILED) base = static_cast<uint8_t*>(mapped);
+        }
+        close(fd);
+        if (!base) shm_unlink(path.c_str());
+    }
+#endif
+    if (!base) {
+        std::cout << "ERROR::FRAME_RING::CANNOT_CREATE " << name << std::endl;
+        Close();
+        return false;
+    }
+
+    // the mapping starts zeroed, which is a valid state for the atomics
+    FrameRingHeader* created = reinterpret_cast<FrameRingHeader*>(base);
+    created->version = kVersion;
+    created->width = uint32_t(width);
+    created->height = uint32_t(height);
+    created->rowBytes = uint32_t(rowBytes);
+    created->slotCount = uint32_t(slots);
+    created->slotSize = slotSize;
+    created->dataOffset = dataOffset;
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(created->magic, kRingMagic, sizeof(kRingMagic));  // last, so a consumer sees a whole header
+
+    header = created;
+    this->name = name;
+    producer = true;
+    return true;
+}
+
+bool FrameRing::Open(const std::string& name) {
+    Close();
+
+#ifdef _WIN32
+    mappingHandle = OpenFileMappingA(FILE_MAP_READ, FALSE, name.c_str());
+    if (mappingHandle) base = static_cast<uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    MEMORY_BASIC_INFORMATION info;
+    if (base && VirtualQuery(base, &info, sizeof(info))) mappedSize = info.RegionSize;
+#else
+    int fd = shm_open(shmName(name).c_str(), O_RDONLY, 0);
+    if (fd >= 0) {
+        struct stat info;
+        if (fstat(fd, &info) == 0 && size_t(info.st_size) >= sizeof(FrameRingHeader)) {
+            mappedSize = size_t(info.st_size);
+            void* mapped = mmap(nullptr, mappedSize, PROT_READ, MAP_SHARED, fd, 0);
+            if (mapped != MAP_FAILED) base = static_cast<uint8_t*>(mapped);
+        }
+        close(fd);
+    }
+#endif
+    if (!base) {
+        std::cout << "ERROR::FRAME_RING::CANNOT_OPEN " << name << std::endl;
+        Close();
+        return false;
+    }
+
+    FrameRingHeader* candidate = reinterpret_cast<FrameRingHeader*>(base);
+    const char* problem = nullptr;
+    if (memcmp(candidate->magic, kRingMagic, sizeof(kRingMagic)) != 0) problem = "NOT_A_RING";
+    else if (candidate->version != kVersion) problem = "UNSUPPORTED_VERSION";
+    else if (candidate->slotCount < 2 || candidate->slotCount > FrameRingHeader::kMaxSlots ||
+        candidate->slotSize < uint64_t(candidate->rowBytes) * candidate->height ||
+        candidate->dataOffset + candidate->slotSize * candidate->slotCount > mappedSize) {
+        problem = "BAD_LAYOUT";
+    }
+    if (problem) {
+        std::cout << "ERROR::FRAME_RING::" << problem << " " << name << std::endl;
+        Close();
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    header = candidate;
+    this->name = name;
+    producer = false;
+    return true;
+}
+
+void FrameRing::Close() {
+#ifdef _WIN32
+    if (base) UnmapViewOfFile(base);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    mappingHandle = nullptr;
+#else
+    if (base) munmap(base, mappedSize);
+    if (base && producer) shm_unlink(shmName(name).c_str());
+#endif
+    header = nullptr;
+    base = nullptr;
+    mappedSize = 0;
+    name.clear();
+    producer = false;
+    writing = false;
+}
+
+uint8_t* FrameRing::BeginWrite() {
+    if (!header || !producer) return nullptr;
+    uint64_t frame = header->published.load(std::memory_order_relaxed);
+    uint32_t slot = uint32_t(frame % header->slotCount);
+    header->sequence[slot].store(2 * frame + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);  // odd before any pixel changes
+    writing = true;
+    return base + header->dataOffset + header->slotSize * slot;
+}
+
+void FrameRing::Publish() {
+    if (!writing) return;
+    uint64_t frame = header->published.load(std::memory_order_relaxed);
+    uint32_t slot = uint32_t(frame % header->slotCount);
+    header->sequence[slot].store(2 * (frame + 1), std::memory_order_release);
+    header->published.store(frame + 1, std::memory_order_release);
+    writing = false;
+}
+
+const uint8_t* FrameRing::Latest(FrameRingToken& token) const {
+    if (!header) return nullptr;
+    // the producer can lap us between the two loads; a newer frame is then published
+    for (uint32_t attempt = 0; attempt < header->slotCount; ++attempt) {
+        uint64_t published = header->published.load(std::memory_order_acquire);
+        if (published == 0) return nullptr;
+        token.frame = published - 1;
+        token.slot = uint32_t(token.frame % header->slotCount);
+        token.sequence = header->sequence[token.slot].load(std::memory_order_acquire);
+        if (token.sequence == 2 * published) return base + header->dataOffset + header->slotSize * token.slot;
+    }
+    return nullptr;
+}
+
+bool FrameRing::StillValid(const FrameRingToken& token) const {
+    if (!header || token.slot >= header->slotCount) return false;
+    std::atomic_thread_fence(std::memory_order_acquire);  // the pixel reads before the check
+    return header->sequence[token.slot].load(std::memory_order_relaxed) == token.sequence;
+}
@@ -0,0 +1,472 @@
+#include "headers/FrameServer.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "ws2_32.lib")
+#endif
+typedef int socklen_t;
+#else
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+#ifdef MSG_NOSIGNAL
+    const int kSendFlags = MSG_NOSIGNAL;  // a client that went away must not kill the server
+#else
+    const int kSendFlags = 0;
+#endif
+    const size_t kMaxRequestBytes = 8192;
+    const size_t kMaxCommandBytes = 4096;
+
+    // The viewer: decodes the frame messages onto a canvas, sends drags, wheel and the
+    // element box back as commands
+    const char kViewerPage[] = R"HTML(<!doctype html>
+<html><head><meta charset="utf-8"><title>Atomic Structure</title>
+<style>body{margin:0;background:#0d0d0d;color:#bbb;font:13px sans-serif}canvas{display:block;cursor:grab}
+#bar{position:fixed;top:6px;left:8px}input{width:4em}</style></head>
+<body><div id="bar">Element <input id="element" type="number" min="1" max="118" value="1">
+<label><input id="lighting" type="checkbox" checked>lighting</label> <span id="stats"></span></div>
+<canvas id="view"></canvas>
+<script>
+const view = document.getElementById('view'), context = view.getContext('2d');
+const stats = document.getElementById('stats');
+const socket = new WebSocket('ws://' + location.host + '/stream');
+socket.binaryType = 'arraybuffer';
+let image = null, frame = -1, synced = false, bytes = 0, frames = 0;
+
+socket.onmessage = event => {
+  const data = new DataView(event.data), b = new Uint8Array(event.data);
+  if (b.length < 20 || data.getUint32(0, true) !== 0x31445441) return;
+  const number = data.getUint32(4, true), w = data.getUint16(8, true), h = data.getUint16(10, true);
+  const tileSize = data.getUint16(12, true), key = data.getUint16(14, true) & 1, tiles = data.getUint32(16, true);
+  bytes += b.length; frames++;
+  if (key) {
+    if (!image || image.width !== w || image.height !== h) {
+      view.width = w; view.height = h;
+      image = context.createImageData(w, h);
+      image.data.fill(255);
+    }
+  } else if (!synced || number !== frame + 1) {
+    synced = false;  // the server sends a keyframe after a gap
+    return;
+  }
+  const p = image.data;
+  let at = 20;
+  for (let t = 0; t < tiles; t++) {
+    const x0 = data.getUint16(at, true) * tileSize, y0 = data.getUint16(at + 2, true) * tileSize;
+    const length = data.getUint32(at + 4, true), raw = length >= 0x80000000, end = at + 8 + (length & 0x7FFFFFFF);
+    const x1 = Math.min(x0 + tileSize, w), y1 = Math.min(y0 + tileSize, h);
+    let x = x0, y = y0;
+    at += 8;
+    while (at < end && y < y1) {
+      const op = b[at++], repeat = op < 128 ? op + 1 : 1, literals = op < 128 ? 1 : op - 127;
+      for (let k = 0; k < literals; k++, at += 3) {
+        for (let r = 0; r < repeat && y < y1; r++) {
+          const o = (y * w + x) * 4;
+          if (raw) { p[o] = b[at]; p[o + 1] = b[at + 1]; p[o + 2] = b[at + 2]; }
+          else { p[o] ^= b[at]; p[o + 1] ^= b[at + 1]; p[o + 2] ^= b[at + 2]; }
+          if (++x === x1) { x = x0; y++; }
+        }
+      }
+    }
+    at = end;
+  }
+  frame = number; synced = true;
+  context.putImageData(image, 0, 0);
+};
+
+setInterval(() => {
+  stats.textContent = frames + ' fps, ' + (bytes / 1024).toFixed(0) + ' KB/s';
+  bytes = frames = 0;
+}, 1000);
+
+let dragX = 0, dragY = 0, dragging = false;
+view.onmousedown = () => { dragging = true; };
+window.onmouseup = () => { dragging = false; };
+window.onmousemove = event => { if (dragging) { dragX += event.movementX; dragY += event.movementY; } };
+view.onwheel = event => { event.preventDefault(); socket.send('zoom ' + (event.deltaY > 0 ? 1.1 : 0.9)); };
+(function sendDrag() {
+  if ((dragX || dragY) && socket.readyState === 1) {
+    socket.send('orbit ' + (dragX * 0.3).toFixed(2) + ' ' + (dragY * 0.3).toFixed(2));
+    dragX = dragY = 0;
+  }
+  requestAnimationFrame(sendDrag);
+})();
+document.getElementById('element').onchange = event => socket.send('element ' + event.target.value);
+document.getElementById('lighting').onchange = event => socket.send('lighting ' + (event.target.checked ? 1 : 0));
+</script></body></html>
+)HTML";
+
+    //----------------------------------------------------------------------------------
+    // SHA-1 and base64, for the Sec-WebSocket-Accept of the handshake
+    //----------------------------------------------------------------------------------
+    uint32_t rotate(uint32_t value, int bits) {
+        return (value << bits) | (value >> (32 - bits));
+    }
+
+    void sha1(const uint8_t* data, size_t size, uint8_t digest[20]) {
+        uint32_t h[5] = { 0x67452301u, 0xEFCDAB89u, 0x98BADCFEu, 0x10325476u, 0xC3D2E1F0u };
+        size_t padded = (size + 8) / 64 * 64 + 64;
+        std::vector<uint8_t> message(padded, 0);
+        memcpy(message.data(), data, size);
+        message[size] = 0x80;
+        uint64_t bits = uint64_t(size) * 8;
+        for (int i = 0; i < 8; ++i) message[padded - 1 - i] = uint8_t(bits >> (8 * i));
+
+        for (size_t block = 0; block < padded; block += 64) {
+            uint32_t w[80];
+            for (int i = 0; i < 16; ++i) {
+                const uint8_t* p = &message[block + i * 4];
+                w[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+            }
+            for (int i = 16; i < 80; ++i) w[i] = rotate(w[i-3] ^ w[i-8] ^ w[i-14] ^ w[i-16], 1);
+
+            uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+            for (int i = 0; i < 80; ++i) {
+                uint32_t f, k;
+                if (i < 20) { f = (b & c) | (~b & d); k = 0x5A827999u; }
+                else if (i < 40) { f = b ^ c ^ d; k = 0x6ED9EBA1u; }
+                else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDCu; }
+                else { f = b ^ c ^ d; k = 0xCA62C1D6u; }
+                uint32_t next = rotate(a, 5) + f + e + k + w[i];
+                e = d; d = c; c = rotate(b, 30); b = a; a = next;
+            }
+            h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+        }
+        for (int i = 0; i < 20; ++i) digest[i] = uint8_t(h[i / 4] >> (24 - 8 * (i % 4)));
+    }
+
+    std::string base64(const uint8_t* data, size_t size) {
+        static const char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        std::string out;
+        for (size_t i = 0; i < size; i += 3) {
+            uint32_t group = uint32_t(data[i]) << 16;
+            if (i + 1 < size) group |= uint32_t(data[i + 1]) << 8;
+            if (i + 2 < size) group |= data[i + 2];
+            out += kAlphabet[(group >> 18) & 63];
+            out += kAlphabet[(group >> 12) & 63];
+            out += i + 1 < size ? kAlphabet[(group >> 6) & 63] : '=';
+            out += i + 2 < size ? kAlphabet[group & 63] : '=';
+        }
+        return out;
+    }
+
+    // Value of an HTTP header, matched without case; "" if absent
+    std::string headerValue(const std::string& request, const char* name) {
+        std::string lower = request;
+        std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return char(tolower(c)); });
+        std::string key = std::string("\r\n") + name + ":";
+        std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return char(tolower(c)); });
+        size_t at = lower.find(key);
+        if (at == std::string::npos) return "";
+        size_t start = request.find_first_not_of(' ', at + key.size());
+        size_t end = request.find("\r\n", start);
+        return start == std::string::npos ? "" : request.substr(start, end - start);
+    }
+
+    bool wouldBlock() {
+#ifdef _WIN32
+        return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+    }
+
+    void setNonBlocking(intptr_t socket) {
+#ifdef _WIN32
+        u_long enabled = 1;
+        ioctlsocket(SOCKET(socket), FIONBIO, &enabled);
+#else
+        fcntl(int(socket), F_SETFL, fcntl(int(socket), F_GETFL, 0) | O_NONBLOCK);
+#endif
+    }
+}
+
+FrameServer::FrameServer()
+    : listener(kNoSocket), listenPort(0), bytesSent(0), framesDropped(0) {}
+
+FrameServer::~FrameServer() {
+    Stop();
+}
+
+bool FrameServer::Start(const std::string& host, int port) {
+    Stop();
+#ifdef _WIN32
+    WSADATA data;
+    if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+        std::cout << "ERROR::FRAME_SERVER::NO_WINSOCK" << std::endl;
+        return false;
+    }
+#endif
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(uint16_t(port));
+    if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+        std::cout << "ERROR::FRAME_SERVER::BAD_ADDRESS " << host << std::endl;
+#ifdef _WIN32
+        WSACleanup();  // Stop() only cleans up after a listener
+#endif
+        return false;
+    }
+
+    intptr_t server = intptr_t(socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+    int reuse = 1;
+    if (server != kNoSocket) setsockopt(server, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+    if (server == kNoSocket || bind(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(server, 8) != 0) {
+        std::cout << "ERROR::FRAME_SERVER::CANNOT_LISTEN " << host << ":" << port << std::endl;
+        if (server != kNoSocket) closeSocket(server);
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return false;
+    }
+    setNonBlocking(server);
+    listener = server;
+    listenHost = host;
+    listenPort = port;
+    return true;
+}
+
+void FrameServer::Stop() {
+    for (Client& client : clients) closeSocket(client.socket);
+    clients.clear();
+    if (listener != kNoSocket) {
+        closeSocket(listener);
+        listener = kNoSocket;
+#ifdef _WIN32
+        WSACleanup();
+#endif
+    }
+}
+
+void FrameServer::closeSocket(intptr_t socket) {
+#ifdef _WIN32
+    closesocket(SOCKET(socket));
+#else
+    close(int(socket));
+#endif
+}
+
+int FrameServer::GetClientCount() const {
+    int count = 0;
+    for (const Client& client : clients) count += client.streaming && !client.closing;
+    return count;
+}
+
+bool FrameServer::NeedsKeyframe() const {
+    // only once the backlog is gone, or the keyframe would be dropped too
+    for (const Client& client : clients) {
+        if (client.streaming && !client.closing && client.resync && client.outputSent == client.output.size()) return true;
+    }
+    return false;
+}
+
+void FrameServer::Poll(std::vector<std::string>& commands) {
+    if (listener == kNoSocket) return;
+    accept();
+    for (size_t i = 0; i < clients.size();) {
+        Client& client = clients[i];
+        bool open = (client.closing || readInput(client, commands)) && flush(client);
+        if (client.closing && client.outputSent == client.output.size()) open = false;
+        if (open) {
+            ++i;
+            continue;
+        }
+        closeSocket(client.socket);
+        clients.erase(clients.begin() + i);
+    }
+}
+
+void FrameServer::accept() {
+    for (;;) {
+        intptr_t socket = intptr_t(::accept(listener, nullptr, nullptr));
+        if (socket == kNoSocket) return;
+        setNonBlocking(socket);
+        int noDelay = 1;  // frames go out as soon as they are queued
+        setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+        Client client;
+        client.socket = socket;
+        client.streaming = false;
+        client.resync = true;
+        client.closing = false;
+        client.outputSent = 0;
+        clients.push_back(std::move(client));
+    }
+}
+
+bool FrameServer::readInput(Client& client, std::vector<std::string>& commands) {
+    uint8_t buffer[4096];
+    for (;;) {
+        int received = int(recv(client.socket, reinterpret_cast<char*>(buffer), sizeof(buffer), 0));
+        if (received == 0) return false;
+        if (received < 0) {
+            if (!wouldBlock()) return false;
+            break;
+        }
+        client.input.insert(client.input.end(), buffer, buffer + received);
+    }
+    return client.streaming ? handleFrames(client, commands) : handleRequest(client);
+}
+
+bool FrameServer::handleRequest(Client& client) {
+    std::string request(client.input.begin(), client.input.end());
+    size_t end = request.find("\r\n\r\n");
+    if (end == std::string::npos) return request.size() < kMaxRequestBytes;
+    client.input.clear();
+
+    std::string path;
+    char target[256] = {};
+    if (sscanf(request.c_str(), "GET %255s", target) == 1) path = target;
+    std::string key = headerValue(request, "Sec-WebSocket-Key");
+    std::string response;
+    if (path == "/stream" && !key.empty() && !originAllowed(request)) {
+        std::cout << "ERROR::FRAME_SERVER::FOREIGN_ORIGIN " << headerValue(request, "Origin") << std::endl;
+        response = "HTTP/1.1 403 Forbidden\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        client.closing = true;
+    } else if (path == "/stream" && !key.empty()) {
+        std::string accept = key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+        uint8_t digest[20];
+        sha1(reinterpret_cast<const uint8_t*>(accept.data()), accept.size(), digest);
+        response = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+            "Sec-WebSocket-Accept: " + base64(digest, sizeof(digest)) + "\r\n\r\n";
+        client.streaming = true;
+    } else if (path == "/" || path == "/index.html") {
+        char head[160];
+        snprintf(head, sizeof(head), "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\nContent-Length: %u\r\n"
+            "Connection: close\r\n\r\n", unsigned(sizeof(kViewerPage) - 1));
+        response = std::string(head) + kViewerPage;
+        client.closing = true;
+    } else {
+        response = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        client.closing = true;
+    }
+    client.output.insert(client.output.end(), response.begin(), response.end());
+    return true;
+}
+
+bool FrameServer::originAllowed(const std::string& request) const {
+    std::string origin = headerValue(request, "Origin");
+    if (origin.empty()) return true;  // not a browser
+    for (const std::string& allowed : allowedOrigins) {
+        if (origin == allowed) return true;
+    }
+
+    // on every interface any name can reach us, a rebound one included, so only the
+    // origins given to AllowOrigin() count
+    if (listenHost == "0.0.0.0") return false;
+
+    // the viewer page connects back to the Host it was loaded from. That Host also has to
+    // name this server, or a hostile name rebound to our address would pass as well
+    std::string host = headerValue(request, "Host");
+    if (origin != "http://" + host) return false;
+    size_t colon = host.rfind(':');
+    int port = colon == std::string::npos ? 80 : atoi(host.c_str() + colon + 1);
+    if (port != listenPort) return false;
+    std::string name = host.substr(0, colon);
+    return name == listenHost || (listenHost == "127.0.0.1" && name == "localhost");
+}
+
+bool FrameServer::handleFrames(Client& client, std::vector<std::string>& commands) {
+    size_t at = 0;
+    std::vector<uint8_t>& in = client.input;
+    while (in.size() - at >= 2) {
+        const uint8_t* frame = &in[at];
+        bool final = (frame[0] & 0x80) != 0;
+        int opcode = frame[0] & 0x0F;
+        bool masked = (frame[1] & 0x80) != 0;
+        uint64_t length = frame[1] & 0x7F;
+        size_t header = 2;
+        if (length == 126) {
+            if (in.size() - at < 4) break;
+            length = (uint64_t(frame[2]) << 8) | frame[3];
+            header = 4;
+        } else if (length == 127) {
+            return false;  // commands are short, nothing legitimate is this long
+        }
+        // clients must mask; fragments aren't worth supporting for one-line commands
+        if (!masked || !final || length > kMaxCommandBytes) return false;
+        if (in.size() - at < header + 4 + length) break;
+
+        const uint8_t* mask = frame + header;
+        std::string payload(size_t(length), '\0');
+        for (size_t i = 0; i < length; ++i) payload[i] = char(frame[header + 4 + i] ^ mask[i % 4]);
+        at += header + 4 + size_t(length);
+
+        if (opcode == 0x1) commands.push_back(payload);
+        else if (opcode == 0x9) queue(client, 0xA, reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+        else if (opcode == 0x8) {
+            queue(client, 0x8, nullptr, 0);
+            client.closing = true;
+            break;
+        }
+    }
+    in.erase(in.begin(), in.begin() + at);
+    return true;
+}
+
+void FrameServer::queue(Client& client, int opcode, const uint8_t* data, size_t size) {
+    // output is only ever appended to, and emptied without freeing once it is all sent
+    uint8_t header[10];
+    size_t headerSize = 2;
+    header[0] = uint8_t(0x80 | opcode);
+    if (size < 126) {
+        header[1] = uint8_t(size);
+    } else if (size <= 0xFFFF) {
+        header[1] = 126;
+        header[2] = uint8_t(size >> 8);
+        header[3] = uint8_t(size);
+        headerSize = 4;
+    } else {
+        header[1] = 127;
+        for (int i = 0; i < 8; ++i) header[2 + i] = uint8_t(uint64_t(size) >> (56 - 8 * i));
+        headerSize = 10;
+    }
+    client.output.insert(client.output.end(), header, header + headerSize);
+    if (size) client.output.insert(client.output.end(), data, data + size);
+}
+
+void FrameServer::Broadcast(const std::vector<uint8_t>& message, bool keyframe) {
+    for (Client& client : clients) {
+        if (!client.streaming || client.closing) continue;
+        if (client.resync && !keyframe) continue;
+        if (client.outputSent != client.output.size()) {
+            // still sending an older frame: skip this one, and the deltas after it
+            client.resync = true;
+            framesDropped++;
+            continue;
+        }
+        queue(client, 0x2, message.data(), message.size());
+        client.resync = false;
+        flush(client);
+    }
+}
+
+bool FrameServer::flush(Client& client) {
+    while (client.outputSent < client.output.size()) {
+        size_t left = client.output.size() - client.outputSent;
+        int sent = int(send(client.socket, reinterpret_cast<const char*>(&client.output[client.outputSent]),
+            int(std::min(left, size_t(1) << 30)), kSendFlags));
+        if (sent < 0) return wouldBlock();
+        client.outputSent += size_t(sent);
+        bytesSent += uint64_t(sent);
+    }
+    client.output.clear();
+    client.outputSent = 0;
+    return true;
+}
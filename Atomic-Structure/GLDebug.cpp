@@ -0,0 +1,53 @@
+#include "headers/GLDebug.hpp"
+#include <iostream>
+
+#ifndef NDEBUG
+namespace {
+    bool attempted = false;
+    bool installed = false;
+
+    const char* debugTypeName(GLenum type) {
+        switch (type) {
+        case GL_DEBUG_TYPE_ERROR: return "ERROR";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "DEPRECATED";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "UNDEFINED_BEHAVIOR";
+        case GL_DEBUG_TYPE_PORTABILITY: return "PORTABILITY";
+        case GL_DEBUG_TYPE_PERFORMANCE: return "PERFORMANCE";
+        default: return "OTHER";
+        }
+    }
+
+    void APIENTRY debugCallback(GLenum source, GLenum type, GLuint id, GLenum severity,
+        GLsizei length, const GLchar* message, const void* userParam) {
+        if (severity == GL_DEBUG_SEVERITY_NOTIFICATION) return; // buffer placement chatter etc.
+        std::cout << "GL::DEBUG::" << debugTypeName(type) << " (" << id << "): " << message << std::endl;
+    }
+}
+#endif
+
+void EnableGLDebugOutput() {
+#ifndef NDEBUG
+    if (attempted) return;
+    attempted = true;
+    GLint flags = 0;
+    glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+    if (!(flags & GL_CONTEXT_FLAG_DEBUG_BIT)) {
+        std::cout << "Warning: no debug context, falling back to glGetError() checks" << std::endl;
+        return;
+    }
+    glEnable(GL_DEBUG_OUTPUT);
+    // synchronous so the callback runs inside the offending call and shows up in its stack
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glDebugMessageCallback(debugCallback, nullptr);
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+    installed = true;
+#endif
+}
+
+bool IsGLDebugOutputEnabled() {
+#ifndef NDEBUG
+    return installed;
+#else
+    return false;
+#endif
+}
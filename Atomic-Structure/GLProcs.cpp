@@ -0,0 +1,127 @@
+#include "headers/GLProcs.hpp"
+#include <iostream>
+
+GLProcs gl;
+
+namespace {
+    bool loaded = false;
+}
+
+bool LoadGLProcs(GLProcLoader loader) {
+    if (loaded) return true;
+    if (!loader) return false;
+#define LOAD_GL(var, name) gl.var = reinterpret_cast<decltype(gl.var)>(loader(name))
+    LOAD_GL(genFramebuffers, "glGenFramebuffers");
+    LOAD_GL(deleteFramebuffers, "glDeleteFramebuffers");
+    LOAD_GL(bindFramebuffer, "glBindFramebuffer");
+    LOAD_GL(genRenderbuffers, "glGenRenderbuffers");
+    LOAD_GL(deleteRenderbuffers, "glDeleteRenderbuffers");
+    LOAD_GL(bindRenderbuffer, "glBindRenderbuffer");
+    LOAD_GL(renderbufferStorage, "glRenderbufferStorage");
+    LOAD_GL(framebufferRenderbuffer, "glFramebufferRenderbuffer");
+    LOAD_GL(framebufferTexture2D, "glFramebufferTexture2D");
+    LOAD_GL(checkFramebufferStatus, "glCheckFramebufferStatus");
+    LOAD_GL(blitFramebuffer, "glBlitFramebuffer");
+    LOAD_GL(genBuffers, "glGenBuffers");
+    LOAD_GL(deleteBuffers, "glDeleteBuffers");
+    LOAD_GL(bindBuffer, "glBindBuffer");
+    LOAD_GL(bufferData, "glBufferData");
+    LOAD_GL(mapBufferRange, "glMapBufferRange");
+    LOAD_GL(unmapBuffer, "glUnmapBuffer");
+    LOAD_GL(fenceSync, "glFenceSync");
+    LOAD_GL(clientWaitSync, "glClientWaitSync");
+    LOAD_GL(deleteSync, "glDeleteSync");
+    LOAD_GL(createShader, "glCreateShader");
+    LOAD_GL(shaderSource, "glShaderSource");
+    LOAD_GL(compileShader, "glCompileShader");
+    LOAD_GL(getShaderiv, "glGetShaderiv");
+    LOAD_GL(getShaderInfoLog, "glGetShaderInfoLog");
+    LOAD_GL(deleteShader, "glDeleteShader");
+    LOAD_GL(createProgram, "glCreateProgram");
+    LOAD_GL(attachShader, "glAttachShader");
+    LOAD_GL(linkProgram, "glLinkProgram");
+    LOAD_GL(getProgramiv, "glGetProgramiv");
+    LOAD_GL(useProgram, "glUseProgram");
+    LOAD_GL(deleteProgram, "glDeleteProgram");
+    LOAD_GL(getUniformLocation, "glGetUniformLocation");
+    LOAD_GL(uniform1i, "glUniform1i");
+    LOAD_GL(uniform1f, "glUniform1f");
+    LOAD_GL(uniform2f, "glUniform2f");
+    LOAD_GL(drawBuffers, "glDrawBuffers");
+    LOAD_GL(clearBufferuiv, "glClearBufferuiv");
+    LOAD_GL(bindFragDataLocation, "glBindFragDataLocation");
+    LOAD_GL(genQueries, "glGenQueries");
+    LOAD_GL(deleteQueries, "glDeleteQueries");
+    LOAD_GL(beginQuery, "glBeginQuery");
+    LOAD_GL(endQuery, "glEndQuery");
+    LOAD_GL(getQueryObjectiv, "glGetQueryObjectiv");
+    LOAD_GL(getQueryObjectui64v, "glGetQueryObjectui64v");
+    LOAD_GL(queryCounter, "glQueryCounter");
+    LOAD_GL(getInteger64v, "glGetInteger64v");
+#undef LOAD_GL
+    loaded = true;
+    return true;
+}
+
+bool GLProcs::HasFramebuffers() const {
+    return genFramebuffers && deleteFramebuffers && bindFramebuffer && genRenderbuffers && deleteRenderbuffers &&
+        bindRenderbuffer && renderbufferStorage && framebufferRenderbuffer && framebufferTexture2D &&
+        checkFramebufferStatus && blitFramebuffer;
+}
+
+bool GLProcs::HasPixelBuffers() const {
+    return genBuffers && deleteBuffers && bindBuffer && bufferData && mapBufferRange && unmapBuffer;
+}
+
+bool GLProcs::HasSync() const {
+    return fenceSync && clientWaitSync && deleteSync;
+}
+
+bool GLProcs::HasPrograms() const {
+    return createShader && shaderSource && compileShader && getShaderiv && getShaderInfoLog && deleteShader &&
+        createProgram && attachShader && linkProgram && getProgramiv && useProgram && deleteProgram &&
+        getUniformLocation && uniform1i && uniform1f && uniform2f;
+}
+
+bool GLProcs::HasDrawBuffers() const {
+    return drawBuffers && clearBufferuiv && bindFragDataLocation;
+}
+
+bool GLProcs::HasQueries() const {
+    return genQueries && deleteQueries && beginQuery && endQuery && getQueryObjectiv;
+}
+
+bool GLProcs::HasTimer() const {
+    return HasQueries() && getQueryObjectui64v;
+}
+
+bool GLProcs::HasTimestamps() const {
+    return genQueries && deleteQueries && queryCounter && getQueryObjectui64v && getInteger64v;
+}
+
+GLuint BuildFragmentProgram(const char* source, const char* owner, const char* const* outputs, int outputCount) {
+    GLuint shader = gl.createShader(GL_FRAGMENT_SHADER);
+    gl.shaderSource(shader, 1, &source, nullptr);
+    gl.compileShader(shader);
+    GLint success = 0;
+    gl.getShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        char log[1024];
+        gl.getShaderInfoLog(shader, sizeof(log), nullptr, log);
+        std::cout << "ERROR::" << owner << "::SHADER_COMPILATION_ERROR\n" << log << std::endl;
+        gl.deleteShader(shader);
+        return 0;
+    }
+    GLuint program = gl.createProgram();
+    gl.attachShader(program, shader);
+    for (int i = 0; i < outputCount; ++i) gl.bindFragDataLocation(program, GLuint(i), outputs[i]);
+    gl.linkProgram(program);
+    gl.deleteShader(shader);
+    gl.getProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        std::cout << "ERROR::" << owner << "::PROGRAM_LINKING_ERROR" << std::endl;
+        gl.deleteProgram(program);
+        return 0;
+    }
+    return program;
+}
@@ -1,13 +1,15 @@
 
 #include "headers/Ground.hpp"
+#include "headers/GLDebug.hpp"
 
 
-Ground::Ground(float width = 100.0f, float length = 100.0f) : width(width), length(length), initialized(false) {
+Ground::Ground(float width = 100.0f, float length = 100.0f, const char* vertPath, const char* fragPath) : width(width), length(length), initialized(false) {
     std::cout << "Creating ground with dimensions: " << width << " x " << length << std::endl;
+    EnableGLDebugOutput();
     createPlane();
     setupBuffers();
     try {
-        shader = new Shader("C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\Ground.vert", "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\Ground.frag");
+        shader = new Shader(vertPath, fragPath);
         initialized = true;
         std::cout << "Ground shader compilation successful" << std::endl;
     }
@@ -75,10 +77,15 @@ void Ground::render(const glm::mat4& view, const glm::mat4& projection, const gl
     glBindVertexArray(VAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
 
-    GLenum error = glGetError();
-    if (error != GL_NO_ERROR) {
-        std::cout << "OpenGL error during ground rendering: " << error << std::endl;
+#ifndef NDEBUG
+    // only without a debug context, the callback reports errors itself
+    if (!IsGLDebugOutputEnabled()) {
+        GLenum error = glGetError();
+        if (error != GL_NO_ERROR) {
+            std::cout << "OpenGL error during ground rendering: " << error << std::endl;
+        }
     }
+#endif
 }
 
 Ground::~Ground() {
@@ -19,6 +19,8 @@ void Input::mouse_callback(GLFWwindow* window, double xpos, double ypos) {
 
 	float actX = static_cast<float>(xpos);
 	float actY = static_cast<float>(ypos);
+	input->cursorX = actX;
+	input->cursorY = actY;
 
 	if (input->firstMouse) {
 		input->lastX = xpos;
@@ -71,3 +73,35 @@ void Input::keyboardInput(GLFWwindow* window, Camera& cam, float& deltaTime) {
 }
 
 
+CameraSample Input::captureCamera(const Camera& cam, int element) {
+	CameraSample sample;
+	sample.frame = 0;
+	sample.element = element;
+	glm::vec3 target = cam.Position + cam.Front;
+	for (int i = 0; i < 3; i++) {
+		sample.position[i] = cam.Position[i];
+		sample.target[i] = target[i];
+	}
+	sample.yaw = cam.Yaw;
+	sample.pitch = cam.Pitch;
+	sample.zoom = cam.Zoom;
+	sample.flags = CAPTURE_LIGHTING;
+	return sample;
+}
+
+void Input::applySample(Camera& cam, const CameraSample& sample) {
+	// yaw/pitch are the source of truth for Camera, the target is only there for the GLUT path
+	cam.SetState(glm::vec3(sample.position[0], sample.position[1], sample.position[2]),
+		sample.yaw, sample.pitch, sample.zoom);
+}
+
+bool Input::replayFrame(CaptureReplay& replay, Camera& cam, int& element, float& deltaTime) {
+	CameraSample sample;
+	if (!replay.Next(sample)) {
+		return false;
+	}
+	applySample(cam, sample);
+	element = sample.element;
+	deltaTime = static_cast<float>(replay.GetFixedStep());
+	return true;
+}
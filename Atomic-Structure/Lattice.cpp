@@ -0,0 +1,137 @@
+#include "headers/Lattice.hpp"
+#include "headers/Elements.hpp"
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+Lattice::Lattice() : type(LatticeType::Custom) {
+    memset(cell, 0, sizeof(cell));
+}
+
+Lattice Lattice::Cubic(LatticeType type, float a, int atomicNumber) {
+    Lattice lattice;
+    lattice.type = type;
+    lattice.cell[0] = lattice.cell[4] = lattice.cell[8] = a;
+
+    static const float corner[1][3] = { { 0, 0, 0 } };
+    static const float bodyCentered[2][3] = { { 0, 0, 0 }, { 0.5f, 0.5f, 0.5f } };
+    static const float faceCentered[4][3] = { { 0, 0, 0 }, { 0.5f, 0.5f, 0 }, { 0.5f, 0, 0.5f }, { 0, 0.5f, 0.5f } };
+    const float (*sites)[3] = corner;
+    int count = 1;
+    switch (type) {
+    case LatticeType::BodyCentered: sites = bodyCentered; count = 2; break;
+    case LatticeType::FaceCentered:
+    case LatticeType::Diamond: sites = faceCentered; count = 4; break;
+    default: break;
+    }
+    for (int i = 0; i < count; ++i) {
+        lattice.basis.push_back({ atomicNumber, { sites[i][0], sites[i][1], sites[i][2] } });
+        // diamond is two interpenetrating FCC lattices, the second shifted by a quarter diagonal
+        if (type == LatticeType::Diamond) {
+            lattice.basis.push_back({ atomicNumber, { sites[i][0] + 0.25f, sites[i][1] + 0.25f, sites[i][2] + 0.25f } });
+        }
+    }
+    return lattice;
+}
+
+Lattice Lattice::HexagonalClosePacked(float a, float c, int atomicNumber) {
+    if (c <= 0.0f) c = a * sqrtf(8.0f / 3.0f);
+    Lattice lattice;
+    lattice.type = LatticeType::HexagonalClosePacked;
+    const float vectors[9] = {
+        a, 0.0f, 0.0f,
+        -0.5f * a, 0.5f * sqrtf(3.0f) * a, 0.0f,
+        0.0f, 0.0f, c
+    };
+    memcpy(lattice.cell, vectors, sizeof(vectors));
+    lattice.basis.push_back({ atomicNumber, { 0.0f, 0.0f, 0.0f } });
+    lattice.basis.push_back({ atomicNumber, { 1.0f / 3.0f, 2.0f / 3.0f, 0.5f } });
+    return lattice;
+}
+
+Lattice Lattice::Custom(const float cell[9], const std::vector<BasisAtom>& basis) {
+    Lattice lattice;
+    memcpy(lattice.cell, cell, sizeof(lattice.cell));
+    lattice.basis = basis;
+    return lattice;
+}
+
+bool Lattice::Parse(const std::string& spec, Lattice& out) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    for (;;) {
+        size_t colon = spec.find(':', start);
+        fields.push_back(spec.substr(start, colon - start));
+        if (colon == std::string::npos) break;
+        start = colon + 1;
+    }
+
+    std::string name = fields[0];
+    for (auto& c : name) c = (char)tolower((unsigned char)c);
+    LatticeType type;
+    if (name == "sc") type = LatticeType::SimpleCubic;
+    else if (name == "bcc") type = LatticeType::BodyCentered;
+    else if (name == "fcc") type = LatticeType::FaceCentered;
+    else if (name == "hcp") type = LatticeType::HexagonalClosePacked;
+    else if (name == "diamond") type = LatticeType::Diamond;
+    else {
+        std::cout << "ERROR::LATTICE::UNKNOWN_TYPE " << fields[0] << " (sc, bcc, fcc, hcp or diamond)" << std::endl;
+        return false;
+    }
+
+    int atomicNumber = 0;
+    if (fields.size() > 1 && !fields[1].empty()) {
+        atomicNumber = isdigit((unsigned char)fields[1][0]) ? atoi(fields[1].c_str())
+            : ElementFromSymbol(fields[1].c_str(), fields[1].size());
+    }
+    if (atomicNumber < 1 || atomicNumber > kElementCount) {
+        std::cout << "ERROR::LATTICE::UNKNOWN_ELEMENT " << spec << std::endl;
+        return false;
+    }
+    float a = fields.size() > 2 ? float(atof(fields[2].c_str())) : 0.0f;
+    float c = fields.size() > 3 ? float(atof(fields[3].c_str())) : 0.0f;
+
+    // nearest neighbour distance is 2r: along the edge (SC, HCP), half the body diagonal
+    // (BCC), half the face diagonal (FCC) or a quarter of the body diagonal (diamond)
+    if (a <= 0.0f) {
+        float d = 2.0f * GetElement(atomicNumber).covalentRadius;
+        switch (type) {
+        case LatticeType::BodyCentered: a = 2.0f * d / sqrtf(3.0f); break;
+        case LatticeType::FaceCentered: a = d * sqrtf(2.0f); break;
+        case LatticeType::Diamond: a = 4.0f * d / sqrtf(3.0f); break;
+        default: a = d; break;
+        }
+    }
+
+    out = type == LatticeType::HexagonalClosePacked ? HexagonalClosePacked(a, c, atomicNumber) : Cubic(type, a, atomicNumber);
+    return true;
+}
+
+void Lattice::FillCell(SceneData& scene) const {
+    const int single[3] = { 1, 1, 1 };
+    Fill(scene, single);
+}
+
+void Lattice::Fill(SceneData& scene, const int repeat[3]) const {
+    scene.atoms.reserve(scene.atoms.size() + basis.size() * size_t(repeat[0]) * repeat[1] * repeat[2]);
+    scene.elements.reserve(scene.atoms.capacity());
+    for (int k = 0; k < repeat[2]; ++k) {
+        for (int j = 0; j < repeat[1]; ++j) {
+            for (int i = 0; i < repeat[0]; ++i) {
+                for (const BasisAtom& atom : basis) {
+                    float f[3] = { atom.fractional[0] + i, atom.fractional[1] + j, atom.fractional[2] + k };
+                    scene.AddAtom(atom.atomicNumber,
+                        f[0] * cell[0] + f[1] * cell[3] + f[2] * cell[6],
+                        f[0] * cell[1] + f[1] * cell[4] + f[2] * cell[7],
+                        f[0] * cell[2] + f[1] * cell[5] + f[2] * cell[8]);
+                }
+            }
+        }
+    }
+    for (int v = 0; v < 3; ++v) {
+        for (int i = 0; i < 3; ++i) scene.cell[v * 3 + i] = cell[v * 3 + i] * repeat[v];
+    }
+    scene.periodic = true;
+}
@@ -0,0 +1,105 @@
+#include "headers/LayerCache.hpp"
+#include "headers/GLProcs.hpp"
+#include <algorithm>
+#include <iostream>
+
+LayerCache::LayerCache(int width, int height, ProcLoader loader)
+    : width(std::max(width, 1)), height(std::max(height, 1)), supported(false), valid(false),
+    layerDraws(0), reusedFrames(0) {
+    for (int i = 0; i < 2; ++i) fbos[i] = colorBuffers[i] = depthBuffers[i] = 0;
+
+    if (!LoadGLProcs(loader) || !gl.HasFramebuffers()) {
+        std::cout << "ERROR::LAYER_CACHE::MISSING_GL_FUNCTIONS (needs GL 3.0 or ARB_framebuffer_object)" << std::endl;
+        return;
+    }
+
+    createTargets();
+    for (int i = 0; i < 2; ++i) {
+        gl.bindFramebuffer(GL_FRAMEBUFFER, fbos[i]);
+        GLenum status = gl.checkFramebufferStatus(GL_FRAMEBUFFER);
+        if (status != GL_FRAMEBUFFER_COMPLETE) {
+            gl.bindFramebuffer(GL_FRAMEBUFFER, 0);
+            std::cout << "ERROR::LAYER_CACHE::FRAMEBUFFER_INCOMPLETE " << status << std::endl;
+            return;
+        }
+    }
+    gl.bindFramebuffer(GL_FRAMEBUFFER, 0);
+    supported = true;
+}
+
+void LayerCache::createTargets() {
+    gl.genRenderbuffers(2, colorBuffers);
+    gl.genRenderbuffers(2, depthBuffers);
+    gl.genFramebuffers(2, fbos);
+    for (int i = 0; i < 2; ++i) {
+        // identical formats, so depth can be blitted from one to the other
+        gl.bindRenderbuffer(GL_RENDERBUFFER, colorBuffers[i]);
+        gl.renderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        gl.bindRenderbuffer(GL_RENDERBUFFER, depthBuffers[i]);
+        gl.renderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+
+        gl.bindFramebuffer(GL_FRAMEBUFFER, fbos[i]);
+        gl.framebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffers[i]);
+        gl.framebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffers[i]);
+    }
+    gl.bindRenderbuffer(GL_RENDERBUFFER, 0);
+    gl.bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void LayerCache::destroyTargets() {
+    if (fbos[0]) gl.deleteFramebuffers(2, fbos);
+    if (colorBuffers[0]) gl.deleteRenderbuffers(2, colorBuffers);
+    if (depthBuffers[0]) gl.deleteRenderbuffers(2, depthBuffers);
+    for (int i = 0; i < 2; ++i) fbos[i] = colorBuffers[i] = depthBuffers[i] = 0;
+}
+
+void LayerCache::Resize(int width, int height) {
+    width = std::max(width, 1);
+    height = std::max(height, 1);
+    if (!supported || (width == this->width && height == this->height)) return;
+    valid = false;
+    this->width = width;
+    this->height = height;
+    destroyTargets();
+    createTargets();
+}
+
+void LayerCache::BeginLayers() {
+    if (!supported) return;
+    gl.bindFramebuffer(GL_FRAMEBUFFER, fbos[0]);
+    glViewport(0, 0, width, height);
+}
+
+void LayerCache::EndLayers() {
+    if (!supported) return;
+    gl.bindFramebuffer(GL_FRAMEBUFFER, 0);
+    valid = true;
+    layerDraws++;
+}
+
+void LayerCache::BeginFrame() {
+    if (!supported) return;
+    gl.bindFramebuffer(GL_READ_FRAMEBUFFER, fbos[0]);
+    gl.bindFramebuffer(GL_DRAW_FRAMEBUFFER, fbos[1]);
+    // depth and stencil blits must use GL_NEAREST
+    gl.blitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    gl.bindFramebuffer(GL_FRAMEBUFFER, fbos[1]);
+    glViewport(0, 0, width, height);
+    reusedFrames++;
+}
+
+void LayerCache::Present(int targetWidth, int targetHeight, unsigned int target) {
+    if (!supported) return;
+    gl.bindFramebuffer(GL_READ_FRAMEBUFFER, fbos[1]);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    gl.bindFramebuffer(GL_DRAW_FRAMEBUFFER, target);
+    gl.blitFramebuffer(0, 0, width, height, 0, 0, targetWidth, targetHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    gl.bindFramebuffer(GL_FRAMEBUFFER, target);
+    glReadBuffer(target ? GL_COLOR_ATTACHMENT0 : GL_BACK);
+    glViewport(0, 0, targetWidth, targetHeight);
+}
+
+LayerCache::~LayerCache() {
+    if (!colorBuffers[0]) return;
+    destroyTargets();
+}
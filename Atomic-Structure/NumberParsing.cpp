@@ -0,0 +1,36 @@
+#include "headers/NumberParsing.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+    const size_t kMaxNumber = 64;
+
+    void copyNumber(const char* begin, const char* end, char (&text)[kMaxNumber]) {
+        size_t length = std::min(size_t(end - begin), kMaxNumber - 1);
+        memcpy(text, begin, length);
+        text[length] = '\0';
+    }
+}
+
+bool ScanFloat(const char* begin, const char* end, float& out, const char** next) {
+    char text[kMaxNumber];
+    copyNumber(begin, end, text);
+    char* stop;
+    errno = 0;
+    out = strtof(text, &stop);
+    if (stop == text || errno == ERANGE) return false;
+    if (next) *next = begin + (stop - text);
+    return true;
+}
+
+bool ScanInteger(const char* begin, const char* end, long long& out) {
+    while (begin < end && (*begin == ' ' || *begin == '\t' || *begin == '\r')) ++begin;
+    char text[kMaxNumber];
+    copyNumber(begin, end, text);
+    char* stop;
+    errno = 0;
+    out = strtoll(text, &stop, 10);
+    return stop != text && errno != ERANGE;
+}
@@ -0,0 +1,125 @@
+#include "headers/OffscreenCapture.hpp"
+#include "headers/GLProcs.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+OffscreenCapture::OffscreenCapture(int width, int height, ProcLoader loader, int ringSize)
+    : width(width), height(height), ringSize(std::min(std::max(ringSize, 2), 8)), supported(false),
+    fbo(0), colorBuffer(0), depthBuffer(0), head(0), pending(0) {
+    for (int i = 0; i < 8; ++i) {
+        pbos[i] = 0;
+        fences[i] = nullptr;
+    }
+
+    if (!LoadGLProcs(loader) || !(gl.HasFramebuffers() && gl.HasPixelBuffers() && gl.HasSync())) {
+        std::cout << "ERROR::OFFSCREEN_CAPTURE::MISSING_GL_FUNCTIONS (needs GL 3.2 or ARB_framebuffer_object + ARB_sync)" << std::endl;
+        return;
+    }
+
+    gl.genRenderbuffers(1, &colorBuffer);
+    gl.bindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    gl.renderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    gl.genRenderbuffers(1, &depthBuffer);
+    gl.bindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    gl.renderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    gl.bindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    gl.genFramebuffers(1, &fbo);
+    gl.bindFramebuffer(GL_FRAMEBUFFER, fbo);
+    gl.framebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    gl.framebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    GLenum status = gl.checkFramebufferStatus(GL_FRAMEBUFFER);
+    gl.bindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "ERROR::OFFSCREEN_CAPTURE::FRAMEBUFFER_INCOMPLETE " << status << std::endl;
+        return;
+    }
+
+    gl.genBuffers(this->ringSize, pbos);
+    for (int i = 0; i < this->ringSize; ++i) {
+        gl.bindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+        gl.bufferData(GL_PIXEL_PACK_BUFFER, GetFrameSize(), nullptr, GL_STREAM_READ);
+    }
+    gl.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    supported = true;
+}
+
+void OffscreenCapture::Bind() {
+    if (!supported) return;
+    gl.bindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, width, height);
+}
+
+void OffscreenCapture::Unbind() {
+    if (!supported) return;
+    gl.bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void OffscreenCapture::BlitToWindow(int windowWidth, int windowHeight) {
+    if (!supported) return;
+    gl.bindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    gl.bindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    gl.blitFramebuffer(0, 0, width, height, 0, 0, windowWidth, windowHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    gl.bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+bool OffscreenCapture::Queue() {
+    if (!supported || pending == ringSize) return false;
+
+    // with a PBO bound the last argument is an offset and glReadPixels returns at once
+    gl.bindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    gl.bindBuffer(GL_PIXEL_PACK_BUFFER, pbos[head]);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    gl.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    gl.bindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+    fences[head] = gl.fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    head = (head + 1) % ringSize;
+    pending++;
+    return true;
+}
+
+bool OffscreenCapture::Collect(uint8_t* dst, bool wait) {
+    if (!supported || pending == 0) return false;
+
+    int slot = (head - pending + ringSize) % ringSize;
+    GLsync fence = static_cast<GLsync>(fences[slot]);
+    // flush on the first check so the fence is guaranteed to signal eventually
+    GLenum result = gl.clientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? 1000000000ull : 0);
+    while (wait && result == GL_TIMEOUT_EXPIRED) {
+        result = gl.clientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+    }
+    if (result == GL_TIMEOUT_EXPIRED) return false;
+    gl.deleteSync(fence);
+    fences[slot] = nullptr;
+    if (result == GL_WAIT_FAILED) {
+        // this frame will never be known to be done, drop it so later ones still arrive
+        std::cout << "ERROR::OFFSCREEN_CAPTURE::WAIT_FAILED, frame dropped" << std::endl;
+        pending--;
+        return false;
+    }
+
+    gl.bindBuffer(GL_PIXEL_PACK_BUFFER, pbos[slot]);
+    const void* data = gl.mapBufferRange(GL_PIXEL_PACK_BUFFER, 0, GetFrameSize(), GL_MAP_READ_BIT);
+    if (data) {
+        memcpy(dst, data, GetFrameSize());
+        gl.unmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    gl.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    pending--;
+    return data != nullptr;
+}
+
+OffscreenCapture::~OffscreenCapture() {
+    if (!colorBuffer) return;
+    for (int i = 0; i < ringSize; ++i) {
+        if (fences[i]) gl.deleteSync(static_cast<GLsync>(fences[i]));
+    }
+    if (pbos[0]) gl.deleteBuffers(ringSize, pbos);
+    if (fbo) gl.deleteFramebuffers(1, &fbo);
+    GLuint renderbuffers[2] = { colorBuffer, depthBuffer };
+    gl.deleteRenderbuffers(2, renderbuffers);
+}
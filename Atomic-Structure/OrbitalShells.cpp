@@ -0,0 +1,131 @@
+#include "headers/OrbitalShells.hpp"
+#include "headers/Electrons.hpp"
+#include <cstddef>
+#include <iostream>
+
+OrbitalShells::OrbitalShells(const char* shellVertPath, const char* ringVertPath, const char* accumFragPath)
+    : shellVAO(0), meshVBO(0), meshEBO(0), shellInstanceVBO(0), ringVAO(0), ringInstanceVBO(0),
+    meshIndexCount(0), meshIndexType(GL_UNSIGNED_SHORT), dirty(true), initialized(false) {
+    // shells are large but smooth and translucent, a medium icosphere is enough
+    SphereMesh mesh(SphereType::Icosphere, 32, 32);
+    std::vector<uint16_t> shortIndices(mesh.GetIndices().begin(), mesh.GetIndices().end());
+    meshIndexCount = static_cast<unsigned int>(shortIndices.size());
+
+    glGenVertexArrays(1, &shellVAO);
+    glGenBuffers(1, &meshVBO);
+    glGenBuffers(1, &meshEBO);
+    glGenBuffers(1, &shellInstanceVBO);
+
+    glBindVertexArray(shellVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, meshVBO);
+    glBufferData(GL_ARRAY_BUFFER, mesh.GetVertices().size() * sizeof(SphereVertex), mesh.GetVertices().data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, sizeof(SphereVertex), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(uint16_t), shortIndices.data(), GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ARRAY_BUFFER, shellInstanceVBO);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(ShellInstance), (void*)offsetof(ShellInstance, centerRadius));
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(ShellInstance), (void*)offsetof(ShellInstance, color));
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+
+    // rings have no per-vertex data at all, the circle comes from gl_VertexID
+    glGenVertexArrays(1, &ringVAO);
+    glGenBuffers(1, &ringInstanceVBO);
+    glBindVertexArray(ringVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, ringInstanceVBO);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(RingInstance), (void*)offsetof(RingInstance, centerRadius));
+    glEnableVertexAttribArray(0);
+    glVertexAttribDivisor(0, 1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(RingInstance), (void*)offsetof(RingInstance, axis));
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(RingInstance), (void*)offsetof(RingInstance, color));
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+
+    glBindVertexArray(0);
+
+    try {
+        shellShader = std::make_unique<Shader>(shellVertPath, accumFragPath);
+        ringShader = std::make_unique<Shader>(ringVertPath, accumFragPath);
+        initialized = true;
+        std::cout << "Orbital shell shader compilation successful" << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cout << "Failed to create orbital shell shaders: " << e.what() << std::endl;
+    }
+}
+
+void OrbitalShells::Clear() {
+    shells.clear();
+    rings.clear();
+    dirty = true;
+}
+
+void OrbitalShells::AddShell(const glm::vec3& center, float radius, const glm::vec3& color, float opacity) {
+    shells.push_back({ glm::vec4(center, radius), glm::vec4(color, opacity) });
+    dirty = true;
+}
+
+void OrbitalShells::AddRing(const glm::vec3& center, float radius, const glm::vec3& axis, const glm::vec3& color, float opacity) {
+    rings.push_back({ glm::vec4(center, radius), glm::vec4(axis, 0.0f), glm::vec4(color, opacity) });
+    dirty = true;
+}
+
+void OrbitalShells::AddAtom(const glm::vec3& center, const std::vector<Electron>& electrons, float opacity) {
+    for (const auto& e : electrons) {
+        AddRing(center, e.GetOrbitRadius(), e.GetOrbitalPlaneNormal(), e.GetColor(), opacity);
+    }
+}
+
+void OrbitalShells::upload() {
+    // instance data only changes when atoms are added or removed, not per frame
+    glBindBuffer(GL_ARRAY_BUFFER, shellInstanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, shells.size() * sizeof(ShellInstance), shells.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, ringInstanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, rings.size() * sizeof(RingInstance), rings.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    dirty = false;
+}
+
+void OrbitalShells::Render(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPos) {
+    if (!initialized) {
+        std::cout << "Warning: Attempting to render uninitialized orbital shells" << std::endl;
+        return;
+    }
+    if (dirty) upload();
+
+    if (!shells.empty()) {
+        shellShader->use();
+        shellShader->setMat4("view", view);
+        shellShader->setMat4("projection", projection);
+        shellShader->setVec3("viewPos", viewPos);
+
+        glBindVertexArray(shellVAO);
+        glDrawElementsInstanced(GL_TRIANGLES, meshIndexCount, meshIndexType, 0, static_cast<GLsizei>(shells.size()));
+    }
+
+    if (!rings.empty()) {
+        ringShader->use();
+        ringShader->setMat4("view", view);
+        ringShader->setMat4("projection", projection);
+        ringShader->setInt("segments", kRingSegments);
+
+        glBindVertexArray(ringVAO);
+        glDrawArraysInstanced(GL_LINE_LOOP, 0, kRingSegments, static_cast<GLsizei>(rings.size()));
+    }
+
+    glBindVertexArray(0);
+}
+
+OrbitalShells::~OrbitalShells() {
+    glDeleteVertexArrays(1, &shellVAO);
+    glDeleteVertexArrays(1, &ringVAO);
+    GLuint buffers[4] = { meshVBO, meshEBO, shellInstanceVBO, ringInstanceVBO };
+    glDeleteBuffers(4, buffers);
+}
@@ -0,0 +1,157 @@
+#include "headers/PhotonSystem.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+    // hc in nm * hartree
+    const float kPlanckWavelength = 45.5634f;
+    // photons per job of Step()
+    const size_t kJobSize = 16384;
+
+    uint32_t packColor(float r, float g, float b, float intensity) {
+        auto channel = [intensity](float c) { return uint32_t(std::min(std::max(c * intensity, 0.0f), 1.0f) * 255.0f + 0.5f); };
+        return channel(r) | channel(g) << 8 | channel(b) << 16 | 255u << 24;
+    }
+}
+
+//======================================================================================
+// RydbergSeries
+//======================================================================================
+RydbergSeries RydbergSeries::FromShells(const ElementShells& shells) {
+    RydbergSeries series = {};
+    const Subshell* outer = &shells.subshells[0];
+    for (int i = 1; i < shells.count; ++i) {
+        if (shells.subshells[i].energy > outer->energy) outer = &shells.subshells[i];
+    }
+    series.groundN = outer->n;
+    series.l = outer->l;
+    series.defect = outer->n - 1.0f / sqrtf(-2.0f * outer->energy);
+
+    for (int upper = 1; upper < kLevels; ++upper) {
+        for (int lower = 0; lower < upper; ++lower) {
+            float energy = series.Energy(series.groundN + upper) - series.Energy(series.groundN + lower);
+            series.wavelength[upper][lower] = kPlanckWavelength / energy;
+            series.color[upper][lower] = WavelengthColor(series.wavelength[upper][lower]);
+        }
+    }
+    return series;
+}
+
+float RydbergSeries::Energy(int n) const {
+    float effective = n - defect;
+    return -0.5f / (effective * effective);
+}
+
+float RydbergSeries::MeanRadius(int n) const {
+    float effective = n - defect;
+    return 0.5f * (3.0f * effective * effective - l * (l + 1));
+}
+
+uint32_t WavelengthColor(float nm) {
+    // piecewise linear fit of the visible spectrum, dimmed toward the ends where the eye
+    // is less sensitive
+    float clamped = std::min(std::max(nm, 380.0f), 780.0f);
+    float r = 0.0f, g = 0.0f, b = 0.0f;
+    if (clamped < 440.0f) { r = (440.0f - clamped) / 60.0f; b = 1.0f; }
+    else if (clamped < 490.0f) { g = (clamped - 440.0f) / 50.0f; b = 1.0f; }
+    else if (clamped < 510.0f) { g = 1.0f; b = (510.0f - clamped) / 20.0f; }
+    else if (clamped < 580.0f) { r = (clamped - 510.0f) / 70.0f; g = 1.0f; }
+    else if (clamped < 645.0f) { r = 1.0f; g = (645.0f - clamped) / 65.0f; }
+    else r = 1.0f;
+
+    float intensity = 1.0f;
+    if (clamped < 420.0f) intensity = 0.3f + 0.7f * (clamped - 380.0f) / 40.0f;
+    else if (clamped > 700.0f) intensity = 0.3f + 0.7f * (780.0f - clamped) / 80.0f;
+    return packColor(r, g, b, intensity);
+}
+
+//======================================================================================
+// PhotonSystem
+//======================================================================================
+PhotonSystem::PhotonSystem(size_t capacity, int lifeSteps, int threads)
+    : capacity(std::max(capacity, size_t(1))), lifeSteps(uint32_t(std::max(lifeSteps, 1))), head(0), live(0),
+    now(0), dropped(0), rngState(0x9E3779B9u), lastMs(0.0),
+    originX(this->capacity), originY(this->capacity), originZ(this->capacity),
+    velocityX(this->capacity), velocityY(this->capacity), velocityZ(this->capacity),
+    birth(this->capacity), color(this->capacity), vertices(this->capacity), pool(threads) {}
+
+uint32_t PhotonSystem::Random() {
+    // xorshift32
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+size_t PhotonSystem::Emit(const float origin[3], uint32_t rgba, size_t count, float speed) {
+    size_t fitting = std::min(count, capacity - live);
+    dropped += count - fitting;
+    for (size_t i = 0; i < fitting; ++i) {
+        size_t slot = (head + live) % capacity;
+        // uniform on the sphere: z uniform in [-1, 1], azimuth uniform
+        float z = 2.0f * RandomUnit() - 1.0f;
+        float azimuth = 6.2831853f * RandomUnit();
+        float ring = sqrtf(std::max(1.0f - z * z, 0.0f));
+        originX[slot] = origin[0];
+        originY[slot] = origin[1];
+        originZ[slot] = origin[2];
+        velocityX[slot] = speed * ring * cosf(azimuth);
+        velocityY[slot] = speed * ring * sinf(azimuth);
+        velocityZ[slot] = speed * z;
+        birth[slot] = now;
+        color[slot] = rgba;
+        live++;
+    }
+    return fitting;
+}
+
+void PhotonSystem::Step() {
+    auto start = std::chrono::steady_clock::now();
+    now++;
+    // all photons live equally long, so the expired ones are the oldest
+    while (live > 0 && now - birth[head] >= lifeSteps) {
+        head = (head + 1) % capacity;
+        live--;
+    }
+
+    size_t first[2], count[2];
+    int ranges = GetRanges(first, count);
+    int jobs[2] = { 0, 0 };
+    for (int r = 0; r < ranges; ++r) jobs[r] = int((count[r] + kJobSize - 1) / kJobSize);
+    if (jobs[0] + jobs[1] > 0) {
+        const float fade = 1.0f / lifeSteps;
+        pool.Run(jobs[0] + jobs[1], [&](int job) {
+            int r = job < jobs[0] ? 0 : 1;
+            size_t begin = first[r] + size_t(job - (r ? jobs[0] : 0)) * kJobSize;
+            size_t end = std::min(begin + kJobSize, first[r] + count[r]);
+            for (size_t i = begin; i < end; ++i) {
+                float age = float(now - birth[i]);
+                PhotonVertex& v = vertices[i];
+                v.position[0] = originX[i] + velocityX[i] * age;
+                v.position[1] = originY[i] + velocityY[i] * age;
+                v.position[2] = originZ[i] + velocityZ[i] * age;
+                v.color[0] = uint8_t(color[i]);
+                v.color[1] = uint8_t(color[i] >> 8);
+                v.color[2] = uint8_t(color[i] >> 16);
+                v.color[3] = uint8_t(255.0f * (1.0f - age * fade));
+            }
+        });
+    }
+    lastMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void PhotonSystem::Clear() {
+    head = 0;
+    live = 0;
+}
+
+int PhotonSystem::GetRanges(size_t first[2], size_t count[2]) const {
+    if (live == 0) return 0;
+    first[0] = head;
+    count[0] = std::min(live, capacity - head);
+    if (count[0] == live) return 1;
+    first[1] = 0;
+    count[1] = live - count[0];
+    return 2;
+}
@@ -0,0 +1,197 @@
+#include "headers/PickBuffer.hpp"
+#include "headers/GLProcs.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+    // Fixed-function vertex processing feeds this: gl_Color is the lit colour the fixed
+    // pipeline would have written, the ID is split over s (low half) and t (high half)
+    const char* kFixedFunctionSource =
+        "#version 130\n"
+        "out vec4 FragColor;\n"
+        "out uint PickID;\n"
+        "void main() {\n"
+        "    FragColor = gl_Color;\n"
+        "    PickID = uint(gl_TexCoord[0].s + 0.5) | (uint(gl_TexCoord[0].t + 0.5) << 16);\n"
+        "}\n";
+}
+
+PickBuffer::PickBuffer(int width, int height, ProcLoader loader, int ringSize)
+    : width(std::max(width, 1)), height(std::max(height, 1)), ringSize(std::min(std::max(ringSize, 2), 8)),
+    supported(false), fbo(0), colorBuffer(0), idBuffer(0), depthBuffer(0), head(0), pending(0),
+    program(0), programFailed(false) {
+    for (int i = 0; i < 8; ++i) {
+        pbos[i] = 0;
+        fences[i] = nullptr;
+    }
+
+    if (!LoadGLProcs(loader) || !(gl.HasFramebuffers() && gl.HasPixelBuffers() && gl.HasSync() && gl.HasPrograms() && gl.HasDrawBuffers())) {
+        std::cout << "ERROR::PICK_BUFFER::MISSING_GL_FUNCTIONS (needs GL 3.2 or ARB_framebuffer_object + ARB_sync)" << std::endl;
+        return;
+    }
+
+    createTargets();
+    gl.bindFramebuffer(GL_FRAMEBUFFER, fbo);
+    GLenum status = gl.checkFramebufferStatus(GL_FRAMEBUFFER);
+    gl.bindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "ERROR::PICK_BUFFER::FRAMEBUFFER_INCOMPLETE " << status << std::endl;
+        return;
+    }
+
+    // one pixel each
+    gl.genBuffers(this->ringSize, pbos);
+    for (int i = 0; i < this->ringSize; ++i) {
+        gl.bindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+        gl.bufferData(GL_PIXEL_PACK_BUFFER, sizeof(uint32_t), nullptr, GL_STREAM_READ);
+    }
+    gl.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    supported = true;
+}
+
+void PickBuffer::createTargets() {
+    GLuint renderbuffers[3];
+    gl.genRenderbuffers(3, renderbuffers);
+    colorBuffer = renderbuffers[0]; idBuffer = renderbuffers[1]; depthBuffer = renderbuffers[2];
+    gl.bindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    gl.renderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    gl.bindRenderbuffer(GL_RENDERBUFFER, idBuffer);
+    gl.renderbufferStorage(GL_RENDERBUFFER, GL_R32UI, width, height);
+    gl.bindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    gl.renderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    gl.bindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    gl.genFramebuffers(1, &fbo);
+    gl.bindFramebuffer(GL_FRAMEBUFFER, fbo);
+    gl.framebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    gl.framebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_RENDERBUFFER, idBuffer);
+    gl.framebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    // glClear must not touch the integer attachment, BeginIDs clears it
+    const GLenum colorOnly = GL_COLOR_ATTACHMENT0;
+    gl.drawBuffers(1, &colorOnly);
+    gl.bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void PickBuffer::destroyTargets() {
+    if (fbo) gl.deleteFramebuffers(1, &fbo);
+    GLuint renderbuffers[3] = { colorBuffer, idBuffer, depthBuffer };
+    if (colorBuffer) gl.deleteRenderbuffers(3, renderbuffers);
+    fbo = colorBuffer = idBuffer = depthBuffer = 0;
+}
+
+void PickBuffer::Resize(int width, int height) {
+    width = std::max(width, 1);
+    height = std::max(height, 1);
+    if (!supported || (width == this->width && height == this->height)) return;
+    this->width = width;
+    this->height = height;
+    destroyTargets();
+    createTargets();
+}
+
+bool PickBuffer::buildProgram() {
+    const char* outputs[2] = { "FragColor", "PickID" };
+    program = BuildFragmentProgram(kFixedFunctionSource, "PICK_BUFFER", outputs, 2);
+    return program != 0;
+}
+
+void PickBuffer::Bind() {
+    if (!supported) return;
+    gl.bindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, width, height);
+}
+
+void PickBuffer::Unbind() {
+    if (!supported) return;
+    gl.bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void PickBuffer::BlitToWindow(int windowWidth, int windowHeight) {
+    if (!supported) return;
+    gl.bindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    gl.bindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    gl.blitFramebuffer(0, 0, width, height, 0, 0, windowWidth, windowHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    gl.bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void PickBuffer::BeginIDs(bool fixedFunction) {
+    if (!supported) return;
+    const GLenum both[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    gl.drawBuffers(2, both);
+    const GLuint none[4] = { 0, 0, 0, 0 };
+    gl.clearBufferuiv(GL_COLOR, 1, none);
+    if (!fixedFunction) return;
+    if (!program && !programFailed) programFailed = !buildProgram();
+    if (program) gl.useProgram(program);
+}
+
+void PickBuffer::EndIDs() {
+    if (!supported) return;
+    if (program) gl.useProgram(0);
+    const GLenum colorOnly = GL_COLOR_ATTACHMENT0;
+    gl.drawBuffers(1, &colorOnly);
+}
+
+void PickBuffer::TagFixedFunction(uint32_t id) {
+    glTexCoord2f(float(id & 0xFFFF), float(id >> 16));
+}
+
+bool PickBuffer::Request(int x, int y) {
+    if (!supported || pending == ringSize) return false;
+    if (x < 0 || y < 0 || x >= width || y >= height) return false;
+
+    // with a PBO bound the last argument is an offset and glReadPixels returns at once
+    gl.bindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glReadBuffer(GL_COLOR_ATTACHMENT1);
+    gl.bindBuffer(GL_PIXEL_PACK_BUFFER, pbos[head]);
+    glReadPixels(x, y, 1, 1, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    gl.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    gl.bindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+    fences[head] = gl.fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    head = (head + 1) % ringSize;
+    pending++;
+    return true;
+}
+
+bool PickBuffer::Poll(uint32_t& id) {
+    bool found = false;
+    while (supported && pending > 0) {
+        int slot = (head - pending + ringSize) % ringSize;
+        GLsync fence = static_cast<GLsync>(fences[slot]);
+        // flush on the check so the fence is guaranteed to signal eventually
+        GLenum result = gl.clientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (result == GL_TIMEOUT_EXPIRED) break;
+        gl.deleteSync(fence);
+        fences[slot] = nullptr;
+        if (result == GL_WAIT_FAILED) {
+            // this read will never be known to be done, drop it so later ones still arrive
+            pending--;
+            continue;
+        }
+
+        gl.bindBuffer(GL_PIXEL_PACK_BUFFER, pbos[slot]);
+        const void* data = gl.mapBufferRange(GL_PIXEL_PACK_BUFFER, 0, sizeof(uint32_t), GL_MAP_READ_BIT);
+        if (data) {
+            id = *static_cast<const uint32_t*>(data);
+            gl.unmapBuffer(GL_PIXEL_PACK_BUFFER);
+            found = true;
+        }
+        gl.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        pending--;
+    }
+    return found;
+}
+
+PickBuffer::~PickBuffer() {
+    if (!colorBuffer) return;
+    for (int i = 0; i < ringSize; ++i) {
+        if (fences[i]) gl.deleteSync(static_cast<GLsync>(fences[i]));
+    }
+    if (pbos[0]) gl.deleteBuffers(ringSize, pbos);
+    if (program) gl.deleteProgram(program);
+    destroyTargets();
+}
@@ -0,0 +1,227 @@
+#include "headers/Profiler.hpp"
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+namespace {
+    struct OpenCpuZone {
+        const char* name;
+        int64_t startUs;
+    };
+
+    // zones can be opened from worker threads, each gets its own stack and trace track
+    thread_local std::vector<OpenCpuZone> openZones;
+    thread_local int threadTrack = -1;
+    std::atomic<int> nextWorkerTrack(2);
+    std::thread::id mainThread;
+
+    int currentTrack() {
+        if (threadTrack < 0) {
+            threadTrack = std::this_thread::get_id() == mainThread ? 0 : nextWorkerTrack++;
+        }
+        return threadTrack;
+    }
+
+    void writeEscaped(std::ofstream& out, const char* s) {
+        for (; *s; ++s) {
+            if (*s == '"' || *s == '\\') out << '\\';
+            out << *s;
+        }
+    }
+}
+
+Profiler& Profiler::Instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler()
+    : enabled(true), frameIndex(0), epoch(std::chrono::steady_clock::now()), frameStartUs(0), frameMs(0.0),
+    gpuCalibrated(false), gpuOffsetUs(0) {
+    mainThread = std::this_thread::get_id();
+    for (auto& slot : slots) {
+        slot.lastQuery = 0;
+        slot.pending = false;
+    }
+}
+
+int64_t Profiler::nowUs() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Profiler::record(const TraceEvent& e) {
+    std::lock_guard<std::mutex> lock(traceMutex);
+    if (trace.size() < kMaxTraceEvents) trace.push_back(e);
+}
+
+void Profiler::ClearTrace() {
+    std::lock_guard<std::mutex> lock(traceMutex);
+    trace.clear();
+}
+
+void Profiler::addTiming(const char* name, double cpuMs) {
+    for (auto& t : cpuTimings) {
+        if (t.name == name || strcmp(t.name, name) == 0) {
+            t.cpuMs += cpuMs;
+            return;
+        }
+    }
+    cpuTimings.push_back({ name, cpuMs, -1.0 });
+}
+
+void Profiler::BeginFrame() {
+    if (!enabled) return;
+
+    if (!gpuCalibrated) {
+        // one-off: GL_TIMESTAMP read is cheap and does not flush, it aligns GPU events with CPU ones
+        GLint64 gpuNow = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+        gpuOffsetUs = nowUs() - gpuNow / 1000;
+        gpuCalibrated = true;
+    }
+
+    // harvest older frames whose queries are done, oldest first, never wait for one
+    for (uint64_t age = kFramesInFlight; age >= 1; --age) {
+        if (frameIndex < age) continue;
+        FrameSlot& older = slots[(frameIndex - age) % kFramesInFlight];
+        if (older.pending && resolveFrame(older)) recycle(older);
+    }
+
+    FrameSlot& slot = slots[frameIndex % kFramesInFlight];
+    if (slot.pending) {
+        // still not back after kFramesInFlight frames, drop it rather than block
+        recycle(slot);
+    }
+
+    gpuStack.clear();
+    cpuTimings.clear();
+    frameStartUs = nowUs();
+}
+
+void Profiler::EndFrame() {
+    if (!enabled) return;
+
+    int64_t end = nowUs();
+    frameMs = (end - frameStartUs) / 1000.0;
+    record({ "Frame", frameStartUs, end - frameStartUs, 0 });
+
+    FrameSlot& slot = slots[frameIndex % kFramesInFlight];
+    slot.timings = cpuTimings;
+    slot.pending = true;
+    frameIndex++;
+}
+
+void Profiler::BeginCpuZone(const char* name) {
+    if (!enabled) return;
+    openZones.push_back({ name, nowUs() });
+}
+
+void Profiler::EndCpuZone() {
+    if (!enabled || openZones.empty()) return;
+
+    OpenCpuZone zone = openZones.back();
+    openZones.pop_back();
+    int64_t duration = nowUs() - zone.startUs;
+    int track = currentTrack();
+    record({ zone.name, zone.startUs, duration, track });
+    if (track == 0) addTiming(zone.name, duration / 1000.0);
+}
+
+GLuint Profiler::acquireQuery(FrameSlot& slot) {
+    if (slot.freeQueries.empty()) {
+        GLuint queries[16];
+        glGenQueries(16, queries);
+        slot.freeQueries.insert(slot.freeQueries.end(), queries, queries + 16);
+    }
+    GLuint query = slot.freeQueries.back();
+    slot.freeQueries.pop_back();
+    return query;
+}
+
+void Profiler::BeginGpuZone(const char* name) {
+    if (!enabled) return;
+    BeginCpuZone(name);
+
+    FrameSlot& slot = slots[frameIndex % kFramesInFlight];
+    GpuZoneQueries zone = { name, acquireQuery(slot), acquireQuery(slot) };
+    glQueryCounter(zone.startQuery, GL_TIMESTAMP);
+    slot.lastQuery = zone.startQuery;
+    gpuStack.push_back(slot.zones.size());
+    slot.zones.push_back(zone);
+}
+
+void Profiler::EndGpuZone() {
+    if (!enabled) return;
+
+    if (!gpuStack.empty()) {
+        FrameSlot& slot = slots[frameIndex % kFramesInFlight];
+        slot.lastQuery = slot.zones[gpuStack.back()].endQuery;
+        glQueryCounter(slot.lastQuery, GL_TIMESTAMP);
+        gpuStack.pop_back();
+    }
+    EndCpuZone();
+}
+
+bool Profiler::resolveFrame(FrameSlot& slot) {
+    if (slot.lastQuery != 0) {
+        // queries complete in the order they were issued, so the last one being ready means
+        // all are; with nested zones that is an outer zone's end, not zones.back()'s
+        GLint available = 0;
+        glGetQueryObjectiv(slot.lastQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) return false;
+    }
+
+    for (const auto& zone : slot.zones) {
+        GLuint64 start = 0, end = 0;
+        glGetQueryObjectui64v(zone.startQuery, GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(zone.endQuery, GL_QUERY_RESULT, &end);
+
+        int64_t startUs = static_cast<int64_t>(start / 1000) + gpuOffsetUs;
+        int64_t durationUs = static_cast<int64_t>((end - start) / 1000);
+        record({ zone.name, startUs, durationUs, 1 });
+
+        double gpuMs = (end - start) / 1.0e6;
+        for (auto& t : slot.timings) {
+            if (t.name == zone.name || strcmp(t.name, zone.name) == 0) {
+                t.gpuMs = (t.gpuMs < 0.0 ? 0.0 : t.gpuMs) + gpuMs;
+                break;
+            }
+        }
+    }
+
+    passTimings = slot.timings;
+    return true;
+}
+
+void Profiler::recycle(FrameSlot& slot) {
+    for (const auto& zone : slot.zones) {
+        slot.freeQueries.push_back(zone.startQuery);
+        slot.freeQueries.push_back(zone.endQuery);
+    }
+    slot.zones.clear();
+    slot.lastQuery = 0;
+    slot.pending = false;
+}
+
+bool Profiler::WriteChromeTrace(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        std::cout << "ERROR::PROFILER::CANNOT_WRITE_TRACE " << path << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(traceMutex);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"CPU\"}},\n";
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"GPU\"}}";
+    for (const auto& e : trace) {
+        out << ",\n{\"name\":\"";
+        writeEscaped(out, e.name);
+        out << "\",\"cat\":\"" << (e.track == 1 ? "gpu" : "cpu") << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.track
+            << ",\"ts\":" << e.startUs << ",\"dur\":" << e.durationUs << "}";
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
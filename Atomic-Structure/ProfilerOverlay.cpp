@@ -0,0 +1,154 @@
+#include "headers/ProfilerOverlay.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdio>
+#include <iostream>
+
+namespace {
+    // 3x5 font, rows top to bottom
+    struct GlyphBitmap {
+        char c;
+        const char* rows;
+    };
+
+    const GlyphBitmap kFont[] = {
+        {'0', "111101101101111"}, {'1', "010110010010111"}, {'2', "111001111100111"}, {'3', "111001111001111"},
+        {'4', "101101111001001"}, {'5', "111100111001111"}, {'6', "111100111101111"}, {'7', "111001001001001"},
+        {'8', "111101111101111"}, {'9', "111101111001111"},
+        {'A', "010101111101101"}, {'B', "110101110101110"}, {'C', "011100100100011"}, {'D', "110101101101110"},
+        {'E', "111100110100111"}, {'F', "111100110100100"}, {'G', "011100101101011"}, {'H', "101101111101101"},
+        {'I', "111010010010111"}, {'J', "001001001101010"}, {'K', "101101110101101"}, {'L', "100100100100111"},
+        {'M', "101111111101101"}, {'N', "110101101101101"}, {'O', "010101101101010"}, {'P', "110101110100100"},
+        {'Q', "010101101110011"}, {'R', "110101110101101"}, {'S', "011100010001110"}, {'T', "111010010010010"},
+        {'U', "101101101101111"}, {'V', "101101101101010"}, {'W', "101101111111101"}, {'X', "101101010101101"},
+        {'Y', "101101010010010"}, {'Z', "111001010100111"},
+        {'.', "000000000000010"}, {':', "000010000010000"}, {'-', "000000111000000"}, {'/', "001001010100100"},
+        {'_', "000000000000111"}
+    };
+
+    const uint32_t kSolid = 0x7FFF;
+    const float kScale = 3.0f;              // font pixel size
+    const float kCharAdvance = 4.0f * kScale;
+    const float kLineHeight = 7.0f * kScale;
+    const float kFrameBudgetMs = 1000.0f / 60.0f;
+    const float kBarWidth = 300.0f;
+
+    uint32_t rgba(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+        return uint32_t(r) | (uint32_t(g) << 8) | (uint32_t(b) << 16) | (uint32_t(a) << 24);
+    }
+}
+
+ProfilerOverlay::ProfilerOverlay(const char* vertPath, const char* fragPath)
+    : VAO(0), VBO(0), capacity(0), initialized(false) {
+    for (auto& g : glyphs) g = 0;
+    for (const auto& g : kFont) {
+        uint32_t bits = 0;
+        for (int i = 0; i < 15; ++i) {
+            if (g.rows[i] == '1') bits |= 1u << i;
+        }
+        glyphs[static_cast<unsigned char>(g.c)] = bits;
+    }
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Quad), (void*)offsetof(Quad, x));
+    glEnableVertexAttribArray(0);
+    glVertexAttribDivisor(0, 1);
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Quad), (void*)offsetof(Quad, color));
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, sizeof(Quad), (void*)offsetof(Quad, glyph));
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+    glBindVertexArray(0);
+
+    quads.reserve(1024);
+
+    try {
+        shader = std::make_unique<Shader>(vertPath, fragPath);
+        initialized = true;
+        std::cout << "Profiler overlay shader compilation successful" << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cout << "Failed to create profiler overlay shader: " << e.what() << std::endl;
+    }
+}
+
+void ProfilerOverlay::addRect(float x, float y, float w, float h, uint32_t color) {
+    quads.push_back({ x, y, w, h, color, kSolid });
+}
+
+void ProfilerOverlay::addText(float x, float y, const char* text, uint32_t color) {
+    for (; *text; ++text, x += kCharAdvance) {
+        unsigned char c = static_cast<unsigned char>(toupper(static_cast<unsigned char>(*text)));
+        uint32_t glyph = c < 128 ? glyphs[c] : 0;
+        if (glyph) quads.push_back({ x, y, 3.0f * kScale, 5.0f * kScale, color, glyph });
+    }
+}
+
+void ProfilerOverlay::Render(const Profiler& profiler, int screenWidth, int screenHeight) {
+    if (!initialized) return;
+
+    const auto& passes = profiler.GetPassTimings();
+    const uint32_t white = rgba(230, 230, 230, 255);
+    const uint32_t cpuColor = rgba(90, 160, 255, 220);
+    const uint32_t gpuColor = rgba(255, 140, 60, 220);
+    char line[64];
+
+    quads.clear();
+    float x = 10.0f, y = 10.0f;
+    float panelHeight = kLineHeight * (passes.size() + 1) + 10.0f;
+    addRect(x - 6.0f, y - 6.0f, 45.0f * kCharAdvance + kBarWidth, panelHeight, rgba(0, 0, 0, 160));
+
+    snprintf(line, sizeof(line), "FRAME %6.2f MS", profiler.GetFrameMs());
+    addText(x, y, line, white);
+    y += kLineHeight;
+
+    for (const auto& pass : passes) {
+        if (pass.gpuMs >= 0.0)
+            snprintf(line, sizeof(line), "%-16.16s C %6.2f G %6.2f", pass.name, pass.cpuMs, pass.gpuMs);
+        else
+            snprintf(line, sizeof(line), "%-16.16s C %6.2f G    -", pass.name, pass.cpuMs);
+        addText(x, y, line, white);
+
+        // two thin bars, full width = one 60 Hz frame
+        float barX = x + 36.0f * kCharAdvance;
+        float cpuWidth = static_cast<float>(pass.cpuMs) / kFrameBudgetMs * kBarWidth;
+        addRect(barX, y, std::min(cpuWidth, kBarWidth), 2.0f * kScale, cpuColor);
+        if (pass.gpuMs >= 0.0) {
+            float gpuWidth = static_cast<float>(pass.gpuMs) / kFrameBudgetMs * kBarWidth;
+            addRect(barX, y + 3.0f * kScale, std::min(gpuWidth, kBarWidth), 2.0f * kScale, gpuColor);
+        }
+        y += kLineHeight;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    if (quads.size() > capacity) {
+        capacity = quads.capacity();
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(Quad), nullptr, GL_STREAM_DRAW);
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, 0, quads.size() * sizeof(Quad), quads.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    shader->use();
+    shader->setVec2("screenSize", static_cast<float>(screenWidth), static_cast<float>(screenHeight));
+    glBindVertexArray(VAO);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(quads.size()));
+    glBindVertexArray(0);
+
+    glDisable(GL_BLEND);
+    if (depthTest) glEnable(GL_DEPTH_TEST);
+}
+
+ProfilerOverlay::~ProfilerOverlay() {
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+}
@@ -0,0 +1,282 @@
+#include "headers/RadialSolver.hpp"
+#include "headers/Float4.hpp"
+#include "headers/WorkerPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace {
+    const char kCacheMagic[8] = { 'A', 'T', 'O', 'M', 'R', 'A', 'D', '\0' };
+
+    struct CacheHeader {
+        char magic[8];          // "ATOMRAD\0"
+        uint32_t version;       // RadialSolver::kVersion of the model that wrote it
+        uint32_t elementCount;
+        uint32_t recordSize;    // sizeof(ElementShells)
+        uint32_t reserved;
+    };
+
+    // Madelung order: by n + l, then by n
+    const int kFillOrder[kSubshellCount][2] = {
+        {1, 0}, {2, 0}, {2, 1}, {3, 0}, {3, 1}, {4, 0}, {3, 2}, {4, 1}, {5, 0}, {4, 2},
+        {5, 1}, {6, 0}, {4, 3}, {5, 2}, {6, 1}, {7, 0}, {5, 3}, {6, 2}, {7, 1}
+    };
+
+    // r = e^x from 1e-5 bohr, well inside the 1s of any element, to 80 bohr, well past
+    // any valence tail
+    const int kGridPoints = 1024;
+    const double kGridStart = -11.5;
+    const double kGridEnd = 4.4;
+    const double kStep = (kGridEnd - kGridStart) / (kGridPoints - 1);
+    // halvings of a bracket up to Z^2/2 hartree wide, to about 1e-6 of it
+    const int kBisections = 36;
+    // Numerov is stable while h^2 g / 12 is small. Past that the solution is deep in the
+    // forbidden region, so the integration stops there as if at a wall
+    const float kStopFactor = 0.25f;
+
+    // Charge the electron sees at r in Green, Sellin and Zachor's independent-particle
+    // model: Z at the nucleus, screened down to the +1 of the ion the electron leaves
+    // behind. d (bohr) sets the core's size; 0.9 binds 3d and 4f about where Hartree-Fock
+    // puts them, where Thomas-Fermi screening leaves them almost free
+    const double kScreeningLength = 0.9;
+
+    double effectiveCharge(int Z, double r) {
+        if (Z == 1) return 1.0;
+        double H = kScreeningLength * pow(Z - 1.0, 0.4);
+        return 1.0 + (Z - 1.0) / (H * (exp(r / kScreeningLength) - 1.0) + 1.0);
+    }
+
+    // With u(r) = sqrt(r) y(x) and r = e^x the radial equation becomes y'' = g y,
+    // g = 2 r^2 (V - E) + (l + 1/2)^2. The grid holds the E-independent parts of it.
+    struct Grid {
+        double r[kGridPoints];
+        double twoR2V[kGridPoints];  // 2 r^2 V
+        double twoR2[kGridPoints];   // 2 r^2
+        float twoR2Vf[kGridPoints];
+        float twoR2f[kGridPoints];
+    };
+
+    void buildGrid(int Z, Grid& grid) {
+        for (int i = 0; i < kGridPoints; ++i) {
+            double r = exp(kGridStart + i * kStep);
+            grid.r[i] = r;
+            grid.twoR2V[i] = -2.0 * r * effectiveCharge(Z, r);
+            grid.twoR2[i] = 2.0 * r * r;
+            grid.twoR2Vf[i] = float(grid.twoR2V[i]);
+            grid.twoR2f[i] = float(grid.twoR2[i]);
+        }
+    }
+
+    // Bisects the energies of up to four subshells at once, one per lane
+    void bisectEnergies(int Z, const Grid& grid, const Subshell* batch, int lanes, float* energies) {
+        float lo[4], hi[4], centrifugal[4], nodes[4], growth[4];
+        for (int j = 0; j < 4; ++j) {
+            const Subshell& s = batch[std::min(j, lanes - 1)];  // spare lanes repeat the last
+            float n2 = float(s.n * s.n);
+            lo[j] = -float(Z * Z) / (2.0f * n2);
+            hi[j] = -1.0f / (2.0f * n2);
+            centrifugal[j] = (s.l + 0.5f) * (s.l + 0.5f);
+            nodes[j] = float(s.n - s.l - 1) + 0.5f;
+            growth[j] = float(exp(kStep * (s.l + 0.5)));  // y ~ r^(l + 1/2) near the nucleus
+        }
+        F4 lo4 = F4::load(lo), hi4 = F4::load(hi);
+        const F4 l4 = F4::load(centrifugal), wanted = F4::load(nodes), y1 = F4::load(growth);
+        const F4 h12 = F4(float(kStep * kStep / 12.0)), stop(kStopFactor);
+        const F4 zero(0.0f), one(1.0f), ten(10.0f), twelve(12.0f), huge(1e30f), shrink(1e-15f);
+
+        for (int it = 0; it < kBisections; ++it) {
+            F4 E = (lo4 + hi4) * F4(0.5f);
+            F4 yPrev = one, y = y1, count = zero;
+            F4 fPrev = one - h12 * (F4(grid.twoR2Vf[0]) - E * F4(grid.twoR2f[0]) + l4);
+            F4 f = one - h12 * (F4(grid.twoR2Vf[1]) - E * F4(grid.twoR2f[1]) + l4);
+            int active = 15;
+            for (int i = 1; i + 1 < kGridPoints && active; ++i) {
+                F4 hg = h12 * (F4(grid.twoR2Vf[i + 1]) - E * F4(grid.twoR2f[i + 1]) + l4);
+                active &= lt(hg, stop);
+                F4 fNext = one - hg;
+                F4 yNext = ((twelve - ten * f) * y - fPrev * yPrev) / fNext;
+                count = count + select(active & lt(yNext * y, zero), zero, one);
+                // only the sign matters here, keep growing solutions in range
+                int big = gt(yNext * yNext, huge);
+                yPrev = select(big, y, y * shrink);
+                y = select(big, yNext, yNext * shrink);
+                fPrev = f;
+                f = fNext;
+            }
+            // a node too many: E is above the eigenvalue
+            int above = gt(count, wanted);
+            hi4 = select(above, hi4, E);
+            lo4 = select(above, E, lo4);
+        }
+        ((lo4 + hi4) * F4(0.5f)).store(lo);
+        for (int j = 0; j < lanes; ++j) energies[j] = lo[j];
+    }
+
+    // <r> of the solution at E, cut where its tail stops decaying
+    float meanRadius(const Grid& grid, int l, double E) {
+        const double h12 = kStep * kStep / 12.0;
+        const double centrifugal = (l + 0.5) * (l + 0.5);
+        double g[kGridPoints];
+        int end = kGridPoints;
+        for (int i = 0; i < kGridPoints; ++i) {
+            g[i] = grid.twoR2V[i] - E * grid.twoR2[i] + centrifugal;
+            if (h12 * g[i] >= kStopFactor) { end = i; break; }
+        }
+        int turning = end - 1;  // outermost classical turning point
+        while (turning > 0 && g[turning] > 0.0) turning--;
+
+        // u^2 dr = r^2 y^2 dx and r u^2 dr = r^3 y^2 dx
+        double yPrev = 1.0, y = exp(kStep * (l + 0.5));
+        double norm = grid.r[0] * grid.r[0] + grid.r[1] * grid.r[1] * y * y;
+        double moment = grid.r[0] * grid.r[0] * grid.r[0] + grid.r[1] * grid.r[1] * grid.r[1] * y * y;
+        double lastU = sqrt(grid.r[1]) * fabs(y);
+        for (int i = 1; i + 1 < end; ++i) {
+            double yNext = ((12.0 - 10.0 * (1.0 - h12 * g[i])) * y - (1.0 - h12 * g[i - 1]) * yPrev)
+                / (1.0 - h12 * g[i + 1]);
+            double r = grid.r[i + 1];
+            double u = sqrt(r) * fabs(yNext);
+            if (i + 1 > turning && u > lastU) break;
+            norm += r * r * yNext * yNext;
+            moment += r * r * r * yNext * yNext;
+            if (yNext * yNext > 1e200) {
+                yNext *= 1e-100;
+                y *= 1e-100;
+                norm *= 1e-200;
+                moment *= 1e-200;
+                u *= 1e-100;
+            }
+            lastU = u;
+            yPrev = y;
+            y = yNext;
+        }
+        return float(moment / norm);
+    }
+}
+
+RadialSolver::RadialSolver() : lastMs(0.0), fromCache(false), threadCount(1) {}
+
+void RadialSolver::Configure(int atomicNumber, ElementShells& out) {
+    memset(&out, 0, sizeof(out));
+    int remaining = atomicNumber;
+    for (int i = 0; i < kSubshellCount && remaining > 0; ++i) {
+        Subshell& s = out.subshells[out.count++];
+        s.n = kFillOrder[i][0];
+        s.l = kFillOrder[i][1];
+        s.electrons = std::min(2 * (2 * s.l + 1), remaining);
+        remaining -= s.electrons;
+    }
+}
+
+void RadialSolver::SolveElement(int atomicNumber, ElementShells& out) {
+    Configure(atomicNumber, out);
+    Grid grid;
+    buildGrid(atomicNumber, grid);
+    for (int first = 0; first < out.count; first += 4) {
+        int lanes = std::min(4, out.count - first);
+        float energies[4];
+        bisectEnergies(atomicNumber, grid, out.subshells + first, lanes, energies);
+        for (int j = 0; j < lanes; ++j) {
+            Subshell& s = out.subshells[first + j];
+            s.energy = energies[j];
+            s.meanRadius = meanRadius(grid, s.l, energies[j]);
+        }
+    }
+}
+
+void RadialSolver::Solve(const std::string& cachePath, int threads) {
+    auto start = std::chrono::steady_clock::now();
+    fromCache = !cachePath.empty() && load(cachePath);
+    if (!fromCache) {
+        table.assign(kElementCount, ElementShells());
+        WorkerPool pool(threads);
+        threadCount = pool.GetThreadCount();
+        // heaviest first, they have the most subshells
+        pool.Run(kElementCount, [this](int job) {
+            int atomicNumber = kElementCount - job;
+            SolveElement(atomicNumber, table[atomicNumber - 1]);
+        });
+        if (!cachePath.empty()) save(cachePath);
+    }
+    lastMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::string RadialSolver::DefaultCachePath() {
+#ifdef _WIN32
+    const char* base = getenv("LOCALAPPDATA");
+    if (!base || !*base) return "";
+    std::string directory = std::string(base) + "\\Atomic-Structure";
+#else
+    std::string directory;
+    const char* xdgCache = getenv("XDG_CACHE_HOME");
+    const char* home = getenv("HOME");
+    if (xdgCache && *xdgCache) directory = xdgCache;
+    else if (home && *home) directory = std::string(home) + "/.cache";
+    else return "";
+    directory += "/atomic-structure";
+#endif
+    // every level, like mkdir -p; the ones that exist just fail
+    for (size_t at = directory.find_first_of("/\\", 1); ; at = directory.find_first_of("/\\", at + 1)) {
+        std::string level = directory.substr(0, at);
+#ifdef _WIN32
+        _mkdir(level.c_str());
+#else
+        mkdir(level.c_str(), 0755);
+#endif
+        if (at == std::string::npos) break;
+    }
+    return directory + "/shells.cache";
+}
+
+bool RadialSolver::load(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return false;  // not written yet
+    CacheHeader header;
+    std::vector<ElementShells> loaded(kElementCount);
+    bool ok = fread(&header, sizeof(header), 1, file) == 1
+        && !memcmp(header.magic, kCacheMagic, sizeof(kCacheMagic))
+        && header.elementCount == uint32_t(kElementCount)
+        && header.recordSize == sizeof(ElementShells);
+    if (ok && header.version != kVersion) {
+        fclose(file);
+        return false;  // an older model, solve again
+    }
+    ok = ok && fread(loaded.data(), sizeof(ElementShells), loaded.size(), file) == loaded.size();
+    fclose(file);
+    for (size_t i = 0; ok && i < loaded.size(); ++i) {
+        ok = loaded[i].count > 0 && loaded[i].count <= kSubshellCount;
+    }
+    if (!ok) {
+        std::cout << "ERROR::RADIAL_SOLVER::BAD_CACHE " << path << std::endl;
+        return false;
+    }
+    table.swap(loaded);
+    return true;
+}
+
+bool RadialSolver::save(const std::string& path) const {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cout << "ERROR::RADIAL_SOLVER::CANNOT_WRITE " << path << std::endl;
+        return false;
+    }
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kCacheMagic, sizeof(kCacheMagic));
+    header.version = kVersion;
+    header.elementCount = kElementCount;
+    header.recordSize = sizeof(ElementShells);
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+        && fwrite(table.data(), sizeof(ElementShells), table.size(), file) == table.size();
+    ok = fclose(file) == 0 && ok;
+    if (!ok) std::cout << "ERROR::RADIAL_SOLVER::CANNOT_WRITE " << path << std::endl;
+    return ok;
+}
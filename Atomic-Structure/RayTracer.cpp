@@ -0,0 +1,768 @@
+#include "headers/RayTracer.hpp"
+#include "headers/Float4.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+namespace {
+    const float kEpsilon = 1e-4f;
+    const float kPi = 3.14159265f;
+    const uint32_t kNoHit = 0xFFFFFFFFu;
+    const uint32_t kGroundHit = 0xFFFFFFFEu;
+
+    inline float dot3(const float a[3], const float b[3]) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+    inline void normalize3(float v[3]) {
+        float len = sqrtf(dot3(v, v));
+        if (len > 0.0f) {
+            v[0] /= len; v[1] /= len; v[2] /= len;
+        }
+    }
+
+    inline void cross3(const float a[3], const float b[3], float out[3]) {
+        out[0] = a[1] * b[2] - a[2] * b[1];
+        out[1] = a[2] * b[0] - a[0] * b[2];
+        out[2] = a[0] * b[1] - a[1] * b[0];
+    }
+
+    // cheap integer hash, good enough to decorrelate pixels and samples
+    inline uint32_t hash32(uint32_t x) {
+        x ^= x >> 16; x *= 0x7feb352du;
+        x ^= x >> 15; x *= 0x846ca68bu;
+        x ^= x >> 16;
+        return x;
+    }
+
+    inline float toUnit(uint32_t x) { return (x >> 8) * (1.0f / 16777216.0f); }
+
+    inline float gammaEncode(float linear) {
+        return powf(std::min(std::max(linear, 0.0f), 1.0f), 1.0f / 2.2f);
+    }
+
+    inline uint8_t encodeDisplay(float c) {
+        return static_cast<uint8_t>(std::min(std::max(c, 0.0f), 1.0f) * 255.0f + 0.5f);
+    }
+
+    // ray vs capsule (segment a-b swept by r), returns -1 on a miss
+    float intersectCapsule(const float ro[3], const float rd[3], const float a[3], const float b[3], float r) {
+        float ba[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+        float oa[3] = { ro[0] - a[0], ro[1] - a[1], ro[2] - a[2] };
+        float baba = dot3(ba, ba), bard = dot3(ba, rd), baoa = dot3(ba, oa);
+        float rdoa = dot3(rd, oa), oaoa = dot3(oa, oa);
+        float qa = baba - bard * bard;
+        float qb = baba * rdoa - baoa * bard;
+        float qc = baba * oaoa - baoa * baoa - r * r * baba;
+        float h = qb * qb - qa * qc;
+        if (h >= 0.0f && qa > 1e-12f) {
+            float t = (-qb - sqrtf(h)) / qa;
+            float y = baoa + t * bard;
+            if (y > 0.0f && y < baba) return t;
+            // end caps
+            float oc[3] = { oa[0], oa[1], oa[2] };
+            if (y >= baba) {
+                oc[0] = ro[0] - b[0]; oc[1] = ro[1] - b[1]; oc[2] = ro[2] - b[2];
+            }
+            float cb = dot3(rd, oc), cc = dot3(oc, oc) - r * r;
+            float ch = cb * cb - cc;
+            if (ch > 0.0f) return -cb - sqrtf(ch);
+        }
+        return -1.0f;
+    }
+}
+
+struct RayTracer::Packet {
+    F4 ox, oy, oz;
+    F4 dx, dy, dz;
+    F4 ix, iy, iz; // 1 / direction for the slab tests
+    F4 tMax;
+    int active;
+
+    void finish() {
+        ix = F4(1.0f) / dx;
+        iy = F4(1.0f) / dy;
+        iz = F4(1.0f) / dz;
+    }
+};
+
+struct RayTracer::PacketHit {
+    F4 t;
+    uint32_t prim[4];
+};
+
+RayTracer::RayTracer(int width, int height, int threads)
+    : width(0), height(0), target(nullptr), targetRowBytes(0), tanX(1.0f), tanY(1.0f), lighting(true), hasGround(false),
+    groundHeight(0.0f), groundHalfSize(0.0f), pickID(0), pool(threads) {
+    settings.samplesPerPixel = 4;
+    settings.aoSamples = 8;
+    settings.aoRadius = 1.0f;
+    settings.ambient = 0.25f;
+    settings.lineRadius = 0.004f;
+    settings.shadows = true;
+
+    for (int i = 0; i < 3; ++i) {
+        eye[i] = right[i] = up[i] = forward[i] = 0.0f;
+        clearColor[i] = groundColor[i] = 0.0f;
+    }
+    const float defaultLight[3] = { 2.0f, 5.0f, 2.0f };
+    SetLight(defaultLight, true);
+    Resize(width, height);
+}
+
+void RayTracer::Resize(int width, int height) {
+    this->width = std::max(width, 1);
+    this->height = std::max(height, 1);
+    pixels.assign(size_t(this->width) * this->height * 4, 0);
+    SetTarget(nullptr, 0);
+}
+
+bool RayTracer::SetTarget(uint8_t* memory, size_t rowBytes) {
+    bool fits = !memory || rowBytes >= size_t(width) * 4;
+    target = fits && memory ? memory : pixels.data();
+    targetRowBytes = fits && memory ? rowBytes : size_t(width) * 4;
+    return fits;
+}
+
+void RayTracer::BeginFrame(const RenderCamera& camera, const float clear[3]) {
+    primitives.clear();
+    hasGround = false;
+    pickID = 0;
+    scratch.Reset();
+
+    for (int i = 0; i < 3; ++i) {
+        eye[i] = camera.eye[i];
+        forward[i] = camera.target[i] - camera.eye[i];
+        clearColor[i] = clear[i];
+    }
+    normalize3(forward);
+    cross3(forward, camera.up, right);
+    normalize3(right);
+    cross3(right, forward, up);
+
+    tanY = tanf(camera.fovY * 0.5f * kPi / 180.0f);
+    tanX = tanY * width / height;
+}
+
+void RayTracer::SetLight(const float position[3], bool viewSpace) {
+    const float white[3] = { 1.0f, 1.0f, 1.0f };
+    lights.clear();
+    AddLight(position, white, viewSpace);
+}
+
+void RayTracer::AddLight(const float position[3], const float color[3], bool viewSpace) {
+    Light light;
+    for (int i = 0; i < 3; ++i) {
+        light.position[i] = position[i];
+        light.color[i] = color[i];
+    }
+    light.viewSpace = viewSpace;
+    lights.push_back(light);
+}
+
+void RayTracer::SetLighting(bool enabled) {
+    lighting = enabled;
+}
+
+void RayTracer::DrawSphere(const float center[3], float radius, const float color[3]) {
+    Primitive p;
+    for (int i = 0; i < 3; ++i) {
+        p.a[i] = p.b[i] = center[i];
+        p.color[i] = color[i];
+    }
+    p.radius = radius;
+    p.pickID = pickID;
+    p.line = false;
+    primitives.push_back(p);
+}
+
+void RayTracer::DrawLine(const float a[3], const float b[3], const float color[3]) {
+    Primitive p;
+    for (int i = 0; i < 3; ++i) {
+        p.a[i] = a[i];
+        p.b[i] = b[i];
+        p.color[i] = color[i];
+    }
+    p.radius = settings.lineRadius;
+    p.pickID = pickID;
+    p.line = true;
+    primitives.push_back(p);
+}
+
+void RayTracer::DrawGround(float height, float halfSize, const float color[3]) {
+    hasGround = true;
+    groundHeight = height;
+    groundHalfSize = halfSize;
+    for (int i = 0; i < 3; ++i) groundColor[i] = color[i];
+}
+
+void RayTracer::primitiveBounds(const Primitive& p, float bmin[3], float bmax[3]) const {
+    for (int i = 0; i < 3; ++i) {
+        bmin[i] = std::min(p.a[i], p.b[i]) - p.radius;
+        bmax[i] = std::max(p.a[i], p.b[i]) + p.radius;
+    }
+}
+
+void RayTracer::updateBounds(Node& node) {
+    for (int i = 0; i < 3; ++i) {
+        node.bmin[i] = 1e30f;
+        node.bmax[i] = -1e30f;
+    }
+    for (uint32_t i = 0; i < node.count; ++i) {
+        float bmin[3], bmax[3];
+        primitiveBounds(primitives[primitiveIndex[node.leftFirst + i]], bmin, bmax);
+        for (int k = 0; k < 3; ++k) {
+            node.bmin[k] = std::min(node.bmin[k], bmin[k]);
+            node.bmax[k] = std::max(node.bmax[k], bmax[k]);
+        }
+    }
+}
+
+void RayTracer::buildBVH() {
+    nodes.clear();
+    primitiveIndex.resize(primitives.size());
+    if (primitives.empty()) return;
+
+    float* centroids = scratch.AllocateArray<float>(primitives.size() * 3);
+    for (size_t i = 0; i < primitives.size(); ++i) {
+        primitiveIndex[i] = static_cast<uint32_t>(i);
+        for (int k = 0; k < 3; ++k) centroids[i * 3 + k] = 0.5f * (primitives[i].a[k] + primitives[i].b[k]);
+    }
+
+    nodes.reserve(primitives.size() * 2);
+    Node root;
+    root.leftFirst = 0;
+    root.count = static_cast<uint32_t>(primitives.size());
+    nodes.push_back(root);
+    updateBounds(nodes[0]);
+    subdivide(0, centroids, 0);
+
+    // leaves end up contiguous, store primitives in that order to drop the indirection
+    orderedPrimitives.resize(primitives.size());
+    for (size_t i = 0; i < primitives.size(); ++i) orderedPrimitives[i] = primitives[primitiveIndex[i]];
+    primitives.swap(orderedPrimitives);
+}
+
+void RayTracer::subdivide(uint32_t nodeIndex, const float* centroids, int depth) {
+    if (nodes[nodeIndex].count <= kLeafSize || depth >= kMaxDepth) return;
+    const uint32_t first = nodes[nodeIndex].leftFirst;
+    const uint32_t count = nodes[nodeIndex].count;
+
+    // binned SAH over the centroid bounds
+    const int kBins = 12;
+    float bestCost = 1e30f;
+    int bestAxis = -1;
+    float bestSplit = 0.0f;
+
+    for (int axis = 0; axis < 3; ++axis) {
+        float cmin = 1e30f, cmax = -1e30f;
+        for (uint32_t i = 0; i < count; ++i) {
+            float c = centroids[primitiveIndex[first + i] * 3 + axis];
+            cmin = std::min(cmin, c);
+            cmax = std::max(cmax, c);
+        }
+        if (cmax - cmin < 1e-6f) continue;
+
+        struct Bin { float bmin[3], bmax[3]; uint32_t count; } bins[kBins];
+        for (auto& bin : bins) {
+            for (int k = 0; k < 3; ++k) { bin.bmin[k] = 1e30f; bin.bmax[k] = -1e30f; }
+            bin.count = 0;
+        }
+        float scale = kBins / (cmax - cmin);
+        for (uint32_t i = 0; i < count; ++i) {
+            uint32_t p = primitiveIndex[first + i];
+            int b = std::min(static_cast<int>((centroids[p * 3 + axis] - cmin) * scale), kBins - 1);
+            float bmin[3], bmax[3];
+            primitiveBounds(primitives[p], bmin, bmax);
+            for (int k = 0; k < 3; ++k) {
+                bins[b].bmin[k] = std::min(bins[b].bmin[k], bmin[k]);
+                bins[b].bmax[k] = std::max(bins[b].bmax[k], bmax[k]);
+            }
+            bins[b].count++;
+        }
+
+        // sweep from both sides to get the area and count left/right of every plane
+        auto area = [](const float bmin[3], const float bmax[3]) {
+            float e[3] = { bmax[0] - bmin[0], bmax[1] - bmin[1], bmax[2] - bmin[2] };
+            return e[0] * e[1] + e[1] * e[2] + e[2] * e[0];
+        };
+        float leftArea[kBins - 1], rightArea[kBins - 1];
+        uint32_t leftCount[kBins - 1], rightCount[kBins - 1];
+        float lmin[3] = { 1e30f, 1e30f, 1e30f }, lmax[3] = { -1e30f, -1e30f, -1e30f };
+        float rmin[3] = { 1e30f, 1e30f, 1e30f }, rmax[3] = { -1e30f, -1e30f, -1e30f };
+        uint32_t lsum = 0, rsum = 0;
+        for (int i = 0; i < kBins - 1; ++i) {
+            lsum += bins[i].count;
+            rsum += bins[kBins - 1 - i].count;
+            for (int k = 0; k < 3; ++k) {
+                lmin[k] = std::min(lmin[k], bins[i].bmin[k]);
+                lmax[k] = std::max(lmax[k], bins[i].bmax[k]);
+                rmin[k] = std::min(rmin[k], bins[kBins - 1 - i].bmin[k]);
+                rmax[k] = std::max(rmax[k], bins[kBins - 1 - i].bmax[k]);
+            }
+            leftCount[i] = lsum;
+            leftArea[i] = lsum ? area(lmin, lmax) : 0.0f;
+            rightCount[kBins - 2 - i] = rsum;
+            rightArea[kBins - 2 - i] = rsum ? area(rmin, rmax) : 0.0f;
+        }
+        for (int i = 0; i < kBins - 1; ++i) {
+            float cost = leftCount[i] * leftArea[i] + rightCount[i] * rightArea[i];
+            if (leftCount[i] && rightCount[i] && cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = cmin + (i + 1) / scale;
+            }
+        }
+    }
+
+    const Node& node = nodes[nodeIndex];
+    float parentCost = count * ((node.bmax[0] - node.bmin[0]) * (node.bmax[1] - node.bmin[1]) +
+        (node.bmax[1] - node.bmin[1]) * (node.bmax[2] - node.bmin[2]) +
+        (node.bmax[2] - node.bmin[2]) * (node.bmax[0] - node.bmin[0]));
+    if (bestAxis < 0 || bestCost >= parentCost) return;
+
+    uint32_t* begin = &primitiveIndex[first];
+    uint32_t* middle = std::partition(begin, begin + count, [&](uint32_t p) {
+        return centroids[p * 3 + bestAxis] < bestSplit;
+    });
+    uint32_t leftCount = static_cast<uint32_t>(middle - begin);
+    if (leftCount == 0 || leftCount == count) return;
+
+    uint32_t leftIndex = static_cast<uint32_t>(nodes.size());
+    Node left, right;
+    left.leftFirst = first;
+    left.count = leftCount;
+    right.leftFirst = first + leftCount;
+    right.count = count - leftCount;
+    nodes.push_back(left);
+    nodes.push_back(right);
+    updateBounds(nodes[leftIndex]);
+    updateBounds(nodes[leftIndex + 1]);
+
+    nodes[nodeIndex].leftFirst = leftIndex;
+    nodes[nodeIndex].count = 0;
+    subdivide(leftIndex, centroids, depth + 1);
+    subdivide(leftIndex + 1, centroids, depth + 1);
+}
+
+namespace {
+    // 4 rays vs one box, returns the lanes that enter it before tMax
+    template <typename PacketT>
+    inline int slabTest(const float bmin[3], const float bmax[3], const PacketT& p, F4 tMax, F4& tEnter) {
+        F4 t1 = (F4(bmin[0]) - p.ox) * p.ix, t2 = (F4(bmax[0]) - p.ox) * p.ix;
+        F4 tmin = min4(t1, t2), tmax = max4(t1, t2);
+        t1 = (F4(bmin[1]) - p.oy) * p.iy; t2 = (F4(bmax[1]) - p.oy) * p.iy;
+        tmin = max4(tmin, min4(t1, t2)); tmax = min4(tmax, max4(t1, t2));
+        t1 = (F4(bmin[2]) - p.oz) * p.iz; t2 = (F4(bmax[2]) - p.oz) * p.iz;
+        tmin = max4(tmin, min4(t1, t2)); tmax = min4(tmax, max4(t1, t2));
+        tmin = max4(tmin, 0.0f);
+        tEnter = tmin;
+        return ge(min4(tmax, tMax), tmin) & p.active;
+    }
+
+    inline float laneMin(F4 v, int mask) {
+        float m = 1e30f;
+        for (int i = 0; i < 4; ++i) {
+            if (mask & (1 << i)) m = std::min(m, v[i]);
+        }
+        return m;
+    }
+}
+
+void RayTracer::intersectLeaf(const Node& node, const Packet& p, int mask, PacketHit& hit) const {
+    for (uint32_t i = 0; i < node.count; ++i) {
+        uint32_t index = node.leftFirst + i;
+        const Primitive& prim = primitives[index];
+        if (!prim.line) {
+            // |o + t d - c| = r with |d| = 1
+            F4 ocx = p.ox - prim.a[0], ocy = p.oy - prim.a[1], ocz = p.oz - prim.a[2];
+            F4 b = ocx * p.dx + ocy * p.dy + ocz * p.dz;
+            F4 c = ocx * ocx + ocy * ocy + ocz * ocz - prim.radius * prim.radius;
+            F4 disc = b * b - c;
+            int m = mask & ge(disc, 0.0f);
+            if (!m) continue;
+            F4 t = F4(0.0f) - b - sqrt4(max4(disc, 0.0f));
+            m &= gt(t, kEpsilon) & lt(t, hit.t);
+            if (!m) continue;
+            hit.t = select(m, hit.t, t);
+            for (int lane = 0; lane < 4; ++lane) {
+                if (m & (1 << lane)) hit.prim[lane] = index;
+            }
+        }
+        else {
+            float t[4];
+            hit.t.store(t);
+            bool changed = false;
+            for (int lane = 0; lane < 4; ++lane) {
+                if (!(mask & (1 << lane))) continue;
+                float ro[3] = { p.ox[lane], p.oy[lane], p.oz[lane] };
+                float rd[3] = { p.dx[lane], p.dy[lane], p.dz[lane] };
+                float tc = intersectCapsule(ro, rd, prim.a, prim.b, prim.radius);
+                if (tc > kEpsilon && tc < t[lane]) {
+                    t[lane] = tc;
+                    hit.prim[lane] = index;
+                    changed = true;
+                }
+            }
+            if (changed) hit.t = F4::load(t);
+        }
+    }
+}
+
+void RayTracer::intersect(const Packet& p, PacketHit& hit) const {
+    if (nodes.empty()) return;
+
+    uint32_t stack[kStackSize];
+    int top = 0;
+    F4 tEnter;
+    if (!slabTest(nodes[0].bmin, nodes[0].bmax, p, hit.t, tEnter)) return;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+        // a closer hit may have been found since this node was pushed
+        int mask = slabTest(node.bmin, node.bmax, p, hit.t, tEnter);
+        if (!mask) continue;
+
+        if (node.count > 0) {
+            intersectLeaf(node, p, mask, hit);
+            continue;
+        }
+
+        F4 enterLeft, enterRight;
+        int left = slabTest(nodes[node.leftFirst].bmin, nodes[node.leftFirst].bmax, p, hit.t, enterLeft);
+        int right = slabTest(nodes[node.leftFirst + 1].bmin, nodes[node.leftFirst + 1].bmax, p, hit.t, enterRight);
+        if (left && right) {
+            // nearer child on top so it is visited first
+            bool leftFirst = laneMin(enterLeft, left) <= laneMin(enterRight, right);
+            stack[top++] = leftFirst ? node.leftFirst + 1 : node.leftFirst;
+            stack[top++] = leftFirst ? node.leftFirst : node.leftFirst + 1;
+        }
+        else if (left) stack[top++] = node.leftFirst;
+        else if (right) stack[top++] = node.leftFirst + 1;
+    }
+}
+
+int RayTracer::occluded(const Packet& p) const {
+    if (nodes.empty() || !p.active) return 0;
+
+    int blocked = 0;
+    uint32_t stack[kStackSize];
+    int top = 0;
+    stack[top++] = 0;
+    F4 tEnter;
+
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+        int mask = slabTest(node.bmin, node.bmax, p, p.tMax, tEnter) & ~blocked;
+        if (!mask) continue;
+
+        if (node.count == 0) {
+            stack[top++] = node.leftFirst;
+            stack[top++] = node.leftFirst + 1;
+            continue;
+        }
+
+        for (uint32_t i = 0; i < node.count && mask; ++i) {
+            const Primitive& prim = primitives[node.leftFirst + i];
+            if (prim.line) continue; // orbit lines are annotations, they cast no shadow
+            F4 ocx = p.ox - prim.a[0], ocy = p.oy - prim.a[1], ocz = p.oz - prim.a[2];
+            F4 b = ocx * p.dx + ocy * p.dy + ocz * p.dz;
+            F4 c = ocx * ocx + ocy * ocy + ocz * ocz - prim.radius * prim.radius;
+            F4 disc = b * b - c;
+            F4 t = F4(0.0f) - b - sqrt4(max4(disc, 0.0f));
+            int m = mask & ge(disc, 0.0f) & gt(t, kEpsilon) & lt(t, p.tMax);
+            blocked |= m;
+            mask &= ~m;
+        }
+        if (blocked == p.active) break;
+    }
+    return blocked;
+}
+
+void RayTracer::EndFrame() {
+    // view-space lights follow the camera, like a fixed-function light under an identity modelview
+    for (auto& light : lights) {
+        for (int i = 0; i < 3; ++i) {
+            light.world[i] = light.viewSpace
+                ? eye[i] + right[i] * light.position[0] + up[i] * light.position[1] - forward[i] * light.position[2]
+                : light.position[i];
+        }
+    }
+
+    buildBVH();
+
+    int tilesX = (width + kTileSize - 1) / kTileSize;
+    int tilesY = (height + kTileSize - 1) / kTileSize;
+    pool.Run(tilesX * tilesY, [this](int tile) { traceTile(tile); });
+}
+
+uint32_t RayTracer::Pick(float x, float y) const {
+    float ndcX = 2.0f * x / width - 1.0f;
+    float ndcY = 1.0f - 2.0f * y / height;
+    float d[3];
+    for (int k = 0; k < 3; ++k) d[k] = forward[k] + right[k] * ndcX * tanX + up[k] * ndcY * tanY;
+    normalize3(d);
+
+    // the same ray in every lane
+    Packet p;
+    p.ox = eye[0]; p.oy = eye[1]; p.oz = eye[2];
+    p.dx = d[0]; p.dy = d[1]; p.dz = d[2];
+    p.finish();
+    p.tMax = 1e30f;
+    p.active = 1;
+
+    PacketHit hit;
+    hit.t = 1e30f;
+    for (auto& id : hit.prim) id = kNoHit;
+    intersect(p, hit);
+    if (hit.prim[0] == kNoHit) return 0;
+
+    // the ground has no ID but hides what is under it
+    if (hasGround && fabsf(d[1]) > 1e-8f) {
+        float tg = (groundHeight - eye[1]) / d[1];
+        float gx = eye[0] + d[0] * tg, gz = eye[2] + d[2] * tg;
+        float t[4];
+        hit.t.store(t);
+        if (tg > kEpsilon && tg < t[0] && fabsf(gx) <= groundHalfSize && fabsf(gz) <= groundHalfSize) return 0;
+    }
+    return primitives[hit.prim[0]].pickID;
+}
+
+void RayTracer::traceTile(int tile) {
+    int tilesX = (width + kTileSize - 1) / kTileSize;
+    int x0 = (tile % tilesX) * kTileSize;
+    int y0 = (tile / tilesX) * kTileSize;
+    int x1 = std::min(x0 + kTileSize, width);
+    int y1 = std::min(y0 + kTileSize, height);
+    int samples = std::max(settings.samplesPerPixel, 1);
+
+    // 2x2 pixel quads, one packet per quad and sample
+    for (int y = y0; y < y1; y += 2) {
+        for (int x = x0; x < x1; x += 2) {
+            int px[4] = { x, x + 1, x, x + 1 };
+            int py[4] = { y, y, y + 1, y + 1 };
+            int active = 0;
+            uint32_t seed[4];
+            for (int lane = 0; lane < 4; ++lane) {
+                if (px[lane] < x1 && py[lane] < y1) active |= 1 << lane;
+                seed[lane] = hash32(uint32_t(py[lane]) * 9781u + uint32_t(px[lane]) * 6271u + 1u);
+            }
+
+            float accum[4][3] = {};
+            for (int s = 0; s < samples; ++s) {
+                Packet p;
+                float dx[4], dy[4], dz[4];
+                for (int lane = 0; lane < 4; ++lane) {
+                    // R2 sequence shifted per pixel; a single sample stays on the centre
+                    float jx = 0.5f, jy = 0.5f;
+                    if (samples > 1) {
+                        jx = fmodf(toUnit(seed[lane]) + s * 0.7548776662f, 1.0f);
+                        jy = fmodf(toUnit(hash32(seed[lane])) + s * 0.5698402910f, 1.0f);
+                    }
+                    float ndcX = 2.0f * (px[lane] + jx) / width - 1.0f;
+                    float ndcY = 1.0f - 2.0f * (py[lane] + jy) / height;
+                    float d[3];
+                    for (int k = 0; k < 3; ++k) d[k] = forward[k] + right[k] * ndcX * tanX + up[k] * ndcY * tanY;
+                    normalize3(d);
+                    dx[lane] = d[0]; dy[lane] = d[1]; dz[lane] = d[2];
+                }
+                p.ox = eye[0]; p.oy = eye[1]; p.oz = eye[2];
+                p.dx = F4::load(dx); p.dy = F4::load(dy); p.dz = F4::load(dz);
+                p.finish();
+                p.tMax = 1e30f;
+                p.active = active;
+
+                PacketHit hit;
+                hit.t = 1e30f;
+                for (auto& id : hit.prim) id = kNoHit;
+                intersect(p, hit);
+
+                // the ground is a single analytic square, tested outside the BVH
+                if (hasGround) {
+                    float t[4];
+                    hit.t.store(t);
+                    for (int lane = 0; lane < 4; ++lane) {
+                        if (fabsf(dy[lane]) < 1e-8f) continue;
+                        float tg = (groundHeight - eye[1]) / dy[lane];
+                        if (tg <= kEpsilon || tg >= t[lane]) continue;
+                        float gx = eye[0] + dx[lane] * tg, gz = eye[2] + dz[lane] * tg;
+                        if (fabsf(gx) > groundHalfSize || fabsf(gz) > groundHalfSize) continue;
+                        t[lane] = tg;
+                        hit.prim[lane] = kGroundHit;
+                    }
+                    hit.t = F4::load(t);
+                }
+
+                float color[4][3];
+                shadePacket(p, hit, seed, static_cast<uint32_t>(s), color);
+                for (int lane = 0; lane < 4; ++lane) {
+                    for (int k = 0; k < 3; ++k) accum[lane][k] += color[lane][k];
+                }
+            }
+
+            for (int lane = 0; lane < 4; ++lane) {
+                if (!(active & (1 << lane))) continue;
+                uint8_t* out = target + size_t(py[lane]) * targetRowBytes + size_t(px[lane]) * 4;
+                for (int k = 0; k < 3; ++k) out[k] = encodeDisplay(accum[lane][k] / samples);
+                out[3] = 255;
+            }
+        }
+    }
+}
+
+void RayTracer::shadePacket(const Packet& p, const PacketHit& hit, uint32_t seed[4], uint32_t sample, float out[4][3]) const {
+    float pos[4][3], normal[4][3], base[4][3];
+    int lit = 0;
+
+    for (int lane = 0; lane < 4; ++lane) {
+        uint32_t id = hit.prim[lane];
+        if (!(p.active & (1 << lane)) || id == kNoHit) {
+            for (int k = 0; k < 3; ++k) out[lane][k] = clearColor[k];
+            continue;
+        }
+
+        float t = hit.t[lane];
+        float d[3] = { p.dx[lane], p.dy[lane], p.dz[lane] };
+        for (int k = 0; k < 3; ++k) pos[lane][k] = eye[k] + d[k] * t;
+
+        if (id == kGroundHit) {
+            normal[lane][0] = 0.0f; normal[lane][1] = eye[1] > groundHeight ? 1.0f : -1.0f; normal[lane][2] = 0.0f;
+            for (int k = 0; k < 3; ++k) base[lane][k] = groundColor[k];
+        }
+        else {
+            const Primitive& prim = primitives[id];
+            if (prim.line || !lighting) {
+                // flat colour, already a display value
+                for (int k = 0; k < 3; ++k) out[lane][k] = prim.color[k];
+                continue;
+            }
+            for (int k = 0; k < 3; ++k) {
+                normal[lane][k] = (pos[lane][k] - prim.a[k]) / prim.radius;
+                base[lane][k] = prim.color[k];
+            }
+        }
+        lit |= 1 << lane;
+    }
+    if (!lit) return;
+
+    float linear[4][3] = {};
+
+    // direct light, one shadow packet per light
+    for (const auto& light : lights) {
+        float lx[4], ly[4], lz[4], dist[4], ndotl[4];
+        float ox[4], oy[4], oz[4];
+        int facing = 0;
+        for (int lane = 0; lane < 4; ++lane) {
+            lx[lane] = ly[lane] = 0.0f; lz[lane] = 1.0f; dist[lane] = 0.0f; ndotl[lane] = 0.0f;
+            ox[lane] = oy[lane] = oz[lane] = 0.0f;
+            if (!(lit & (1 << lane))) continue;
+            float l[3] = { light.world[0] - pos[lane][0], light.world[1] - pos[lane][1], light.world[2] - pos[lane][2] };
+            dist[lane] = sqrtf(dot3(l, l));
+            normalize3(l);
+            ndotl[lane] = dot3(normal[lane], l);
+            if (ndotl[lane] <= 0.0f) continue;
+            facing |= 1 << lane;
+            lx[lane] = l[0]; ly[lane] = l[1]; lz[lane] = l[2];
+            ox[lane] = pos[lane][0] + normal[lane][0] * kEpsilon * 10.0f;
+            oy[lane] = pos[lane][1] + normal[lane][1] * kEpsilon * 10.0f;
+            oz[lane] = pos[lane][2] + normal[lane][2] * kEpsilon * 10.0f;
+        }
+        if (!facing) continue;
+
+        int visible = facing;
+        if (settings.shadows) {
+            Packet shadow;
+            shadow.ox = F4::load(ox); shadow.oy = F4::load(oy); shadow.oz = F4::load(oz);
+            shadow.dx = F4::load(lx); shadow.dy = F4::load(ly); shadow.dz = F4::load(lz);
+            shadow.finish();
+            shadow.tMax = F4::load(dist);
+            shadow.active = facing;
+            visible &= ~occluded(shadow);
+        }
+
+        for (int lane = 0; lane < 4; ++lane) {
+            if (!(visible & (1 << lane))) continue;
+            // Lambert plus a soft Blinn highlight
+            float v[3] = { -p.dx[lane], -p.dy[lane], -p.dz[lane] };
+            float h[3] = { lx[lane] + v[0], ly[lane] + v[1], lz[lane] + v[2] };
+            normalize3(h);
+            float spec = 0.25f * powf(std::max(dot3(normal[lane], h), 0.0f), 48.0f);
+            for (int k = 0; k < 3; ++k) {
+                linear[lane][k] += (base[lane][k] * ndotl[lane] + spec) * light.color[k];
+            }
+        }
+    }
+
+    // ambient occlusion, cosine-weighted hemisphere, one packet per AO sample
+    float ambient[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    if (settings.aoSamples > 0) {
+        int unoccluded[4] = { 0, 0, 0, 0 };
+        for (int a = 0; a < settings.aoSamples; ++a) {
+            float ox[4], oy[4], oz[4], dx[4], dy[4], dz[4];
+            for (int lane = 0; lane < 4; ++lane) {
+                ox[lane] = oy[lane] = oz[lane] = dx[lane] = dy[lane] = 0.0f; dz[lane] = 1.0f;
+                if (!(lit & (1 << lane))) continue;
+                const float* n = normal[lane];
+                // orthonormal basis around n (Duff et al.)
+                float sign = n[2] >= 0.0f ? 1.0f : -1.0f;
+                float q = -1.0f / (sign + n[2]);
+                float w = n[0] * n[1] * q;
+                float t1[3] = { 1.0f + sign * n[0] * n[0] * q, sign * w, -sign * n[0] };
+                float t2[3] = { w, sign + n[1] * n[1] * q, -n[1] };
+
+                uint32_t h = hash32(seed[lane] ^ (sample * 0x9E3779B9u) ^ (uint32_t(a) * 0x85EBCA6Bu));
+                float u1 = toUnit(h), u2 = toUnit(hash32(h));
+                float r = sqrtf(u1), phi = 2.0f * kPi * u2;
+                float lx = r * cosf(phi), ly = r * sinf(phi), lz = sqrtf(std::max(1.0f - u1, 0.0f));
+                dx[lane] = t1[0] * lx + t2[0] * ly + n[0] * lz;
+                dy[lane] = t1[1] * lx + t2[1] * ly + n[1] * lz;
+                dz[lane] = t1[2] * lx + t2[2] * ly + n[2] * lz;
+                ox[lane] = pos[lane][0] + n[0] * kEpsilon * 10.0f;
+                oy[lane] = pos[lane][1] + n[1] * kEpsilon * 10.0f;
+                oz[lane] = pos[lane][2] + n[2] * kEpsilon * 10.0f;
+            }
+            Packet ao;
+            ao.ox = F4::load(ox); ao.oy = F4::load(oy); ao.oz = F4::load(oz);
+            ao.dx = F4::load(dx); ao.dy = F4::load(dy); ao.dz = F4::load(dz);
+            ao.finish();
+            ao.tMax = settings.aoRadius;
+            ao.active = lit;
+            int blocked = occluded(ao);
+            for (int lane = 0; lane < 4; ++lane) {
+                if (!(blocked & (1 << lane))) unoccluded[lane]++;
+            }
+        }
+        for (int lane = 0; lane < 4; ++lane) ambient[lane] = float(unoccluded[lane]) / settings.aoSamples;
+    }
+
+    for (int lane = 0; lane < 4; ++lane) {
+        if (!(lit & (1 << lane))) continue;
+        for (int k = 0; k < 3; ++k) {
+            float c = linear[lane][k] + base[lane][k] * settings.ambient * ambient[lane];
+            // gamma encode here so the tile loop can average display values for every pixel kind
+            out[lane][k] = gammaEncode(c);
+        }
+    }
+}
+
+bool RayTracer::WritePPM(const std::string& path) const {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cout << "ERROR::RAY_TRACER::CANNOT_WRITE " << path << std::endl;
+        return false;
+    }
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    std::vector<uint8_t> row(size_t(width) * 3);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* src = target + size_t(y) * targetRowBytes;
+        for (int x = 0; x < width; ++x) {
+            row[x * 3 + 0] = src[x * 4 + 0];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 2];
+        }
+        fwrite(row.data(), 1, row.size(), file);
+    }
+    bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
@@ -0,0 +1,215 @@
+#include "headers/SceneFile.hpp"
+#include "headers/Elements.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const char kSceneMagic[8] = { 'A', 'T', 'O', 'M', 'S', 'C', 'N', '\0' };
+    const float kIdentity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+    uint64_t alignUp(uint64_t offset) {
+        return (offset + 15) & ~uint64_t(15);
+    }
+
+    // array of count * stride bytes at offset lies inside the file and is aligned
+    bool arrayFits(uint64_t offset, uint64_t count, uint64_t stride, uint64_t fileSize) {
+        if (offset % 16 != 0 || offset < sizeof(SceneFileHeader) || offset > fileSize) return false;
+        return count <= (fileSize - offset) / stride;
+    }
+}
+
+//======================================================================================
+// SceneData
+//======================================================================================
+SceneData::SceneData() : periodic(false) {
+    memcpy(transform, kIdentity, sizeof(transform));
+    memset(cell, 0, sizeof(cell));
+}
+
+void SceneData::AddAtom(int atomicNumber, float x, float y, float z, float radius) {
+    if (radius <= 0.0f) radius = 0.5f * GetElement(atomicNumber).covalentRadius;
+    atoms.push_back({ { x, y, z }, radius });
+    elements.push_back(static_cast<uint16_t>(atomicNumber));
+}
+
+void SceneData::Clear() {
+    atoms.clear();
+    elements.clear();
+    colors.clear();
+}
+
+SceneView SceneData::GetView() const {
+    SceneView view;
+    view.atoms = atoms.data();
+    view.elements = elements.data();
+    view.colors = colors.size() == atoms.size() && !colors.empty() ? colors.data() : nullptr;
+    view.atomCount = atoms.size();
+    view.transform = transform;
+    view.cell = periodic ? cell : nullptr;
+    return view;
+}
+
+//======================================================================================
+// SceneFile
+//======================================================================================
+SceneFile::SceneFile()
+    : header(nullptr), base(nullptr), mappedSize(0),
+#ifdef _WIN32
+    fileHandle(nullptr), mappingHandle(nullptr)
+#else
+    fd(-1)
+#endif
+{}
+
+SceneFile::~SceneFile() {
+    Close();
+}
+
+bool SceneFile::Open(const std::string& path) {
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cout << "ERROR::SCENE_FILE::CANNOT_OPEN " << path << std::endl;
+        return false;
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(file, &size);
+    fileHandle = file;
+    mappedSize = static_cast<size_t>(size.QuadPart);
+    if (mappedSize >= sizeof(SceneFileHeader)) {
+        mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mappingHandle) base = static_cast<const uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    }
+#else
+    fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cout << "ERROR::SCENE_FILE::CANNOT_OPEN " << path << std::endl;
+        return false;
+    }
+    struct stat info;
+    fstat(fd, &info);
+    mappedSize = static_cast<size_t>(info.st_size);
+    if (mappedSize >= sizeof(SceneFileHeader)) {
+        void* mapped = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) base = static_cast<const uint8_t*>(mapped);
+    }
+#endif
+    if (!base) {
+        std::cout << (mappedSize < sizeof(SceneFileHeader) ? "ERROR::SCENE_FILE::NOT_A_SCENE " : "ERROR::SCENE_FILE::CANNOT_MAP ")
+            << path << std::endl;
+        Close();
+        return false;
+    }
+
+    const SceneFileHeader* candidate = reinterpret_cast<const SceneFileHeader*>(base);
+    const char* problem = nullptr;
+    if (memcmp(candidate->magic, kSceneMagic, sizeof(kSceneMagic)) != 0) problem = "NOT_A_SCENE";
+    else if (candidate->version != kVersion) problem = "UNSUPPORTED_VERSION";
+    else if (candidate->fileSize != mappedSize) problem = "TRUNCATED";
+    else if (!arrayFits(candidate->atomsOffset, candidate->atomCount, sizeof(SceneAtom), mappedSize) ||
+        !arrayFits(candidate->elementsOffset, candidate->atomCount, sizeof(uint16_t), mappedSize) ||
+        ((candidate->flags & SCENE_HAS_COLORS) &&
+            !arrayFits(candidate->colorsOffset, candidate->atomCount, sizeof(uint32_t), mappedSize))) {
+        problem = "BAD_ARRAY_BOUNDS";
+    }
+    if (problem) {
+        std::cout << "ERROR::SCENE_FILE::" << problem << " " << path << std::endl;
+        Close();
+        return false;
+    }
+
+    header = candidate;
+    return true;
+}
+
+void SceneFile::Close() {
+#ifdef _WIN32
+    if (base) UnmapViewOfFile(base);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle) CloseHandle(fileHandle);
+    fileHandle = mappingHandle = nullptr;
+#else
+    if (base) munmap(const_cast<uint8_t*>(base), mappedSize);
+    if (fd >= 0) close(fd);
+    fd = -1;
+#endif
+    header = nullptr;
+    base = nullptr;
+    mappedSize = 0;
+}
+
+SceneView SceneFile::GetView() const {
+    SceneView view = {};
+    if (!header) return view;
+    view.atoms = reinterpret_cast<const SceneAtom*>(base + header->atomsOffset);
+    view.elements = reinterpret_cast<const uint16_t*>(base + header->elementsOffset);
+    view.colors = (header->flags & SCENE_HAS_COLORS) ? reinterpret_cast<const uint32_t*>(base + header->colorsOffset) : nullptr;
+    view.atomCount = size_t(header->atomCount);
+    view.transform = header->transform;
+    view.cell = (header->flags & SCENE_PERIODIC) ? header->cell : nullptr;
+    return view;
+}
+
+bool SceneFile::Write(const std::string& path, const SceneView& scene) {
+    SceneFileHeader out;
+    memset(&out, 0, sizeof(out));
+    memcpy(out.magic, kSceneMagic, sizeof(kSceneMagic));
+    out.version = kVersion;
+    out.flags = (scene.colors ? uint32_t(SCENE_HAS_COLORS) : 0u) | (scene.cell ? uint32_t(SCENE_PERIODIC) : 0u);
+    out.atomCount = scene.atomCount;
+    out.atomsOffset = sizeof(SceneFileHeader);
+    out.elementsOffset = alignUp(out.atomsOffset + scene.atomCount * sizeof(SceneAtom));
+    uint64_t end = alignUp(out.elementsOffset + scene.atomCount * sizeof(uint16_t));
+    if (scene.colors) {
+        out.colorsOffset = end;
+        end = alignUp(out.colorsOffset + scene.atomCount * sizeof(uint32_t));
+    }
+    out.fileSize = end;
+    memcpy(out.transform, scene.transform ? scene.transform : kIdentity, sizeof(out.transform));
+    if (scene.cell) memcpy(out.cell, scene.cell, sizeof(out.cell));
+
+    for (int i = 0; i < 3; ++i) {
+        out.boundsMin[i] = scene.atomCount ? FLT_MAX : 0.0f;
+        out.boundsMax[i] = scene.atomCount ? -FLT_MAX : 0.0f;
+    }
+    for (size_t a = 0; a < scene.atomCount; ++a) {
+        const SceneAtom& atom = scene.atoms[a];
+        for (int i = 0; i < 3; ++i) {
+            out.boundsMin[i] = std::min(out.boundsMin[i], atom.position[i] - atom.radius);
+            out.boundsMax[i] = std::max(out.boundsMax[i], atom.position[i] + atom.radius);
+        }
+    }
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cout << "ERROR::SCENE_FILE::CANNOT_WRITE " << path << std::endl;
+        return false;
+    }
+    static const uint8_t padding[16] = {};
+    auto writeArray = [&](const void* data, uint64_t bytes) {
+        fwrite(data, 1, size_t(bytes), file);
+        fwrite(padding, 1, size_t(alignUp(bytes) - bytes), file);
+    };
+    fwrite(&out, sizeof(out), 1, file);
+    writeArray(scene.atoms, scene.atomCount * sizeof(SceneAtom));
+    writeArray(scene.elements, scene.atomCount * sizeof(uint16_t));
+    if (scene.colors) writeArray(scene.colors, scene.atomCount * sizeof(uint32_t));
+    bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
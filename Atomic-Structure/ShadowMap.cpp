@@ -0,0 +1,218 @@
+#include "headers/ShadowMap.hpp"
+#include "headers/sphere.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+ShadowMap::ShadowMap(int resolution, int cascadeCount, float shadowDistance, const char* vertPath, const char* fragPath)
+    : resolution(resolution), dynamicResolution(std::max(resolution / 2, 256)),
+    cascadeCount(std::min(std::max(cascadeCount, 1), kMaxCascades)), shadowDistance(shadowDistance),
+    staticFBO(0), dynamicFBO(0), staticDepth(0), dynamicDepth(0),
+    staticCasterBuffer(0), dynamicCasterBuffer(0), staticCapacity(0), dynamicCapacity(0),
+    staticRenders(0), initialized(false) {
+    for (auto& c : cascades) {
+        c.valid = false;
+        c.dirty = true;
+    }
+    SetLightDirection(glm::vec3(-2.0f, -5.0f, -2.0f));
+
+    staticDepth = createDepthArray(resolution);
+    dynamicDepth = createDepthArray(dynamicResolution);
+
+    glGenFramebuffers(1, &staticFBO);
+    glGenFramebuffers(1, &dynamicFBO);
+    for (GLuint fbo : { staticFBO, dynamicFBO }) {
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glGenBuffers(1, &staticCasterBuffer);
+    glGenBuffers(1, &dynamicCasterBuffer);
+
+    try {
+        depthShader = std::make_unique<Shader>(vertPath, fragPath);
+        initialized = true;
+        std::cout << "Shadow depth shader compilation successful" << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cout << "Failed to create shadow depth shader: " << e.what() << std::endl;
+    }
+}
+
+GLuint ShadowMap::createDepthArray(int size) {
+    GLuint tex;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, tex);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_DEPTH_COMPONENT32F, size, size, cascadeCount);
+    // hardware 2x2 PCF on top of the 3x3 taps in the shader
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    // outside the map counts as lit
+    const float border[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, border);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    return tex;
+}
+
+void ShadowMap::SetLightDirection(const glm::vec3& direction) {
+    lightDirection = glm::normalize(direction);
+    glm::vec3 up = fabsf(lightDirection.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    // fixed orientation, only the ortho window moves, which keeps texel snapping stable
+    lightView = glm::lookAt(glm::vec3(0.0f), lightDirection, up);
+    for (auto& c : cascades) {
+        c.valid = false;
+        c.dirty = true;
+    }
+}
+
+void ShadowMap::SetStaticCasters(const std::vector<glm::vec4>& casters) {
+    staticCasters = casters;
+    uploadCasters(staticCasterBuffer, staticCasters, staticCapacity);
+    for (auto& c : cascades) c.dirty = true;
+}
+
+void ShadowMap::SetDynamicCasters(const std::vector<glm::vec4>& casters) {
+    dynamicCasters = casters;
+    uploadCasters(dynamicCasterBuffer, dynamicCasters, dynamicCapacity);
+}
+
+void ShadowMap::uploadCasters(GLuint buffer, const std::vector<glm::vec4>& casters, size_t& capacity) {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    if (casters.size() > capacity || capacity == 0) {
+        capacity = std::max<size_t>(casters.size() * 2, 64);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, capacity * sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
+    }
+    if (!casters.empty()) {
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, casters.size() * sizeof(glm::vec4), casters.data());
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void ShadowMap::Update(const glm::mat4& view, float fovY, float aspect, float nearPlane, Sphere& casterMesh) {
+    if (!initialized) return;
+
+    glm::mat4 inverseView = glm::inverse(view);
+    float tanY = tanf(fovY * 0.5f);
+    float tanX = tanY * aspect;
+    float sliceStart = nearPlane;
+
+    for (int i = 0; i < cascadeCount; ++i) {
+        Cascade& c = cascades[i];
+
+        // practical split scheme: blend of logarithmic and uniform splits
+        float p = float(i + 1) / cascadeCount;
+        float logSplit = nearPlane * powf(shadowDistance / nearPlane, p);
+        float uniformSplit = nearPlane + (shadowDistance - nearPlane) * p;
+        float sliceEnd = 0.75f * logSplit + 0.25f * uniformSplit;
+        c.end = sliceEnd;
+
+        // bounding sphere of the slice, rotation invariant so turning the camera does not resize it
+        float mid = 0.5f * (sliceStart + sliceEnd);
+        glm::vec3 farCorner(tanX * sliceEnd, tanY * sliceEnd, -sliceEnd);
+        glm::vec3 nearCorner(tanX * sliceStart, tanY * sliceStart, -sliceStart);
+        glm::vec3 center(0.0f, 0.0f, -mid);
+        float sliceRadius = std::max(glm::length(farCorner - center), glm::length(nearCorner - center));
+        sliceStart = sliceEnd;
+
+        glm::vec3 lightCenter = glm::vec3(lightView * inverseView * glm::vec4(center, 1.0f));
+
+        // re-place the cascade only when the slice leaves it or its size no longer fits
+        float wanted = sliceRadius * 1.25f;
+        float drift = glm::length(glm::vec2(lightCenter.x - c.center.x, lightCenter.y - c.center.y));
+        bool refit = !c.valid || drift + sliceRadius > c.radius || wanted < c.radius * 0.7f;
+        if (refit) {
+            c.radius = wanted;
+            float texel = 2.0f * c.radius / resolution;
+            c.center = glm::vec3(floorf(lightCenter.x / texel) * texel, floorf(lightCenter.y / texel) * texel, lightCenter.z);
+
+            // depth range is generous so casters between the light and the slice are kept
+            float zMargin = c.radius + shadowDistance;
+            glm::mat4 projection = glm::ortho(c.center.x - c.radius, c.center.x + c.radius,
+                c.center.y - c.radius, c.center.y + c.radius,
+                -(c.center.z + zMargin), -(c.center.z - zMargin));
+            c.lightSpace = projection * lightView;
+            c.valid = true;
+            c.dirty = true;
+        }
+    }
+
+    GLint previousFBO;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFBO);
+    GLint previousViewport[4];
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+    GLboolean depthTestWasEnabled = glIsEnabled(GL_DEPTH_TEST);
+    GLboolean cullFaceWasEnabled = glIsEnabled(GL_CULL_FACE);
+    GLint previousCullFace;
+    glGetIntegerv(GL_CULL_FACE_MODE, &previousCullFace);
+
+    // render back faces with a slope-scaled offset, the usual fix for acne on spheres
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_FRONT);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(2.0f, 4.0f);
+    depthShader->use();
+
+    for (int i = 0; i < cascadeCount; ++i) {
+        if (cascades[i].dirty) {
+            renderLayer(staticFBO, staticDepth, resolution, staticCasterBuffer, staticCasters.size(), i, casterMesh);
+            cascades[i].dirty = false;
+            staticRenders++;
+        }
+        renderLayer(dynamicFBO, dynamicDepth, dynamicResolution, dynamicCasterBuffer, dynamicCasters.size(), i, casterMesh);
+    }
+
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glCullFace(GLenum(previousCullFace));
+    if (!cullFaceWasEnabled) glDisable(GL_CULL_FACE);
+    if (!depthTestWasEnabled) glDisable(GL_DEPTH_TEST);
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFBO);
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+}
+
+void ShadowMap::renderLayer(GLuint fbo, GLuint depthArray, int size, GLuint casterBuffer, size_t casterCount,
+    int cascade, Sphere& casterMesh) {
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthArray, 0, cascade);
+    glViewport(0, 0, size, size);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    if (casterCount == 0) return;
+
+    depthShader->setMat4("lightSpace", cascades[cascade].lightSpace);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, casterBuffer);
+    casterMesh.DrawInstanced(static_cast<GLsizei>(casterCount));
+}
+
+void ShadowMap::Apply(const Shader& shader, int firstTextureUnit) const {
+    shader.use();
+    shader.setBool("shadowsEnabled", initialized);
+    shader.setInt("staticShadowMap", firstTextureUnit);
+    shader.setInt("dynamicShadowMap", firstTextureUnit + 1);
+    shader.setInt("cascadeCount", cascadeCount);
+    for (int i = 0; i < cascadeCount; ++i) {
+        shader.setMat4("lightSpace[" + std::to_string(i) + "]", cascades[i].lightSpace);
+        shader.setFloat("cascadeEnd[" + std::to_string(i) + "]", cascades[i].end);
+    }
+
+    glActiveTexture(GL_TEXTURE0 + firstTextureUnit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, staticDepth);
+    glActiveTexture(GL_TEXTURE0 + firstTextureUnit + 1);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, dynamicDepth);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+ShadowMap::~ShadowMap() {
+    glDeleteFramebuffers(1, &staticFBO);
+    glDeleteFramebuffers(1, &dynamicFBO);
+    GLuint textures[2] = { staticDepth, dynamicDepth };
+    glDeleteTextures(2, textures);
+    GLuint buffers[2] = { staticCasterBuffer, dynamicCasterBuffer };
+    glDeleteBuffers(2, buffers);
+}
@@ -0,0 +1,449 @@
+#include "headers/SoftwareRasterizer.hpp"
+#include "headers/Float4.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    const float kAmbient = 0.06f; // GL default global ambient 0.2 * material ambient 0.3
+    const uint32_t kSphereBit = 0x80000000u;
+
+    inline float dot3(const float a[3], const float b[3]) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+    inline void normalize3(float v[3]) {
+        float len = sqrtf(dot3(v, v));
+        if (len > 0.0f) {
+            v[0] /= len; v[1] /= len; v[2] /= len;
+        }
+    }
+
+    inline void cross3(const float a[3], const float b[3], float out[3]) {
+        out[0] = a[1] * b[2] - a[2] * b[1];
+        out[1] = a[2] * b[0] - a[0] * b[2];
+        out[2] = a[0] * b[1] - a[1] * b[0];
+    }
+
+    inline uint32_t packColor(float r, float g, float b) {
+        auto channel = [](float c) { return static_cast<uint32_t>(std::min(std::max(c, 0.0f), 1.0f) * 255.0f + 0.5f); };
+        return channel(r) | (channel(g) << 8) | (channel(b) << 16) | 0xFF000000u;
+    }
+}
+
+SoftwareRasterizer::SoftwareRasterizer(int width, int height, int threads)
+    : width(0), height(0), stride(0), tilesX(0), tilesY(0), target(nullptr), targetRowBytes(0),
+    tanX(1.0f), tanY(1.0f), nearPlane(0.1f), clearValue(0xFF000000u), lightInViewSpace(true), lighting(true), pool(threads) {
+    const float defaultLight[3] = { 2.0f, 5.0f, 2.0f };
+    SetLight(defaultLight, true);
+    Resize(width, height);
+}
+
+void SoftwareRasterizer::Resize(int width, int height) {
+    this->width = std::max(width, 1);
+    this->height = std::max(height, 1);
+    stride = (this->width + 3) & ~3;
+    tilesX = (this->width + kTileSize - 1) / kTileSize;
+    tilesY = (this->height + kTileSize - 1) / kTileSize;
+
+    color.assign(size_t(stride) * this->height, clearValue);
+    depth.assign(size_t(stride) * this->height, 0.0f);
+    pixels.assign(size_t(this->width) * this->height * 4, 0);
+    binStart.assign(size_t(tilesX) * tilesY + 1, 0);
+    binFill.assign(size_t(tilesX) * tilesY, 0);
+    SetTarget(nullptr, 0);
+}
+
+bool SoftwareRasterizer::SetTarget(uint8_t* memory, size_t rowBytes) {
+    bool fits = !memory || rowBytes >= size_t(width) * 4;
+    target = fits && memory ? memory : pixels.data();
+    targetRowBytes = fits && memory ? rowBytes : size_t(width) * 4;
+    return fits;
+}
+
+void SoftwareRasterizer::BeginFrame(const RenderCamera& camera, const float clearColor[3]) {
+    spheres.clear();
+    triangles.clear();
+    submitted.clear();
+    clearValue = packColor(clearColor[0], clearColor[1], clearColor[2]);
+
+    // same basis as gluLookAt
+    float forward[3] = { camera.target[0] - camera.eye[0], camera.target[1] - camera.eye[1], camera.target[2] - camera.eye[2] };
+    normalize3(forward);
+    cross3(forward, camera.up, viewRight);
+    normalize3(viewRight);
+    cross3(viewRight, forward, viewUp);
+    for (int i = 0; i < 3; ++i) {
+        viewBack[i] = -forward[i];
+        eye[i] = camera.eye[i];
+    }
+
+    tanY = tanf(camera.fovY * 0.5f * 3.14159265f / 180.0f);
+    tanX = tanY * width / height;
+    nearPlane = camera.nearPlane;
+
+    if (!lightInViewSpace) toView(lightWorld, lightPos);
+}
+
+void SoftwareRasterizer::SetLight(const float position[3], bool viewSpace) {
+    lightInViewSpace = viewSpace;
+    for (int i = 0; i < 3; ++i) {
+        lightWorld[i] = position[i];
+        lightPos[i] = position[i];
+    }
+    if (!viewSpace) toView(lightWorld, lightPos);
+}
+
+void SoftwareRasterizer::SetLighting(bool enabled) {
+    lighting = enabled;
+}
+
+void SoftwareRasterizer::toView(const float world[3], float out[3]) const {
+    float d[3] = { world[0] - eye[0], world[1] - eye[1], world[2] - eye[2] };
+    out[0] = dot3(viewRight, d);
+    out[1] = dot3(viewUp, d);
+    out[2] = dot3(viewBack, d);
+}
+
+void SoftwareRasterizer::shadeVertex(const float viewPos[3], const float normal[3], const float color[3], float out[3]) const {
+    float diffuse = 1.0f - kAmbient;
+    if (lighting) {
+        float toLight[3] = { lightPos[0] - viewPos[0], lightPos[1] - viewPos[1], lightPos[2] - viewPos[2] };
+        normalize3(toLight);
+        diffuse = std::max(dot3(normal, toLight), 0.0f);
+    }
+    for (int i = 0; i < 3; ++i) out[i] = color[i] * (kAmbient + diffuse);
+}
+
+void SoftwareRasterizer::DrawSphere(const float center[3], float radius, const float color[3]) {
+    SpherePrim s;
+    toView(center, s.center);
+    s.radius = radius;
+    for (int i = 0; i < 3; ++i) s.color[i] = color[i];
+
+    float nearZ = -(s.center[2] + radius);
+    float farZ = -(s.center[2] - radius);
+    if (farZ < nearPlane) return; // entirely behind the near plane
+
+    if (nearZ <= nearPlane) {
+        // crosses the near plane, the projection is unbounded
+        s.x0 = 0; s.y0 = 0; s.x1 = width; s.y1 = height;
+    }
+    else {
+        // conservative bounds: extremes of (x +- r) / depth over the sphere's depth range
+        float minX = 1e30f, maxX = -1e30f, minY = 1e30f, maxY = -1e30f;
+        for (float z : { nearZ, farZ }) {
+            for (float sign : { -1.0f, 1.0f }) {
+                float x = (s.center[0] + sign * radius) / (z * tanX);
+                float y = (s.center[1] + sign * radius) / (z * tanY);
+                minX = std::min(minX, x); maxX = std::max(maxX, x);
+                minY = std::min(minY, y); maxY = std::max(maxY, y);
+            }
+        }
+        s.x0 = std::max(static_cast<int>(floorf((minX + 1.0f) * 0.5f * width)), 0);
+        s.x1 = std::min(static_cast<int>(ceilf((maxX + 1.0f) * 0.5f * width)) + 1, width);
+        s.y0 = std::max(static_cast<int>(floorf((1.0f - maxY) * 0.5f * height)), 0);
+        s.y1 = std::min(static_cast<int>(ceilf((1.0f - minY) * 0.5f * height)) + 1, height);
+        if (s.x0 >= s.x1 || s.y0 >= s.y1) return;
+    }
+
+    submitted.push_back(static_cast<uint32_t>(spheres.size()) | kSphereBit);
+    spheres.push_back(s);
+}
+
+SoftwareRasterizer::ScreenVertex SoftwareRasterizer::project(const ViewVertex& v) const {
+    ScreenVertex s;
+    s.invW = 1.0f / -v.p[2];
+    s.x = (v.p[0] * s.invW / tanX + 1.0f) * 0.5f * width;
+    s.y = (1.0f - v.p[1] * s.invW / tanY) * 0.5f * height;
+    for (int i = 0; i < 3; ++i) s.color[i] = v.color[i];
+    return s;
+}
+
+void SoftwareRasterizer::DrawLine(const float a[3], const float b[3], const float color[3]) {
+    ViewVertex va, vb;
+    toView(a, va.p);
+    toView(b, vb.p);
+
+    // clip against the near plane (view space looks down -z)
+    float da = -va.p[2] - nearPlane, db = -vb.p[2] - nearPlane;
+    if (da < 0.0f && db < 0.0f) return;
+    if (da < 0.0f || db < 0.0f) {
+        float t = da / (da - db);
+        ViewVertex& behind = da < 0.0f ? va : vb;
+        for (int i = 0; i < 3; ++i) behind.p[i] = va.p[i] + (vb.p[i] - va.p[i]) * t;
+    }
+    for (int i = 0; i < 3; ++i) va.color[i] = vb.color[i] = color[i];
+
+    ScreenVertex sa = project(va), sb = project(vb);
+    float dx = sb.x - sa.x, dy = sb.y - sa.y;
+    float len = sqrtf(dx * dx + dy * dy);
+    if (len < 1e-4f) return;
+
+    // 1 px wide quad along the line
+    float nx = -dy / len * 0.5f, ny = dx / len * 0.5f;
+    ScreenVertex a0 = sa, a1 = sa, b0 = sb, b1 = sb;
+    a0.x += nx; a0.y += ny; a1.x -= nx; a1.y -= ny;
+    b0.x += nx; b0.y += ny; b1.x -= nx; b1.y -= ny;
+    addScreenTriangle(a0, b0, b1);
+    addScreenTriangle(a0, b1, a1);
+}
+
+void SoftwareRasterizer::DrawGround(float height, float halfSize, const float color[3]) {
+    // a grid rather than one quad so the Gouraud lighting from the point light holds up
+    const int cells = 16;
+    const float worldNormal[3] = { 0.0f, 1.0f, 0.0f };
+    float normal[3] = { dot3(viewRight, worldNormal), dot3(viewUp, worldNormal), dot3(viewBack, worldNormal) };
+
+    float step = 2.0f * halfSize / cells;
+    ViewVertex grid[(cells + 1) * (cells + 1)];  // about 7 KB, no heap per call
+    for (int z = 0; z <= cells; ++z) {
+        for (int x = 0; x <= cells; ++x) {
+            float world[3] = { -halfSize + x * step, height, -halfSize + z * step };
+            ViewVertex& v = grid[z * (cells + 1) + x];
+            toView(world, v.p);
+            shadeVertex(v.p, normal, color, v.color);
+        }
+    }
+
+    for (int z = 0; z < cells; ++z) {
+        for (int x = 0; x < cells; ++x) {
+            ViewVertex quad[4] = {
+                grid[z * (cells + 1) + x], grid[z * (cells + 1) + x + 1],
+                grid[(z + 1) * (cells + 1) + x + 1], grid[(z + 1) * (cells + 1) + x]
+            };
+            addClippedPolygon(quad, 4);
+        }
+    }
+}
+
+void SoftwareRasterizer::addClippedPolygon(const ViewVertex* vertices, int count) {
+    // Sutherland-Hodgman against the near plane, a quad gains at most one vertex per plane
+    ViewVertex clipped[8];
+    int n = 0;
+    for (int i = 0; i < count && n < 8; ++i) {
+        const ViewVertex& a = vertices[i];
+        const ViewVertex& b = vertices[(i + 1) % count];
+        float da = -a.p[2] - nearPlane, db = -b.p[2] - nearPlane;
+        if (da >= 0.0f) clipped[n++] = a;
+        if ((da >= 0.0f) != (db >= 0.0f) && n < 8) {
+            float t = da / (da - db);
+            ViewVertex& v = clipped[n++];
+            for (int k = 0; k < 3; ++k) {
+                v.p[k] = a.p[k] + (b.p[k] - a.p[k]) * t;
+                v.color[k] = a.color[k] + (b.color[k] - a.color[k]) * t;
+            }
+        }
+    }
+    if (n < 3) return;
+
+    ScreenVertex first = project(clipped[0]);
+    ScreenVertex previous = project(clipped[1]);
+    for (int i = 2; i < n; ++i) {
+        ScreenVertex current = project(clipped[i]);
+        addScreenTriangle(first, previous, current);
+        previous = current;
+    }
+}
+
+void SoftwareRasterizer::addScreenTriangle(const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c) {
+    float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    if (fabsf(area) < 1e-8f) return;
+
+    TrianglePrim t;
+    t.x0 = std::max(static_cast<int>(floorf(std::min({ a.x, b.x, c.x }))), 0);
+    t.y0 = std::max(static_cast<int>(floorf(std::min({ a.y, b.y, c.y }))), 0);
+    t.x1 = std::min(static_cast<int>(ceilf(std::max({ a.x, b.x, c.x }))) + 1, width);
+    t.y1 = std::min(static_cast<int>(ceilf(std::max({ a.y, b.y, c.y }))) + 1, height);
+    if (t.x0 >= t.x1 || t.y0 >= t.y1) return;
+
+    // edge i is opposite vertex i; dividing by the signed area makes both windings positive inside
+    const ScreenVertex* v[3] = { &a, &b, &c };
+    for (int i = 0; i < 3; ++i) {
+        const ScreenVertex& p = *v[(i + 1) % 3];
+        const ScreenVertex& q = *v[(i + 2) % 3];
+        float A = -(q.y - p.y), B = q.x - p.x;
+        t.edge[i][0] = A / area;
+        t.edge[i][1] = B / area;
+        t.edge[i][2] = -(A * p.x + B * p.y) / area;
+        t.invW[i] = v[i]->invW;
+        for (int k = 0; k < 3; ++k) t.colorW[i][k] = v[i]->color[k] * v[i]->invW;
+    }
+
+    submitted.push_back(static_cast<uint32_t>(triangles.size()));
+    triangles.push_back(t);
+}
+
+void SoftwareRasterizer::binPrimitives() {
+    auto tileBounds = [this](uint32_t id, int& tx0, int& ty0, int& tx1, int& ty1) {
+        int x0, y0, x1, y1;
+        if (id & kSphereBit) {
+            const SpherePrim& s = spheres[id & ~kSphereBit];
+            x0 = s.x0; y0 = s.y0; x1 = s.x1; y1 = s.y1;
+        }
+        else {
+            const TrianglePrim& t = triangles[id];
+            x0 = t.x0; y0 = t.y0; x1 = t.x1; y1 = t.y1;
+        }
+        tx0 = x0 / kTileSize; ty0 = y0 / kTileSize;
+        tx1 = (x1 - 1) / kTileSize; ty1 = (y1 - 1) / kTileSize;
+    };
+
+    // count per tile, prefix sum, scatter: no per-tile vectors to grow when an electron
+    // first enters a tile
+    std::fill(binStart.begin(), binStart.end(), 0u);
+    for (uint32_t id : submitted) {
+        int tx0, ty0, tx1, ty1;
+        tileBounds(id, tx0, ty0, tx1, ty1);
+        for (int ty = ty0; ty <= ty1; ++ty) {
+            for (int tx = tx0; tx <= tx1; ++tx) binStart[ty * tilesX + tx + 1]++;
+        }
+    }
+    for (size_t i = 1; i < binStart.size(); ++i) binStart[i] += binStart[i - 1];
+
+    size_t total = binStart.back();
+    if (total > binEntries.size()) binEntries.resize(total + total / 2);
+    std::copy(binStart.begin(), binStart.end() - 1, binFill.begin());
+    for (uint32_t id : submitted) {
+        int tx0, ty0, tx1, ty1;
+        tileBounds(id, tx0, ty0, tx1, ty1);
+        for (int ty = ty0; ty <= ty1; ++ty) {
+            for (int tx = tx0; tx <= tx1; ++tx) binEntries[binFill[ty * tilesX + tx]++] = id;
+        }
+    }
+}
+
+void SoftwareRasterizer::EndFrame() {
+    binPrimitives();
+    pool.Run(tilesX * tilesY, [this](int tile) { rasterTile(tile); });
+}
+
+void SoftwareRasterizer::rasterTile(int tile) {
+    int tx0 = (tile % tilesX) * kTileSize;
+    int ty0 = (tile / tilesX) * kTileSize;
+    int tx1 = std::min(tx0 + kTileSize, width);
+    int ty1 = std::min(ty0 + kTileSize, height);
+
+    for (int y = ty0; y < ty1; ++y) {
+        std::fill_n(&color[size_t(y) * stride + tx0], tx1 - tx0, clearValue);
+        std::fill_n(&depth[size_t(y) * stride + tx0], tx1 - tx0, 0.0f);
+    }
+
+    // bins keep submission order, so equal depths resolve the same way as in GL
+    for (uint32_t i = binStart[tile]; i < binStart[tile + 1]; ++i) {
+        uint32_t id = binEntries[i];
+        if (id & kSphereBit) rasterSphere(spheres[id & ~kSphereBit], tx0, ty0, tx1, ty1);
+        else rasterTriangle(triangles[id], tx0, ty0, tx1, ty1);
+    }
+
+    for (int y = ty0; y < ty1; ++y) {
+        memcpy(target + size_t(y) * targetRowBytes + size_t(tx0) * 4, &color[size_t(y) * stride + tx0], size_t(tx1 - tx0) * 4);
+    }
+}
+
+void SoftwareRasterizer::rasterSphere(const SpherePrim& s, int tx0, int ty0, int tx1, int ty1) {
+    int x0 = std::max(s.x0, tx0) & ~3, x1 = std::min(s.x1, tx1);
+    int y0 = std::max(s.y0, ty0), y1 = std::min(s.y1, ty1);
+
+    // the ray through pixel (px, py) is d = (px * kx + ox, dy, -1) in view space
+    const float kx = 2.0f * tanX / width, ox = -tanX;
+    const float cx = s.center[0], cy = s.center[1], cz = s.center[2];
+    const float k = cx * cx + cy * cy + cz * cz - s.radius * s.radius;
+    const float invRadius = 1.0f / s.radius;
+
+    for (int y = y0; y < y1; ++y) {
+        float dy = (1.0f - 2.0f * (y + 0.5f) / height) * tanY;
+        F4 rowA = dy * dy + 1.0f;
+        F4 rowB = dy * cy - cz;
+        float* depthRow = &depth[size_t(y) * stride];
+        uint32_t* colorRow = &color[size_t(y) * stride];
+
+        for (int x = x0; x < x1; x += 4) {
+            // |t d - c| = r  ->  a t^2 - 2 b t + k = 0 with a = d.d, b = d.c
+            F4 dx = F4::ramp((x + 0.5f) * kx + ox, kx);
+            F4 a = dx * dx + rowA;
+            F4 b = dx * cx + rowB;
+            F4 disc = b * b - a * k;
+            int mask = ge(disc, 0.0f);
+            if (!mask) continue;
+
+            F4 t = (b - sqrt4(max4(disc, 0.0f))) / a;
+            F4 invW = F4(1.0f) / t;   // d.z = -1, so w = t
+            mask &= ge(t, nearPlane) & gt(invW, F4::load(depthRow + x));
+            if (x + 4 > x1) mask &= (1 << (x1 - x)) - 1;
+
+            for (; mask; mask &= mask - 1) {
+                int lane = 0;
+                while (!(mask & (1 << lane))) lane++;
+                float tl = t[lane];
+                float hit[3] = { dx[lane] * tl, dy * tl, -tl };
+                float normal[3] = { (hit[0] - cx) * invRadius, (hit[1] - cy) * invRadius, (hit[2] - cz) * invRadius };
+                float shaded[3];
+                shadeVertex(hit, normal, s.color, shaded);
+                depthRow[x + lane] = invW[lane];
+                colorRow[x + lane] = packColor(shaded[0], shaded[1], shaded[2]);
+            }
+        }
+    }
+}
+
+void SoftwareRasterizer::rasterTriangle(const TrianglePrim& t, int tx0, int ty0, int tx1, int ty1) {
+    int x0 = std::max(t.x0, tx0) & ~3, x1 = std::min(t.x1, tx1);
+    int y0 = std::max(t.y0, ty0), y1 = std::min(t.y1, ty1);
+
+    const float (*e)[3] = t.edge;
+    for (int y = y0; y < y1; ++y) {
+        float py = y + 0.5f;
+        float* depthRow = &depth[size_t(y) * stride];
+        uint32_t* colorRow = &color[size_t(y) * stride];
+
+        for (int x = x0; x < x1; x += 4) {
+            // barycentrics straight from the edge functions, four pixels at once
+            F4 px = F4::ramp(x + 0.5f, 1.0f);
+            F4 l0 = px * e[0][0] + (e[0][1] * py + e[0][2]);
+            F4 l1 = px * e[1][0] + (e[1][1] * py + e[1][2]);
+            F4 l2 = px * e[2][0] + (e[2][1] * py + e[2][2]);
+            int mask = ge(l0, 0.0f) & ge(l1, 0.0f) & ge(l2, 0.0f);
+            if (!mask) continue;
+
+            F4 invW = l0 * t.invW[0] + l1 * t.invW[1] + l2 * t.invW[2];
+            mask &= gt(invW, F4::load(depthRow + x));
+            if (x + 4 > x1) mask &= (1 << (x1 - x)) - 1;
+
+            for (; mask; mask &= mask - 1) {
+                int lane = 0;
+                while (!(mask & (1 << lane))) lane++;
+                float w = 1.0f / invW[lane];
+                float b0 = l0[lane], b1 = l1[lane], b2 = l2[lane];
+                float c[3];
+                for (int k = 0; k < 3; ++k) {
+                    c[k] = (b0 * t.colorW[0][k] + b1 * t.colorW[1][k] + b2 * t.colorW[2][k]) * w;
+                }
+                depthRow[x + lane] = invW[lane];
+                colorRow[x + lane] = packColor(c[0], c[1], c[2]);
+            }
+        }
+    }
+}
+
+bool SoftwareRasterizer::WritePPM(const std::string& path) const {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cout << "ERROR::SOFTWARE_RASTERIZER::CANNOT_WRITE " << path << std::endl;
+        return false;
+    }
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    std::vector<uint8_t> row(size_t(width) * 3);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* src = target + size_t(y) * targetRowBytes;
+        for (int x = 0; x < width; ++x) {
+            row[x * 3 + 0] = src[x * 4 + 0];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 2];
+        }
+        fwrite(row.data(), 1, row.size(), file);
+    }
+    bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
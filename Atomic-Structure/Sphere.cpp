@@ -1,10 +1,12 @@
 ﻿#include "headers/sphere.hpp"    
+#include "headers/GLDebug.hpp"
 #include <iostream>
-#include <glm/ext/scalar_constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 
-Sphere::Sphere(float radius, int sectors, int stacks, const char* vertPath, const char* fragPath)
-    : initialized(false) {
-    createSphere(radius, sectors, stacks);
+Sphere::Sphere(float radius, int sectors, int stacks, const char* vertPath, const char* fragPath, SphereType type)
+    : radius(radius), initialized(false) {
+    EnableGLDebugOutput();
+    createSphere(sectors, stacks, type);
     setupBuffers();
 
     try {
@@ -17,56 +19,24 @@ Sphere::Sphere(float radius, int sectors, int stacks, const char* vertPath, cons
     }
 }
 
-void Sphere::createSphere(float radius, int sectors, int stacks) {
-    const float PI = glm::pi<float>();
-    vertices.clear();
+void Sphere::createSphere(int sectors, int stacks, SphereType type) {
+    SphereMesh mesh(type, sectors, stacks);
+    stats = mesh.Analyze();
+
+    vertices = mesh.GetVertices();
+    shortIndices.clear();
     indices.clear();
 
-    // Vertex generation
-    for (int i = 0; i <= stacks; ++i) {
-        float stackAngle = PI / 2 - i * (PI / stacks);
-        float xy = radius * cosf(stackAngle);
-        float z = radius * sinf(stackAngle);
-
-        for (int j = 0; j <= sectors; ++j) {
-            float sectorAngle = j * 2 * PI / sectors;
-
-            // Position
-            vertices.push_back(xy * cosf(sectorAngle)); // x
-            vertices.push_back(xy * sinf(sectorAngle)); // y
-            vertices.push_back(z);                      // z
-
-            // Normal
-            glm::vec3 normal = glm::normalize(glm::vec3(
-                vertices[vertices.size() - 3],
-                vertices[vertices.size() - 2],
-                vertices[vertices.size() - 1]
-            ));
-            vertices.push_back(normal.x);
-            vertices.push_back(normal.y);
-            vertices.push_back(normal.z);
-        }
+    // 16-bit indices whenever the welded mesh allows it, halves the index buffer
+    if (mesh.FitsShortIndices()) {
+        shortIndices.assign(mesh.GetIndices().begin(), mesh.GetIndices().end());
+        indexType = GL_UNSIGNED_SHORT;
     }
-
-    // Index generation
-    for (int i = 0; i < stacks; ++i) {
-        int k1 = i * (sectors + 1);
-        int k2 = k1 + sectors + 1;
-
-        for (int j = 0; j < sectors; ++j, ++k1, ++k2) {
-            if (i != 0) {
-                indices.push_back(k1);
-                indices.push_back(k2);
-                indices.push_back(k1 + 1);
-            }
-            if (i != (stacks - 1)) {
-                indices.push_back(k1 + 1);
-                indices.push_back(k2);
-                indices.push_back(k2 + 1);
-            }
-        }
+    else {
+        indices = mesh.GetIndices();
+        indexType = GL_UNSIGNED_INT;
     }
-    indexCount = indices.size();
+    indexCount = static_cast<unsigned int>(mesh.GetIndices().size());
 }
 
 void Sphere::setupBuffers() {
@@ -77,19 +47,18 @@ void Sphere::setupBuffers() {
     glBindVertexArray(VAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(SphereVertex), vertices.data(), GL_STATIC_DRAW);
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    if (indexType == GL_UNSIGNED_SHORT)
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(uint16_t), shortIndices.data(), GL_STATIC_DRAW);
+    else
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_STATIC_DRAW);
 
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+    // Position attribute: normalized shorts, the shader derives the normal from it
+    glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, sizeof(SphereVertex), (void*)0);
     glEnableVertexAttribArray(0);
 
-    // Normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
     glBindVertexArray(0);
 }
 
@@ -104,7 +73,7 @@ void Sphere::render(const glm::mat4& view, const glm::mat4& projection,
     shader->use();
 
     // Matrices
-    shader->setMat4("model", model);
+    shader->setMat4("model", glm::scale(model, glm::vec3(radius)));
     shader->setMat4("view", view);
     shader->setMat4("projection", projection);
 
@@ -114,13 +83,24 @@ void Sphere::render(const glm::mat4& view, const glm::mat4& projection,
     shader->setVec3("objectColor", glm::vec3(0.8f, 0.3f, 0.2f));
 
     glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES, indexCount, indexType, 0);
     glBindVertexArray(0);
 
-    GLenum error = glGetError();
-    if (error != GL_NO_ERROR) {
-        std::cout << "OpenGL error during sphere rendering: " << error << std::endl;
+#ifndef NDEBUG
+    // only without a debug context, the callback reports errors itself
+    if (!IsGLDebugOutputEnabled()) {
+        GLenum error = glGetError();
+        if (error != GL_NO_ERROR) {
+            std::cout << "OpenGL error during sphere rendering: " << error << std::endl;
+        }
     }
+#endif
+}
+
+void Sphere::DrawInstanced(GLsizei instanceCount) const {
+    glBindVertexArray(VAO);
+    glDrawElementsInstanced(GL_TRIANGLES, indexCount, indexType, 0, instanceCount);
+    glBindVertexArray(0);
 }
 
 Sphere::~Sphere() {
@@ -136,9 +116,9 @@ Sphere::~Sphere() {
 
 Sphere::Sphere(Sphere&& other) noexcept
     : VAO(other.VAO), VBO(other.VBO), EBO(other.EBO),
-    indexCount(other.indexCount),
+    indexCount(other.indexCount), indexType(other.indexType), radius(other.radius),
     shader(std::move(other.shader)),
-    initialized(other.initialized) {
+    initialized(other.initialized), stats(other.stats) {
     other.VAO = other.VBO = other.EBO = 0;
     other.initialized = false;
 }
@@ -150,6 +130,9 @@ Sphere& Sphere::operator=(Sphere&& other) noexcept {
         VBO = other.VBO;
         EBO = other.EBO;
         indexCount = other.indexCount;
+        indexType = other.indexType;
+        radius = other.radius;
+        stats = other.stats;
         shader = std::move(other.shader);
         initialized = other.initialized;
 
@@ -0,0 +1,370 @@
+#include "headers/SphereMesh.hpp"
+#include <glm/ext/scalar_constants.hpp>
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace {
+    // Forsyth "linear-speed vertex cache optimisation" scoring constants
+    const int kScoreCacheSize = 32;
+    const float kCacheDecayPower = 1.5f;
+    const float kLastTriScore = 0.75f;
+    const float kValenceBoostScale = 2.0f;
+    const float kValenceBoostPower = 0.5f;
+
+    float vertexScore(int cachePosition, int remainingTriangles) {
+        if (remainingTriangles == 0) return -1.0f; // no triangles left, never pick it again
+
+        float score = 0.0f;
+        if (cachePosition >= 0) {
+            if (cachePosition < 3) {
+                // vertices of the last triangle get a fixed score so the strip does not
+                // just keep going around the same fan
+                score = kLastTriScore;
+            }
+            else {
+                float scaler = 1.0f / (kScoreCacheSize - 3);
+                score = powf(1.0f - (cachePosition - 3) * scaler, kCacheDecayPower);
+            }
+        }
+        // boost vertices with few triangles left so they get finished off early
+        score += kValenceBoostScale * powf(static_cast<float>(remainingTriangles), -kValenceBoostPower);
+        return score;
+    }
+
+    int16_t toSnorm16(float v) {
+        v = std::min(std::max(v, -1.0f), 1.0f);
+        return static_cast<int16_t>(roundf(v * 32767.0f));
+    }
+}
+
+SphereMesh::SphereMesh(SphereType type, int sectors, int stacks) {
+    switch (type) {
+    case SphereType::Icosphere: {
+        // pick the subdivision level whose triangle count is closest below the UV sphere's
+        int target = 2 * sectors * std::max(stacks - 1, 1);
+        int level = 0;
+        while (level < 6 && 20 * (1 << (2 * (level + 1))) <= target) level++;
+        createIcosphere(level);
+        break;
+    }
+    case SphereType::CubeSphere:
+        // sectors/4 cells per face edge gives the same sample count around the equator
+        createCubeSphere(std::max(1, sectors / 4));
+        break;
+    case SphereType::UV:
+    default:
+        createUV(sectors, stacks);
+        break;
+    }
+
+    weldVertices();
+    optimizeVertexCache();
+    optimizeVertexFetch();
+}
+
+void SphereMesh::createUV(int sectors, int stacks) {
+    const float PI = glm::pi<float>();
+    positions.clear();
+    indices.clear();
+    positions.reserve((stacks + 1) * (sectors + 1));
+    indices.reserve(6 * sectors * stacks);
+
+    for (int i = 0; i <= stacks; ++i) {
+        float stackAngle = PI / 2 - i * (PI / stacks);
+        float xy = cosf(stackAngle);
+        float z = sinf(stackAngle);
+
+        for (int j = 0; j <= sectors; ++j) {
+            float sectorAngle = j * 2 * PI / sectors;
+            positions.push_back(glm::vec3(xy * cosf(sectorAngle), xy * sinf(sectorAngle), z));
+        }
+    }
+
+    for (int i = 0; i < stacks; ++i) {
+        uint32_t k1 = i * (sectors + 1);
+        uint32_t k2 = k1 + sectors + 1;
+
+        for (int j = 0; j < sectors; ++j, ++k1, ++k2) {
+            if (i != 0) {
+                indices.push_back(k1);
+                indices.push_back(k2);
+                indices.push_back(k1 + 1);
+            }
+            if (i != (stacks - 1)) {
+                indices.push_back(k1 + 1);
+                indices.push_back(k2);
+                indices.push_back(k2 + 1);
+            }
+        }
+    }
+}
+
+void SphereMesh::createIcosphere(int subdivisions) {
+    const float t = (1.0f + sqrtf(5.0f)) / 2.0f;
+
+    positions = {
+        {-1,  t,  0}, { 1,  t,  0}, {-1, -t,  0}, { 1, -t,  0},
+        { 0, -1,  t}, { 0,  1,  t}, { 0, -1, -t}, { 0,  1, -t},
+        { t,  0, -1}, { t,  0,  1}, {-t,  0, -1}, {-t,  0,  1}
+    };
+    for (auto& p : positions) p = glm::normalize(p);
+    // every level adds a vertex per edge: 10 * 4^n + 2 in the end
+    positions.reserve(10 * (size_t(1) << (2 * subdivisions)) + 2);
+
+    indices = {
+        0, 11, 5,   0, 5, 1,    0, 1, 7,    0, 7, 10,   0, 10, 11,
+        1, 5, 9,    5, 11, 4,   11, 10, 2,  10, 7, 6,   7, 1, 8,
+        3, 9, 4,    3, 4, 2,    3, 2, 6,    3, 6, 8,    3, 8, 9,
+        4, 9, 5,    2, 4, 11,   6, 2, 10,   8, 6, 7,    9, 8, 1
+    };
+
+    for (int level = 0; level < subdivisions; ++level) {
+        // shared edges must map to the same midpoint or the mesh cracks
+        std::unordered_map<uint64_t, uint32_t> midpoints;
+        midpoints.reserve(indices.size());
+
+        auto midpoint = [&](uint32_t a, uint32_t b) {
+            uint64_t key = (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+            auto it = midpoints.find(key);
+            if (it != midpoints.end()) return it->second;
+
+            uint32_t index = static_cast<uint32_t>(positions.size());
+            positions.push_back(glm::normalize(positions[a] + positions[b]));
+            midpoints.emplace(key, index);
+            return index;
+        };
+
+        std::vector<uint32_t> subdivided;
+        subdivided.reserve(indices.size() * 4);
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            uint32_t v0 = indices[i], v1 = indices[i + 1], v2 = indices[i + 2];
+            uint32_t a = midpoint(v0, v1);
+            uint32_t b = midpoint(v1, v2);
+            uint32_t c = midpoint(v2, v0);
+
+            subdivided.insert(subdivided.end(), { v0, a, c });
+            subdivided.insert(subdivided.end(), { v1, b, a });
+            subdivided.insert(subdivided.end(), { v2, c, b });
+            subdivided.insert(subdivided.end(), { a, b, c });
+        }
+        indices.swap(subdivided);
+    }
+}
+
+void SphereMesh::createCubeSphere(int gridSize) {
+    // face normal, then u and v axes with cross(u, v) == normal so triangles wind outward
+    const glm::vec3 faces[6][3] = {
+        { { 1, 0, 0}, { 0, 0, -1}, {0, 1,  0} },
+        { {-1, 0, 0}, { 0, 0,  1}, {0, 1,  0} },
+        { { 0, 1, 0}, { 1, 0,  0}, {0, 0, -1} },
+        { { 0,-1, 0}, { 1, 0,  0}, {0, 0,  1} },
+        { { 0, 0, 1}, { 1, 0,  0}, {0, 1,  0} },
+        { { 0, 0,-1}, {-1, 0,  0}, {0, 1,  0} }
+    };
+
+    positions.clear();
+    indices.clear();
+    positions.reserve(6 * (gridSize + 1) * (gridSize + 1));
+    indices.reserve(6 * 6 * gridSize * gridSize);
+
+    for (const auto& face : faces) {
+        uint32_t base = static_cast<uint32_t>(positions.size());
+
+        for (int j = 0; j <= gridSize; ++j) {
+            for (int i = 0; i <= gridSize; ++i) {
+                glm::vec3 p = face[0]
+                    + face[1] * (2.0f * i / gridSize - 1.0f)
+                    + face[2] * (2.0f * j / gridSize - 1.0f);
+
+                // spherified cube mapping, spreads the samples far more evenly than normalize(p)
+                glm::vec3 p2 = p * p;
+                glm::vec3 s(
+                    p.x * sqrtf(1.0f - p2.y / 2.0f - p2.z / 2.0f + p2.y * p2.z / 3.0f),
+                    p.y * sqrtf(1.0f - p2.z / 2.0f - p2.x / 2.0f + p2.z * p2.x / 3.0f),
+                    p.z * sqrtf(1.0f - p2.x / 2.0f - p2.y / 2.0f + p2.x * p2.y / 3.0f));
+                positions.push_back(glm::normalize(s));
+            }
+        }
+
+        for (int j = 0; j < gridSize; ++j) {
+            for (int i = 0; i < gridSize; ++i) {
+                uint32_t a = base + j * (gridSize + 1) + i;
+                uint32_t b = a + 1;
+                uint32_t d = a + gridSize + 1;
+                uint32_t c = d + 1;
+                indices.insert(indices.end(), { a, b, c, a, c, d });
+            }
+        }
+    }
+}
+
+// Merges vertices that quantize to the same snorm16 position (UV poles and seams,
+// cube edges) and drops triangles that collapse as a result.
+void SphereMesh::weldVertices() {
+    std::unordered_map<uint64_t, uint32_t> unique;
+    unique.reserve(positions.size());
+    std::vector<uint32_t> remap(positions.size());
+
+    vertices.clear();
+    vertices.reserve(positions.size());
+
+    for (size_t i = 0; i < positions.size(); ++i) {
+        SphereVertex v = { toSnorm16(positions[i].x), toSnorm16(positions[i].y), toSnorm16(positions[i].z), 0 };
+        uint64_t key = (static_cast<uint64_t>(static_cast<uint16_t>(v.x)) << 32)
+            | (static_cast<uint64_t>(static_cast<uint16_t>(v.y)) << 16)
+            | static_cast<uint16_t>(v.z);
+
+        auto result = unique.emplace(key, static_cast<uint32_t>(vertices.size()));
+        if (result.second) vertices.push_back(v);
+        remap[i] = result.first->second;
+    }
+
+    size_t out = 0;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        uint32_t a = remap[indices[i]], b = remap[indices[i + 1]], c = remap[indices[i + 2]];
+        if (a == b || b == c || c == a) continue;
+        indices[out++] = a;
+        indices[out++] = b;
+        indices[out++] = c;
+    }
+    indices.resize(out);
+
+    positions.clear();
+    positions.shrink_to_fit();
+}
+
+// Reorders triangles so that consecutive triangles reuse recently transformed vertices.
+// Spheres are convex, so with back-face culling there is no overdraw inside one mesh
+// and the cache order is the only ordering that matters.
+void SphereMesh::optimizeVertexCache() {
+    const size_t vertexCount = vertices.size();
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return;
+
+    // vertex -> triangle adjacency in one flat array
+    std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+    for (uint32_t index : indices) adjacencyOffset[index + 1]++;
+    for (size_t v = 0; v < vertexCount; ++v) adjacencyOffset[v + 1] += adjacencyOffset[v];
+
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> cursor(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+    for (size_t i = 0; i < indices.size(); ++i) adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+
+    std::vector<int> remaining(vertexCount);
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> score(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        remaining[v] = adjacencyOffset[v + 1] - adjacencyOffset[v];
+        score[v] = vertexScore(-1, remaining[v]);
+    }
+
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<char> emitted(triangleCount, 0);
+    int best = 0;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        triangleScore[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+        if (triangleScore[t] > triangleScore[best]) best = static_cast<int>(t);
+    }
+
+    std::vector<uint32_t> cache, nextCache;
+    cache.reserve(kScoreCacheSize + 3);
+    nextCache.reserve(kScoreCacheSize + 3);
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    size_t scan = 0;
+
+    while (best >= 0) {
+        const uint32_t* tri = &indices[best * 3];
+        emitted[best] = 1;
+        result.insert(result.end(), tri, tri + 3);
+
+        // triangle's vertices go to the front of the LRU cache
+        nextCache.assign(tri, tri + 3);
+        for (uint32_t v : cache) {
+            if (v != tri[0] && v != tri[1] && v != tri[2]) nextCache.push_back(v);
+        }
+        for (int k = 0; k < 3; ++k) remaining[tri[k]]--;
+
+        for (size_t i = 0; i < nextCache.size(); ++i) {
+            uint32_t v = nextCache[i];
+            cachePosition[v] = i < kScoreCacheSize ? static_cast<int>(i) : -1;
+            score[v] = vertexScore(cachePosition[v], remaining[v]);
+        }
+
+        // only triangles touching the cache can change score
+        best = -1;
+        float bestScore = -1.0f;
+        for (uint32_t v : nextCache) {
+            for (uint32_t a = adjacencyOffset[v]; a < adjacencyOffset[v + 1]; ++a) {
+                uint32_t t = adjacency[a];
+                if (emitted[t]) continue;
+                triangleScore[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+                if (triangleScore[t] > bestScore) {
+                    bestScore = triangleScore[t];
+                    best = static_cast<int>(t);
+                }
+            }
+        }
+
+        if (nextCache.size() > kScoreCacheSize) nextCache.resize(kScoreCacheSize);
+        cache.swap(nextCache);
+
+        // cache ran dry: restart from the next triangle that has not been emitted
+        if (best < 0) {
+            while (scan < triangleCount && emitted[scan]) scan++;
+            if (scan < triangleCount) best = static_cast<int>(scan);
+        }
+    }
+
+    indices.swap(result);
+}
+
+// Renumbers vertices in first-use order so vertex fetch walks memory linearly.
+void SphereMesh::optimizeVertexFetch() {
+    const uint32_t unused = ~0u;
+    std::vector<uint32_t> remap(vertices.size(), unused);
+    std::vector<SphereVertex> reordered;
+    reordered.reserve(vertices.size());
+
+    for (uint32_t& index : indices) {
+        if (remap[index] == unused) {
+            remap[index] = static_cast<uint32_t>(reordered.size());
+            reordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices.swap(reordered);
+}
+
+VertexCacheStats SphereMesh::Analyze() const {
+    VertexCacheStats stats = analyzeVertexCache(indices, static_cast<unsigned int>(vertices.size()));
+    stats.vertexBytes = vertices.size() * sizeof(SphereVertex);
+    stats.indexBytes = indices.size() * (FitsShortIndices() ? sizeof(uint16_t) : sizeof(uint32_t));
+    return stats;
+}
+
+// Simulates a FIFO post-transform cache of the given size over the index stream.
+VertexCacheStats SphereMesh::analyzeVertexCache(const std::vector<uint32_t>& indices,
+    unsigned int vertexCount, int cacheSize) {
+    VertexCacheStats stats = {};
+    stats.vertexCount = vertexCount;
+    stats.triangleCount = static_cast<unsigned int>(indices.size() / 3);
+
+    // a vertex is in the cache while fewer than cacheSize misses happened since it was loaded
+    std::vector<unsigned int> loadedAt(vertexCount, 0);
+    unsigned int time = cacheSize + 1;
+    for (uint32_t index : indices) {
+        if (time - loadedAt[index] > static_cast<unsigned int>(cacheSize)) {
+            loadedAt[index] = time++;
+            stats.shaderInvocations++;
+        }
+    }
+
+    stats.acmr = stats.triangleCount ? float(stats.shaderInvocations) / stats.triangleCount : 0.0f;
+    stats.atvr = vertexCount ? float(stats.shaderInvocations) / vertexCount : 0.0f;
+    stats.vertexBytes = vertexCount * sizeof(SphereVertex);
+    stats.indexBytes = indices.size() * sizeof(uint32_t);
+    return stats;
+}
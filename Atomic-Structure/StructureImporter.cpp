@@ -0,0 +1,572 @@
+#include "headers/StructureImporter.hpp"
+#include "headers/Elements.hpp"
+#include "headers/NumberParsing.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    bool isBlank(char c) {
+        return c == ' ' || c == '\t';
+    }
+
+    // Next whitespace separated token; CIF quoting ('...' or "...") is honoured
+    bool nextToken(const char*& p, const char* end, const char*& token, size_t& length) {
+        while (p < end && isBlank(*p)) ++p;
+        if (p == end) return false;
+        if (*p == '\'' || *p == '"') {
+            char quote = *p++;
+            token = p;
+            // a quote only closes the string when whitespace or the line end follows
+            while (p < end && !(*p == quote && (p + 1 == end || isBlank(p[1])))) ++p;
+            length = size_t(p - token);
+            if (p < end) ++p;
+            return true;
+        }
+        token = p;
+        while (p < end && !isBlank(*p)) ++p;
+        length = size_t(p - token);
+        return true;
+    }
+
+    // With the extras structure files use: a leading '+' and CIF standard uncertainties
+    // such as "5.4309(2)"
+    bool parseFloat(const char* begin, const char* end, float& out) {
+        while (begin < end && isBlank(*begin)) ++begin;
+        if (begin < end && *begin == '+') ++begin;
+        return ScanFloat(begin, end, out);
+    }
+
+    bool startsWith(const char* line, size_t length, const char* prefix) {
+        size_t n = strlen(prefix);
+        return length >= n && memcmp(line, prefix, n) == 0;
+    }
+
+    // Lattice vectors from cell lengths and angles (degrees), a along x, b in the xy plane
+    void cellVectors(const float params[6], float cell[9]) {
+        const float toRad = 3.14159265f / 180.0f;
+        float ca = cosf(params[3] * toRad), cb = cosf(params[4] * toRad);
+        float cg = cosf(params[5] * toRad), sg = sinf(params[5] * toRad);
+        float cx = cb, cy = (ca - cb * cg) / sg;
+        float cz = sqrtf(std::max(0.0f, 1.0f - cx * cx - cy * cy));
+        float vectors[9] = {
+            params[0], 0.0f, 0.0f,
+            params[1] * cg, params[1] * sg, 0.0f,
+            params[2] * cx, params[2] * cy, params[2] * cz
+        };
+        memcpy(cell, vectors, sizeof(vectors));
+    }
+
+    // Symmetry operation such as "-x+1/2, y, -z" as a 3x4 affine matrix in fractional space
+    bool parseSymop(const char* text, size_t length, float op[12]) {
+        memset(op, 0, 12 * sizeof(float));
+        const char* p = text;
+        const char* end = text + length;
+        int row = 0;
+        float sign = 1.0f;
+        while (p < end) {
+            char c = (char)tolower((unsigned char)*p);
+            if (c == ',') { if (++row > 2) return false; sign = 1.0f; ++p; }
+            else if (c == '+') { sign = 1.0f; ++p; }
+            else if (c == '-') { sign = -1.0f; ++p; }
+            else if (c >= 'x' && c <= 'z') { op[row * 4 + (c - 'x')] += sign; sign = 1.0f; ++p; }
+            else if (isdigit((unsigned char)c) || c == '.') {
+                float value;
+                if (!ScanFloat(p, end, value, &p)) return false;
+                if (p < end && *p == '/') {
+                    float denominator;
+                    if (!ScanFloat(p + 1, end, denominator, &p) || denominator == 0.0f) return false;
+                    value /= denominator;
+                }
+                op[row * 4 + 3] += sign * value;
+                sign = 1.0f;
+            }
+            else ++p; // spaces, quotes
+        }
+        return row == 2;
+    }
+}
+
+// The atom_site columns we read and the row being assembled. Values are copied into
+// fixed buffers because a row may continue on the next line (and in the next chunk).
+struct StructureImporter::CifState {
+    enum Column { TypeSymbol, Label, FractX, FractY, FractZ, CartnX, CartnY, CartnZ, Model, Symop, ColumnCount };
+    static const size_t kValueSize = 48;
+
+    bool inLoop = false;
+    bool readingTags = false;
+    bool atomLoop = false;
+    bool symopLoop = false;
+    bool inText = false;     // inside a ;-delimited text field
+    int tagCount = 0;
+    int columnIndex[ColumnCount];
+    int token = 0;           // tokens of the current row so far
+    char values[ColumnCount][kValueSize];
+    size_t valueLengths[ColumnCount];
+    uint64_t rowOffset = 0;
+
+    float cellParams[6] = { 1, 1, 1, 90, 90, 90 };
+    bool fractional = false;
+    bool modelKnown = false;
+    long long currentModel = 0;
+    std::vector<std::vector<float>> symops;  // 3x4 each; small-molecule files list only the asymmetric unit
+    std::vector<float> images;               // scratch for one atom's symmetry images
+
+    void beginLoop() {
+        inLoop = readingTags = true;
+        atomLoop = symopLoop = false;
+        tagCount = token = 0;
+        for (int& c : columnIndex) c = -1;
+    }
+};
+
+StructureImporter::StructureImporter()
+    : format(Format::Unknown), cancelled(false), done(true), failed(false), bytesRead(0), fileSize(0),
+    frame(-1), firstFrame(true), firstFrameOnly(false), xyzRemaining(-1), xyzCount(0), cif(nullptr), cellKnown(false), cellPending(false) {}
+
+StructureImporter::~StructureImporter() {
+    Cancel();
+    delete cif;
+}
+
+StructureImporter::Format StructureImporter::DetectFormat(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) return Format::Unknown;
+    std::string ext = path.substr(dot + 1);
+    for (auto& c : ext) c = (char)tolower((unsigned char)c);
+    if (ext == "xyz" || ext == "extxyz") return Format::XYZ;
+    if (ext == "pdb" || ext == "ent") return Format::PDB;
+    if (ext == "cif" || ext == "mmcif") return Format::CIF;
+    return Format::Unknown;
+}
+
+bool StructureImporter::Start(const std::string& path, Format format, bool firstFrameOnly) {
+    Cancel();
+    if (format == Format::Unknown) format = DetectFormat(path);
+    if (format == Format::Unknown) {
+        std::cout << "ERROR::STRUCTURE_IMPORTER::UNKNOWN_FORMAT " << path << std::endl;
+        return false;
+    }
+    this->format = format;
+
+    FILE* probe = fopen(path.c_str(), "rb");
+    if (!probe) {
+        std::cout << "ERROR::STRUCTURE_IMPORTER::CANNOT_OPEN " << path << std::endl;
+        return false;
+    }
+#ifdef _WIN32
+    _fseeki64(probe, 0, SEEK_END);
+    fileSize = static_cast<uint64_t>(_ftelli64(probe));
+#else
+    fseeko(probe, 0, SEEK_END);
+    fileSize = static_cast<uint64_t>(ftello(probe));
+#endif
+    fclose(probe);
+
+    frame = -1;
+    firstFrame = true;
+    this->firstFrameOnly = firstFrameOnly;
+    xyzRemaining = -1;
+    delete cif;
+    cif = format == Format::CIF ? new CifState() : nullptr;
+    cellKnown = cellPending = false;
+    localAtoms.clear();
+    localElements.clear();
+    pendingAtoms.clear();
+    pendingElements.clear();
+    frameOffsets.clear();
+    cancelled = failed = false;
+    bytesRead = 0;
+    done = false;
+    worker = std::thread(&StructureImporter::run, this, path);
+    return true;
+}
+
+void StructureImporter::Cancel() {
+    cancelled = true;
+    if (worker.joinable()) worker.join();
+}
+
+void StructureImporter::Wait() {
+    if (worker.joinable()) worker.join();
+}
+
+size_t StructureImporter::Poll(SceneData& scene) {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t added = pendingAtoms.size();
+    scene.atoms.insert(scene.atoms.end(), pendingAtoms.begin(), pendingAtoms.end());
+    scene.elements.insert(scene.elements.end(), pendingElements.begin(), pendingElements.end());
+    pendingAtoms.clear();
+    pendingElements.clear();
+    if (cellPending) {
+        memcpy(scene.cell, pendingCell, sizeof(pendingCell));
+        scene.periodic = true;
+        cellPending = false;
+    }
+    return added;
+}
+
+std::vector<uint64_t> StructureImporter::GetFrameOffsets() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return frameOffsets;
+}
+
+//======================================================================================
+// Worker
+//======================================================================================
+void StructureImporter::run(std::string path) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        std::cout << "ERROR::STRUCTURE_IMPORTER::CANNOT_OPEN " << path << std::endl;
+        failed = true;
+        done = true;
+        return;
+    }
+
+    std::vector<char> buffer(kChunkSize);
+    size_t carried = 0;         // bytes of an unfinished line at the front of buffer
+    uint64_t bufferOffset = 0;  // file offset of buffer[0]
+    bool endOfFile = false;
+
+    while (!endOfFile && !cancelled) {
+        if (carried == buffer.size()) buffer.resize(buffer.size() * 2); // a line longer than a chunk
+        size_t got = fread(buffer.data() + carried, 1, buffer.size() - carried, file);
+        endOfFile = got < buffer.size() - carried;
+        size_t filled = carried + got;
+        bytesRead += got;
+
+        const char* data = buffer.data();
+        size_t start = 0;
+        for (;;) {
+            const char* newline = static_cast<const char*>(memchr(data + start, '\n', filled - start));
+            if (!newline) break;
+            size_t end = size_t(newline - data);
+            size_t length = end - start;
+            if (length && data[start + length - 1] == '\r') --length;
+            parseLine(data + start, length, bufferOffset + start);
+            start = end + 1;
+        }
+        if (endOfFile && start < filled) {  // last line without a newline
+            size_t length = filled - start;
+            if (data[start + length - 1] == '\r') --length;
+            parseLine(data + start, length, bufferOffset + start);
+            start = filled;
+        }
+
+        carried = filled - start;
+        memmove(buffer.data(), data + start, carried);
+        bufferOffset += start;
+        publish(false);
+    }
+    fclose(file);
+
+    publish(true);
+    done = true;
+}
+
+void StructureImporter::parseLine(const char* line, size_t length, uint64_t offset) {
+    switch (format) {
+    case Format::XYZ: parseXYZ(line, length, offset); break;
+    case Format::PDB: parsePDB(line, length, offset); break;
+    case Format::CIF: parseCIF(line, length, offset); break;
+    default: break;
+    }
+}
+
+void StructureImporter::beginFrame(uint64_t offset) {
+    frame++;
+    if (frame > 0 && firstFrame) {
+        firstFrame = false;
+        publish(true);
+        if (firstFrameOnly) cancelled = true;  // run() stops after this chunk
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    frameOffsets.push_back(offset);
+}
+
+void StructureImporter::addAtom(int atomicNumber, float x, float y, float z) {
+    if (cif && cif->fractional) {
+        if (!cellKnown) {
+            float vectors[9];
+            cellVectors(cif->cellParams, vectors);
+            setCell(vectors);
+        }
+        float fx = x, fy = y, fz = z;
+        x = fx * cell[0] + fy * cell[3] + fz * cell[6];
+        y = fx * cell[1] + fy * cell[4] + fz * cell[7];
+        z = fx * cell[2] + fy * cell[5] + fz * cell[8];
+    }
+    localAtoms.push_back({ { x, y, z }, 0.5f * GetElement(atomicNumber).covalentRadius });
+    localElements.push_back(static_cast<uint16_t>(atomicNumber));
+    if (localAtoms.size() >= kBatchSize) publish(true);
+}
+
+void StructureImporter::setCell(const float vectors[9]) {
+    memcpy(cell, vectors, sizeof(cell));
+    cellKnown = true;
+    std::lock_guard<std::mutex> lock(mutex);
+    memcpy(pendingCell, cell, sizeof(cell));
+    cellPending = true;
+}
+
+void StructureImporter::publish(bool force) {
+    if (localAtoms.empty() || (!force && localAtoms.size() < kBatchSize / 4)) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    pendingAtoms.insert(pendingAtoms.end(), localAtoms.begin(), localAtoms.end());
+    pendingElements.insert(pendingElements.end(), localElements.begin(), localElements.end());
+    localAtoms.clear();
+    localElements.clear();
+}
+
+//======================================================================================
+// XYZ: count line, comment line, then "symbol x y z" per atom; frames repeat
+//======================================================================================
+void StructureImporter::parseXYZ(const char* line, size_t length, uint64_t offset) {
+    const char* end = line + length;
+    if (xyzRemaining == -1) {
+        long long count;
+        if (!ScanInteger(line, end, count)) return; // blank lines between frames
+        beginFrame(offset);
+        xyzRemaining = count > 0 ? -2 : -1;
+        xyzCount = count;
+        return;
+    }
+    if (xyzRemaining == -2) {
+        // extended XYZ keeps the cell in the comment: Lattice="ax ay az bx by bz cx cy cz"
+        static const char key[] = "Lattice=\"";
+        const char* lattice = firstFrame && !cellKnown ? std::search(line, end, key, key + 9) : end;
+        if (lattice != end) {
+            const char* p = lattice + 9;
+            float values[9];
+            int found = 0;
+            const char* token;
+            size_t tokenLength;
+            while (found < 9 && nextToken(p, end, token, tokenLength) && parseFloat(token, token + tokenLength, values[found])) found++;
+            if (found == 9) setCell(values);
+        }
+        xyzRemaining = xyzCount;
+        return;
+    }
+
+    if (firstFrame) {
+        const char* p = line;
+        const char* token;
+        size_t tokenLength;
+        if (nextToken(p, end, token, tokenLength)) {
+            long long number;
+            int z = isdigit((unsigned char)token[0]) && ScanInteger(token, token + tokenLength, number)
+                ? int(number) : ElementFromSymbol(token, tokenLength);
+            float xyz[3];
+            int found = 0;
+            while (found < 3 && nextToken(p, end, token, tokenLength) && parseFloat(token, token + tokenLength, xyz[found])) found++;
+            if (found == 3) addAtom(z, xyz[0], xyz[1], xyz[2]);
+        }
+    }
+    if (--xyzRemaining == 0) xyzRemaining = -1;
+}
+
+//======================================================================================
+// PDB: fixed columns, MODEL/ENDMDL for multiple frames
+//======================================================================================
+void StructureImporter::parsePDB(const char* line, size_t length, uint64_t offset) {
+    bool atom = startsWith(line, length, "ATOM  ") || startsWith(line, length, "HETATM");
+    if (startsWith(line, length, "MODEL ")) {
+        beginFrame(offset);
+        return;
+    }
+    if (startsWith(line, length, "ENDMDL")) {
+        if (firstFrame && frame == 0) {
+            firstFrame = false;
+            publish(true);
+        }
+        return;
+    }
+    if (startsWith(line, length, "CRYST1") && length >= 54 && !cellKnown) {
+        float params[6];
+        const int columns[7] = { 6, 15, 24, 33, 40, 47, 54 };
+        for (int i = 0; i < 6; ++i) {
+            if (!parseFloat(line + columns[i], line + columns[i + 1], params[i])) return;
+        }
+        // 1 1 1 90 90 90 is the placeholder for structures without a cell (NMR, models)
+        if (params[0] <= 1.0f && params[1] <= 1.0f && params[2] <= 1.0f) return;
+        float vectors[9];
+        cellVectors(params, vectors);
+        setCell(vectors);
+        return;
+    }
+    if (!atom || length < 54) return;
+    if (frame < 0) beginFrame(0);  // single-model files have no MODEL record
+    if (!firstFrame) return;
+
+    float x, y, z;
+    if (!parseFloat(line + 30, line + 38, x) || !parseFloat(line + 38, line + 46, y) || !parseFloat(line + 46, line + 54, z)) return;
+
+    // element columns 77-78; older files only have the atom name (columns 13-16), where a
+    // one-letter element is written in column 14
+    int element = 0;
+    if (length >= 78) {
+        const char* symbol = line + 76;
+        size_t symbolLength = 2;
+        if (*symbol == ' ') { ++symbol; --symbolLength; }
+        element = ElementFromSymbol(symbol, symbolLength);
+    }
+    if (!element) {
+        const char* name = line + 12;
+        element = (name[0] == ' ' || isdigit((unsigned char)name[0])) ? ElementFromSymbol(name + 1, 1) : ElementFromSymbol(name, 2);
+    }
+    addAtom(element, x, y, z);
+}
+
+//======================================================================================
+// CIF: cell items plus the atom_site loop, fractional (small molecule) or Cartesian (mmCIF)
+//======================================================================================
+void StructureImporter::parseCIF(const char* line, size_t length, uint64_t offset) {
+    CifState& s = *cif;
+    if (length && line[0] == ';') {
+        s.inText = !s.inText;
+        return;
+    }
+    if (s.inText) return;
+
+    const char* end = line + length;
+    const char* p = line;
+    const char* token;
+    size_t tokenLength;
+    if (!nextToken(p, end, token, tokenLength) || token[0] == '#') return;
+
+    bool keyword = token[0] == '_' || (tokenLength >= 5 && (!strncmp(token, "loop_", 5) || !strncmp(token, "data_", 5)
+        || !strncmp(token, "save_", 5))) || (tokenLength >= 7 && !strncmp(token, "global_", 7));
+
+    if (s.inLoop && !s.readingTags && keyword) {
+        // the loop ended; a row left half-filled is dropped
+        s.inLoop = false;
+    }
+
+    if (tokenLength == 5 && !strncmp(token, "loop_", 5)) {
+        s.beginLoop();
+        return;
+    }
+
+    if (token[0] == '_') {
+        char tag[64];
+        size_t n = std::min(tokenLength, sizeof(tag) - 1);
+        for (size_t i = 0; i < n; ++i) tag[i] = token[i] == '.' ? '_' : (char)tolower((unsigned char)token[i]);
+        tag[n] = 0;
+
+        if (s.inLoop && s.readingTags) {
+            static const char* const names[CifState::ColumnCount] = {
+                "_atom_site_type_symbol", "_atom_site_label", "_atom_site_fract_x", "_atom_site_fract_y",
+                "_atom_site_fract_z", "_atom_site_cartn_x", "_atom_site_cartn_y", "_atom_site_cartn_z",
+                "_atom_site_pdbx_pdb_model_num", "_symmetry_equiv_pos_as_xyz"
+            };
+            for (int c = 0; c < CifState::ColumnCount; ++c) {
+                if (!strcmp(tag, names[c])) s.columnIndex[c] = s.tagCount;
+            }
+            if (!strcmp(tag, "_space_group_symop_operation_xyz")) s.columnIndex[CifState::Symop] = s.tagCount;
+            if (!strncmp(tag, "_atom_site_", 11) && strncmp(tag, "_atom_site_aniso", 16)) s.atomLoop = true;
+            if (s.columnIndex[CifState::Symop] >= 0) s.symopLoop = true;
+            s.tagCount++;
+            return;
+        }
+
+        static const char* const cellNames[6] = {
+            "_cell_length_a", "_cell_length_b", "_cell_length_c",
+            "_cell_angle_alpha", "_cell_angle_beta", "_cell_angle_gamma"
+        };
+        for (int i = 0; i < 6; ++i) {
+            if (!strcmp(tag, cellNames[i]) && nextToken(p, end, token, tokenLength)) {
+                parseFloat(token, token + tokenLength, s.cellParams[i]);
+            }
+        }
+        return;
+    }
+
+    if (!s.inLoop) return;
+    if (s.readingTags) {
+        s.readingTags = false;
+        if (s.atomLoop) {
+            s.fractional = s.columnIndex[CifState::FractX] >= 0 && s.columnIndex[CifState::CartnX] < 0;
+            if (frame < 0) beginFrame(offset);
+        }
+    }
+    if (!s.atomLoop && !s.symopLoop) return;
+
+    // rows may span several lines; tokens are counted until a row is complete
+    p = line;
+    while (nextToken(p, end, token, tokenLength)) {
+        if (s.token == 0) s.rowOffset = offset + uint64_t(token - line);
+        for (int c = 0; c < CifState::ColumnCount; ++c) {
+            if (s.columnIndex[c] != s.token) continue;
+            size_t n = std::min(tokenLength, CifState::kValueSize - 1);
+            memcpy(s.values[c], token, n);
+            s.values[c][n] = 0;
+            s.valueLengths[c] = n;
+        }
+        if (++s.token == s.tagCount) {
+            float op[12];
+            if (!s.symopLoop) cifRow();
+            else if (parseSymop(s.values[CifState::Symop], s.valueLengths[CifState::Symop], op)) s.symops.emplace_back(op, op + 12);
+            s.token = 0;
+        }
+    }
+}
+
+void StructureImporter::cifRow() {
+    CifState& s = *cif;
+    auto value = [&](int column, float& out) {
+        int index = s.columnIndex[column];
+        return index >= 0 && parseFloat(s.values[column], s.values[column] + s.valueLengths[column], out);
+    };
+
+    // mmCIF lists every model of an NMR ensemble or trajectory in the same loop
+    long long model;
+    if (s.columnIndex[CifState::Model] >= 0 &&
+        ScanInteger(s.values[CifState::Model], s.values[CifState::Model] + s.valueLengths[CifState::Model], model)) {
+        if (s.modelKnown && model != s.currentModel) beginFrame(s.rowOffset);
+        s.modelKnown = true;
+        s.currentModel = model;
+    }
+    if (!firstFrame) return;
+
+    float x, y, z;
+    int base = s.fractional ? CifState::FractX : CifState::CartnX;
+    if (!value(base, x) || !value(base + 1, y) || !value(base + 2, z)) return;
+
+    int element = 0;
+    if (s.columnIndex[CifState::TypeSymbol] >= 0) {
+        element = ElementFromSymbol(s.values[CifState::TypeSymbol], s.valueLengths[CifState::TypeSymbol]);
+    }
+    if (!element && s.columnIndex[CifState::Label] >= 0) {
+        element = ElementFromSymbol(s.values[CifState::Label], s.valueLengths[CifState::Label]);
+    }
+    if (!s.fractional || s.symops.size() < 2) {
+        addAtom(element, x, y, z);
+        return;
+    }
+
+    // fill the unit cell: every symmetry image, wrapped into [0, 1), duplicates dropped
+    std::vector<float>& images = s.images;
+    images.clear();
+    for (const auto& op : s.symops) {
+        float f[3];
+        for (int r = 0; r < 3; ++r) {
+            f[r] = op[r * 4] * x + op[r * 4 + 1] * y + op[r * 4 + 2] * z + op[r * 4 + 3];
+            f[r] -= floorf(f[r]);
+        }
+        bool duplicate = false;
+        for (size_t i = 0; i < images.size() && !duplicate; i += 3) {
+            float d = 0.0f;
+            for (int r = 0; r < 3; ++r) {
+                float delta = fabsf(images[i + r] - f[r]);
+                d = std::max(d, std::min(delta, 1.0f - delta));
+            }
+            duplicate = d < 1e-3f;
+        }
+        if (duplicate) continue;
+        images.insert(images.end(), f, f + 3);
+        addAtom(element, f[0], f[1], f[2]);
+    }
+}
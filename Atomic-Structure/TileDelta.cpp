@@ -0,0 +1,233 @@
+#include "headers/TileDelta.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+    const uint32_t kTileMagic = 0x31445441u;  // "ATD1"
+    const int kTilePixels = TileDeltaEncoder::kTileSize * TileDeltaEncoder::kTileSize;
+    // a lone literal between two runs costs 4 bytes a pixel, nothing costs more
+    const size_t kMaxTileBytes = size_t(kTilePixels) * 4;
+
+    void put16(uint8_t* out, uint32_t value) {
+        out[0] = uint8_t(value);
+        out[1] = uint8_t(value >> 8);
+    }
+
+    void put32(uint8_t* out, uint32_t value) {
+        for (int i = 0; i < 4; ++i) out[i] = uint8_t(value >> (8 * i));
+    }
+
+    uint32_t get16(const uint8_t* in) {
+        return uint32_t(in[0]) | (uint32_t(in[1]) << 8);
+    }
+
+    uint32_t get32(const uint8_t* in) {
+        return get16(in) | (get16(in + 2) << 16);
+    }
+
+    // Run-length codes count 24-bit values, returns the bytes written
+    size_t encodeRuns(const uint32_t* values, int count, uint8_t* out) {
+        uint8_t* start = out;
+        int i = 0;
+        while (i < count) {
+            int run = 1;
+            while (i + run < count && run < 128 && values[i + run] == values[i]) ++run;
+            if (run >= 2) {
+                *out++ = uint8_t(run - 1);
+                out[0] = uint8_t(values[i]); out[1] = uint8_t(values[i] >> 8); out[2] = uint8_t(values[i] >> 16);
+                out += 3;
+                i += run;
+                continue;
+            }
+            // literals up to the next pair of equal values
+            int literal = 1;
+            while (i + literal < count && literal < 128 &&
+                !(i + literal + 1 < count && values[i + literal] == values[i + literal + 1])) {
+                ++literal;
+            }
+            *out++ = uint8_t(127 + literal);
+            for (int k = 0; k < literal; ++k) {
+                uint32_t v = values[i + k];
+                out[0] = uint8_t(v); out[1] = uint8_t(v >> 8); out[2] = uint8_t(v >> 16);
+                out += 3;
+            }
+            i += literal;
+        }
+        return size_t(out - start);
+    }
+}
+
+//======================================================================================
+// Encoder
+//======================================================================================
+TileDeltaEncoder::TileDeltaEncoder(int width, int height, int threads)
+    : width(0), height(0), tilesX(0), tilesY(0), frame(0), keyframePending(true), lastKeyframe(false),
+    dirtyTiles(0), lastMs(0.0), pool(threads) {
+    Resize(width, height);
+}
+
+void TileDeltaEncoder::Resize(int width, int height) {
+    this->width = std::max(width, 1);
+    this->height = std::max(height, 1);
+    tilesX = (this->width + kTileSize - 1) / kTileSize;
+    tilesY = (this->height + kTileSize - 1) / kTileSize;
+    size_t tiles = size_t(tilesX) * tilesY;
+    previous.assign(size_t(this->width) * this->height * 3, 0);
+    tileBytes.resize(tiles * kMaxTileBytes);
+    tileLength.assign(tiles, 0);
+    message.reserve(kHeaderBytes + tiles * (kTileHeaderBytes + kMaxTileBytes));
+    keyframePending = true;
+}
+
+void TileDeltaEncoder::encodeTile(int tile, const uint8_t* rgba, size_t rowBytes, bool keyframe) {
+    int x0 = (tile % tilesX) * kTileSize, y0 = (tile / tilesX) * kTileSize;
+    int x1 = std::min(x0 + kTileSize, width), y1 = std::min(y0 + kTileSize, height);
+
+    // unchanged tiles are found with a compare of the RGB the clients have
+    uint32_t values[kTilePixels];
+    bool changed = keyframe;
+    int count = 0;
+    for (int y = y0; y < y1; ++y) {
+        const uint8_t* source = rgba + size_t(y) * rowBytes + size_t(x0) * 4;
+        uint8_t* old = &previous[(size_t(y) * width + x0) * 3];
+        for (int x = x0; x < x1; ++x, source += 4, old += 3) {
+            uint32_t now = uint32_t(source[0]) | (uint32_t(source[1]) << 8) | (uint32_t(source[2]) << 16);
+            uint32_t before = uint32_t(old[0]) | (uint32_t(old[1]) << 8) | (uint32_t(old[2]) << 16);
+            values[count++] = keyframe ? now : now ^ before;
+            if (now != before) {
+                changed = true;
+                old[0] = source[0]; old[1] = source[1]; old[2] = source[2];
+            }
+        }
+    }
+    if (!changed) {
+        tileLength[tile] = 0;
+        return;
+    }
+    uint8_t* out = &tileBytes[size_t(tile) * kMaxTileBytes];
+    uint32_t length = uint32_t(encodeRuns(values, count, out));
+    if (keyframe) {
+        tileLength[tile] = length | TILE_DELTA_RAW;
+        return;
+    }
+
+    // the new pixels back from the XOR, coded as they are, win when most of them changed
+    uint8_t raw[kMaxTileBytes];
+    count = 0;
+    for (int y = y0; y < y1; ++y) {
+        const uint8_t* now = &previous[(size_t(y) * width + x0) * 3];
+        for (int x = x0; x < x1; ++x, now += 3) {
+            values[count++] = uint32_t(now[0]) | (uint32_t(now[1]) << 8) | (uint32_t(now[2]) << 16);
+        }
+    }
+    uint32_t rawLength = uint32_t(encodeRuns(values, count, raw));
+    if (rawLength < length) {
+        memcpy(out, raw, rawLength);
+        length = rawLength | TILE_DELTA_RAW;
+    }
+    tileLength[tile] = length;
+}
+
+const std::vector<uint8_t>& TileDeltaEncoder::Encode(const uint8_t* rgba, size_t rowBytes) {
+    auto start = std::chrono::steady_clock::now();
+    bool keyframe = keyframePending;
+    keyframePending = false;
+
+    pool.Run(tilesX * tilesY, [&](int tile) { encodeTile(tile, rgba, rowBytes, keyframe); });
+
+    // gathered in tile order behind the header, into capacity reserved by Resize()
+    message.resize(kHeaderBytes);
+    dirtyTiles = 0;
+    for (int tile = 0; tile < tilesX * tilesY; ++tile) {
+        uint32_t length = tileLength[tile] & ~TILE_DELTA_RAW;
+        if (length == 0) continue;
+        size_t at = message.size();
+        message.resize(at + kTileHeaderBytes + length);
+        put16(&message[at], uint32_t(tile % tilesX));
+        put16(&message[at + 2], uint32_t(tile / tilesX));
+        put32(&message[at + 4], tileLength[tile]);
+        memcpy(&message[at + kTileHeaderBytes], &tileBytes[size_t(tile) * kMaxTileBytes], length);
+        ++dirtyTiles;
+    }
+    put32(&message[0], kTileMagic);
+    put32(&message[4], frame);
+    put16(&message[8], uint32_t(width));
+    put16(&message[10], uint32_t(height));
+    put16(&message[12], uint32_t(kTileSize));
+    put16(&message[14], keyframe ? uint32_t(TILE_DELTA_KEYFRAME) : 0u);
+    put32(&message[16], uint32_t(dirtyTiles));
+
+    frame++;
+    lastKeyframe = keyframe;
+    lastMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return message;
+}
+
+//======================================================================================
+// Decoder
+//======================================================================================
+TileDeltaDecoder::TileDeltaDecoder()
+    : width(0), height(0), frame(0), synced(false) {}
+
+bool TileDeltaDecoder::Apply(const uint8_t* data, size_t size) {
+    if (size < TileDeltaEncoder::kHeaderBytes || get32(data) != kTileMagic) return false;
+    uint32_t number = get32(data + 4);
+    int w = int(get16(data + 8)), h = int(get16(data + 10)), tileSize = int(get16(data + 12));
+    bool keyframe = (get16(data + 14) & TILE_DELTA_KEYFRAME) != 0;
+    uint32_t tiles = get32(data + 16);
+    // only the encoder's tiles: tile coordinates times a larger size could overflow
+    if (w < 1 || h < 1 || tileSize != TileDeltaEncoder::kTileSize) return false;
+
+    if (keyframe) {
+        if (w != width || h != height) pixels.assign(size_t(w) * h * 4, 255);
+        width = w;
+        height = h;
+    } else if (!synced || w != width || h != height || number != frame + 1) {
+        synced = false;  // missed a message, wait for the next keyframe
+        return false;
+    }
+
+    const uint8_t* in = data + TileDeltaEncoder::kHeaderBytes;
+    const uint8_t* end = data + size;
+    uint32_t decoded = 0;
+    for (uint32_t t = 0; t < tiles; ++t) {
+        if (end - in < ptrdiff_t(TileDeltaEncoder::kTileHeaderBytes)) break;
+        int64_t tileX0 = int64_t(get16(in)) * tileSize, tileY0 = int64_t(get16(in + 2)) * tileSize;
+        uint32_t length = get32(in + 4) & ~TILE_DELTA_RAW;
+        bool raw = (get32(in + 4) & TILE_DELTA_RAW) != 0;
+        in += TileDeltaEncoder::kTileHeaderBytes;
+        if (size_t(end - in) < length || tileX0 < 0 || tileY0 < 0 || tileX0 >= width || tileY0 >= height) break;
+        int x0 = int(tileX0), y0 = int(tileY0);
+        int x1 = std::min(x0 + tileSize, width), y1 = std::min(y0 + tileSize, height);
+
+        const uint8_t* op = in;
+        const uint8_t* opEnd = in + length;
+        int x = x0, y = y0;
+        while (op < opEnd && y < y1) {
+            int repeat = *op < 128 ? *op + 1 : 1;
+            int literals = *op < 128 ? 1 : *op - 127;
+            ++op;
+            if (opEnd - op < ptrdiff_t(literals) * 3) break;
+            for (int k = 0; k < literals; ++k, op += 3) {
+                for (int r = 0; r < repeat && y < y1; ++r) {
+                    uint8_t* out = &pixels[(size_t(y) * width + x) * 4];
+                    if (raw) {
+                        out[0] = op[0]; out[1] = op[1]; out[2] = op[2];
+                    } else {
+                        out[0] ^= op[0]; out[1] ^= op[1]; out[2] ^= op[2];
+                    }
+                    out[3] = 255;
+                    if (++x == x1) { x = x0; ++y; }
+                }
+            }
+        }
+        if (op != opEnd) break;
+        in = opEnd;
+        ++decoded;
+    }
+    // a torn message leaves the frame half updated
+    synced = decoded == tiles;
+    frame = number;
+    return synced;
+}
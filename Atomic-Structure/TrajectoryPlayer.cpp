@@ -0,0 +1,430 @@
+#include "headers/TrajectoryPlayer.hpp"
+#include "headers/NumberParsing.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    bool isBlank(char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    bool nextToken(const char*& p, const char* end, const char*& token) {
+        while (p < end && isBlank(*p)) ++p;
+        if (p == end) return false;
+        token = p;
+        while (p < end && !isBlank(*p)) ++p;
+        return true;
+    }
+
+    // Line starting at p (without its newline); p moves to the next line
+    bool nextLine(const char*& p, const char* end, const char*& line, const char*& lineEnd) {
+        if (p >= end) return false;
+        line = p;
+        const char* newline = static_cast<const char*>(memchr(p, '\n', size_t(end - p)));
+        lineEnd = newline ? newline : end;
+        p = newline ? newline + 1 : end;
+        return true;
+    }
+
+    bool seekTo(FILE* file, uint64_t offset) {
+#ifdef _WIN32
+        return _fseeki64(file, static_cast<long long>(offset), SEEK_SET) == 0;
+#else
+        return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+    }
+
+    uint64_t sizeOf(FILE* file) {
+#ifdef _WIN32
+        _fseeki64(file, 0, SEEK_END);
+        uint64_t size = static_cast<uint64_t>(_ftelli64(file));
+#else
+        fseeko(file, 0, SEEK_END);
+        uint64_t size = static_cast<uint64_t>(ftello(file));
+#endif
+        seekTo(file, 0);
+        return size;
+    }
+
+    uint32_t swapBytes(uint32_t v) {
+        return (v >> 24) | ((v >> 8) & 0xFF00) | ((v << 8) & 0xFF0000) | (v << 24);
+    }
+
+    // Frame f of n after wrapping around either end
+    long long wrapFrame(long long f, long long n) {
+        return ((f % n) + n) % n;
+    }
+}
+
+TrajectoryPlayer::TrajectoryPlayer()
+    : format(Format::Unknown), atomCount(0), fileSize(0), frameCount(0), indexed(true),
+    dcdHeaderSize(0), dcdFrameSize(0), dcdHasCell(false), dcdSwapped(false),
+    indexFile(nullptr), indexCarried(0), indexBufferOffset(0), indexLine(0),
+    closing(false), indexing(false), reported(false), target(0), direction(1) {}
+
+TrajectoryPlayer::~TrajectoryPlayer() {
+    Close();
+}
+
+TrajectoryPlayer::Format TrajectoryPlayer::DetectFormat(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) return Format::Unknown;
+    std::string ext = path.substr(dot + 1);
+    for (auto& c : ext) c = (char)tolower((unsigned char)c);
+    if (ext == "xyz" || ext == "extxyz") return Format::XYZ;
+    if (ext == "dcd") return Format::DCD;
+    return Format::Unknown;
+}
+
+bool TrajectoryPlayer::Open(const std::string& path, int slotCount, int loaderCount) {
+    Close();
+    Format detected = DetectFormat(path);
+    if (detected == Format::Unknown) {
+        std::cout << "ERROR::TRAJECTORY::UNKNOWN_FORMAT " << path << std::endl;
+        return false;
+    }
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        std::cout << "ERROR::TRAJECTORY::CANNOT_OPEN " << path << std::endl;
+        return false;
+    }
+    this->path = path;
+    fileSize = sizeOf(file);
+    bool ok = detected == Format::DCD ? openDCD(file, path) : openXYZ(file, path);
+    fclose(file);
+    if (!ok) return false;
+
+    format = detected;
+    slots.assign(size_t(std::max(slotCount, 2)), Slot());
+    for (Slot& slot : slots) slot.positions.reserve(atomCount * 3);
+    closing = indexing = reported = false;
+    target = 0;
+    direction = 1;
+    for (int i = 0; i < std::max(loaderCount, 1); ++i) {
+        loaders.emplace_back(&TrajectoryPlayer::loaderLoop, this);
+    }
+    return true;
+}
+
+void TrajectoryPlayer::Close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing = true;
+    }
+    workReady.notify_all();
+    frameReady.notify_all();
+    for (auto& loader : loaders) loader.join();
+    loaders.clear();
+    if (indexFile) fclose(indexFile);
+    indexFile = nullptr;
+    slots.clear();
+    frameOffsets.clear();
+    format = Format::Unknown;
+    atomCount = 0;
+    frameCount = 0;
+    indexed = true;
+}
+
+//======================================================================================
+// Opening: DCD header / XYZ first frame
+//======================================================================================
+// CHARMM/NAMD layout: Fortran records (length, data, length) for the 84-byte "CORD" block,
+// the titles and the atom count, then per frame an optional unit cell record followed by
+// the X, Y and Z records. Files from the other byte order are swapped on load.
+bool TrajectoryPlayer::openDCD(FILE* file, const std::string& path) {
+    uint32_t header[23];  // marker, "CORD", icntrl[20], marker
+    if (fread(header, sizeof(header), 1, file) != 1) {
+        std::cout << "ERROR::TRAJECTORY::NOT_A_DCD " << path << std::endl;
+        return false;
+    }
+    dcdSwapped = header[0] != 84;
+    auto value = [this](uint32_t v) { return dcdSwapped ? swapBytes(v) : v; };
+    if (value(header[0]) != 84 || memcmp(&header[1], "CORD", 4) != 0 || value(header[22]) != 84) {
+        std::cout << "ERROR::TRAJECTORY::NOT_A_DCD " << path << std::endl;
+        return false;
+    }
+    const uint32_t* icntrl = header + 2;
+    bool charmm = value(icntrl[19]) != 0;
+    if (value(icntrl[8]) != 0 || (charmm && value(icntrl[11]) != 0)) {
+        std::cout << "ERROR::TRAJECTORY::UNSUPPORTED_DCD (fixed atoms or 4D) " << path << std::endl;
+        return false;
+    }
+    dcdHasCell = charmm && value(icntrl[10]) != 0;
+
+    uint32_t titleLength, record[3];
+    if (fread(&titleLength, 4, 1, file) != 1 || !seekTo(file, 92 + 4 + uint64_t(value(titleLength)) + 4) ||
+        fread(record, sizeof(record), 1, file) != 1 || value(record[0]) != 4) {
+        std::cout << "ERROR::TRAJECTORY::NOT_A_DCD " << path << std::endl;
+        return false;
+    }
+    atomCount = value(record[1]);
+    dcdHeaderSize = 92 + 4 + uint64_t(value(titleLength)) + 4 + sizeof(record);
+    dcdFrameSize = (dcdHasCell ? 4 + 48 + 4 : 0) + 3 * (4 + 4 * uint64_t(atomCount) + 4);
+    // the frame count in the header is often left at 0 by writers that were cut short
+    frameCount = atomCount && fileSize > dcdHeaderSize ? (long long)((fileSize - dcdHeaderSize) / dcdFrameSize) : 0;
+    indexed = true;
+    std::cout << "Trajectory: " << atomCount << " atoms, " << frameCount << " frames" << std::endl;
+    return atomCount > 0;
+}
+
+bool TrajectoryPlayer::openXYZ(FILE* file, const std::string& path) {
+    char head[256];
+    size_t got = fread(head, 1, sizeof(head), file);
+    const char* p = head;
+    const char* end = head + got;
+    const char *line, *lineEnd;
+    long long count = 0;
+    while (nextLine(p, end, line, lineEnd) && !ScanInteger(line, lineEnd, count)) {}
+    if (count <= 0) {
+        std::cout << "ERROR::TRAJECTORY::NOT_AN_XYZ " << path << std::endl;
+        return false;
+    }
+    atomCount = size_t(count);
+
+    // frames become playable as the loaders index them
+    indexFile = fopen(path.c_str(), "rb");
+    if (!indexFile) return false;
+    frameOffsets.assign(1, 0);
+    indexBuffer.resize(kChunkSize);
+    indexCarried = 0;
+    indexBufferOffset = 0;
+    indexLine = 0;
+    frameCount = 0;
+    indexed = false;
+    return true;
+}
+
+//======================================================================================
+// Main thread
+//======================================================================================
+void TrajectoryPlayer::Seek(long long frame) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (frame == target) return;
+        long long delta = frame - target;
+        long long n = frameCount;
+        if (indexed && n > 0 && std::abs(delta) > n / 2) delta = -delta;  // wrapped around an end
+        direction = delta < 0 ? -1 : 1;
+        target = frame;
+    }
+    workReady.notify_all();
+}
+
+bool TrajectoryPlayer::Apply(long long frame, SceneAtom* atoms, size_t count, std::vector<AtomRange>& changed, bool wait) {
+    if (count != atomCount || frame < 0) return false;
+    std::unique_lock<std::mutex> lock(mutex);
+    auto find = [&]() -> Slot* {
+        for (Slot& slot : slots) {
+            if (slot.frame == frame && !slot.loading) return &slot;
+        }
+        return nullptr;
+    };
+    Slot* slot = find();
+    if (!slot && wait) {
+        if (frame != target) {
+            direction = frame < target ? -1 : 1;
+            target = frame;
+            workReady.notify_all();
+        }
+        frameReady.wait(lock, [&] { return closing || (slot = find()) || (indexed && frame >= frameCount); });
+    }
+    if (!slot || slot->positions.size() != count * 3) return false;
+
+    // copy, collecting the runs that moved; short gaps are bridged to keep the runs few
+    const float* positions = slot->positions.data();
+    size_t runStart = 0, runLast = 0;
+    bool inRun = false;
+    for (size_t i = 0; i < count; ++i) {
+        float* dst = atoms[i].position;
+        if (memcmp(dst, positions + i * 3, 3 * sizeof(float)) == 0) continue;
+        memcpy(dst, positions + i * 3, 3 * sizeof(float));
+        if (inRun && i - runLast <= kMergeGap) {
+            runLast = i;
+            continue;
+        }
+        if (inRun) changed.push_back({ runStart, runLast - runStart + 1 });
+        runStart = runLast = i;
+        inRun = true;
+    }
+    if (inRun) changed.push_back({ runStart, runLast - runStart + 1 });
+    return true;
+}
+
+//======================================================================================
+// Loaders
+//======================================================================================
+// Frames within a ring's length of the target, in the direction of travel
+bool TrajectoryPlayer::wanted(long long frame) const {
+    long long n = frameCount;
+    for (size_t k = 0; k < slots.size(); ++k) {
+        long long f = target + direction * (long long)k;
+        if (indexed && n > 0) f = wrapFrame(f, n);
+        if (f == frame && f < n) return true;
+    }
+    return false;
+}
+
+void TrajectoryPlayer::loaderLoop() {
+    FILE* file = fopen(path.c_str(), "rb");
+    std::vector<char> bytes;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!closing) {
+        // nearest wanted frame that isn't loaded or being loaded
+        long long n = frameCount;
+        long long job = -1;
+        for (size_t k = 0; k < slots.size() && job < 0; ++k) {
+            long long f = target + direction * (long long)k;
+            if (indexed && n > 0) f = wrapFrame(f, n);
+            if (f < 0 || f >= n) continue;
+            bool present = false;
+            for (const Slot& slot : slots) present |= slot.frame == f;
+            if (!present) job = f;
+        }
+        Slot* slot = nullptr;
+        if (job >= 0) {
+            for (Slot& candidate : slots) {
+                if (!candidate.loading && (candidate.frame < 0 || !wanted(candidate.frame))) {
+                    slot = &candidate;
+                    break;
+                }
+            }
+        }
+
+        if (slot && file) {
+            uint64_t begin, size;
+            if (format == Format::DCD) {
+                begin = dcdHeaderSize + uint64_t(job) * dcdFrameSize;
+                size = dcdFrameSize;
+            }
+            else {
+                begin = frameOffsets[size_t(job)];
+                size = frameOffsets[size_t(job) + 1] - begin;
+            }
+            slot->frame = job;
+            slot->loading = true;
+            lock.unlock();
+
+            bytes.resize(size_t(size));
+            bool ok = seekTo(file, begin) && fread(bytes.data(), 1, bytes.size(), file) == bytes.size();
+            ok = ok && (format == Format::DCD ? loadDCD(bytes.data(), slot->positions)
+                                              : loadXYZ(bytes.data(), bytes.size(), slot->positions));
+            if (!ok) slot->positions.clear();  // Apply() refuses it instead of waiting on it forever
+
+            lock.lock();
+            slot->loading = false;
+            if (!ok && !reported) {
+                std::cout << "ERROR::TRAJECTORY::BAD_FRAME " << job << std::endl;
+                reported = true;
+            }
+            frameReady.notify_all();
+        }
+        else if (!indexed && !indexing) {
+            indexing = true;
+            lock.unlock();
+            indexChunk();
+            lock.lock();
+            indexing = false;
+            workReady.notify_all();
+        }
+        else {
+            workReady.wait(lock);
+        }
+    }
+    lock.unlock();
+    if (file) fclose(file);
+}
+
+bool TrajectoryPlayer::loadXYZ(const char* data, size_t size, std::vector<float>& positions) {
+    const char* p = data;
+    const char* end = data + size;
+    const char *line, *lineEnd, *token;
+    long long count = 0;
+    while (nextLine(p, end, line, lineEnd) && !ScanInteger(line, lineEnd, count)) {}  // blank lines between frames
+    if (size_t(count) != atomCount || !nextLine(p, end, line, lineEnd)) return false;  // comment
+
+    positions.resize(atomCount * 3);
+    float* out = positions.data();
+    for (size_t i = 0; i < atomCount; ++i) {
+        if (!nextLine(p, end, line, lineEnd) || !nextToken(line, lineEnd, token)) return false;  // symbol
+        for (int k = 0; k < 3; ++k) {
+            if (!nextToken(line, lineEnd, token)) return false;
+            if (*token == '+') ++token;
+            if (!ScanFloat(token, line, out[k])) return false;
+        }
+        out += 3;
+    }
+    return true;
+}
+
+bool TrajectoryPlayer::loadDCD(const char* data, std::vector<float>& positions) {
+    positions.resize(atomCount * 3);
+    const char* record = data + (dcdHasCell ? 4 + 48 + 4 : 0);
+    for (int axis = 0; axis < 3; ++axis) {
+        uint32_t marker;
+        memcpy(&marker, record, 4);
+        if ((dcdSwapped ? swapBytes(marker) : marker) != 4 * atomCount) return false;
+        const char* values = record + 4;
+        for (size_t i = 0; i < atomCount; ++i) {
+            uint32_t bits;
+            memcpy(&bits, values + i * 4, 4);
+            if (dcdSwapped) bits = swapBytes(bits);
+            memcpy(&positions[i * 3 + axis], &bits, 4);
+        }
+        record += 4 + 4 * atomCount + 4;
+    }
+    return true;
+}
+
+// Reads the next chunk of an XYZ file and records where each complete frame ends
+void TrajectoryPlayer::indexChunk() {
+    if (indexCarried == indexBuffer.size()) indexBuffer.resize(indexBuffer.size() * 2);
+    size_t got = fread(indexBuffer.data() + indexCarried, 1, indexBuffer.size() - indexCarried, indexFile);
+    bool endOfFile = got < indexBuffer.size() - indexCarried;
+    size_t filled = indexCarried + got;
+
+    std::vector<uint64_t> ends;
+    bool stop = false;
+    const char* data = indexBuffer.data();
+    size_t start = 0;
+    while (!stop && start < filled) {
+        const char* newline = static_cast<const char*>(memchr(data + start, '\n', filled - start));
+        if (!newline && !endOfFile) break;
+        size_t end = newline ? size_t(newline - data) : filled;
+        if (indexLine == 0) {
+            long long count;
+            if (ScanInteger(data + start, data + end, count)) {
+                if (size_t(count) != atomCount) {
+                    std::cout << "ERROR::TRAJECTORY::ATOM_COUNT_CHANGES at frame " << frameCount + (long long)ends.size()
+                              << ", playing the frames before it" << std::endl;
+                    stop = true;
+                }
+                else indexLine = 1;
+            }
+        }
+        else if (++indexLine == (long long)atomCount + 2) {  // count, comment, atoms
+            ends.push_back(indexBufferOffset + std::min(end + 1, filled));
+            indexLine = 0;
+        }
+        start = std::min(end + 1, filled);
+    }
+    indexCarried = filled - start;
+    memmove(indexBuffer.data(), data + start, indexCarried);
+    indexBufferOffset += start;
+
+    bool finished = stop || endOfFile;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        frameOffsets.insert(frameOffsets.end(), ends.begin(), ends.end());
+        frameCount = (long long)frameOffsets.size() - 1;
+        if (finished) indexed = true;
+    }
+    frameReady.notify_all();
+    if (finished) {
+        fclose(indexFile);
+        indexFile = nullptr;
+        std::cout << "Trajectory: " << atomCount << " atoms, " << frameCount << " frames" << std::endl;
+    }
+}
@@ -0,0 +1,125 @@
+#include "headers/TransparencyPass.hpp"
+#include <iostream>
+
+TransparencyPass::TransparencyPass(int width, int height, const char* compositeVertPath, const char* compositeFragPath)
+    : width(width), height(height), fbo(0), accumTexture(0), revealageTexture(0), depthTexture(0),
+    sourceFramebuffer(0), emptyVAO(0), cullFaceWasEnabled(false), initialized(false) {
+    createTargets();
+    glGenVertexArrays(1, &emptyVAO);
+
+    try {
+        compositeShader = std::make_unique<Shader>(compositeVertPath, compositeFragPath);
+        initialized = true;
+        std::cout << "OIT composite shader compilation successful" << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cout << "Failed to create OIT composite shader: " << e.what() << std::endl;
+    }
+}
+
+void TransparencyPass::createTargets() {
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+    auto attach = [&](GLuint& tex, GLenum internalFormat, GLenum attachment) {
+        glGenTextures(1, &tex);
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glTexStorage2D(GL_TEXTURE_2D, 1, internalFormat, width, height);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, tex, 0);
+    };
+
+    attach(accumTexture, GL_RGBA16F, GL_COLOR_ATTACHMENT0);
+    attach(revealageTexture, GL_R8, GL_COLOR_ATTACHMENT1);
+    attach(depthTexture, GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL_ATTACHMENT);
+
+    GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, drawBuffers);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "ERROR::OIT::FRAMEBUFFER_INCOMPLETE" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void TransparencyPass::destroyTargets() {
+    GLuint textures[3] = { accumTexture, revealageTexture, depthTexture };
+    glDeleteTextures(3, textures);
+    glDeleteFramebuffers(1, &fbo);
+    accumTexture = revealageTexture = depthTexture = fbo = 0;
+}
+
+void TransparencyPass::Resize(int newWidth, int newHeight) {
+    if (newWidth == width && newHeight == height) return;
+    width = newWidth;
+    height = newHeight;
+    destroyTargets();
+    createTargets();
+}
+
+void TransparencyPass::Begin(GLuint source) {
+    sourceFramebuffer = source;
+
+    // opaque depth so shells behind the nucleus or the ground are hidden
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, source);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, width, height);
+
+    const GLfloat zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    const GLfloat one[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    glClearBufferfv(GL_COLOR, 0, zero);
+    glClearBufferfv(GL_COLOR, 1, one);
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthMask(GL_FALSE);
+    cullFaceWasEnabled = glIsEnabled(GL_CULL_FACE) == GL_TRUE;
+    glDisable(GL_CULL_FACE); // back halves of shells are translucent too
+
+    glEnable(GL_BLEND);
+    glBlendFunci(0, GL_ONE, GL_ONE);
+    glBlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+}
+
+void TransparencyPass::End() {
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+    if (cullFaceWasEnabled) glEnable(GL_CULL_FACE);
+    glBindFramebuffer(GL_FRAMEBUFFER, sourceFramebuffer);
+}
+
+void TransparencyPass::Composite(GLuint target) {
+    if (!initialized) {
+        std::cout << "Warning: Attempting to composite uninitialized transparency pass" << std::endl;
+        return;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, target);
+    glViewport(0, 0, width, height);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    compositeShader->use();
+    compositeShader->setInt("accumTexture", 0);
+    compositeShader->setInt("revealageTexture", 1);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, accumTexture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, revealageTexture);
+
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glActiveTexture(GL_TEXTURE0);
+
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+}
+
+TransparencyPass::~TransparencyPass() {
+    destroyTargets();
+    glDeleteVertexArrays(1, &emptyVAO);
+}
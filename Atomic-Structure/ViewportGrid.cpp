@@ -0,0 +1,263 @@
+#include "headers/ViewportGrid.hpp"
+#include "headers/AtomScene.hpp"
+#include "headers/SphereMesh.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+
+struct ViewportGrid::ViewportAtom {
+    int atomicNumber;  // 0 for an empty cell
+    std::vector<Electron> electrons;
+};
+
+namespace {
+    // std140 mirror of the GridFrame block in ViewportGrid.vert and ViewportGridRing.vert
+    struct GridFrame {
+        glm::mat4 viewProjection[ViewportGrid::kMaxViewports];
+        glm::vec4 viewPos[ViewportGrid::kMaxViewports];
+        glm::vec4 cellRect[ViewportGrid::kMaxViewports];  // xy scale, zw center in NDC
+        glm::vec4 lightPos;
+    };
+    const GLuint kFrameBinding = 0;
+    const float kNucleonRadius = 0.1f;
+    const float kElectronRadius = 0.03f;
+
+    bool bindFrameBlock(const Shader& program) {
+        GLuint block = glGetUniformBlockIndex(program.ID, "GridFrame");
+        if (block == GL_INVALID_INDEX) return false;
+        glUniformBlockBinding(program.ID, block, kFrameBinding);
+        return true;
+    }
+
+    glm::vec4 electronPosition(const Electron& e) {
+        float center[3];
+        orbitPoint(e, e.angle, center);
+        return glm::vec4(center[0], center[1], center[2], kElectronRadius);
+    }
+
+    // Position, colour and cell of each instance from attribute first on; spheres put the
+    // mesh in front of them, rings have nothing else
+    void instanceAttributes(GLuint first) {
+        glVertexAttribPointer(first, 4, GL_FLOAT, GL_FALSE, sizeof(GridInstance), (void*)offsetof(GridInstance, position));
+        glVertexAttribPointer(first + 1, 4, GL_FLOAT, GL_FALSE, sizeof(GridInstance), (void*)offsetof(GridInstance, color));
+        glVertexAttribIPointer(first + 2, 1, GL_UNSIGNED_INT, sizeof(GridInstance), (void*)offsetof(GridInstance, viewport));
+        for (GLuint attribute = first; attribute < first + 3; ++attribute) {
+            glEnableVertexAttribArray(attribute);
+            glVertexAttribDivisor(attribute, 1);
+        }
+    }
+}
+
+ViewportGrid::ViewportGrid(const char* vertPath, const char* fragPath, const char* ringVertPath, const char* ringFragPath)
+    : sphereVAO(0), meshVBO(0), meshEBO(0), sphereVBO(0), ringVAO(0), ringVBO(0), frameUBO(0), meshIndexCount(0),
+    viewportCount(0), width(1), height(1), columns(1), rows(1), atoms(std::make_unique<ViewportAtom[]>(kMaxViewports)),
+    nucleonInstances(0), instancesStale(true), initialized(false) {
+    for (int i = 0; i < kMaxViewports; ++i) {
+        rects[i] = glm::ivec4(0, 0, 1, 1);
+        atoms[i].atomicNumber = 0;
+    }
+
+    // the same low-poly icosphere as AtomInstances, a cell is a fraction of the window
+    SphereMesh mesh(SphereType::Icosphere, 16, 12);
+    std::vector<uint16_t> shortIndices(mesh.GetIndices().begin(), mesh.GetIndices().end());
+    meshIndexCount = static_cast<unsigned int>(shortIndices.size());
+
+    glGenVertexArrays(1, &sphereVAO);
+    glGenVertexArrays(1, &ringVAO);
+    GLuint buffers[5];
+    glGenBuffers(5, buffers);
+    meshVBO = buffers[0]; meshEBO = buffers[1]; sphereVBO = buffers[2]; ringVBO = buffers[3]; frameUBO = buffers[4];
+
+    glBindVertexArray(sphereVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, meshVBO);
+    glBufferData(GL_ARRAY_BUFFER, mesh.GetVertices().size() * sizeof(SphereVertex), mesh.GetVertices().data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, sizeof(SphereVertex), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(uint16_t), shortIndices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, sphereVBO);
+    instanceAttributes(1);
+
+    // rings have no per-vertex data, the circle comes from gl_VertexID
+    glBindVertexArray(ringVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, ringVBO);
+    instanceAttributes(0);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindBuffer(GL_UNIFORM_BUFFER, frameUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(GridFrame), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    try {
+        shader = std::make_unique<Shader>(vertPath, fragPath);
+        ringShader = std::make_unique<Shader>(ringVertPath, ringFragPath);
+        std::cout << "Viewport grid shader compilation successful" << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cout << "Failed to create viewport grid shaders: " << e.what() << std::endl;
+        return;
+    }
+    if (!bindFrameBlock(*shader) || !bindFrameBlock(*ringShader)) {
+        std::cout << "ERROR::VIEWPORT_GRID::NO_FRAME_BLOCK" << std::endl;
+        return;
+    }
+    ringShader->use();
+    ringShader->setInt("segments", kRingSegments);
+    initialized = true;
+}
+
+ViewportGrid::~ViewportGrid() {
+    GLuint arrays[2] = { sphereVAO, ringVAO };
+    glDeleteVertexArrays(2, arrays);
+    GLuint buffers[5] = { meshVBO, meshEBO, sphereVBO, ringVBO, frameUBO };
+    glDeleteBuffers(5, buffers);
+}
+
+bool ViewportGrid::SetLayout(int count, int width, int height) {
+    if (count < 1 || count > kMaxViewports) {
+        std::cout << "ERROR::VIEWPORT_GRID::VIEWPORT_COUNT " << count << " (1 to " << kMaxViewports << ")" << std::endl;
+        return false;
+    }
+    this->width = std::max(width, 1);
+    this->height = std::max(height, 1);
+    columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+    rows = (count + columns - 1) / columns;
+
+    // row 0 is the top one, GL counts from the bottom
+    for (int i = 0; i < count; ++i) {
+        int column = i % columns, row = rows - 1 - i / columns;
+        int x0 = column * this->width / columns, x1 = (column + 1) * this->width / columns;
+        int y0 = row * this->height / rows, y1 = (row + 1) * this->height / rows;
+        rects[i] = glm::ivec4(x0 + kGutter / 2, y0 + kGutter / 2,
+            std::max(x1 - x0 - kGutter, 1), std::max(y1 - y0 - kGutter, 1));
+    }
+    for (int i = count; i < kMaxViewports; ++i) {
+        atoms[i].atomicNumber = 0;
+        atoms[i].electrons.clear();
+    }
+    viewportCount = count;
+    instancesStale = true;
+    return true;
+}
+
+int ViewportGrid::GetViewportAt(double x, double y) const {
+    double glY = height - y;
+    for (int i = 0; i < viewportCount; ++i) {
+        const glm::ivec4& r = rects[i];
+        if (x >= r.x && x < r.x + r.z && glY >= r.y && glY < r.y + r.w) return i;
+    }
+    return -1;
+}
+
+void ViewportGrid::SetElement(int viewport, int atomicNumber, const ElementShells& shells) {
+    if (viewport < 0 || viewport >= viewportCount) {
+        std::cout << "ERROR::VIEWPORT_GRID::NO_VIEWPORT " << viewport << std::endl;
+        return;
+    }
+    ViewportAtom& atom = atoms[viewport];
+    atom.atomicNumber = atomicNumber;
+    buildElectrons(shells, atom.electrons);
+
+    // far enough back that the outermost orbit fills the cell's height
+    float reach = 0.16f + kNucleonRadius;
+    for (const Electron& e : atom.electrons) reach = std::max(reach, e.radius + kElectronRadius);
+    float distance = 1.05f * reach / std::sin(glm::radians(ZOOM * 0.5f));
+    cameras[viewport].SetState(glm::vec3(0.0f, 0.0f, distance), YAW, PITCH, ZOOM);
+    instancesStale = true;
+}
+
+int ViewportGrid::GetElement(int viewport) const {
+    return viewport >= 0 && viewport < viewportCount ? atoms[viewport].atomicNumber : 0;
+}
+
+void ViewportGrid::Update() {
+    size_t instance = nucleonInstances;
+    for (int v = 0; v < viewportCount; ++v) {
+        advanceElectrons(atoms[v].electrons);
+        if (instancesStale) continue;
+        for (const Electron& e : atoms[v].electrons) spheres[instance++].position = electronPosition(e);
+    }
+}
+
+void ViewportGrid::uploadInstances() {
+    spheres.clear();
+    rings.clear();
+    for (int v = 0; v < viewportCount; ++v) {
+        if (atoms[v].atomicNumber == 0) continue;
+        for (size_t i = 0; i < kNucleonCount; ++i) {
+            const float* p = kNucleusPositions[i];
+            spheres.push_back({ glm::vec4(p[0], p[1], p[2], kNucleonRadius),
+                glm::vec4(kNucleusColor[0], kNucleusColor[1], kNucleusColor[2], 1.0f), GLuint(v) });
+        }
+    }
+    nucleonInstances = spheres.size();
+    for (int v = 0; v < viewportCount; ++v) {
+        for (const Electron& e : atoms[v].electrons) {
+            glm::vec3 color(e.color[0], e.color[1], e.color[2]);
+            spheres.push_back({ electronPosition(e), glm::vec4(color, 1.0f), GLuint(v) });
+            rings.push_back({ glm::vec4(e.normal[0], e.normal[1], e.normal[2], e.radius),
+                glm::vec4(color * 0.2f, 1.0f), GLuint(v) });
+        }
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, sphereVBO);
+    glBufferData(GL_ARRAY_BUFFER, spheres.size() * sizeof(GridInstance), spheres.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, ringVBO);
+    glBufferData(GL_ARRAY_BUFFER, rings.size() * sizeof(GridInstance), rings.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    instancesStale = false;
+}
+
+void ViewportGrid::Render(const glm::vec3& lightPos) {
+    if (!initialized) {
+        std::cout << "Warning: Attempting to render an uninitialized viewport grid" << std::endl;
+        return;
+    }
+    if (viewportCount == 0) return;
+
+    if (instancesStale) {
+        uploadInstances();
+    }
+    else if (spheres.size() > nucleonInstances) {
+        // only the electrons moved
+        glBindBuffer(GL_ARRAY_BUFFER, sphereVBO);
+        glBufferSubData(GL_ARRAY_BUFFER, nucleonInstances * sizeof(GridInstance),
+            (spheres.size() - nucleonInstances) * sizeof(GridInstance), spheres.data() + nucleonInstances);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    GridFrame frame;
+    for (int v = 0; v < viewportCount; ++v) {
+        const glm::ivec4& r = rects[v];
+        Camera& camera = cameras[v];
+        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), float(r.z) / float(r.w), 0.1f, 100.0f);
+        frame.viewProjection[v] = projection * camera.GetViewMatrix();
+        frame.viewPos[v] = glm::vec4(camera.Position, 1.0f);
+        frame.cellRect[v] = glm::vec4(float(r.z) / width, float(r.w) / height,
+            (2.0f * r.x + r.z) / width - 1.0f, (2.0f * r.y + r.w) / height - 1.0f);
+    }
+    frame.lightPos = glm::vec4(lightPos, 1.0f);
+    glBindBuffer(GL_UNIFORM_BUFFER, frameUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(GridFrame), &frame);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, kFrameBinding, frameUBO);
+
+    glViewport(0, 0, width, height);
+    for (int plane = 0; plane < 4; ++plane) glEnable(GL_CLIP_DISTANCE0 + plane);
+
+    if (!spheres.empty()) {
+        shader->use();
+        glBindVertexArray(sphereVAO);
+        glDrawElementsInstanced(GL_TRIANGLES, meshIndexCount, GL_UNSIGNED_SHORT, 0, static_cast<GLsizei>(spheres.size()));
+    }
+    if (!rings.empty()) {
+        ringShader->use();
+        glBindVertexArray(ringVAO);
+        glDrawArraysInstanced(GL_LINE_LOOP, 0, kRingSegments, static_cast<GLsizei>(rings.size()));
+    }
+    glBindVertexArray(0);
+    for (int plane = 0; plane < 4; ++plane) glDisable(GL_CLIP_DISTANCE0 + plane);
+}
@@ -0,0 +1,60 @@
+#include "headers/WorkerPool.hpp"
+
+WorkerPool::WorkerPool(int threads)
+    : generation(0), busyWorkers(0), quit(false), currentJob(nullptr), currentThunk(nullptr), jobCount(0), nextJob(0) {
+    int count = threads > 0 ? threads : static_cast<int>(std::thread::hardware_concurrency());
+    for (int i = 1; i < count; ++i) {
+        workers.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+void WorkerPool::run(int count, const void* job, JobThunk thunk) {
+    currentJob = job;
+    currentThunk = thunk;
+    jobCount = count;
+    nextJob = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        busyWorkers = static_cast<int>(workers.size());
+        generation++;
+    }
+    wake.notify_all();
+
+    drain();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this] { return busyWorkers == 0; });
+    currentJob = nullptr;
+}
+
+void WorkerPool::workerLoop() {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return quit || generation != seen; });
+            if (quit) return;
+            seen = generation;
+        }
+        drain();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busyWorkers == 0) finished.notify_one();
+        }
+    }
+}
+
+void WorkerPool::drain() {
+    for (int job = nextJob++; job < jobCount; job = nextJob++) {
+        currentThunk(currentJob, job);
+    }
+}
@@ -0,0 +1,23 @@
+#version 330 core
+in vec3 FragPos;
+in vec3 Normal;
+in vec3 Color;
+flat in uint AtomID;
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out uint PickID;  // only stored when a PickBuffer is bound
+
+uniform vec3 lightPos;
+uniform vec3 viewPos;
+
+void main() {
+    vec3 norm = normalize(Normal);
+    vec3 lightDir = normalize(lightPos - FragPos);
+    vec3 viewDir = normalize(viewPos - FragPos);
+
+    float ambient = 0.2;
+    float diff = max(dot(norm, lightDir), 0.0);
+    float spec = 0.3 * pow(max(dot(viewDir, reflect(-lightDir, norm)), 0.0), 32.0);
+
+    FragColor = vec4(Color * (ambient + diff) + vec3(spec), 1.0);
+    PickID = AtomID;
+}
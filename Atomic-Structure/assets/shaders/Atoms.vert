@@ -0,0 +1,35 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;          // unit sphere, also the normal
+layout (location = 1) in vec4 aCenterRadius; // per atom
+layout (location = 2) in uint aElement;      // per atom, atomic number
+layout (location = 3) in vec4 aColor;        // per atom override, a = 0 means none
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 elementColors[119];
+
+// periodic repetition: instance i draws atom i / cellCount in cell i % cellCount, so the
+// per-atom attributes (divisor cellCount) only ever hold one unit cell
+uniform vec3 cellA;
+uniform vec3 cellB;
+uniform vec3 cellC;
+uniform int repeatX;
+uniform int repeatY;
+uniform int cellCount;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec3 Color;
+flat out uint AtomID;   // pick ID, see PickBuffer.hpp
+
+void main() {
+    int cell = gl_InstanceID % cellCount;
+    vec3 offset = float(cell % repeatX) * cellA + float((cell / repeatX) % repeatY) * cellB +
+        float(cell / (repeatX * repeatY)) * cellC;
+    FragPos = vec3(model * vec4(aCenterRadius.xyz + offset + aPos * aCenterRadius.w, 1.0));
+    Normal = mat3(model) * aPos;
+    Color = aColor.a > 0.0 ? aColor.rgb : elementColors[min(aElement, 118u)];
+    AtomID = (1u << 29) | uint(gl_InstanceID / cellCount);
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
@@ -0,0 +1,53 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;   // unit cylinder along z, z in [0, 1]
+layout (location = 1) in uvec2 aBond; // per bond, indices of the two atoms
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 elementColors[119];
+uniform float bondRadius;
+
+// the atoms' instance buffers: centre + radius, and atomic number
+uniform samplerBuffer atomData;
+uniform usamplerBuffer atomElements;
+
+// periodic repetition, as in Atoms.vert
+uniform vec3 cellA;
+uniform vec3 cellB;
+uniform vec3 cellC;
+uniform int repeatX;
+uniform int repeatY;
+uniform int cellCount;
+
+out vec3 FragPos;
+out vec3 Normal;
+out float Along;
+flat out vec3 ColorA;
+flat out vec3 ColorB;
+flat out uint BondID;   // pick ID, see PickBuffer.hpp
+
+void main() {
+    int cell = gl_InstanceID % cellCount;
+    vec3 offset = float(cell % repeatX) * cellA + float((cell / repeatX) % repeatY) * cellB +
+        float(cell / (repeatX * repeatY)) * cellC;
+
+    vec3 a = texelFetch(atomData, int(aBond.x)).xyz;
+    vec3 b = texelFetch(atomData, int(aBond.y)).xyz;
+    ColorA = elementColors[min(texelFetch(atomElements, int(aBond.x)).r, 118u)];
+    ColorB = elementColors[min(texelFetch(atomElements, int(aBond.y)).r, 118u)];
+
+    // orthonormal frame around the bond axis
+    vec3 axis = b - a;
+    vec3 w = normalize(axis);
+    vec3 helper = abs(w.z) < 0.9 ? vec3(0.0, 0.0, 1.0) : vec3(1.0, 0.0, 0.0);
+    vec3 u = normalize(cross(helper, w));
+    vec3 v = cross(w, u);
+
+    vec3 radial = aPos.x * u + aPos.y * v;
+    FragPos = vec3(model * vec4(a + offset + axis * aPos.z + radial * bondRadius, 1.0));
+    Normal = mat3(model) * radial;
+    Along = aPos.z;
+    BondID = (4u << 29) | uint(gl_InstanceID / cellCount);
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
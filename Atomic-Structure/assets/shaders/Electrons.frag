@@ -1,7 +1,10 @@
 #version 330 core
-out vec4 FragColor;
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out uint PickID;
 uniform vec3 objectColor;
+uniform uint pickID = 0u;  // see PickBuffer.hpp
 
 void main() {
     FragColor = vec4(objectColor * 1.5, 1.0);
+    PickID = pickID;
 }
\ No newline at end of file
@@ -0,0 +1,20 @@
+#version 330 core
+in vec3 FragPos;
+in vec3 Normal;
+
+layout (location = 0) out vec4 gPosition;
+layout (location = 1) out vec4 gNormal;
+layout (location = 2) out vec4 gAlbedo;
+
+uniform vec3 objectColor;
+uniform float specularStrength = 0.5;
+
+// Geometry pass for spheres: lighting happens later in TiledLighting.comp
+void main() {
+    // Same color variation as Sphere.frag
+    vec3 variedColor = objectColor * (0.9 + 0.1 * sin(FragPos.x * 10.0));
+
+    gPosition = vec4(FragPos, 1.0);
+    gNormal = vec4(normalize(Normal), 0.0);
+    gAlbedo = vec4(variedColor, specularStrength);
+}
@@ -3,11 +3,49 @@ out vec4 FragColor;
 
 in vec3 FragPos;
 in vec3 Normal;
+in float ViewDepth;
 
 uniform vec3 groundColor;
 uniform vec3 lightPos;
 uniform vec3 viewPos;
 
+// set by ShadowMap::Apply, shadowsEnabled stays false without it
+uniform bool shadowsEnabled;
+uniform sampler2DArrayShadow staticShadowMap;
+uniform sampler2DArrayShadow dynamicShadowMap;
+uniform mat4 lightSpace[4];
+uniform float cascadeEnd[4];
+uniform int cascadeCount;
+
+// 3x3 PCF in one cascade layer
+float sampleShadow(sampler2DArrayShadow map, vec3 coord, int layer)
+{
+    vec2 texel = 1.0 / vec2(textureSize(map, 0).xy);
+    float lit = 0.0;
+    for (int x = -1; x <= 1; ++x)
+        for (int y = -1; y <= 1; ++y)
+            lit += texture(map, vec4(coord.xy + vec2(x, y) * texel, float(layer), coord.z));
+    return lit / 9.0;
+}
+
+float visibility()
+{
+    if (!shadowsEnabled) return 1.0;
+
+    int layer = cascadeCount - 1;
+    for (int i = 0; i < cascadeCount; ++i) {
+        if (ViewDepth < cascadeEnd[i]) { layer = i; break; }
+    }
+
+    vec4 lightCoord = lightSpace[layer] * vec4(FragPos, 1.0);
+    vec3 coord = lightCoord.xyz / lightCoord.w * 0.5 + 0.5;
+    if (coord.z > 1.0) return 1.0;
+    coord.z -= 0.0015; // bias against acne on the flat plane
+
+    // static nuclei and moving electrons live in separate maps, the darker one wins
+    return min(sampleShadow(staticShadowMap, coord, layer), sampleShadow(dynamicShadowMap, coord, layer));
+}
+
 void main()
 {
     // Simple lighting calculation
@@ -15,7 +53,7 @@ void main()
     vec3 lightDir = normalize(lightPos - FragPos);
     
     float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = diff * vec3(1.0);
+    vec3 diffuse = diff * visibility() * vec3(1.0);
     
     vec3 result = (0.3 + diffuse) * groundColor;
     FragColor = vec4(result, 1.0);
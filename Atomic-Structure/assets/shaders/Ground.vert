@@ -9,10 +9,12 @@ uniform mat4 projection;
 
 out vec3 FragPos;
 out vec3 Normal;
+out float ViewDepth; // distance along the view axis, selects the shadow cascade
 
 void main()
 {
     FragPos = vec3(model * vec4(aPos, 1.0));
     Normal = mat3(transpose(inverse(model))) * aNormal;
+    ViewDepth = -(view * model * vec4(aPos, 1.0)).z;
     gl_Position = projection * view * model * vec4(aPos, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,16 @@
+#version 330 core
+in vec3 FragPos;
+in vec3 Normal;
+
+layout (location = 0) out vec4 gPosition;
+layout (location = 1) out vec4 gNormal;
+layout (location = 2) out vec4 gAlbedo;
+
+uniform vec3 groundColor;
+
+void main()
+{
+    gPosition = vec4(FragPos, 1.0);
+    gNormal = vec4(normalize(Normal), 0.0);
+    gAlbedo = vec4(groundColor, 0.0); // matte, no specular
+}
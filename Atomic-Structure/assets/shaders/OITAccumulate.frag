@@ -0,0 +1,17 @@
+#version 330 core
+in vec4 vColor; // rgb, alpha
+
+layout (location = 0) out vec4 accum;
+layout (location = 1) out float revealage;
+
+// Weighted blended order-independent transparency (McGuire & Bavoil 2013).
+// Order does not matter because both targets are combined with commutative blending.
+void main() {
+    float a = vColor.a;
+    // depth weight, eq. 10 of the paper: near fragments dominate, far ones fade out
+    float w = clamp(pow(min(1.0, a * 10.0) + 0.01, 3.0) * 1e8 *
+                    pow(1.0 - gl_FragCoord.z * 0.9, 3.0), 1e-2, 3e3);
+
+    accum = vec4(vColor.rgb * a, a) * w;
+    revealage = a;
+}
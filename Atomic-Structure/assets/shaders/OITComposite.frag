@@ -0,0 +1,18 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+uniform sampler2D accumTexture;
+uniform sampler2D revealageTexture;
+
+void main() {
+    float revealage = texture(revealageTexture, TexCoord).r;
+    if (revealage >= 1.0) discard; // nothing translucent here
+
+    vec4 accum = texture(accumTexture, TexCoord);
+    vec3 average = accum.rgb / clamp(accum.a, 1e-4, 5e4);
+
+    // blended with GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA over the opaque image
+    FragColor = vec4(average, 1.0 - revealage);
+}
@@ -0,0 +1,22 @@
+#version 330 core
+layout (location = 0) in vec4 aCenterRadius; // per instance: atom center, orbit radius
+layout (location = 1) in vec4 aAxis;         // per instance: orbital plane normal
+layout (location = 2) in vec4 aColor;        // per instance, a = opacity
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform int segments;
+
+out vec4 vColor;
+
+// Same path as Electron: (radius, 0, 0) rotated about the plane normal.
+// The ring is generated from gl_VertexID, so it needs no vertex buffer.
+void main() {
+    float angle = 6.28318530718 * float(gl_VertexID) / float(segments);
+    vec3 v = vec3(aCenterRadius.w, 0.0, 0.0);
+    vec3 n = normalize(aAxis.xyz);
+    vec3 p = v * cos(angle) + cross(n, v) * sin(angle) + n * dot(n, v) * (1.0 - cos(angle));
+
+    vColor = aColor;
+    gl_Position = projection * view * vec4(aCenterRadius.xyz + p, 1.0);
+}
@@ -0,0 +1,21 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;          // unit sphere, also the normal
+layout (location = 1) in vec4 aCenterRadius; // per instance
+layout (location = 2) in vec4 aColor;        // per instance, a = opacity
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 viewPos;
+
+out vec4 vColor;
+
+void main() {
+    vec3 worldPos = aCenterRadius.xyz + aPos * aCenterRadius.w;
+
+    // thin-shell look: more opaque where the view grazes the surface
+    float facing = abs(dot(aPos, normalize(viewPos - worldPos)));
+    float rim = 0.35 + 0.65 * pow(1.0 - facing, 2.0);
+    vColor = vec4(aColor.rgb, aColor.a * rim);
+
+    gl_Position = projection * view * vec4(worldPos, 1.0);
+}
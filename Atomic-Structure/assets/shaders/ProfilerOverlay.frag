@@ -0,0 +1,14 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 GlyphUV;
+in vec4 Color;
+flat in uint Glyph;
+
+void main()
+{
+    int col = min(int(GlyphUV.x * 3.0), 2);
+    int row = min(int(GlyphUV.y * 5.0), 4);
+    if (((Glyph >> uint(row * 3 + col)) & 1u) == 0u) discard;
+    FragColor = Color;
+}
@@ -0,0 +1,22 @@
+#version 330 core
+layout (location = 0) in vec4 aRect;   // x, y, width, height in pixels, origin top-left
+layout (location = 1) in vec4 aColor;
+layout (location = 2) in uint aGlyph;  // 3x5 bitmap, 0x7FFF = solid
+
+uniform vec2 screenSize;
+
+out vec2 GlyphUV;
+out vec4 Color;
+flat out uint Glyph;
+
+void main()
+{
+    // triangle strip corners from gl_VertexID, no vertex buffer
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vec2 pixel = aRect.xy + corner * aRect.zw;
+
+    GlyphUV = corner;
+    Color = aColor;
+    Glyph = aGlyph;
+    gl_Position = vec4(pixel.x / screenSize.x * 2.0 - 1.0, 1.0 - pixel.y / screenSize.y * 2.0, 0.0, 1.0);
+}
@@ -0,0 +1,15 @@
+#version 430 core
+layout (location = 0) in vec3 aPos; // unit sphere from Sphere's VBO
+
+// one entry per caster: center, radius
+layout (std430, binding = 1) readonly buffer Casters {
+    vec4 casters[];
+};
+
+uniform mat4 lightSpace;
+
+void main()
+{
+    vec4 caster = casters[gl_InstanceID];
+    gl_Position = lightSpace * vec4(caster.xyz + aPos * caster.w, 1.0);
+}
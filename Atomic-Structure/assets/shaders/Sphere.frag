@@ -1,11 +1,13 @@
 #version 330 core
 in vec3 FragPos;
 in vec3 Normal;
-out vec4 FragColor;
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out uint PickID;
 
 uniform vec3 objectColor;
 uniform vec3 lightPos;
 uniform vec3 viewPos;
+uniform uint pickID = 0u;  // see PickBuffer.hpp
 
 void main() {
     // Add some randomness to color
@@ -34,4 +36,5 @@ void main() {
     vec3 result = (ambient + diffuse + specular) * depthFactor;
     
     FragColor = vec4(result, 1.0);
+    PickID = pickID;
 }
\ No newline at end of file
@@ -1,6 +1,5 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
+layout (location = 0) in vec3 aPos; // unit sphere, so it doubles as the normal
 
 uniform mat4 model;
 uniform mat4 view;
@@ -11,6 +10,6 @@ out vec3 Normal;
 
 void main() {
     FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    Normal = mat3(transpose(inverse(model))) * aPos;
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,25 @@
+#version 330 core
+in vec3 FragPos;
+in vec3 Normal;
+in vec3 Color;
+flat in uint Viewport;
+layout (location = 0) out vec4 FragColor;
+
+layout (std140) uniform GridFrame {
+    mat4 viewProjection[16];
+    vec4 viewPos[16];
+    vec4 cellRect[16];
+    vec4 lightPos;
+};
+
+void main() {
+    vec3 norm = normalize(Normal);
+    vec3 lightDir = normalize(lightPos.xyz - FragPos);
+    vec3 viewDir = normalize(viewPos[Viewport].xyz - FragPos);
+
+    float ambient = 0.2;
+    float diff = max(dot(norm, lightDir), 0.0);
+    float spec = 0.3 * pow(max(dot(viewDir, reflect(-lightDir, norm)), 0.0), 32.0);
+
+    FragColor = vec4(Color * (ambient + diff) + vec3(spec), 1.0);
+}
@@ -0,0 +1,35 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;          // unit sphere, also the normal
+layout (location = 1) in vec4 aCenterRadius; // per instance
+layout (location = 2) in vec4 aColor;        // per instance
+layout (location = 3) in uint aViewport;     // per instance, the cell it is drawn in
+
+// one per frame for every cell, ViewportGrid::kMaxViewports of each
+layout (std140) uniform GridFrame {
+    mat4 viewProjection[16];
+    vec4 viewPos[16];
+    vec4 cellRect[16];  // xy scale, zw center of the cell in NDC
+    vec4 lightPos;
+};
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec3 Color;
+flat out uint Viewport;
+out float gl_ClipDistance[4];
+
+void main() {
+    FragPos = aCenterRadius.xyz + aPos * aCenterRadius.w;
+    Normal = aPos;
+    Color = aColor.rgb;
+    Viewport = aViewport;
+
+    // clipped to the cell's own frustum, then moved into the cell
+    vec4 clip = viewProjection[aViewport] * vec4(FragPos, 1.0);
+    gl_ClipDistance[0] = clip.w + clip.x;
+    gl_ClipDistance[1] = clip.w - clip.x;
+    gl_ClipDistance[2] = clip.w + clip.y;
+    gl_ClipDistance[3] = clip.w - clip.y;
+    clip.xy = clip.xy * cellRect[aViewport].xy + cellRect[aViewport].zw * clip.w;
+    gl_Position = clip;
+}
@@ -0,0 +1,42 @@
+#version 330 core
+layout (location = 0) in vec4 aAxisRadius; // per instance: orbital plane normal, orbit radius
+layout (location = 1) in vec4 aColor;      // per instance
+layout (location = 2) in uint aViewport;   // per instance, the cell it is drawn in
+
+layout (std140) uniform GridFrame {
+    mat4 viewProjection[16];
+    vec4 viewPos[16];
+    vec4 cellRect[16];
+    vec4 lightPos;
+};
+uniform int segments;
+
+out vec4 vColor;
+out float gl_ClipDistance[4];
+
+// The circle in the xy plane turned so z points along the normal, as orbitPoint() in
+// ElectronOrbits.hpp, so the rings pass through the electrons placed on the CPU.
+// The ring is generated from gl_VertexID, so it needs no vertex buffer.
+void main() {
+    float angle = 6.28318530718 * float(gl_VertexID) / float(segments);
+    vec3 n = aAxisRadius.xyz;
+    vec2 p = aAxisRadius.w * vec2(cos(angle), sin(angle));
+    vec2 axis = vec2(-n.y, n.x);
+    float s = length(axis);
+    vec3 position = vec3(p, 0.0);
+    if (s >= 1e-6) {
+        axis /= s;
+        float c = n.z;
+        float kDotP = dot(axis, p);
+        position = vec3(p * c + axis * kDotP * (1.0 - c), (axis.x * p.y - axis.y * p.x) * s);
+    }
+
+    vColor = aColor;
+    vec4 clip = viewProjection[aViewport] * vec4(position, 1.0);
+    gl_ClipDistance[0] = clip.w + clip.x;
+    gl_ClipDistance[1] = clip.w - clip.x;
+    gl_ClipDistance[2] = clip.w + clip.y;
+    gl_ClipDistance[3] = clip.w - clip.y;
+    clip.xy = clip.xy * cellRect[aViewport].xy + cellRect[aViewport].zw * clip.w;
+    gl_Position = clip;
+}
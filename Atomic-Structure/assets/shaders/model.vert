@@ -1,6 +1,5 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;  // Matches sphere's vertex format
+layout (location = 0) in vec3 aPos;  // Matches sphere's vertex format (unit position == normal)
 
 uniform mat4 model;
 uniform mat4 view;
@@ -12,7 +11,7 @@ out vec3 Normal;
 void main()
 {
     FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;  // For correct normal matrix
+    Normal = mat3(transpose(inverse(model))) * aPos;  // For correct normal matrix
     
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
\ No newline at end of file
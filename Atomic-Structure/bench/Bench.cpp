@@ -0,0 +1,323 @@
+// Microbenchmarks and scaling runs of the CPU side of the atom view.
+//
+//   bench [--filter text] [--json results.json] [--quick] [--max-electrons N] [--threads N]
+//
+// Each benchmark is timed in samples of enough iterations to last a few tens of
+// milliseconds; the median and the fastest sample are reported per iteration, with the
+// hardware counters and heap allocations of the whole run divided by its iterations.
+// --json writes the same table for trend tracking.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "PerfCounters.hpp"
+#include "headers/AllocationTracker.hpp"
+#include "headers/AtomScene.hpp"
+#include "headers/ElectronOrbits.hpp"
+#include "headers/Elements.hpp"
+#include "headers/FrameCapture.hpp"
+#include "headers/RadialSolver.hpp"
+#include "headers/RayTracer.hpp"
+#include "headers/SoftwareRasterizer.hpp"
+#ifdef BENCH_SPHERE_MESH
+#include "headers/SphereMesh.hpp"
+#endif
+
+namespace {
+    struct Result {
+        std::string name;
+        double items;          // units of work per iteration (vertices, electrons, ...)
+        const char* unit;
+        long long iterations;  // over all samples
+        int samples;
+        double medianNs, minNs;  // per iteration
+        uint64_t counters[PERF_COUNTER_COUNT];  // over all iterations
+        uint64_t allocations;                   // heap allocations over all iterations
+        uint64_t check;          // result of the work, so it is not optimised away
+    };
+
+    struct Options {
+        std::string filter;
+        std::string jsonPath;
+        bool quick = false;
+        long long maxElectrons = 10000000;
+        int threads = 0;
+    };
+
+    Options options;
+    PerfCounters* counters = nullptr;
+    std::vector<Result> results;
+
+    double elapsedNs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    bool selected(const std::string& name) {
+        return options.filter.empty() || name.find(options.filter) != std::string::npos;
+    }
+
+    // Times body(), which does one iteration and returns a checksum. setup() runs once
+    // before the warm-up and is not timed
+    void run(const std::string& name, double items, const char* unit,
+        const std::function<uint64_t()>& body, const std::function<void()>& setup = nullptr) {
+        if (!selected(name)) return;
+        if (setup) setup();
+
+        const double targetNs = options.quick ? 5e6 : 4e7;
+        const int sampleCount = options.quick ? 3 : 7;
+
+        // warm-up, and a first guess of how many iterations make a sample
+        uint64_t check = 0;
+        auto start = std::chrono::steady_clock::now();
+        check += body();
+        double once = std::max(elapsedNs(start), 1.0);
+        long long perSample = std::max(1LL, (long long)(targetNs / once));
+
+        Result result = {};
+        result.name = name;
+        result.items = items;
+        result.unit = unit;
+        result.samples = sampleCount;
+        std::vector<double> sampleNs;
+        sampleNs.reserve(sampleCount);
+        uint64_t before[PERF_COUNTER_COUNT], after[PERF_COUNTER_COUNT];
+        counters->Read(before);
+        uint64_t allocationsBefore = AllocationTracker::GetCounts().allocations;
+        for (int s = 0; s < sampleCount; ++s) {
+            start = std::chrono::steady_clock::now();
+            for (long long i = 0; i < perSample; ++i) check += body();
+            sampleNs.push_back(elapsedNs(start) / perSample);
+            result.iterations += perSample;
+        }
+        result.allocations = AllocationTracker::GetCounts().allocations - allocationsBefore;
+        counters->Read(after);
+        for (int c = 0; c < PERF_COUNTER_COUNT; ++c) result.counters[c] = after[c] - before[c];
+
+        std::sort(sampleNs.begin(), sampleNs.end());
+        result.medianNs = sampleNs[sampleNs.size() / 2];
+        result.minNs = sampleNs.front();
+        result.check = check;
+        results.push_back(result);
+
+        double perIteration = 1.0 / result.iterations;
+        printf("%-34s %12.3f ms %12.3f ms %10.2f ns/%-9s", name.c_str(), result.medianNs * 1e-6,
+            result.minNs * 1e-6, result.medianNs / items, unit);
+        if (counters->Has(PERF_CYCLES)) printf(" %10.1f cyc/%s", result.counters[PERF_CYCLES] * perIteration / items, unit);
+        if (counters->Has(PERF_CACHE_MISSES)) printf(" %12.0f misses", result.counters[PERF_CACHE_MISSES] * perIteration);
+        if (result.allocations > 0) printf(" %10.1f allocs", result.allocations * perIteration);
+        printf("\n");
+        fflush(stdout);
+    }
+
+    // Electrons of the given element's layout, repeated to count with the planes spun so
+    // the copies do not overlap
+    std::vector<Electron> makeElectrons(const RadialSolver& solver, int atomicNumber, size_t count) {
+        std::vector<Electron> layout, electrons;
+        buildElectrons(solver.Get(atomicNumber), layout);
+        electrons.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            Electron e = layout[i % layout.size()];
+            float spin = 0.61803398875f * float(i / layout.size());
+            float x = e.normal[0], y = e.normal[1];
+            e.normal[0] = x * cosf(spin) - y * sinf(spin);
+            e.normal[1] = x * sinf(spin) + y * cosf(spin);
+            e.angle = fmodf(e.angle + 37.0f * spin, 360.0f);
+            electrons.push_back(e);
+        }
+        return electrons;
+    }
+
+    // Same scene and camera as submitScene() in Atomic-Structure.cpp shows for a single atom
+    void submitAtom(RenderBackend& renderer, const std::vector<Electron>& electrons) {
+        const RenderCamera camera = {
+            {0.0f, 0.0f, 3.0f}, {0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f},
+            45.0f, 0.1f, 100.0f
+        };
+        const float lightPos[3] = {2.0f, 5.0f, 2.0f};
+
+        renderer.SetLight(lightPos, true);
+        renderer.SetLighting(true);
+        renderer.BeginFrame(camera, kClearColor);
+        submitNucleus(renderer);
+        submitElectrons(renderer, electrons);
+        renderer.EndFrame();
+    }
+
+#ifdef BENCH_SPHERE_MESH
+    void benchSphereMeshes() {
+        const struct { SphereType type; const char* name; } types[] = {
+            { SphereType::UV, "uv" }, { SphereType::Icosphere, "icosphere" }, { SphereType::CubeSphere, "cubesphere" }
+        };
+        for (const auto& type : types) {
+            for (int sectors = 16; sectors <= 256; sectors *= 2) {
+                std::string name = std::string("sphere_mesh/") + type.name + "/" + std::to_string(sectors);
+                size_t vertexCount = SphereMesh(type.type, sectors, sectors).GetVertices().size();
+                // the CPU work of Sphere::createSphere: generate, analyse, narrow the indices
+                run(name, double(vertexCount), "vertex", [&]() {
+                    SphereMesh mesh(type.type, sectors, sectors);
+                    VertexCacheStats stats = mesh.Analyze();
+                    std::vector<uint16_t> shortIndices;
+                    if (mesh.FitsShortIndices()) shortIndices.assign(mesh.GetIndices().begin(), mesh.GetIndices().end());
+                    return uint64_t(stats.shaderInvocations) + shortIndices.size();
+                });
+            }
+        }
+    }
+#endif
+
+    void benchShells(RadialSolver& solver) {
+        run("shells/solve_all", kElementCount, "element", [&]() {
+            RadialSolver fresh;
+            fresh.Solve("", options.threads);
+            return uint64_t(fresh.Get(kElementCount).count);
+        });
+        run("shells/solve_element/26", 1, "element", []() {
+            ElementShells shells;
+            RadialSolver::SolveElement(26, shells);
+            return uint64_t(shells.count);
+        });
+        run("shells/solve_element/92", 1, "element", []() {
+            ElementShells shells;
+            RadialSolver::SolveElement(92, shells);
+            return uint64_t(shells.count);
+        });
+        std::vector<Electron> electrons;
+        run("shells/layout_all", kElementCount, "element", [&]() {
+            uint64_t total = 0;
+            for (int z = 1; z <= kElementCount; ++z) {
+                buildElectrons(solver.Get(z), electrons);
+                total += electrons.size();
+            }
+            return total;
+        });
+    }
+
+    void benchElectrons(const RadialSolver& solver) {
+        std::vector<Electron> electrons;
+        for (long long count = 1000; count <= options.maxElectrons; count *= 10) {
+            std::string suffix = "/" + std::to_string(count);
+            auto setup = [&]() { if (electrons.size() != size_t(count)) electrons = makeElectrons(solver, 92, size_t(count)); };
+            run("electrons/step" + suffix, double(count), "electron", [&]() {
+                advanceElectrons(electrons);
+                return uint64_t(electrons.back().angle);
+            }, setup);
+            // the per-frame placement the renderers do for every electron
+            run("electrons/orbit_points" + suffix, double(count), "electron", [&]() {
+                float sum = 0.0f;
+                for (const Electron& e : electrons) {
+                    float p[3];
+                    orbitPoint(e, e.angle, p);
+                    sum += p[0] + p[1] + p[2];
+                }
+                return uint64_t(fabsf(sum));
+            }, setup);
+        }
+        electrons.clear();
+        electrons.shrink_to_fit();
+    }
+
+    void benchFrames(const RadialSolver& solver) {
+        const int width = 640, height = 480;
+        const int elements[] = { 1, 26, 92 };
+        std::vector<Electron> electrons;
+        // the renderers are created only if their benchmarks run, a pool each
+        SoftwareRasterizer* rasterizer = nullptr;
+        for (int z : elements) {
+            run("frame/software/" + std::to_string(z), double(width) * height, "pixel", [&]() {
+                submitAtom(*rasterizer, electrons);
+                advanceElectrons(electrons);
+                return FrameStats::HashPixels(rasterizer->GetPixels(), 64);
+            }, [&]() {
+                if (!rasterizer) rasterizer = new SoftwareRasterizer(width, height, options.threads);
+                buildElectrons(solver.Get(z), electrons);
+            });
+        }
+        delete rasterizer;
+
+        RayTracer* tracer = nullptr;
+        run("frame/raytrace/26", double(width) * height, "pixel", [&]() {
+            submitAtom(*tracer, electrons);
+            advanceElectrons(electrons);
+            return FrameStats::HashPixels(tracer->GetPixels(), 64);
+        }, [&]() {
+            tracer = new RayTracer(width, height, options.threads);
+            RayTracer::Settings settings = tracer->GetSettings();
+            settings.samplesPerPixel = 1;
+            tracer->SetSettings(settings);
+            buildElectrons(solver.Get(26), electrons);
+        });
+        delete tracer;
+    }
+
+    void writeJson(const std::string& path) {
+        FILE* file = fopen(path.c_str(), "w");
+        if (!file) {
+            std::cout << "ERROR::BENCH::CANNOT_WRITE " << path << std::endl;
+            return;
+        }
+        char date[32];
+        time_t now = time(NULL);
+        strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+        fprintf(file, "{\n  \"version\": 1,\n  \"date\": \"%s\",\n  \"quick\": %s,\n  \"results\": [", date,
+            options.quick ? "true" : "false");
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            fprintf(file, "%s\n    {\"name\": \"%s\", \"items\": %.0f, \"unit\": \"%s\", \"iterations\": %lld, \"samples\": %d,"
+                " \"median_ns\": %.1f, \"min_ns\": %.1f, \"ns_per_item\": %.4f, \"allocations\": %.2f",
+                i ? "," : "", r.name.c_str(), r.items, r.unit, r.iterations, r.samples, r.medianNs, r.minNs, r.medianNs / r.items,
+                double(r.allocations) / r.iterations);
+            // per iteration, null where the counter is not available
+            for (int c = 0; c < PERF_COUNTER_COUNT; ++c) {
+                if (counters->Has(c)) fprintf(file, ", \"%s\": %.1f", PerfCounters::GetName(c), double(r.counters[c]) / r.iterations);
+                else fprintf(file, ", \"%s\": null", PerfCounters::GetName(c));
+            }
+            fprintf(file, "}");
+        }
+        fprintf(file, "\n  ]\n}\n");
+        fclose(file);
+        std::cout << "Wrote " << results.size() << " results to " << path << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--filter") && i + 1 < argc) options.filter = argv[++i];
+        else if (!strcmp(argv[i], "--json") && i + 1 < argc) options.jsonPath = argv[++i];
+        else if (!strcmp(argv[i], "--quick")) options.quick = true;
+        else if (!strcmp(argv[i], "--max-electrons") && i + 1 < argc) options.maxElectrons = std::max(atoll(argv[++i]), 1000LL);
+        else if (!strcmp(argv[i], "--threads") && i + 1 < argc) options.threads = std::max(atoi(argv[++i]), 0);
+        else {
+            std::cout << "Usage: " << argv[0] << " [--filter text] [--json results.json] [--quick]"
+                      << " [--max-electrons N] [--threads N]" << std::endl;
+            return 1;
+        }
+    }
+
+    // before any worker thread exists, so the counters follow the pools' threads
+    PerfCounters perf;
+    counters = &perf;
+    if (!perf.IsAvailable()) std::cout << "Hardware counters unavailable, timing only" << std::endl;
+
+    printf("%-34s %15s %15s %16s\n", "benchmark", "median", "min", "per item");
+#ifdef BENCH_SPHERE_MESH
+    benchSphereMeshes();
+#else
+    if (selected("sphere_mesh")) std::cout << "sphere_mesh: built without glm, skipped" << std::endl;
+#endif
+    RadialSolver solver;
+    solver.Solve("", options.threads);
+    benchShells(solver);
+    benchElectrons(solver);
+    benchFrames(solver);
+
+    if (!options.jsonPath.empty()) writeJson(options.jsonPath);
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include "PerfCounters.hpp"
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+    const uint64_t kEvents[PERF_COUNTER_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_REFERENCES,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+
+    int openCounter(uint64_t event) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = event;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;  // all perf_event_paranoid <= 2 allows
+        attr.exclude_hv = 1;
+        // this process on any CPU
+        return int(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+}
+
+PerfCounters::PerfCounters() {
+    for (int i = 0; i < PERF_COUNTER_COUNT; ++i) fds[i] = openCounter(kEvents[i]);
+}
+
+PerfCounters::~PerfCounters() {
+    for (int i = 0; i < PERF_COUNTER_COUNT; ++i) {
+        if (fds[i] >= 0) close(fds[i]);
+    }
+}
+
+void PerfCounters::Read(uint64_t out[PERF_COUNTER_COUNT]) const {
+    for (int i = 0; i < PERF_COUNTER_COUNT; ++i) {
+        out[i] = 0;
+        uint64_t value[3];  // count, time enabled, time running
+        if (fds[i] < 0 || read(fds[i], value, sizeof(value)) != ssize_t(sizeof(value))) continue;
+        if (value[2] == 0) continue;
+        out[i] = value[2] < value[1] ? uint64_t(double(value[0]) * value[1] / value[2]) : value[0];
+    }
+}
+#else
+PerfCounters::PerfCounters() {
+    for (int i = 0; i < PERF_COUNTER_COUNT; ++i) fds[i] = -1;
+}
+
+PerfCounters::~PerfCounters() {}
+
+void PerfCounters::Read(uint64_t out[PERF_COUNTER_COUNT]) const {
+    for (int i = 0; i < PERF_COUNTER_COUNT; ++i) out[i] = 0;
+}
+#endif
+
+bool PerfCounters::IsAvailable() const {
+    for (int i = 0; i < PERF_COUNTER_COUNT; ++i) {
+        if (Has(i)) return true;
+    }
+    return false;
+}
+
+const char* PerfCounters::GetName(int counter) {
+    static const char* const names[PERF_COUNTER_COUNT] = {
+        "cycles", "instructions", "cache_references", "cache_misses", "branch_misses"
+    };
+    return names[counter];
+}
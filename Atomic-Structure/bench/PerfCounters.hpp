@@ -0,0 +1,46 @@
+#pragma once
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <cstdint>
+
+enum PerfCounter {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_REFERENCES,
+    PERF_CACHE_MISSES,      // last level cache
+    PERF_BRANCH_MISSES,
+    PERF_COUNTER_COUNT
+};
+
+/**
+* Hardware event counters of this process through Linux perf_event, user space only.
+*
+* The counters are inherited by threads created after the constructor, so open them
+* before any WorkerPool exists and the pools' work is counted too. Each event has its own
+* counter (inherited counters cannot be read as a group), and a counter the kernel
+* multiplexes is scaled by how long it actually ran.
+*
+* Events the CPU, the VM or perf_event_paranoid do not allow are left out, and on other
+* platforms none are available; Has() tells which ones count.
+*/
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool IsAvailable() const;
+    bool Has(int counter) const { return fds[counter] >= 0; }
+    static const char* GetName(int counter);
+
+    // Events since construction; counters that are not available read 0
+    void Read(uint64_t out[PERF_COUNTER_COUNT]) const;
+
+private:
+    int fds[PERF_COUNTER_COUNT];
+};
+
+#endif
@@ -0,0 +1,121 @@
+/* Both ends of an atomrender frame ring, through the C API only.
+ *
+ *   frame_ring_demo produce NAME [element] [frames]   renders into the ring at full rate
+ *   frame_ring_demo consume NAME [out.ppm]            reads frames in place until the
+ *                                                     producer stops, keeps the last one
+ *
+ * Start the producer first; the consumer reports how many frames it saw and how many the
+ * producer overwrote while they were being read.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "headers/AtomApi.h"
+
+static double seconds(void) {
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    return (double)now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static int produce(const char *name, int element, int frames) {
+    AtomRenderer *renderer = atom_create(640, 480, ATOM_BACKEND_RASTER, 0);
+    if (!renderer || !atom_set_element(renderer, element) || !atom_open_ring(renderer, name, 4)) {
+        fprintf(stderr, "producer: %s\n", atom_last_error(renderer));
+        atom_destroy(renderer);
+        return 1;
+    }
+    double start = seconds();
+    for (int i = 0; i < frames; ++i) {
+        atom_step(renderer, 1);
+        atom_publish(renderer);
+    }
+    double elapsed = seconds() - start;
+    printf("published %d frames in %.2f s, %.0f fps\n", frames, elapsed, frames / elapsed);
+    atom_destroy(renderer);
+    return 0;
+}
+
+/* Copies the newest frame out as a PPM; 0 if the producer overwrote it meanwhile, -1 if
+   there is no frame or the file can't be written, which trying again won't change */
+static int save(AtomRing *ring, const char *output) {
+    AtomFrame frame;
+    if (!atom_ring_latest(ring, &frame)) return -1;
+    size_t size = (size_t)frame.width * frame.height * 3;
+    unsigned char *rgb = malloc(size);
+    if (!rgb) return -1;
+    for (int y = 0; y < frame.height; ++y) {
+        for (int x = 0; x < frame.width; ++x) {
+            memcpy(rgb + ((size_t)y * frame.width + x) * 3, frame.pixels + (size_t)y * frame.rowBytes + (size_t)x * 4, 3);
+        }
+    }
+    if (!atom_ring_still_valid(ring, &frame)) {
+        free(rgb);
+        return 0;
+    }
+    FILE *file = fopen(output, "wb");
+    int written = file != NULL;
+    if (file) {
+        fprintf(file, "P6\n%d %d\n255\n", frame.width, frame.height);
+        written = fwrite(rgb, 1, size, file) == size;
+        written = fclose(file) == 0 && written;
+    }
+    free(rgb);
+    if (!written) {
+        fprintf(stderr, "consumer: cannot write %s\n", output);
+        return -1;
+    }
+    printf("frame %llu written to %s\n", (unsigned long long)frame.frame, output);
+    return 1;
+}
+
+static int consume(const char *name, const char *output) {
+    AtomRing *ring = atom_ring_open(name);
+    if (!ring) {
+        fprintf(stderr, "consumer: no ring %s\n", name);
+        return 1;
+    }
+    AtomFrame frame;
+    unsigned long long seen = 0, torn = 0, last = ~0ull;
+    unsigned checksum = 0;
+    double idleSince = seconds();
+    while (seconds() - idleSince < 1.0) {
+        if (!atom_ring_latest(ring, &frame) || frame.frame == last) continue;
+        last = frame.frame;
+        idleSince = seconds();
+
+        /* the work on a frame, reading it straight out of the ring */
+        unsigned sum = 0;
+        for (int y = 0; y < frame.height; ++y) {
+            const uint8_t *row = frame.pixels + (size_t)y * frame.rowBytes;
+            for (int x = 0; x < frame.width * 4; ++x) sum += row[x];
+        }
+        if (atom_ring_still_valid(ring, &frame)) {
+            seen++;
+            checksum ^= sum;
+        } else {
+            torn++;  /* dropped */
+        }
+    }
+    printf("read %llu frames in place, %llu overwritten while read (checksum %08x)\n", seen, torn, checksum);
+    int saved = 1;
+    if (seen) {
+        while ((saved = save(ring, output)) == 0) {}  /* torn, the next try gets a newer frame */
+    }
+    atom_ring_close(ring);
+    return saved < 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 3 && strcmp(argv[1], "produce") == 0) {
+        return produce(argv[2], argc > 3 ? atoi(argv[3]) : 26, argc > 4 ? atoi(argv[4]) : 600);
+    }
+    if (argc >= 3 && strcmp(argv[1], "consume") == 0) {
+        return consume(argv[2], argc > 3 ? argv[3] : "ring.ppm");
+    }
+    fprintf(stderr, "usage: %s produce NAME [element] [frames] | consume NAME [out.ppm]\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,163 @@
+// Stands in for the browser viewer of `atom --serve`: connects to the WebSocket, decodes
+// every frame message with TileDeltaDecoder and reports what the stream costs.
+//
+//   stream_client [host:]port [frames] [last.ppm]
+//
+// A third of the way through it switches to iron, for the last third it keeps turning
+// the camera, so the report shows the electrons-only steady state next to frames where
+// everything changes.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "headers/TileDelta.hpp"
+
+namespace {
+    int connectTo(const std::string& host, int port) {
+        sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(uint16_t(port));
+        if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) return -1;
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    bool sendAll(int fd, const void* data, size_t size) {
+        const char* p = static_cast<const char*>(data);
+        while (size > 0) {
+            ssize_t sent = send(fd, p, size, 0);
+            if (sent <= 0) return false;
+            p += sent;
+            size -= size_t(sent);
+        }
+        return true;
+    }
+
+    bool receiveAll(int fd, void* data, size_t size) {
+        char* p = static_cast<char*>(data);
+        while (size > 0) {
+            ssize_t received = recv(fd, p, size, 0);
+            if (received <= 0) return false;
+            p += received;
+            size -= size_t(received);
+        }
+        return true;
+    }
+
+    // Client frames must be masked
+    bool sendText(int fd, const std::string& text) {
+        uint8_t frame[4 + 4 + 125];
+        if (text.size() > 125) return false;
+        frame[0] = 0x81;
+        frame[1] = uint8_t(0x80 | text.size());
+        uint32_t mask = uint32_t(rand());
+        memcpy(frame + 2, &mask, 4);
+        for (size_t i = 0; i < text.size(); ++i) frame[6 + i] = uint8_t(text[i]) ^ frame[2 + i % 4];
+        return sendAll(fd, frame, 6 + text.size());
+    }
+
+    // Next binary message, answering nothing else; false when the connection ends
+    bool receiveMessage(int fd, std::vector<uint8_t>& message) {
+        for (;;) {
+            uint8_t head[2];
+            if (!receiveAll(fd, head, 2)) return false;
+            uint64_t length = head[1] & 0x7F;
+            if (length >= 126) {
+                uint8_t extended[8];
+                int bytes = length == 126 ? 2 : 8;
+                if (!receiveAll(fd, extended, bytes)) return false;
+                length = 0;
+                for (int i = 0; i < bytes; ++i) length = (length << 8) | extended[i];
+            }
+            message.resize(size_t(length));
+            if (length && !receiveAll(fd, message.data(), message.size())) return false;
+            int opcode = head[0] & 0x0F;
+            if (opcode == 0x8) return false;
+            if (opcode == 0x2) return true;
+        }
+    }
+
+    struct Phase {
+        const char* name;
+        int frames, keyframes, tiles;
+        double bytes;
+    };
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s [host:]port [frames] [last.ppm]\n", argv[0]);
+        return 2;
+    }
+    std::string address = argv[1], host = "127.0.0.1";
+    size_t colon = address.rfind(':');
+    if (colon != std::string::npos) host = address.substr(0, colon);
+    int port = atoi(address.c_str() + (colon == std::string::npos ? 0 : colon + 1));
+    int frames = argc > 2 ? atoi(argv[2]) : 300;
+    const char* output = argc > 3 ? argv[3] : nullptr;
+
+    int fd = connectTo(host, port);
+    if (fd < 0) {
+        fprintf(stderr, "cannot connect to %s:%d\n", host.c_str(), port);
+        return 1;
+    }
+    std::string request = "GET /stream HTTP/1.1\r\nHost: " + host + "\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+        "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+    std::string response;
+    char c;
+    sendAll(fd, request.data(), request.size());
+    while (response.find("\r\n\r\n") == std::string::npos && recv(fd, &c, 1, 0) == 1) response += c;
+    // the accept value for this key is the one from RFC 6455
+    if (response.compare(0, 12, "HTTP/1.1 101") != 0 || response.find("s3pPLMBiTxaQ9kYGzzhZRbK+xOo=") == std::string::npos) {
+        fprintf(stderr, "handshake failed:\n%s\n", response.c_str());
+        return 1;
+    }
+
+    Phase phases[3] = { { "element 1", 0, 0, 0, 0.0 }, { "element 26", 0, 0, 0, 0.0 }, { "orbit 2 0", 0, 0, 0, 0.0 } };
+    TileDeltaDecoder decoder;
+    std::vector<uint8_t> message;
+    int rejected = 0;
+    for (int frame = 0; frame < frames && receiveMessage(fd, message); ++frame) {
+        if (message.size() < TileDeltaEncoder::kHeaderBytes) break;
+        int phase = frame * 3 / frames;
+        if (frame == frames / 3 || phase == 2) sendText(fd, phases[phase].name);
+        if (!decoder.Apply(message.data(), message.size())) rejected++;
+
+        Phase& p = phases[phase];
+        p.frames++;
+        p.bytes += double(message.size());
+        p.tiles += int(message[16] | (message[17] << 8));
+        p.keyframes += message[14] & TILE_DELTA_KEYFRAME;
+    }
+    for (const Phase& p : phases) {
+        if (p.frames == 0) continue;
+        printf("%-12s %4d frames, %3d keyframes, %8.1f KB/frame, %6.1f tiles/frame\n",
+            p.name, p.frames, p.keyframes, p.bytes / 1024.0 / p.frames, double(p.tiles) / p.frames);
+    }
+    printf("%d messages not applied\n", rejected);
+
+    if (output && decoder.HasFrame()) {
+        FILE* file = fopen(output, "wb");
+        if (file) {
+            fprintf(file, "P6\n%d %d\n255\n", decoder.GetWidth(), decoder.GetHeight());
+            const uint8_t* pixels = decoder.GetPixels();
+            for (int i = 0; i < decoder.GetWidth() * decoder.GetHeight(); ++i) fwrite(pixels + i * 4, 1, 3, file);
+            fclose(file);
+        }
+    }
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#ifndef ALLOCATION_TRACKER_HPP
+#define ALLOCATION_TRACKER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+struct AllocationCounts {
+    uint64_t allocations;
+    uint64_t frees;
+    uint64_t bytes;  // requested by the allocations
+};
+
+/**
+* Counts every heap allocation of the program. AllocationTracker.cpp replaces the global
+* operator new and delete (all forms) with counting wrappers around malloc, so linking it
+* in is all it takes; the counts are relaxed atomics and cost a few cycles per call.
+* Direct malloc calls and allocations inside GL drivers are not seen.
+*
+* The hook, when set, is called with the size of every allocation on the thread that
+* makes it. It must not allocate; allocations it makes anyway are not reported to it.
+* A breakpoint in the hook finds the code that allocates.
+*/
+class AllocationTracker {
+public:
+    typedef void (*Hook)(size_t size);
+
+    static AllocationCounts GetCounts();
+    static void SetHook(Hook hook);
+};
+
+/**
+* Heap allocations per frame. The first warmUpFrames frames fill caches and grow buffers
+* to their working size, so they are reported apart from the steady state, which should
+* not allocate at all.
+*/
+class FrameAllocations {
+public:
+    explicit FrameAllocations(uint64_t warmUpFrames = 10)
+        : warmUpFrames(warmUpFrames), frames(0), warmUpTotal(0), steadyTotal(0), steadyMax(0), allocatingFrames(0), start(0) {}
+
+    void BeginFrame() { start = AllocationTracker::GetCounts().allocations; }
+
+    // Returns the frame's allocations
+    uint64_t EndFrame() {
+        uint64_t count = AllocationTracker::GetCounts().allocations - start;
+        if (frames++ < warmUpFrames) warmUpTotal += count;
+        else {
+            steadyTotal += count;
+            if (count > steadyMax) steadyMax = count;
+            if (count > 0) allocatingFrames++;
+        }
+        return count;
+    }
+
+    uint64_t GetFrameCount() const { return frames; }
+    bool InSteadyState() const { return frames >= warmUpFrames; }
+
+    std::string Summary() const {
+        char line[200];
+        if (frames <= warmUpFrames) {
+            snprintf(line, sizeof(line), "Heap: %llu allocations in %llu frames", (unsigned long long)warmUpTotal,
+                (unsigned long long)frames);
+        }
+        else {
+            uint64_t steadyFrames = frames - warmUpFrames;
+            snprintf(line, sizeof(line), "Heap: %llu allocations in the first %llu frames, then %.2f per frame "
+                "(max %llu, %llu of %llu frames allocating)", (unsigned long long)warmUpTotal,
+                (unsigned long long)warmUpFrames, double(steadyTotal) / steadyFrames, (unsigned long long)steadyMax,
+                (unsigned long long)allocatingFrames, (unsigned long long)steadyFrames);
+        }
+        return line;
+    }
+
+private:
+    uint64_t warmUpFrames;
+    uint64_t frames;
+    uint64_t warmUpTotal, steadyTotal, steadyMax, allocatingFrames;
+    uint64_t start;
+};
+
+#endif
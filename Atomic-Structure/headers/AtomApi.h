@@ -0,0 +1,121 @@
+#ifndef ATOM_API_H
+#define ATOM_API_H
+
+/*
+* C interface of the atomrender library: the atom view without a window.
+*
+* A renderer holds one element (nucleus and electrons) or one loaded structure, a camera
+* and a CPU backend, and renders RGBA8 frames, top row first, either into memory the caller
+* owns or into a shared-memory ring that other processes read in place:
+*
+*   AtomRenderer *r = atom_create(640, 480, ATOM_BACKEND_RASTER, 0);
+*   atom_set_element(r, 26);
+*   atom_open_ring(r, "atom-frames", 3);
+*   for (;;) { atom_step(r, 1); atom_publish(r); }
+*
+* and in the consumer:
+*
+*   AtomRing *ring = atom_ring_open("atom-frames");
+*   AtomFrame frame;
+*   if (atom_ring_latest(ring, &frame)) {
+*       use(frame.pixels);
+*       if (!atom_ring_still_valid(ring, &frame)) drop();  // overwritten while in use
+*   }
+*
+* A renderer is used from one thread at a time; it renders with its own worker threads.
+* Functions returning int give 1 on success and 0 on failure, with atom_last_error() set.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(ATOM_API_EXPORTS)
+#    define ATOM_API __declspec(dllexport)
+#  else
+#    define ATOM_API __declspec(dllimport)
+#  endif
+#elif defined(__GNUC__)
+#  define ATOM_API __attribute__((visibility("default")))
+#else
+#  define ATOM_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct AtomRenderer AtomRenderer;
+typedef struct AtomRing AtomRing;
+
+typedef enum AtomBackend {
+    ATOM_BACKEND_RASTER = 0,   /* tiled rasterizer, interactive rates */
+    ATOM_BACKEND_RAYTRACE = 1  /* shadows and ambient occlusion, offline quality */
+} AtomBackend;
+
+typedef struct AtomCamera {
+    float eye[3];
+    float target[3];
+    float up[3];
+    float fovY;       /* degrees */
+    float nearPlane;
+    float farPlane;
+} AtomCamera;
+
+typedef struct AtomFrame {
+    const uint8_t *pixels;
+    int width;
+    int height;
+    size_t rowBytes;
+    uint64_t frame;     /* frames published before this one */
+    uint32_t slot;
+    uint64_t sequence;  /* for atom_ring_still_valid */
+} AtomFrame;
+
+/* threads = 0 uses every hardware thread. NULL if the size is not positive */
+ATOM_API AtomRenderer *atom_create(int width, int height, AtomBackend backend, int threads);
+ATOM_API void atom_destroy(AtomRenderer *renderer);
+/* Also closes the renderer's ring, whose frames have the old size */
+ATOM_API int atom_resize(AtomRenderer *renderer, int width, int height);
+
+/* The nucleus and electrons of element 1..118, with the default camera */
+ATOM_API int atom_set_element(AtomRenderer *renderer, int atomicNumber);
+/* A .atoms scene or an XYZ, PDB or CIF structure (its first frame), fitted by the camera */
+ATOM_API int atom_load_scene(AtomRenderer *renderer, const char *path);
+
+ATOM_API void atom_set_camera(AtomRenderer *renderer, const AtomCamera *camera);
+ATOM_API void atom_get_camera(const AtomRenderer *renderer, AtomCamera *camera);
+/* Back to the camera that frames the current element or scene */
+ATOM_API void atom_reset_camera(AtomRenderer *renderer);
+ATOM_API void atom_set_lighting(AtomRenderer *renderer, int enabled);
+
+/* Moves the electrons on by a number of frames of the view's animation */
+ATOM_API void atom_step(AtomRenderer *renderer, int frames);
+
+/* Renders into pixels, height rows of rowBytes >= 4 * width (0 for a shorter row, nothing
+   is written); NULL renders into the renderer's own buffer, which atom_pixels returns */
+ATOM_API int atom_render(AtomRenderer *renderer, uint8_t *pixels, size_t rowBytes);
+ATOM_API const uint8_t *atom_pixels(const AtomRenderer *renderer, size_t *rowBytes);
+
+/* Creates the shared-memory ring name (2..16 slots of the renderer's size) */
+ATOM_API int atom_open_ring(AtomRenderer *renderer, const char *name, int slots);
+/* Renders straight into the ring's next slot and publishes it */
+ATOM_API int atom_publish(AtomRenderer *renderer);
+ATOM_API void atom_close_ring(AtomRenderer *renderer);
+
+/* What the last failing call on renderer ran into; never NULL */
+ATOM_API const char *atom_last_error(const AtomRenderer *renderer);
+
+/* Consumer side, in any process: read-only mapping of a ring by name */
+ATOM_API AtomRing *atom_ring_open(const char *name);
+/* The newest complete frame, pixels in the ring itself. 0 before the first one */
+ATOM_API int atom_ring_latest(AtomRing *ring, AtomFrame *frame);
+/* 1 if the producer has not started overwriting frame yet; check after reading it */
+ATOM_API int atom_ring_still_valid(const AtomRing *ring, const AtomFrame *frame);
+ATOM_API void atom_ring_close(AtomRing *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+#ifndef ATOM_INSTANCES_HPP
+#define ATOM_INSTANCES_HPP
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include "shaders.hpp"
+#include "SceneFile.hpp"
+
+/**
+* Draws a whole structure (see SceneFile) as one instanced draw of a low-poly icosphere.
+* The scene's arrays become the instance buffers as they are, so a mapped file goes from
+* disk to the GPU with a single copy per array and no per-atom work on the CPU.
+* Colours come from the element table unless the scene overrides them. A periodic scene
+* can be drawn as a block of repeated unit cells, see SetRepeat().
+*/
+class AtomInstances {
+public:
+    AtomInstances(
+        const char* vertPath = "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\Atoms.vert",
+        const char* fragPath = "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\Atoms.frag");
+    ~AtomInstances();
+
+    AtomInstances(const AtomInstances&) = delete;
+    AtomInstances& operator=(const AtomInstances&) = delete;
+
+    // Uploads the scene; the view only has to stay valid for the duration of the call
+    void SetScene(const SceneView& scene);
+    // Re-uploads atoms [first, first + count) after they moved, e.g. the runs a
+    // TrajectoryPlayer reports; atoms points at the whole array
+    void UpdateAtoms(const SceneAtom* atoms, size_t first, size_t count);
+    size_t GetAtomCount() const { return atomCount; }
+
+    // Draws repeat[0] x repeat[1] x repeat[2] copies of the scene along the cell vectors
+    // (a, b, c). The copies are placed in the vertex shader, so the instance buffers stay
+    // the size of one cell however large the lattice gets.
+    bool SetRepeat(const float cell[9], const int repeat[3]);
+    size_t GetCellCount() const { return cellCount; }
+    // Sets cellA/B/C, repeatX/Y and cellCount on a program that repeats per-cell instances
+    // the same way (Atoms.vert, Bonds.vert)
+    void SetRepeatUniforms(const Shader& program) const;
+
+    // For passes that read the atoms straight from the instance buffers, e.g. BondInstances
+    GLuint GetAtomBuffer() const { return atomVBO; }
+    GLuint GetElementBuffer() const { return elementVBO; }
+    const glm::mat4& GetModel() const { return model; }
+
+    void Render(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPos,
+        const glm::vec3& lightPos);
+
+private:
+    GLuint VAO, meshVBO, meshEBO, atomVBO, elementVBO, colorVBO;
+    unsigned int meshIndexCount;
+    size_t atomCount;
+    glm::mat4 model;
+    glm::vec3 cellVectors[3];
+    int repeat[3];
+    size_t cellCount;
+
+    std::unique_ptr<Shader> shader;
+    bool initialized;
+};
+
+#endif
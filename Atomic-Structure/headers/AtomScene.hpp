@@ -0,0 +1,103 @@
+#pragma once
+#ifndef ATOM_SCENE_HPP
+#define ATOM_SCENE_HPP
+
+#include <cmath>
+#include <vector>
+#include "ElectronOrbits.hpp"
+#include "Elements.hpp"
+#include "PickBuffer.hpp"
+#include "RenderBackend.hpp"
+#include "SceneFile.hpp"
+
+/**
+* The atom view's primitives as RenderBackend calls: the nucleus, the electrons with their
+* orbits and the atoms of a loaded structure. The GLUT software path, the benchmarks and
+* the embeddable renderer all submit through these, so they draw the same picture. Every
+* primitive carries its pick ID; backends without picking ignore it.
+*/
+
+// Pre-defined positions for nucleus particles (protons/neutrons)
+// Each row is a 3D coordinate {x, y, z}
+const float kNucleusPositions[][3] = {
+    {0.0f, 0.0f, 0.0f},     // Center
+    {0.12f, 0.12f, 0.12f},  // Upper octant 1
+    {-0.12f, 0.12f, 0.12f}, // Upper octant 2
+    {0.12f, -0.12f, 0.12f}, // Lower octant 1
+    {-0.12f, -0.12f, 0.12f},// Lower octant 2
+    {0.12f, 0.12f, -0.12f}, // Upper octant 3
+    {-0.12f, 0.12f, -0.12f},// Upper octant 4
+    {0.12f, -0.12f, -0.12f},// Lower octant 3
+    {-0.12f, -0.12f, -0.12f},// Lower octant 4
+    {0.16f, 0.0f, 0.0f},    // Along x-axis
+    {-0.16f, 0.0f, 0.0f},   // Along x-axis
+    {0.0f, 0.16f, 0.0f},    // Along y-axis
+    {0.0f, -0.16f, 0.0f},   // Along y-axis
+    {0.0f, 0.0f, 0.16f},    // Along z-axis
+    {0.0f, 0.0f, -0.16f}    // Along z-axis
+};
+const size_t kNucleonCount = sizeof(kNucleusPositions) / sizeof(kNucleusPositions[0]);
+
+const float kNucleusColor[3] = {0.8f, 0.3f, 0.2f};
+const float kClearColor[3] = {0.05f, 0.05f, 0.05f};
+
+// Atom i of scene in world space, with the scene transform applied (uniform scale assumed)
+inline void sceneAtomWorld(const SceneView& scene, size_t i, float center[3], float& radius, float color[3]) {
+    const SceneAtom& atom = scene.atoms[i];
+    const float* m = scene.transform;
+    for (int r = 0; r < 3; r++) {
+        center[r] = m[r]*atom.position[0] + m[4+r]*atom.position[1] + m[8+r]*atom.position[2] + m[12+r];
+    }
+    radius = atom.radius * sqrtf(m[0]*m[0] + m[1]*m[1] + m[2]*m[2]);
+
+    uint32_t rgba = scene.colors ? scene.colors[i] : 0;
+    if (rgba >> 24) {  // alpha set: per-atom override, bytes are r, g, b, a in memory
+        color[0] = (rgba & 0xFF) / 255.0f;
+        color[1] = ((rgba >> 8) & 0xFF) / 255.0f;
+        color[2] = ((rgba >> 16) & 0xFF) / 255.0f;
+    } else {
+        const float* c = GetElement(scene.elements[i]).color;
+        color[0] = c[0]; color[1] = c[1]; color[2] = c[2];
+    }
+}
+
+// The atoms of scene, moved by offset (a repeated cell)
+inline void submitSceneAtoms(RenderBackend& renderer, const SceneView& scene, const float offset[3]) {
+    for (size_t i = 0; i < scene.atomCount; i++) {
+        float center[3], radius, color[3];
+        sceneAtomWorld(scene, i, center, radius, color);
+        for (int k = 0; k < 3; k++) center[k] += offset[k];
+        renderer.SetPickID(MakePickID(PickKind::Atom, uint32_t(i)));
+        renderer.DrawSphere(center, radius, color);
+    }
+}
+
+inline void submitNucleus(RenderBackend& renderer) {
+    for (size_t i = 0; i < kNucleonCount; i++) {
+        renderer.SetPickID(MakePickID(PickKind::Nucleus, uint32_t(i)));
+        renderer.DrawSphere(kNucleusPositions[i], 0.1f, kNucleusColor);
+    }
+}
+
+// Each electron and its orbit, the orbit as 60 dimmed segments
+inline void submitElectrons(RenderBackend& renderer, const std::vector<Electron>& electrons) {
+    for (size_t n = 0; n < electrons.size(); n++) {
+        const Electron& e = electrons[n];
+        float center[3];
+        orbitPoint(e, e.angle, center);
+        renderer.SetPickID(MakePickID(PickKind::Electron, uint32_t(n)));
+        renderer.DrawSphere(center, 0.03f, e.color);
+        renderer.SetPickID(0);
+
+        float orbitColor[3] = {e.color[0]*0.2f, e.color[1]*0.2f, e.color[2]*0.2f};
+        float previous[3], current[3];
+        orbitPoint(e, 0.0f, previous);
+        for (int i = 1; i <= 60; i++) {
+            orbitPoint(e, i * 6.0f, current);
+            renderer.DrawLine(previous, current, orbitColor);
+            previous[0] = current[0]; previous[1] = current[1]; previous[2] = current[2];
+        }
+    }
+}
+
+#endif
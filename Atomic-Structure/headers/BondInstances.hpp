@@ -0,0 +1,53 @@
+#pragma once
+#ifndef BOND_INSTANCES_HPP
+#define BOND_INSTANCES_HPP
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+#include "shaders.hpp"
+#include "AtomInstances.hpp"
+#include "Bonds.hpp"
+
+/**
+* Draws the bonds of an AtomInstances scene as one instanced draw of a unit cylinder (see
+* CylinderMesh). An instance is only the pair of atom indices; the vertex shader fetches
+* both ends from the atoms' own instance buffers through texture buffers, so moving atoms
+* (UpdateAtoms) moves their bonds without touching the bond buffer. Each half of a bond
+* takes the colour of the atom at its end. Periodic repetition follows the atoms'.
+*/
+class BondInstances {
+public:
+    BondInstances(const AtomInstances& atoms,
+        const char* vertPath = "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\Bonds.vert",
+        const char* fragPath = "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\Bonds.frag");
+    ~BondInstances();
+
+    BondInstances(const BondInstances&) = delete;
+    BondInstances& operator=(const BondInstances&) = delete;
+
+    // Uploads the bonds; call again whenever BondFinder reports a change
+    void SetBonds(const std::vector<Bond>& bonds);
+    size_t GetBondCount() const { return bondCount; }
+
+    void SetRadius(float radius) { bondRadius = radius; }
+
+    void Render(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPos,
+        const glm::vec3& lightPos);
+
+private:
+    const AtomInstances& atoms;
+    GLuint VAO, meshVBO, meshEBO, bondVBO;
+    GLuint atomTexture, elementTexture;
+    unsigned int meshIndexCount;
+    size_t bondCount;
+    size_t bondCapacity;
+    size_t divisor;
+    float bondRadius;
+
+    std::unique_ptr<Shader> shader;
+    bool initialized;
+};
+
+#endif
@@ -0,0 +1,75 @@
+#pragma once
+#ifndef BONDS_HPP
+#define BONDS_HPP
+
+#include <cstdint>
+#include <vector>
+#include "FrameArena.hpp"
+#include "SceneFile.hpp"
+#include "WorkerPool.hpp"
+
+// Two bonded atoms, a < b
+struct Bond {
+    uint32_t a, b;
+};
+
+/**
+* Finds the bonds of a scene: atom pairs closer than tolerance x the sum of their covalent
+* radii.
+*
+* Atoms are binned into a hashed grid whose cells are as wide as the longest possible bond,
+* so each atom only looks at the 27 cells around its own. The grid is a counting sort of
+* the atoms by cell hash (two flat arrays, no per-cell allocation), which keeps it compact
+* for sparse scenes too; hash collisions only cost extra distance tests. Threads of a
+* WorkerPool take runs of atoms.
+*
+* The search keeps every pair within the cutoff plus a skin as candidates. After atoms move
+* (trajectory frames), Update() re-checks only the candidates' distances, and searches
+* again only once some atom has moved more than half the skin since the last search, the
+* usual Verlet list scheme.
+*/
+class BondFinder {
+public:
+    explicit BondFinder(int threads = 0, float tolerance = 1.2f, float skin = 0.6f);
+
+    BondFinder(const BondFinder&) = delete;
+    BondFinder& operator=(const BondFinder&) = delete;
+
+    // Full search
+    void Build(const SceneView& scene);
+    // After the atoms in moved changed position; returns true if the bonds changed
+    bool Update(const SceneView& scene, const std::vector<AtomRange>& moved);
+
+    // Sorted by a
+    const std::vector<Bond>& GetBonds() const { return bonds; }
+    size_t GetCandidateCount() const { return candidates.size(); }
+    // Time of the last Build()/Update() and whether it had to search
+    double GetLastMs() const { return lastMs; }
+    bool LastSearched() const { return lastSearched; }
+
+private:
+    void search(const SceneView& scene);
+    void filter(const SceneView& scene);
+
+    WorkerPool pool;
+    float tolerance;
+    float skin;
+
+    std::vector<Bond> candidates;
+    std::vector<Bond> bonds;
+    std::vector<Bond> previousBonds;     // Update()'s copy to compare with, kept for its capacity
+    std::vector<float> radii;            // covalent radius per atom
+    std::vector<float> searchPositions;  // x y z per atom at the last search
+
+    // hashed grid: bucket k holds cellAtoms[cellStart[k] .. cellStart[k + 1])
+    std::vector<uint32_t> keys;
+    std::vector<uint32_t> cellStart;
+    std::vector<uint32_t> cellAtoms;
+    std::vector<std::vector<Bond>> jobResults;
+    FrameArena scratch;                  // reset by every Build()/Update()
+
+    double lastMs;
+    bool lastSearched;
+};
+
+#endif
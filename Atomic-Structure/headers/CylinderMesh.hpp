@@ -0,0 +1,24 @@
+#pragma once
+#ifndef CYLINDER_MESH_HPP
+#define CYLINDER_MESH_HPP
+
+#include <cstdint>
+#include <vector>
+#include "SphereMesh.hpp"
+
+// Unit cylinder for bonds: radius 1 around the z axis from z = 0 to z = 1, open at both
+// ends because the atoms cover them. Vertices use the compressed SphereVertex layout; the
+// normal is (x, y, 0) and is rebuilt in the vertex shader, the way spheres rebuild theirs.
+class CylinderMesh {
+public:
+    explicit CylinderMesh(int sectors = 12);
+
+    const std::vector<SphereVertex>& GetVertices() const { return vertices; }
+    const std::vector<uint16_t>& GetIndices() const { return indices; }
+
+private:
+    std::vector<SphereVertex> vertices;
+    std::vector<uint16_t> indices;
+};
+
+#endif
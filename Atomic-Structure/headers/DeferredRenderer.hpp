@@ -0,0 +1,78 @@
+#pragma once
+#ifndef DEFERRED_RENDERER_HPP
+#define DEFERRED_RENDERER_HPP
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+#include "shaders.hpp"
+
+// Matches the std430 PointLight struct in TiledLighting.comp
+struct PointLight {
+    glm::vec4 positionRadius; // world position, radius of influence
+    glm::vec4 color;          // rgb, intensity
+};
+
+/**
+* Deferred shading with tiled light culling.
+*
+* Opaque geometry is drawn once into a G-buffer (position, normal, albedo + specular),
+* using GBuffer.frag / GroundGBuffer.frag instead of the forward fragment shaders.
+* A compute pass then splits the screen into 16x16 tiles, culls the light list against
+* each tile's depth range and shades every pixel with its tile's lights only, so cost
+* follows pixels x lights-per-tile instead of objects x lights.
+*
+* Usage per frame:
+*   BeginGeometryPass();  draw spheres / ground;  EndGeometryPass();
+*   LightingPass(view, projection, viewPos);  // writes to the default framebuffer
+*   draw unlit forward objects (electrons, orbits) on top, the depth buffer is kept.
+*/
+class DeferredRenderer {
+public:
+    static const int kTileSize = 16; // must match TILE_SIZE in TiledLighting.comp
+
+    DeferredRenderer(int width, int height,
+        const char* lightingPath = "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\TiledLighting.comp",
+        const char* presentVertPath = "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\Fullscreen.vert",
+        const char* presentFragPath = "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\Present.frag");
+    ~DeferredRenderer();
+
+    DeferredRenderer(const DeferredRenderer&) = delete;
+    DeferredRenderer& operator=(const DeferredRenderer&) = delete;
+
+    void Resize(int width, int height);
+
+    // The scene's key light is just another entry, e.g. {(2,5,2), 50} white.
+    void ClearLights() { lights.clear(); }
+    void AddLight(const glm::vec3& position, float radius, const glm::vec3& color, float intensity = 1.0f);
+    const std::vector<PointLight>& GetLights() const { return lights; }
+
+    void BeginGeometryPass();
+    void EndGeometryPass();
+    void LightingPass(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPos);
+
+    void SetClearColor(const glm::vec3& color) { clearColor = color; }
+    GLuint GetDepthTexture() const { return gDepth; }
+
+private:
+    void createTargets();
+    void destroyTargets();
+    void uploadLights();
+
+    int width, height;
+    GLuint gBuffer;
+    GLuint gPosition, gNormal, gAlbedo, gDepth;
+    GLuint litColor;      // rgba16f output of the compute pass
+    GLuint lightBuffer;   // SSBO
+    size_t lightCapacity; // in lights
+    GLuint emptyVAO;      // core profile needs a VAO bound even for the attribute-less fullscreen triangle
+
+    std::unique_ptr<ComputeShader> lightingShader;
+    std::unique_ptr<Shader> presentShader;
+    std::vector<PointLight> lights;
+    glm::vec3 clearColor;
+    bool initialized;
+};
+
+#endif
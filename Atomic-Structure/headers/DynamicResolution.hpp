@@ -0,0 +1,91 @@
+#pragma once
+#ifndef DYNAMIC_RESOLUTION_HPP
+#define DYNAMIC_RESOLUTION_HPP
+
+/**
+* Renders the scene below the window's resolution when the GPU can't keep up, and scales it
+* back up with a sharpening filter.
+*
+* Begin()/End() bracket the frame with a GL_TIME_ELAPSED query. The results are read a few
+* frames later, when they are ready, so timing never stalls the pipeline. Every few frames
+* the scale moves toward the budget: fragment cost goes with the pixel count, so a frame that
+* takes t ms at scale s should take about budget ms at s * sqrt(budget / t). It drops at
+* once when a frame is over budget and climbs back in small steps once frames are well
+* under it, so it doesn't oscillate around the threshold.
+*
+* While scaled, Begin() binds an offscreen target and the scene draws into its bottom-left
+* GetRenderWidth() x GetRenderHeight() pixels. The target is allocated at window size, so
+* changing the scale doesn't reallocate anything. End() stretches those pixels over the
+* window with bilinear filtering and an unsharp mask. The mask is limited to the range of
+* the neighbouring pixels so edges don't get halos. At full scale the scene draws straight
+* into the window and only the timer query remains.
+*
+* GL entry points come from the given loader like OffscreenCapture's. Needs GL 3.0 or
+* ARB_framebuffer_object, plus GL 3.3 or ARB_timer_query to adapt; without the timer the
+* scale stays at 1.
+*/
+class DynamicResolution {
+public:
+    typedef void (*GLProc)();
+    typedef GLProc (*ProcLoader)(const char* name);
+
+    DynamicResolution(int width, int height, ProcLoader loader, float budgetMs = 16.7f, float minScale = 0.5f);
+    ~DynamicResolution();
+
+    DynamicResolution(const DynamicResolution&) = delete;
+    DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+    bool IsSupported() const { return supported; }
+    // Window size
+    void Resize(int width, int height);
+
+    void SetBudget(float ms) { budgetMs = ms; }
+    float GetBudget() const { return budgetMs; }
+    float GetScale() const { return scale; }
+    // Smoothed GPU time of the recent frames, 0 until the first result is in
+    float GetGpuMs() const { return gpuMs; }
+
+    // Size the scene is drawn at this frame
+    int GetRenderWidth() const { return renderWidth; }
+    int GetRenderHeight() const { return renderHeight; }
+    // Where the scene is drawn: the offscreen target while scaled, otherwise the window (0)
+    unsigned int GetFramebuffer() const;
+
+    // Starts timing; binds the target and sets the viewport to the render size
+    void Begin();
+    // Stops timing; when scaled, upscales the frame into the window
+    void End();
+
+private:
+    void createTarget();
+    void destroyTarget();
+    bool buildProgram();
+    void collectTimings();
+    void adapt();
+    void upscale();
+
+    int width, height;
+    int renderWidth, renderHeight;
+    bool supported;
+    bool timed;
+
+    float budgetMs;
+    float minScale;
+    float scale;
+    float gpuMs;
+    int framesSinceChange;
+
+    unsigned int fbo, colorTexture, depthBuffer;
+    unsigned int program;
+    bool programFailed;
+    int frameLocation, texelLocation, limitLocation, sharpnessLocation;
+
+    static const int kQueries = 4;
+    unsigned int queries[kQueries];
+    int queryHead;     // next query to start
+    int queryPending;  // started but not read back
+    int staleQueries;  // pending ones timed before the last scale change
+    bool queryActive;  // between Begin() and End()
+};
+
+#endif
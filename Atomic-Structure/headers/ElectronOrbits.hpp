@@ -0,0 +1,156 @@
+#pragma once
+#ifndef ELECTRON_ORBITS_HPP
+#define ELECTRON_ORBITS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "RadialSolver.hpp"
+
+/**
+* The animated atom's electrons: how an element's solved subshells become circular orbits,
+* how they move each frame, and where a point of an orbit lies. Header only and free of
+* GL, so the GLUT view and the benchmarks run the same code.
+*/
+
+// Structure to hold properties of each electron
+struct Electron {
+    float radius;    // Distance from nucleus (orbital radius)
+    float angle;     // Current position in the orbital (in degrees)
+    float speed;     // Rotation speed in degrees per frame
+    float normal[3]; // Vector perpendicular to orbital plane (defines orientation)
+    float color[3];  // RGB color values for the electron
+    int shell;       // principal quantum number n
+    int l;           // angular momentum of its subshell
+};
+
+const double kOrbitPi = 3.14159265358979323846;
+
+// <r> in bohr maps linearly onto the orbit radius, so hydrogen's 1s (1.5 bohr) stays near
+// the old innermost 1.2, and uranium's 1s clears the nucleus. A subshell the model barely
+// binds is kept in view
+inline float orbitRadius(float meanRadius) {
+    return std::min(0.55f + 0.45f * meanRadius, 6.0f);
+}
+
+// Angular speed is the classical v / r with v = sqrt(2|E|), relative to hydrogen's 1s
+// (which keeps the old 45). The fourth root keeps uranium's 1s from blurring
+inline float orbitSpeed(float energy, float meanRadius) {
+    const float hydrogenRate = 1.0f / 1.5f;
+    float rate = sqrtf(2.0f * fabsf(energy)) / meanRadius;
+    return std::min(std::max(45.0f * powf(rate / hydrogenRate, 0.25f), 5.0f), 180.0f);
+}
+
+// Replaces electrons with one per electron of the configuration, shell by shell
+inline void buildElectrons(const ElementShells& config, std::vector<Electron>& electrons) {
+    // rgb for the shells
+    const float shellColors[7][3] = {
+        {0.2f, 0.4f, 1.0f}, // Shell 1: Blue
+        {0.2f, 0.8f, 0.8f}, // Shell 2: Cyan
+        {0.2f, 0.8f, 0.2f}, // Shell 3: Green
+        {0.8f, 0.8f, 0.2f}, // Shell 4: Yellow
+        {1.0f, 0.6f, 0.2f}, // Shell 5: Orange
+        {1.0f, 0.2f, 0.2f}, // Shell 6: Red
+        {0.8f, 0.2f, 0.8f}  // Shell 7: Magenta
+    };
+
+    // Clearing any existing electrons; the vector keeps its memory across element switches
+    electrons.clear();
+    int total = 0;
+    for (int k = 0; k < config.count; k++) total += config.subshells[k].electrons;
+    electrons.reserve(total);
+
+    for (int shell = 1; shell <= 7; shell++) {
+        // All subshells of one n share its orbit planes and colour
+        int electronsInShell = 0;
+        for (int k = 0; k < config.count; k++) {
+            if (config.subshells[k].n == shell) electronsInShell += config.subshells[k].electrons;
+        }
+
+        // color for this shell
+        int colorIndex = (shell - 1) % 7;
+        float r = shellColors[colorIndex][0];
+        float g = shellColors[colorIndex][1];
+        float b = shellColors[colorIndex][2];
+
+        int i = 0;  // index within the shell
+        for (int k = 0; k < config.count; k++) {
+            const Subshell& sub = config.subshells[k];
+            if (sub.n != shell) continue;
+
+            float radius = orbitRadius(sub.meanRadius);
+            float speed = orbitSpeed(sub.energy, sub.meanRadius);
+
+            // Creating electrons for this subshell
+            for (int j = 0; j < sub.electrons; j++, i++) {
+                Electron e;
+
+                e.radius = radius;
+                e.speed = speed;
+
+                // Calculate positioning angles for 3D distribution
+                float angleStep = 180.0f / electronsInShell;
+                float phi = i * angleStep;  // Vertical angle
+
+                // Theta creates variation in horizontal angle based on shell number
+                float theta = (i % shell) * (180.0f / shell) + (shell * 20.0f);
+
+                // Initial angle in orbital path
+                e.angle = (360.0f / electronsInShell) * i;
+
+                // Calculate normal vector for orbital plane orientation
+                e.normal[0] = sin(phi * kOrbitPi/180) * cos(theta * kOrbitPi/180);
+                e.normal[1] = sin(phi * kOrbitPi/180) * sin(theta * kOrbitPi/180);
+                e.normal[2] = cos(phi * kOrbitPi/180);
+
+                // Normalize the vector to ensure unit length
+                float length = sqrt(e.normal[0]*e.normal[0] +
+                                   e.normal[1]*e.normal[1] +
+                                   e.normal[2]*e.normal[2]);
+                e.normal[0] /= length;
+                e.normal[1] /= length;
+                e.normal[2] /= length;
+
+                // Assign color from the palette
+                e.color[0] = r;
+                e.color[1] = g;
+                e.color[2] = b;
+                e.shell = shell;
+                e.l = sub.l;
+
+                // Add the electron to our collection
+                electrons.push_back(e);
+            }
+        }
+    }
+}
+
+// Advance the animation by one frame
+inline void advanceElectrons(std::vector<Electron>& electrons) {
+    for (auto &e : electrons) {
+        e.angle += e.speed * 0.025f;  // 0.016 seconds = ~60 FPS
+        if (e.angle > 360) e.angle -= 360;  // Keep angle in 0-360 range
+    }
+}
+
+// Where the transforms in drawElectron/drawOrbit put the orbit point at angleDeg
+inline void orbitPoint(const Electron &e, float angleDeg, float out[3]) {
+    float a = angleDeg * kOrbitPi/180;
+    float p[3] = {e.radius * cosf(a), e.radius * sinf(a), 0.0f};
+
+    // glRotatef(acos(n.z), -n.y, n.x, 0) via Rodrigues; sin(acos(n.z)) is the axis length
+    float ax = -e.normal[1], ay = e.normal[0];
+    float s = sqrtf(ax*ax + ay*ay);
+    if (s < 1e-6f) {  // normal along z, GL leaves the orbit in the xy plane
+        out[0] = p[0]; out[1] = p[1]; out[2] = p[2];
+        return;
+    }
+    ax /= s; ay /= s;
+    float c = e.normal[2];
+    float kDotP = ax*p[0] + ay*p[1];
+    out[0] = p[0]*c + (ay*p[2]) * s + ax*kDotP*(1 - c);
+    out[1] = p[1]*c + (-ax*p[2]) * s + ay*kDotP*(1 - c);
+    out[2] = p[2]*c + (ax*p[1] - ay*p[0]) * s;
+}
+
+#endif
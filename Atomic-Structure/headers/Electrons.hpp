@@ -15,6 +15,14 @@ public:
         const glm::vec3& viewPos);
     //~Electron();
 
+    // Current world position on the orbit, e.g. to place a glow light at the electron
+    glm::vec3 GetPosition() const;
+    const glm::vec3& GetColor() const { return m_color; }
+    float GetOrbitRadius() const { return m_orbitRadius; }
+    const glm::vec3& GetOrbitalPlaneNormal() const { return m_orbitalPlaneNormal; }
+    // Written to the pick ID output, see PickBuffer.hpp
+    void SetPickID(unsigned int id) { m_pickID = id; }
+
 private:
     Sphere m_sphere;
     float m_orbitRadius;
@@ -22,4 +30,5 @@ private:
     float m_currentAngle;
     glm::vec3 m_orbitalPlaneNormal;
     glm::vec3 m_color;
+    unsigned int m_pickID;
 };
\ No newline at end of file
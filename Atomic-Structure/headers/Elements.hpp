@@ -0,0 +1,26 @@
+#pragma once
+#ifndef ELEMENTS_HPP
+#define ELEMENTS_HPP
+
+#include <cstddef>
+
+/**
+* Periodic table data for drawing structures: symbol, covalent radius (Cordero et al. 2008,
+* in angstrom; 1.5 where no value is known) and the usual Jmol/CPK colour.
+*/
+struct ElementInfo {
+    const char* symbol;
+    float covalentRadius;
+    float color[3];
+};
+
+static const int kElementCount = 118;
+
+// atomicNumber 1-118; anything else gives an "unknown element" entry (symbol "X")
+const ElementInfo& GetElement(int atomicNumber);
+
+// Atomic number for a symbol in any case ("Fe", "FE", "fe"), 0 if unknown. Only the
+// leading letters count, so PDB/CIF labels such as "Fe2" or "C1A" work as well.
+int ElementFromSymbol(const char* symbol, size_t length);
+
+#endif
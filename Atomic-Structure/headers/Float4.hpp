@@ -0,0 +1,78 @@
+#pragma once
+#ifndef FLOAT4_HPP
+#define FLOAT4_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+/**
+* Four lanes of floats for the CPU renderers: SSE2 when the target has it, a plain loop
+* otherwise (or when RASTER_NO_SIMD is defined). Comparisons return a 4-bit lane mask.
+*/
+
+#if !defined(RASTER_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+
+struct F4 {
+    __m128 v;
+    F4() {}
+    F4(__m128 v) : v(v) {}
+    F4(float f) : v(_mm_set1_ps(f)) {}
+    F4(float a, float b, float c, float d) : v(_mm_setr_ps(a, b, c, d)) {}
+    static F4 ramp(float base, float step) { return _mm_setr_ps(base, base + step, base + 2.0f * step, base + 3.0f * step); }
+    static F4 load(const float* p) { return _mm_loadu_ps(p); }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+    float operator[](int i) const { float out[4]; _mm_storeu_ps(out, v); return out[i]; }
+};
+inline F4 operator+(F4 a, F4 b) { return _mm_add_ps(a.v, b.v); }
+inline F4 operator-(F4 a, F4 b) { return _mm_sub_ps(a.v, b.v); }
+inline F4 operator*(F4 a, F4 b) { return _mm_mul_ps(a.v, b.v); }
+inline F4 operator/(F4 a, F4 b) { return _mm_div_ps(a.v, b.v); }
+inline F4 sqrt4(F4 a) { return _mm_sqrt_ps(a.v); }
+inline F4 min4(F4 a, F4 b) { return _mm_min_ps(a.v, b.v); }
+inline F4 max4(F4 a, F4 b) { return _mm_max_ps(a.v, b.v); }
+inline int ge(F4 a, F4 b) { return _mm_movemask_ps(_mm_cmpge_ps(a.v, b.v)); }
+inline int gt(F4 a, F4 b) { return _mm_movemask_ps(_mm_cmpgt_ps(a.v, b.v)); }
+inline int lt(F4 a, F4 b) { return _mm_movemask_ps(_mm_cmplt_ps(a.v, b.v)); }
+// lanes of b where mask is set, a elsewhere
+inline F4 select(int mask, F4 a, F4 b) {
+    static const __m128 lanes[16] = {
+#define F4_LANE(m) _mm_castsi128_ps(_mm_setr_epi32((m) & 1 ? -1 : 0, (m) & 2 ? -1 : 0, (m) & 4 ? -1 : 0, (m) & 8 ? -1 : 0))
+        F4_LANE(0), F4_LANE(1), F4_LANE(2), F4_LANE(3), F4_LANE(4), F4_LANE(5), F4_LANE(6), F4_LANE(7),
+        F4_LANE(8), F4_LANE(9), F4_LANE(10), F4_LANE(11), F4_LANE(12), F4_LANE(13), F4_LANE(14), F4_LANE(15)
+#undef F4_LANE
+    };
+    __m128 m = lanes[mask & 15];
+    return _mm_or_ps(_mm_and_ps(m, b.v), _mm_andnot_ps(m, a.v));
+}
+
+#else
+
+struct F4 {
+    float v[4];
+    F4() {}
+    F4(float f) { v[0] = v[1] = v[2] = v[3] = f; }
+    F4(float a, float b, float c, float d) { v[0] = a; v[1] = b; v[2] = c; v[3] = d; }
+    static F4 ramp(float base, float step) { F4 r; for (int i = 0; i < 4; ++i) r.v[i] = base + i * step; return r; }
+    static F4 load(const float* p) { F4 r; memcpy(r.v, p, sizeof(r.v)); return r; }
+    void store(float* p) const { memcpy(p, v, sizeof(v)); }
+    float operator[](int i) const { return v[i]; }
+};
+#define F4_BINARY(name, expr) inline F4 name(F4 a, F4 b) { F4 r; for (int i = 0; i < 4; ++i) r.v[i] = expr; return r; }
+F4_BINARY(operator+, a.v[i] + b.v[i])
+F4_BINARY(operator-, a.v[i] - b.v[i])
+F4_BINARY(operator*, a.v[i] * b.v[i])
+F4_BINARY(operator/, a.v[i] / b.v[i])
+F4_BINARY(min4, std::min(a.v[i], b.v[i]))
+F4_BINARY(max4, std::max(a.v[i], b.v[i]))
+#undef F4_BINARY
+inline F4 sqrt4(F4 a) { F4 r; for (int i = 0; i < 4; ++i) r.v[i] = sqrtf(a.v[i]); return r; }
+inline int ge(F4 a, F4 b) { int m = 0; for (int i = 0; i < 4; ++i) m |= (a.v[i] >= b.v[i]) << i; return m; }
+inline int gt(F4 a, F4 b) { int m = 0; for (int i = 0; i < 4; ++i) m |= (a.v[i] > b.v[i]) << i; return m; }
+inline int lt(F4 a, F4 b) { int m = 0; for (int i = 0; i < 4; ++i) m |= (a.v[i] < b.v[i]) << i; return m; }
+inline F4 select(int mask, F4 a, F4 b) { F4 r; for (int i = 0; i < 4; ++i) r.v[i] = (mask >> i) & 1 ? b.v[i] : a.v[i]; return r; }
+
+#endif
+
+#endif
@@ -0,0 +1,55 @@
+#pragma once
+#ifndef FRAME_ARENA_HPP
+#define FRAME_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+* Bump allocator for memory that only lives for one frame.
+*
+* Allocate() hands out the next aligned bytes of one block, and Reset() at the start of
+* the next frame takes them all back at once; there is no per-allocation free. A frame
+* that needs more than the block gets separate heap blocks for the rest, and the next
+* Reset() regrows the block to that frame's peak. Frames of the same size then allocate
+* nothing.
+*
+* Memory is uninitialised and nothing is destructed, so only trivially destructible
+* types belong here. Not thread safe: workers of a pool take their ranges of arrays that
+* were allocated before Run().
+*/
+class FrameArena {
+public:
+    explicit FrameArena(size_t capacity = size_t(64) << 10);
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Valid until the next Reset(); alignment must be a power of two
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    template <typename T>
+    T* AllocateArray(size_t count) {
+        return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void Reset();
+
+    size_t GetCapacity() const { return capacity; }
+    // Bytes handed out since the last Reset(), with alignment padding
+    size_t GetUsed() const { return used + overflowBytes; }
+    // Frames that did not fit in the block
+    uint64_t GetOverflows() const { return overflows; }
+
+private:
+    std::unique_ptr<unsigned char[]> block;
+    size_t capacity;
+    size_t used;
+    std::vector<std::unique_ptr<unsigned char[]>> overflow;
+    size_t overflowBytes;
+    uint64_t overflows;
+};
+
+#endif
@@ -0,0 +1,215 @@
+#pragma once
+#ifndef FRAME_CAPTURE_HPP
+#define FRAME_CAPTURE_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+* Deterministic capture/replay for benchmark runs.
+*
+* A capture is one camera sample per rendered frame plus the element on screen, written as
+* plain text so two captures can be diffed. On replay the render loop takes its camera from
+* the capture instead of the input handlers and advances time by the fixed step stored in the
+* file, so every run draws exactly the same frames. FrameStats collects per-frame times and
+* (optionally) a hash of the frame's pixels to compare speed and output between builds.
+*
+* Header only and free of GL/glm so the single-file GLUT build can use it too.
+*/
+
+const char* const kCaptureMagic = "ATOMCAPTURE";
+const int kCaptureVersion = 1;
+
+enum CaptureFlags : uint32_t {
+    CAPTURE_LIGHTING = 1u << 0,
+    CAPTURE_PAUSED = 1u << 1,   // electron animation stopped
+    CAPTURE_EMITTING = 1u << 2  // excitation and photon emission on
+};
+
+struct CameraSample {
+    uint32_t frame;
+    int element;         // atomic number
+    float position[3];
+    float target[3];     // point looked at
+    float yaw, pitch;    // degrees
+    float zoom;          // vertical fov in degrees
+    uint32_t flags;      // CaptureFlags
+};
+
+class CaptureRecorder {
+public:
+    CaptureRecorder() : file(nullptr), frames(0) {}
+    ~CaptureRecorder() { End(); }
+
+    CaptureRecorder(const CaptureRecorder&) = delete;
+    CaptureRecorder& operator=(const CaptureRecorder&) = delete;
+
+    bool Begin(const std::string& path, double fixedStep) {
+        End();
+        file = fopen(path.c_str(), "w");
+        if (!file) {
+            std::cout << "ERROR::CAPTURE::CANNOT_OPEN " << path << std::endl;
+            return false;
+        }
+        fprintf(file, "%s %d\nstep %.9g\n", kCaptureMagic, kCaptureVersion, fixedStep);
+        frames = 0;
+        return true;
+    }
+
+    bool IsRecording() const { return file != nullptr; }
+
+    // Call once per frame with the state the frame was drawn with
+    void Record(CameraSample sample) {
+        if (!file) return;
+        sample.frame = frames++;
+        // %.9g round-trips a float exactly, replay sees the same bits that were drawn
+        fprintf(file, "%u %d %.9g %.9g %.9g %.9g %.9g %.9g %.9g %.9g %.9g %u\n",
+            sample.frame, sample.element,
+            sample.position[0], sample.position[1], sample.position[2],
+            sample.target[0], sample.target[1], sample.target[2],
+            sample.yaw, sample.pitch, sample.zoom, sample.flags);
+    }
+
+    void End() {
+        if (!file) return;
+        fclose(file);
+        file = nullptr;
+        std::cout << "Capture finished: " << frames << " frames" << std::endl;
+    }
+
+private:
+    FILE* file;
+    uint32_t frames;
+};
+
+class CaptureReplay {
+public:
+    CaptureReplay() : step(1.0 / 60.0), cursor(0) {}
+
+    bool Load(const std::string& path) {
+        samples.clear();
+        cursor = 0;
+
+        FILE* file = fopen(path.c_str(), "r");
+        if (!file) {
+            std::cout << "ERROR::REPLAY::CANNOT_OPEN " << path << std::endl;
+            return false;
+        }
+
+        char magic[32] = {};
+        int version = 0;
+        if (fscanf(file, "%31s %d step %lf", magic, &version, &step) != 3 ||
+            std::string(magic) != kCaptureMagic || version != kCaptureVersion) {
+            std::cout << "ERROR::REPLAY::BAD_HEADER " << path << std::endl;
+            fclose(file);
+            return false;
+        }
+
+        CameraSample s;
+        while (fscanf(file, "%u %d %f %f %f %f %f %f %f %f %f %u",
+            &s.frame, &s.element, &s.position[0], &s.position[1], &s.position[2],
+            &s.target[0], &s.target[1], &s.target[2], &s.yaw, &s.pitch, &s.zoom, &s.flags) == 12) {
+            samples.push_back(s);
+        }
+        fclose(file);
+
+        if (samples.empty()) {
+            std::cout << "ERROR::REPLAY::EMPTY " << path << std::endl;
+            return false;
+        }
+        std::cout << "Replay loaded: " << samples.size() << " frames, step " << step << " s" << std::endl;
+        return true;
+    }
+
+    bool IsActive() const { return !samples.empty(); }
+    bool Finished() const { return cursor >= samples.size(); }
+    double GetFixedStep() const { return step; }
+    size_t GetFrameCount() const { return samples.size(); }
+    const CameraSample& First() const { return samples.front(); }
+
+    // Sample for the next frame; false once the capture is exhausted
+    bool Next(CameraSample& out) {
+        if (cursor >= samples.size()) return false;
+        out = samples[cursor++];
+        return true;
+    }
+
+private:
+    std::vector<CameraSample> samples;
+    double step;
+    size_t cursor;
+};
+
+class FrameStats {
+public:
+    // 64-bit FNV-1a, enough to spot any changed pixel between two builds
+    static uint64_t HashPixels(const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        uint64_t hash = 1469598103934665603ull;
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    void Add(double frameMs, uint64_t imageHash = 0) {
+        frames.push_back({ frameMs, imageHash });
+    }
+
+    // Room for frameCount frames, so a run of known length doesn't grow the list mid-run
+    void Reserve(size_t frameCount) { frames.reserve(frameCount); }
+
+    size_t Size() const { return frames.size(); }
+
+    // frame,ms,hash rows followed by a summary; returns false if the file cannot be written
+    bool Write(const std::string& path) const {
+        FILE* file = fopen(path.c_str(), "w");
+        if (!file) {
+            std::cout << "ERROR::FRAMESTATS::CANNOT_WRITE " << path << std::endl;
+            return false;
+        }
+
+        fprintf(file, "frame,ms,hash\n");
+        for (size_t i = 0; i < frames.size(); ++i) {
+            fprintf(file, "%zu,%.4f,%016llx\n", i, frames[i].ms, static_cast<unsigned long long>(frames[i].hash));
+        }
+        fclose(file);
+
+        std::cout << Summary() << std::endl;
+        return true;
+    }
+
+    std::string Summary() const {
+        if (frames.empty()) return "No frames";
+
+        std::vector<double> sorted;
+        sorted.reserve(frames.size());
+        double total = 0.0;
+        for (const auto& f : frames) {
+            sorted.push_back(f.ms);
+            total += f.ms;
+        }
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&](double p) { return sorted[static_cast<size_t>(p * (sorted.size() - 1))]; };
+
+        char line[160];
+        snprintf(line, sizeof(line), "%zu frames: mean %.3f ms, p50 %.3f, p95 %.3f, p99 %.3f, max %.3f",
+            frames.size(), total / frames.size(), percentile(0.5), percentile(0.95), percentile(0.99), sorted.back());
+        return line;
+    }
+
+private:
+    struct Frame {
+        double ms;
+        uint64_t hash;
+    };
+
+    std::vector<Frame> frames;
+};
+
+#endif
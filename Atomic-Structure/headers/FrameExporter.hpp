@@ -0,0 +1,82 @@
+#pragma once
+#ifndef FRAME_EXPORTER_HPP
+#define FRAME_EXPORTER_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+* Writes exported frames off the render thread, either as numbered .ppm images (several
+* writer threads) or as raw RGBA piped into an encoder process such as ffmpeg (one writer,
+* so the stream stays in order).
+*
+* Frames travel in a fixed set of recycled buffers: AcquireBuffer() hands out a free one and
+* only blocks when every buffer is still queued for writing, which is the backpressure that
+* keeps memory bounded when the disk or encoder can't keep up. Frames come in as GL reads
+* them (RGBA8, bottom row first) and are written top row first.
+*/
+class FrameExporter {
+public:
+    FrameExporter();
+    ~FrameExporter();
+
+    FrameExporter(const FrameExporter&) = delete;
+    FrameExporter& operator=(const FrameExporter&) = delete;
+
+    // prefix_00000.ppm, prefix_00001.ppm, ...
+    bool OpenImages(const std::string& prefix, int width, int height, int threads = 2, int bufferCount = 8);
+    // e.g. "ffmpeg -y -f rawvideo -pix_fmt rgba -s 1920x1080 -r 60 -i - out.mp4"
+    bool OpenPipe(const std::string& command, int width, int height, int bufferCount = 8);
+    bool IsOpen() const { return open; }
+
+    // A buffer of GetFrameSize() bytes to fill; waits while all of them are in flight
+    uint8_t* AcquireBuffer();
+    // Queues a filled buffer as the next frame
+    void Submit(uint8_t* buffer);
+    // Gives back a buffer that won't be submitted after all
+    void Release(uint8_t* buffer);
+    // Waits for every queued frame to be written and closes the output
+    bool Finish();
+
+    size_t GetFrameSize() const { return size_t(width) * height * 4; }
+    int GetFramesWritten() const { return framesWritten; }
+    // total time AcquireBuffer() spent waiting on the writers
+    double GetBlockedMs() const { return blockedMs; }
+
+private:
+    struct Job {
+        uint8_t* data;
+        int frame;
+    };
+
+    void start(int threads, int bufferCount);
+    void writerLoop();
+    bool writeImage(const uint8_t* data, int frame);
+    bool writeRaw(const uint8_t* data);
+
+    int width, height;
+    bool open;
+    std::string prefix;
+    FILE* pipe;
+
+    std::vector<std::vector<uint8_t>> storage;
+    std::vector<uint8_t*> freeBuffers;
+    std::deque<Job> queue;
+    std::vector<std::thread> writers;
+    std::mutex mutex;
+    std::condition_variable workReady, bufferReady;
+    bool closing;
+    bool failed;
+
+    int nextFrame;
+    int framesWritten;
+    double blockedMs;
+};
+
+#endif
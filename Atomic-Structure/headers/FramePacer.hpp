@@ -0,0 +1,82 @@
+#pragma once
+#ifndef FRAME_PACER_HPP
+#define FRAME_PACER_HPP
+
+#include <chrono>
+#include "FrameCapture.hpp"
+
+/**
+* Keeps the CPU at most N frames ahead of the GPU and measures input-to-photon latency.
+*
+* Drivers happily queue two or three frames, and each queued frame is a frame of lag
+* between moving the mouse and seeing it. EndFrame(), called right after the swap, drops
+* a fence behind the frame and waits until no more than maxFramesAhead frames are
+* unfinished. Waiting there rather than at the start of the next frame is what keeps the
+* camera late: input that arrives during the wait is handled before the next frame reads
+* it.
+*
+* For latency, NoteInput() stamps the first input event since the last frame and
+* BeginFrame() hands that stamp to the frame being built. EndFrame() also writes a
+* GL_TIMESTAMP query, and when the frame's fence has signalled, the GPU time is mapped
+* onto the CPU clock by sampling both clocks at once. The sample is then the time from
+* the input to the GPU finishing the frame that shows it. Scan-out adds up to one refresh
+* with vsync. Without a timer query, the time the fence was seen to signal is used.
+* Frames with no new input are not counted.
+*
+* GL entry points come from the given loader like OffscreenCapture's. Needs GL 3.2 or
+* ARB_sync; the timestamps need GL 3.3 or ARB_timer_query.
+*/
+class FramePacer {
+public:
+    typedef void (*GLProc)();
+    typedef GLProc (*ProcLoader)(const char* name);
+    static const int kMaxFramesAhead = 4;
+
+    FramePacer(ProcLoader loader, int maxFramesAhead = 1);
+    ~FramePacer();
+
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    bool IsSupported() const { return supported; }
+    int GetFramesAhead() const { return maxFramesAhead; }
+
+    // An input event that the next frame will show
+    void NoteInput();
+    void BeginFrame();
+    // After the swap: fences the frame and waits for older ones
+    void EndFrame();
+
+    // Input-to-finish milliseconds, one per frame that showed new input
+    const FrameStats& GetLatency() const { return latency; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Slot {
+        void* fence;
+        unsigned int query;
+        bool hasInput;
+        Clock::time_point input;
+    };
+
+    // Records the latency of the oldest frame; wait blocks until its fence has signalled
+    bool retire(bool wait);
+
+    int maxFramesAhead;
+    bool supported;
+    bool timed;
+
+    Slot slots[kMaxFramesAhead + 1];
+    int head;     // slot of the next frame
+    int pending;  // frames fenced but not retired
+
+    bool inputPending;
+    Clock::time_point inputTime;
+    bool frameHasInput;
+    Clock::time_point frameInput;
+
+    FrameStats latency;
+};
+
+#endif
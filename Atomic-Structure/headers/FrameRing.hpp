@@ -0,0 +1,96 @@
+#pragma once
+#ifndef FRAME_RING_HPP
+#define FRAME_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+* Header at the start of a frame ring's shared memory. Slots of slotSize bytes follow from
+* dataOffset (page aligned), each an RGBA8 image of height rows of rowBytes, top row first.
+*
+* sequence[slot] is a seqlock: odd while the producer writes the slot, 2 * (frame + 1) once
+* frame is complete in it. published counts the completed frames, so the newest one is
+* published - 1 and lives in slot (published - 1) % slotCount.
+*/
+struct FrameRingHeader {
+    static const uint32_t kMaxSlots = 16;
+
+    char magic[8];          // "ATOMRNG\0"
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t rowBytes;
+    uint32_t slotCount;
+    uint32_t reserved;
+    uint64_t slotSize;
+    uint64_t dataOffset;
+    std::atomic<uint64_t> published;
+    std::atomic<uint64_t> sequence[kMaxSlots];
+};
+
+// A frame a consumer is reading in place; see FrameRing::StillValid
+struct FrameRingToken {
+    uint64_t frame;
+    uint32_t slot;
+    uint64_t sequence;
+};
+
+/**
+* Ring of rendered frames in named shared memory (POSIX shm_open, a named file mapping on
+* Windows), for handing frames to another process without copying them.
+*
+* The producer Create()s the ring, renders straight into BeginWrite() and calls Publish().
+* A consumer Open()s it by name, takes Latest() and reads the pixels where they are; the
+* producer never waits for it. Reading is only safe for a slot the producer has not come
+* round to again, which StillValid() checks afterwards: a frame that fails it was torn and
+* is dropped. With N slots the consumer has N - 1 frame times to finish with one.
+*/
+class FrameRing {
+public:
+    static const uint32_t kVersion = 1;
+
+    FrameRing();
+    ~FrameRing();
+
+    FrameRing(const FrameRing&) = delete;
+    FrameRing& operator=(const FrameRing&) = delete;
+
+    // Producer side; replaces a ring left behind under the same name
+    bool Create(const std::string& name, int width, int height, int slots = 3);
+    // Consumer side, read only
+    bool Open(const std::string& name);
+    // The producer also removes the name, consumers keep their mapping until they close
+    void Close();
+
+    bool IsOpen() const { return header != nullptr; }
+    int GetWidth() const { return header ? int(header->width) : 0; }
+    int GetHeight() const { return header ? int(header->height) : 0; }
+    size_t GetRowBytes() const { return header ? header->rowBytes : 0; }
+    int GetSlotCount() const { return header ? int(header->slotCount) : 0; }
+    uint64_t GetPublished() const { return header ? header->published.load(std::memory_order_acquire) : 0; }
+
+    // Producer: the slot for the next frame, marked as being written
+    uint8_t* BeginWrite();
+    void Publish();
+
+    // Consumer: the newest complete frame, nullptr before the first one
+    const uint8_t* Latest(FrameRingToken& token) const;
+    // Whether the frame was left alone while it was read
+    bool StillValid(const FrameRingToken& token) const;
+
+private:
+    FrameRingHeader* header;
+    uint8_t* base;
+    size_t mappedSize;
+    std::string name;
+    bool producer;
+    bool writing;
+#ifdef _WIN32
+    void* mappingHandle;
+#endif
+};
+
+#endif
@@ -0,0 +1,84 @@
+#pragma once
+#ifndef FRAME_SERVER_HPP
+#define FRAME_SERVER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+* Small HTTP/WebSocket server for streaming frames to browsers.
+*
+* GET / answers with a viewer page; GET /stream upgrades to a WebSocket that receives
+* every frame as one binary message (see TileDelta.hpp) and sends text commands back.
+* Everything runs on the caller's thread with non-blocking sockets: Poll() once a frame
+* accepts, reads and flushes, Broadcast() queues a frame.
+*
+* A client is only given a frame once the last one has been handed to its socket, so a
+* slow link drops frames instead of building up latency. A client that missed one can't
+* apply the deltas after it and waits for a keyframe; NeedsKeyframe() says when one
+* should be sent, which is also when a client has just joined.
+*
+* Browsers let any page open a WebSocket to any address, so an upgrade that carries an
+* Origin header (browsers always send one) is only accepted from the page this server
+* handed out, i.e. from http://<Host> where Host names this server, or from an origin
+* given to AllowOrigin(). A server on 0.0.0.0 answers to any name, so there only the
+* AllowOrigin() ones count. Other clients, which send no Origin, are let through.
+*/
+class FrameServer {
+public:
+    FrameServer();
+    ~FrameServer();
+
+    FrameServer(const FrameServer&) = delete;
+    FrameServer& operator=(const FrameServer&) = delete;
+
+    // host 127.0.0.1 keeps the server local, 0.0.0.0 serves every interface (see AllowOrigin)
+    bool Start(const std::string& host, int port);
+    void Stop();
+    // Also accepts WebSocket upgrades from pages at origin, e.g. "https://example.com"
+    void AllowOrigin(const std::string& origin) { allowedOrigins.push_back(origin); }
+    bool IsRunning() const { return listener != kNoSocket; }
+
+    // Text messages received since the last call are appended to commands
+    void Poll(std::vector<std::string>& commands);
+    void Broadcast(const std::vector<uint8_t>& message, bool keyframe);
+
+    int GetClientCount() const;  // streaming clients
+    bool NeedsKeyframe() const;
+    uint64_t GetBytesSent() const { return bytesSent; }
+    uint64_t GetFramesDropped() const { return framesDropped; }
+
+private:
+    static const intptr_t kNoSocket = -1;
+
+    struct Client {
+        intptr_t socket;
+        bool streaming;    // past the WebSocket handshake
+        bool resync;       // skips deltas until the next keyframe
+        bool closing;      // closes once the output is flushed
+        std::vector<uint8_t> input;
+        std::vector<uint8_t> output;
+        size_t outputSent;
+    };
+
+    void accept();
+    bool readInput(Client& client, std::vector<std::string>& commands);
+    bool handleRequest(Client& client);
+    bool originAllowed(const std::string& request) const;
+    bool handleFrames(Client& client, std::vector<std::string>& commands);
+    bool flush(Client& client);
+    void queue(Client& client, int opcode, const uint8_t* data, size_t size);
+    void closeSocket(intptr_t socket);
+
+    intptr_t listener;
+    std::string listenHost;
+    int listenPort;
+    std::vector<std::string> allowedOrigins;
+    std::vector<Client> clients;
+    uint64_t bytesSent;
+    uint64_t framesDropped;
+};
+
+#endif
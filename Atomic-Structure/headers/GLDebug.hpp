@@ -0,0 +1,20 @@
+#pragma once
+#ifndef GL_DEBUG_HPP
+#define GL_DEBUG_HPP
+
+#include <glad/glad.h>
+
+/**
+* Debug builds only (no NDEBUG): routes driver errors and warnings through a KHR_debug
+* callback instead of polling glGetError() after draws, which forces a sync. Needs a
+* debug context, e.g. glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE); without one,
+* debug builds fall back to the glGetError() checks. Release builds do neither.
+*
+* Sphere and Ground call this when they are created, so the first GL object turns it on.
+* Later calls do nothing.
+*/
+void EnableGLDebugOutput();
+// Whether the callback is installed, i.e. glGetError() checks are redundant
+bool IsGLDebugOutputEnabled();
+
+#endif
@@ -0,0 +1,100 @@
+#pragma once
+#ifndef GL_PROCS_HPP
+#define GL_PROCS_HPP
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+/**
+* GL 2.0-3.3 entry points for the helpers of the fixed-function GLUT view (OffscreenCapture,
+* PickBuffer, LayerCache, DynamicResolution, FramePacer). The view links no GL loader
+* library, so LoadGLProcs() fetches them once through the given loader (glutGetProcAddress,
+* glfwGetProcAddress). Functions the driver lacks stay null; each helper checks the groups
+* it needs with the Has* functions.
+*/
+typedef void (*GLProc)();
+typedef GLProc (*GLProcLoader)(const char* name);
+
+struct GLProcs {
+    // framebuffer objects: GL 3.0 or ARB_framebuffer_object
+    PFNGLGENFRAMEBUFFERSPROC genFramebuffers;
+    PFNGLDELETEFRAMEBUFFERSPROC deleteFramebuffers;
+    PFNGLBINDFRAMEBUFFERPROC bindFramebuffer;
+    PFNGLGENRENDERBUFFERSPROC genRenderbuffers;
+    PFNGLDELETERENDERBUFFERSPROC deleteRenderbuffers;
+    PFNGLBINDRENDERBUFFERPROC bindRenderbuffer;
+    PFNGLRENDERBUFFERSTORAGEPROC renderbufferStorage;
+    PFNGLFRAMEBUFFERRENDERBUFFERPROC framebufferRenderbuffer;
+    PFNGLFRAMEBUFFERTEXTURE2DPROC framebufferTexture2D;
+    PFNGLCHECKFRAMEBUFFERSTATUSPROC checkFramebufferStatus;
+    PFNGLBLITFRAMEBUFFERPROC blitFramebuffer;
+
+    // buffer objects with mapped ranges: GL 3.0
+    PFNGLGENBUFFERSPROC genBuffers;
+    PFNGLDELETEBUFFERSPROC deleteBuffers;
+    PFNGLBINDBUFFERPROC bindBuffer;
+    PFNGLBUFFERDATAPROC bufferData;
+    PFNGLMAPBUFFERRANGEPROC mapBufferRange;
+    PFNGLUNMAPBUFFERPROC unmapBuffer;
+
+    // fences: GL 3.2 or ARB_sync
+    PFNGLFENCESYNCPROC fenceSync;
+    PFNGLCLIENTWAITSYNCPROC clientWaitSync;
+    PFNGLDELETESYNCPROC deleteSync;
+
+    // programs: GL 2.0
+    PFNGLCREATESHADERPROC createShader;
+    PFNGLSHADERSOURCEPROC shaderSource;
+    PFNGLCOMPILESHADERPROC compileShader;
+    PFNGLGETSHADERIVPROC getShaderiv;
+    PFNGLGETSHADERINFOLOGPROC getShaderInfoLog;
+    PFNGLDELETESHADERPROC deleteShader;
+    PFNGLCREATEPROGRAMPROC createProgram;
+    PFNGLATTACHSHADERPROC attachShader;
+    PFNGLLINKPROGRAMPROC linkProgram;
+    PFNGLGETPROGRAMIVPROC getProgramiv;
+    PFNGLUSEPROGRAMPROC useProgram;
+    PFNGLDELETEPROGRAMPROC deleteProgram;
+    PFNGLGETUNIFORMLOCATIONPROC getUniformLocation;
+    PFNGLUNIFORM1IPROC uniform1i;
+    PFNGLUNIFORM1FPROC uniform1f;
+    PFNGLUNIFORM2FPROC uniform2f;
+
+    // several outputs, integer ones among them: GL 3.0
+    PFNGLDRAWBUFFERSPROC drawBuffers;
+    PFNGLCLEARBUFFERUIVPROC clearBufferuiv;
+    PFNGLBINDFRAGDATALOCATIONPROC bindFragDataLocation;
+
+    // queries: GL 1.5; 64-bit results and timestamps: GL 3.3 or ARB_timer_query
+    PFNGLGENQUERIESPROC genQueries;
+    PFNGLDELETEQUERIESPROC deleteQueries;
+    PFNGLBEGINQUERYPROC beginQuery;
+    PFNGLENDQUERYPROC endQuery;
+    PFNGLGETQUERYOBJECTIVPROC getQueryObjectiv;
+    PFNGLGETQUERYOBJECTUI64VPROC getQueryObjectui64v;
+    PFNGLQUERYCOUNTERPROC queryCounter;
+    PFNGLGETINTEGER64VPROC getInteger64v;
+
+    bool HasFramebuffers() const;
+    bool HasPixelBuffers() const;
+    bool HasSync() const;
+    bool HasPrograms() const;
+    bool HasDrawBuffers() const;
+    bool HasQueries() const;
+    bool HasTimer() const;       // GL_TIME_ELAPSED results
+    bool HasTimestamps() const;  // GL_TIMESTAMP queries and reads
+};
+
+extern GLProcs gl;
+
+// Fills gl on the first call, later calls only say whether that worked. False without a loader
+bool LoadGLProcs(GLProcLoader loader);
+
+// Compiles and links a fragment-only program, binding outputs[i] to draw buffer i.
+// Errors go to the log under owner (e.g. "PICK_BUFFER"); 0 when it fails
+GLuint BuildFragmentProgram(const char* source, const char* owner, const char* const* outputs = nullptr, int outputCount = 0);
+
+#endif
@@ -22,8 +22,11 @@ public:
 
     /**
     * Creates a 100x100 plane and compiles and links ground shaders.
+    * Pass GroundGBuffer.frag as fragPath to draw into the deferred G-buffer.
     */
-    Ground(float width, float length);
+    Ground(float width, float length,
+        const char* vertPath = "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\Ground.vert",
+        const char* fragPath = "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\Ground.frag");
 
     void createPlane();
 
@@ -31,6 +34,8 @@ public:
 
     void render(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPos);
 
+    Shader& GetShader() { return *shader; }
+
     ~Ground();
 };
 
@@ -2,11 +2,12 @@
 #ifndef INPUT_HPP
 #define INPUT_HPP
 #include"camera.hpp"
+#include"FrameCapture.hpp"
 #include<GLFW/glfw3.h>
 #include<iostream>
 class Input {
 public:
-	Input() : firstMouse(true), lastX(400), lastY(300) {}
+	Input() : firstMouse(true), lastX(400), lastY(300), cursorX(-1.0f), cursorY(-1.0f) {}
 
 	// input and cams
 	struct WindowData {
@@ -19,9 +20,23 @@ public:
 	static void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 
 	static void keyboardInput(GLFWwindow* window, Camera& cam, float& deltaTime);
+
+	// capture/replay: the camera state of a frame, and setting it back
+	static CameraSample captureCamera(const Camera& cam, int element);
+	static void applySample(Camera& cam, const CameraSample& sample);
+
+	// Replaces live input for one frame: applies the next recorded sample and fixes deltaTime
+	// to the capture's step. Returns false once the capture is exhausted.
+	static bool replayFrame(CaptureReplay& replay, Camera& cam, int& element, float& deltaTime);
+
+	// Cursor in window pixels, top-left origin, for hover picking: a PickBuffer request
+	// is at (x, height - 1 - y). Negative until the mouse has moved.
+	float getCursorX() const { return cursorX; }
+	float getCursorY() const { return cursorY; }
 private:
 	bool firstMouse;
 	float lastX, lastY;
+	float cursorX, cursorY;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+#ifndef LATTICE_HPP
+#define LATTICE_HPP
+
+#include <string>
+#include <vector>
+#include "SceneFile.hpp"
+
+enum class LatticeType { SimpleCubic, BodyCentered, FaceCentered, HexagonalClosePacked, Diamond, Custom };
+
+// An atom of the basis, in fractional coordinates of the cell
+struct BasisAtom {
+    int atomicNumber;
+    float fractional[3];
+};
+
+/**
+* A crystal described by its unit cell: three lattice vectors and the basis atoms inside
+* the cell. FillCell() emits one cell into a scene and marks it periodic, which is all the
+* renderers need to draw any number of repetitions (they repeat the cell rather than the
+* atoms); Fill() writes the repetitions out as explicit atoms for code that needs them.
+*/
+class Lattice {
+public:
+    Lattice();
+
+    // Conventional cubic cells (SC, BCC, FCC, diamond) with edge a in angstrom
+    static Lattice Cubic(LatticeType type, float a, int atomicNumber);
+    // c <= 0 uses the ideal ratio c/a = sqrt(8/3)
+    static Lattice HexagonalClosePacked(float a, float c, int atomicNumber);
+    static Lattice Custom(const float cell[9], const std::vector<BasisAtom>& basis);
+    // "fcc:Cu", "bcc:Fe:2.87", "hcp:Mg:3.21:5.21", "diamond:6:3.57" (element by symbol or
+    // number). Without a lattice constant the atoms' covalent spheres just touch.
+    static bool Parse(const std::string& spec, Lattice& out);
+
+    // Appends the basis atoms of the cell at the origin and sets the scene's cell
+    void FillCell(SceneData& scene) const;
+    // Appends repeat[0] x repeat[1] x repeat[2] cells of atoms; the scene's cell becomes the
+    // whole block
+    void Fill(SceneData& scene, const int repeat[3]) const;
+
+    LatticeType GetType() const { return type; }
+    const float* GetCell() const { return cell; }
+    const std::vector<BasisAtom>& GetBasis() const { return basis; }
+
+private:
+    LatticeType type;
+    float cell[9];  // a, b, c
+    std::vector<BasisAtom> basis;
+};
+
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+#ifndef LAYER_CACHE_HPP
+#define LAYER_CACHE_HPP
+
+/**
+* Keeps the parts of a frame that don't move (nucleus, orbit rings, a loaded structure) in
+* an offscreen colour + depth target, so that while the camera is still only the moving
+* objects are drawn each frame.
+*
+* The static layers are drawn once between BeginLayers() and EndLayers(). Each frame then
+* starts with BeginFrame(), which copies the cached colour and depth into a second target;
+* the moving objects are drawn on top of that with the ordinary depth test, and Present()
+* copies the result to the window. Both copies are framebuffer blits between targets of
+* the same format, so the picture is exactly the one a full redraw would give.
+*
+* Anything that changes the static layers (camera, lighting, projection, atoms) has to
+* Invalidate() the cache. GL entry points come from the given loader like
+* OffscreenCapture's. Needs GL 3.0 or ARB_framebuffer_object.
+*/
+class LayerCache {
+public:
+    typedef void (*GLProc)();
+    typedef GLProc (*ProcLoader)(const char* name);
+
+    LayerCache(int width, int height, ProcLoader loader);
+    ~LayerCache();
+
+    LayerCache(const LayerCache&) = delete;
+    LayerCache& operator=(const LayerCache&) = delete;
+
+    bool IsSupported() const { return supported; }
+    // Invalidates when the size changes
+    void Resize(int width, int height);
+
+    bool IsValid() const { return valid; }
+    void Invalidate() { valid = false; }
+
+    // Render the static layers between these; the caller clears and sets up the camera
+    void BeginLayers();
+    void EndLayers();
+
+    // Starts a frame from the cached layers; the moving objects are drawn after this
+    void BeginFrame();
+    // Copies the frame to the given framebuffer (0 is the window's back buffer) and binds it
+    void Present(int targetWidth, int targetHeight, unsigned int target = 0);
+
+    // Times the layers were drawn / frames reused them, for the summary on exit
+    unsigned long GetLayerDraws() const { return layerDraws; }
+    unsigned long GetReusedFrames() const { return reusedFrames; }
+
+private:
+    void createTargets();
+    void destroyTargets();
+
+    int width, height;
+    bool supported;
+    bool valid;
+
+    // [0] the cached layers, [1] the frame being composed
+    unsigned int fbos[2], colorBuffers[2], depthBuffers[2];
+
+    unsigned long layerDraws, reusedFrames;
+};
+
+#endif
@@ -0,0 +1,17 @@
+#pragma once
+#ifndef NUMBER_PARSING_HPP
+#define NUMBER_PARSING_HPP
+
+/**
+* Numbers in the text formats the importers read. The text sits in a read buffer and is
+* not NUL-terminated, so strtof/strtoll read a copy of at most 63 characters (<charconv>
+* would avoid the copy, but needs C++17).
+*/
+
+// next is set past the digits; false if there are none or the value is out of range
+bool ScanFloat(const char* begin, const char* end, float& out, const char** next = nullptr);
+
+// Leading blanks are skipped; false if there are no digits or the value is out of range
+bool ScanInteger(const char* begin, const char* end, long long& out);
+
+#endif
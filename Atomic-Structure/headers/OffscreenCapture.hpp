@@ -0,0 +1,67 @@
+#pragma once
+#ifndef OFFSCREEN_CAPTURE_HPP
+#define OFFSCREEN_CAPTURE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+* Offscreen render target plus asynchronous readback, for exporting frames.
+*
+* Frames are drawn into an FBO of a fixed size (independent of the window). Queue() starts a
+* glReadPixels into the next pixel buffer object of a ring and drops a fence behind it; the
+* call returns immediately because the copy happens on the GPU timeline. Collect() hands back
+* the oldest frame once its fence has signalled, so the CPU only ever maps buffers the GPU is
+* done with and the pipeline never stalls on readback.
+*
+* GL entry points are loaded through the given loader (glutGetProcAddress, glfwGetProcAddress,
+* see GLProcs.hpp) so it works from the legacy GLUT context without a GL loader library. Needs GL 3.2 or
+* ARB_framebuffer_object + ARB_sync; IsSupported() says whether they were found.
+*/
+class OffscreenCapture {
+public:
+    typedef void (*GLProc)();
+    typedef GLProc (*ProcLoader)(const char* name);
+
+    OffscreenCapture(int width, int height, ProcLoader loader, int ringSize = 3);
+    ~OffscreenCapture();
+
+    OffscreenCapture(const OffscreenCapture&) = delete;
+    OffscreenCapture& operator=(const OffscreenCapture&) = delete;
+
+    bool IsSupported() const { return supported; }
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+    // bytes per frame, RGBA8, bottom row first as GL returns it
+    size_t GetFrameSize() const { return size_t(width) * height * 4; }
+
+    // Render into / away from the offscreen target
+    void Bind();
+    void Unbind();
+
+    // Copies the offscreen target to the window's back buffer, scaled, for a preview
+    void BlitToWindow(int windowWidth, int windowHeight);
+
+    // Starts reading the current frame. Returns false if the ring is full (Collect first).
+    bool Queue();
+
+    // Copies the oldest pending frame into dst if it is ready (or always, when wait is set).
+    // A frame whose fence fails is dropped, false is returned for it as well
+    bool Collect(uint8_t* dst, bool wait);
+
+    int GetPending() const { return pending; }
+
+private:
+
+    int width, height;
+    int ringSize;
+    bool supported;
+
+    unsigned int fbo, colorBuffer, depthBuffer;
+    unsigned int pbos[8];
+    void* fences[8];
+    int head;     // next slot to queue into
+    int pending;  // queued but not collected
+};
+
+#endif
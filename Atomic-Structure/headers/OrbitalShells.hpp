@@ -0,0 +1,69 @@
+#pragma once
+#ifndef ORBITAL_SHELLS_HPP
+#define ORBITAL_SHELLS_HPP
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+#include "shaders.hpp"
+#include "SphereMesh.hpp"
+
+class Electron;
+
+// Per-instance data, laid out exactly as the vertex attributes read it
+struct ShellInstance {
+    glm::vec4 centerRadius;
+    glm::vec4 color; // a = opacity
+};
+
+struct RingInstance {
+    glm::vec4 centerRadius; // atom center, orbit radius
+    glm::vec4 axis;         // orbital plane normal
+    glm::vec4 color;        // a = opacity
+};
+
+/**
+* Translucent orbital clouds and orbit rings for any number of atoms.
+* All shells are one instanced draw and all rings another, both written through
+* OITAccumulate.frag, so Render() must run between TransparencyPass::Begin/End.
+*/
+class OrbitalShells {
+public:
+    static const int kRingSegments = 64;
+
+    OrbitalShells(
+        const char* shellVertPath = "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\OrbitalShell.vert",
+        const char* ringVertPath = "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\OrbitRing.vert",
+        const char* accumFragPath = "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\OITAccumulate.frag");
+    ~OrbitalShells();
+
+    OrbitalShells(const OrbitalShells&) = delete;
+    OrbitalShells& operator=(const OrbitalShells&) = delete;
+
+    void Clear();
+    void AddShell(const glm::vec3& center, float radius, const glm::vec3& color, float opacity = 0.15f);
+    void AddRing(const glm::vec3& center, float radius, const glm::vec3& axis, const glm::vec3& color, float opacity = 0.4f);
+    // one ring per electron, tinted with the electron's color
+    void AddAtom(const glm::vec3& center, const std::vector<Electron>& electrons, float opacity = 0.4f);
+
+    void Render(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPos);
+
+private:
+    void upload();
+
+    GLuint shellVAO, meshVBO, meshEBO, shellInstanceVBO;
+    GLuint ringVAO, ringInstanceVBO;
+    unsigned int meshIndexCount;
+    GLenum meshIndexType;
+
+    std::vector<ShellInstance> shells;
+    std::vector<RingInstance> rings;
+    bool dirty;
+
+    std::unique_ptr<Shader> shellShader;
+    std::unique_ptr<Shader> ringShader;
+    bool initialized;
+};
+
+#endif
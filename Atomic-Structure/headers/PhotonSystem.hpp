@@ -0,0 +1,106 @@
+#pragma once
+#ifndef PHOTON_SYSTEM_HPP
+#define PHOTON_SYSTEM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "RadialSolver.hpp"
+#include "WorkerPool.hpp"
+
+/**
+* Bound levels of an element's outermost electron as a Rydberg series,
+* E(n) = -1 / 2(n - defect)^2 hartree for n = groundN ... groundN + kLevels - 1.
+*
+* The outermost electron is the least bound subshell the radial solver found (4s rather
+* than 3d for iron), and the quantum defect is fitted so the ground level has its energy.
+* Hydrogen has no defect, so its series is the real one: Lyman in the ultraviolet, Balmer
+* in the visible. The table holds the wavelength and colour of every downward transition.
+*/
+struct RydbergSeries {
+    static const int kLevels = 6;
+
+    int groundN, l;
+    float defect;
+    // indexed by level - groundN, upper first; only upper > lower is filled
+    float wavelength[kLevels][kLevels];  // nm
+    uint32_t color[kLevels][kLevels];    // RGBA8
+
+    static RydbergSeries FromShells(const ElementShells& shells);
+
+    float Energy(int n) const;
+    // <r> of level n, (3 n*^2 - l(l + 1)) / 2 bohr
+    float MeanRadius(int n) const;
+};
+
+// RGBA8 of light of the given wavelength; ultraviolet and infrared keep the colour of the
+// nearest visible edge, dimmed, so they still show
+uint32_t WavelengthColor(float nm);
+
+// One photon as glInterleavedArrays(GL_C4UB_V3F) reads it
+struct PhotonVertex {
+    uint8_t color[4];
+    float position[3];
+};
+
+/**
+* A fixed pool of photons that fly outward in straight lines and fade.
+*
+* Every photon lives the same number of steps, so photons retire in the order they were
+* emitted and the pool is a ring: Emit() writes behind the newest, Step() advances past
+* the ones that have expired, and nothing is ever allocated, freed or compacted after
+* construction. A full pool drops new photons rather than growing.
+*
+* The photons are stored as arrays per attribute (origin, velocity, birth step, colour),
+* and a photon's position is origin + velocity * age, so Step() has no state to carry.
+* It writes the live photons' vertices in parallel runs on a WorkerPool. The vertex of
+* a photon sits at its pool index, so the live ones are one or two ranges of
+* GetVertices() (GetRanges()).
+*/
+class PhotonSystem {
+public:
+    explicit PhotonSystem(size_t capacity = size_t(1) << 19, int lifeSteps = 120, int threads = 0);
+
+    PhotonSystem(const PhotonSystem&) = delete;
+    PhotonSystem& operator=(const PhotonSystem&) = delete;
+
+    // count photons from origin in random directions, speed in units per step; returns how
+    // many fit in the pool
+    size_t Emit(const float origin[3], uint32_t color, size_t count, float speed);
+    // Ages everything by a step, retires the expired photons and writes the vertices
+    void Step();
+    void Clear();
+
+    size_t GetLiveCount() const { return live; }
+    size_t GetCapacity() const { return capacity; }
+    uint64_t GetDropped() const { return dropped; }
+    double GetLastMs() const { return lastMs; }
+
+    // Live vertices are vertices[first[i] .. first[i] + count[i]) for i < the result
+    int GetRanges(size_t first[2], size_t count[2]) const;
+    const PhotonVertex* GetVertices() const { return vertices.data(); }
+
+    // Deterministic, so replays emit the same photons
+    uint32_t Random();
+    float RandomUnit() { return (Random() >> 8) * (1.0f / 16777216.0f); }
+
+private:
+    size_t capacity;
+    uint32_t lifeSteps;
+    size_t head;  // oldest live photon
+    size_t live;
+    uint32_t now;
+    uint64_t dropped;
+    uint32_t rngState;
+    double lastMs;
+
+    std::vector<float> originX, originY, originZ;
+    std::vector<float> velocityX, velocityY, velocityZ;
+    std::vector<uint32_t> birth;
+    std::vector<uint32_t> color;
+    std::vector<PhotonVertex> vertices;
+
+    WorkerPool pool;
+};
+
+#endif
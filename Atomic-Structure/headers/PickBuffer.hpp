@@ -0,0 +1,86 @@
+#pragma once
+#ifndef PICK_BUFFER_HPP
+#define PICK_BUFFER_HPP
+
+#include <cstdint>
+
+// What a pick ID names: the kind in the top 3 bits, an index below it. 0 is "nothing".
+enum class PickKind : uint32_t { None = 0, Atom = 1, Electron = 2, Nucleus = 3, Bond = 4 };
+
+const uint32_t kPickIndexMask = (1u << 29) - 1;
+
+inline uint32_t MakePickID(PickKind kind, uint32_t index) {
+    return (static_cast<uint32_t>(kind) << 29) | (index & kPickIndexMask);
+}
+inline PickKind GetPickKind(uint32_t id) { return static_cast<PickKind>(id >> 29); }
+inline uint32_t GetPickIndex(uint32_t id) { return id & kPickIndexMask; }
+
+/**
+* Offscreen target with an object ID per pixel next to the colour, for hover and click
+* picking. Shaders write the colour to output 0 and a pick ID (MakePickID) to output 1, in
+* the same pass; then Request() copies the single pixel under the cursor into a pixel
+* buffer object and Poll() picks the value up a frame or two later once its fence has
+* signalled. Nothing waits on the GPU and the cost does not depend on the scene size.
+*
+* The fixed-function GLUT path has no shaders of its own: BeginIDs(true) binds a fragment
+* program that passes the lit colour through and reads the ID from texture coordinate 0,
+* which the geometry sets with TagFixedFunction(). Everything drawn into the target has to
+* go through a program then: with an integer attachment present, drivers reject
+* fixed-function fragments.
+*
+* GL entry points come from the given loader like OffscreenCapture's. Needs GL 3.2 or
+* ARB_framebuffer_object + ARB_sync.
+*/
+class PickBuffer {
+public:
+    typedef void (*GLProc)();
+    typedef GLProc (*ProcLoader)(const char* name);
+
+    PickBuffer(int width, int height, ProcLoader loader, int ringSize = 3);
+    ~PickBuffer();
+
+    PickBuffer(const PickBuffer&) = delete;
+    PickBuffer& operator=(const PickBuffer&) = delete;
+
+    bool IsSupported() const { return supported; }
+    void Resize(int width, int height);
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+
+    // Render into / away from the target; only the colour is drawn to until BeginIDs()
+    void Bind();
+    void Unbind();
+    void BlitToWindow(int windowWidth, int windowHeight);
+
+    // Clears the IDs to 0 and adds them as a second draw buffer. fixedFunction binds the
+    // pass-through program for geometry tagged with TagFixedFunction().
+    void BeginIDs(bool fixedFunction);
+    void EndIDs();
+    // Sets the ID of the fixed-function geometry that follows (a glTexCoord2f)
+    static void TagFixedFunction(uint32_t id);
+
+    // Starts reading the ID at pixel (x, y), bottom-left origin. False if the ring is full.
+    bool Request(int x, int y);
+    // Takes every finished request; id is the newest. False if none had finished.
+    bool Poll(uint32_t& id);
+    int GetPending() const { return pending; }
+
+private:
+    void createTargets();
+    void destroyTargets();
+    bool buildProgram();
+
+    int width, height;
+    int ringSize;
+    bool supported;
+
+    unsigned int fbo, colorBuffer, idBuffer, depthBuffer;
+    unsigned int pbos[8];
+    void* fences[8];
+    int head;     // next slot to request into
+    int pending;  // requested but not polled
+    unsigned int program;
+    bool programFailed;
+};
+
+#endif
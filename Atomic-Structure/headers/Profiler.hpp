@@ -0,0 +1,126 @@
+#pragma once
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <glad/glad.h>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+* Frame profiler with CPU and GPU zones.
+*
+* CPU zones time with steady_clock. GPU zones put a pair of GL_TIMESTAMP queries around
+* the commands (timestamps nest, GL_TIME_ELAPSED queries do not). Queries are kept in a
+* ring of kFramesInFlight frames and results are only read once the driver says they
+* are available, so profiling never stalls the pipeline; GPU numbers lag a few frames.
+*
+* Zone names must be string literals (or otherwise outlive the profiler).
+*/
+class Profiler {
+public:
+    static const int kFramesInFlight = 4;
+
+    struct PassTiming {
+        const char* name;
+        double cpuMs;
+        double gpuMs; // < 0 when the zone has no GPU part
+    };
+
+    static Profiler& Instance();
+
+    void SetEnabled(bool enabled) { this->enabled = enabled; }
+    bool IsEnabled() const { return enabled; }
+
+    void BeginFrame();
+    void EndFrame();
+
+    void BeginCpuZone(const char* name);
+    void EndCpuZone();
+    void BeginGpuZone(const char* name);
+    void EndGpuZone();
+
+    // Per-pass totals of the newest frame whose GPU results are in
+    const std::vector<PassTiming>& GetPassTimings() const { return passTimings; }
+    double GetFrameMs() const { return frameMs; }
+
+    // Everything recorded so far (bounded by kMaxTraceEvents) in chrome://tracing / Perfetto format
+    bool WriteChromeTrace(const std::string& path) const;
+    void ClearTrace();
+
+private:
+    Profiler();
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    static const size_t kMaxTraceEvents = 1 << 20;
+
+    struct TraceEvent {
+        const char* name;
+        int64_t startUs;
+        int64_t durationUs;
+        int track; // 0 = CPU main, 1 = GPU, others = worker threads
+    };
+
+    struct GpuZoneQueries {
+        const char* name;
+        GLuint startQuery, endQuery;
+    };
+
+    struct FrameSlot {
+        std::vector<GpuZoneQueries> zones;
+        std::vector<GLuint> freeQueries;
+        std::vector<PassTiming> timings; // CPU side, completed with GPU times on resolve
+        GLuint lastQuery;                // issued last, nested zones end in any order
+        bool pending;
+    };
+
+    int64_t nowUs() const;
+    GLuint acquireQuery(FrameSlot& slot);
+    bool resolveFrame(FrameSlot& slot);
+    void recycle(FrameSlot& slot);
+    void addTiming(const char* name, double cpuMs);
+    void record(const TraceEvent& e);
+
+    bool enabled;
+    uint64_t frameIndex;
+    std::chrono::steady_clock::time_point epoch;
+    int64_t frameStartUs;
+    double frameMs;
+
+    // GPU clock -> CPU clock offset, measured once
+    bool gpuCalibrated;
+    int64_t gpuOffsetUs;
+
+    std::vector<size_t> gpuStack; // indices into the current slot's zones
+    FrameSlot slots[kFramesInFlight];
+
+    std::vector<PassTiming> passTimings;
+    std::vector<PassTiming> cpuTimings; // current frame, handed to its slot in EndFrame
+
+    mutable std::mutex traceMutex;
+    std::vector<TraceEvent> trace;
+};
+
+// RAII CPU zone
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name) { Profiler::Instance().BeginCpuZone(name); }
+    ~ProfileZone() { Profiler::Instance().EndCpuZone(); }
+};
+
+// RAII zone timed on both the CPU and the GPU
+class GpuProfileZone {
+public:
+    explicit GpuProfileZone(const char* name) { Profiler::Instance().BeginGpuZone(name); }
+    ~GpuProfileZone() { Profiler::Instance().EndGpuZone(); }
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_GPU_ZONE(name) GpuProfileZone PROFILE_CONCAT(gpuProfileZone, __LINE__)(name)
+
+#endif
@@ -0,0 +1,48 @@
+#pragma once
+#ifndef PROFILER_OVERLAY_HPP
+#define PROFILER_OVERLAY_HPP
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "shaders.hpp"
+#include "Profiler.hpp"
+
+/**
+* Draws the profiler's per-pass table in the top-left corner: name, CPU ms, GPU ms and
+* a bar scaled so the full width is one 60 Hz frame. Text uses a built-in 3x5 pixel font
+* and everything is a single instanced draw of quads.
+*/
+class ProfilerOverlay {
+public:
+    ProfilerOverlay(
+        const char* vertPath = "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\ProfilerOverlay.vert",
+        const char* fragPath = "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\ProfilerOverlay.frag");
+    ~ProfilerOverlay();
+
+    ProfilerOverlay(const ProfilerOverlay&) = delete;
+    ProfilerOverlay& operator=(const ProfilerOverlay&) = delete;
+
+    void Render(const Profiler& profiler, int screenWidth, int screenHeight);
+
+private:
+    struct Quad {
+        float x, y, w, h;
+        uint32_t color; // RGBA8
+        uint32_t glyph;
+    };
+
+    void addText(float x, float y, const char* text, uint32_t color);
+    void addRect(float x, float y, float w, float h, uint32_t color);
+
+    GLuint VAO, VBO;
+    size_t capacity;
+    std::vector<Quad> quads;
+    uint32_t glyphs[128];
+
+    std::unique_ptr<Shader> shader;
+    bool initialized;
+};
+
+#endif
@@ -0,0 +1,83 @@
+#pragma once
+#ifndef RADIAL_SOLVER_HPP
+#define RADIAL_SOLVER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Elements.hpp"
+
+// 1s 2s 2p 3s 3p 4s 3d 4p 5s 4d 5p 6s 4f 5d 6p 7s 5f 6d 7p holds exactly 118 electrons
+static const int kSubshellCount = 19;
+
+// One occupied subshell of an element's ground state, in atomic units
+struct Subshell {
+    int n, l;
+    int electrons;
+    float energy;      // orbital energy, hartree
+    float meanRadius;  // <r>, bohr
+};
+
+struct ElementShells {
+    int count;  // occupied subshells, in filling order
+    Subshell subshells[kSubshellCount];
+};
+
+/**
+* Orbital energies and radii of every element from the radial Schrodinger equation.
+*
+* Each element's electrons fill subshells in Madelung order (the few d and f exceptions,
+* Cr, Cu, La and so on, are ignored). All of them move in one screened central potential,
+* the independent-particle model of Green, Sellin and Zachor: the nucleus' full charge
+* close in, screened down to 1/r far out by the other electrons. It is not
+* self-consistent, but it puts the shells in the right order with energies near
+* Hartree-Fock's, and it costs one integration per energy tried.
+*
+* The equation is integrated outward with Numerov's method on a logarithmic grid, which
+* resolves the 1s of uranium and the 7s of the same atom with one step size. The energy
+* is bisected on the node count until the solution has exactly n - l - 1 nodes, between
+* the hydrogen-like bounds -Z^2/2n^2 and -1/2n^2 that the screening can't leave. Four
+* subshells share one pass in the lanes of an F4, and a WorkerPool takes the elements.
+*
+* Solve() reads the table from a cache file when the file was written by the same model
+* version, so the work is only done once per machine. DefaultCachePath() puts that file in
+* the user's cache directory rather than wherever the program was started.
+*/
+class RadialSolver {
+public:
+    static const uint32_t kVersion = 1;
+
+    RadialSolver();
+
+    RadialSolver(const RadialSolver&) = delete;
+    RadialSolver& operator=(const RadialSolver&) = delete;
+
+    // Loads cachePath, or solves all elements and writes it; "" skips the cache.
+    // threads = 0 uses every hardware thread
+    void Solve(const std::string& cachePath, int threads = 0);
+    bool IsSolved() const { return !table.empty(); }
+    // shells.cache in %LOCALAPPDATA%\Atomic-Structure or $XDG_CACHE_HOME/atomic-structure
+    // (~/.cache when unset), created if missing; "" when there is no such directory
+    static std::string DefaultCachePath();
+
+    const ElementShells& Get(int atomicNumber) const { return table[atomicNumber - 1]; }
+
+    double GetLastMs() const { return lastMs; }
+    bool LoadedFromCache() const { return fromCache; }
+    int GetThreadCount() const { return threadCount; }
+
+    // Occupied subshells of the ground state, energies and radii left zero
+    static void Configure(int atomicNumber, ElementShells& out);
+    static void SolveElement(int atomicNumber, ElementShells& out);
+
+private:
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+    std::vector<ElementShells> table;
+    double lastMs;
+    bool fromCache;
+    int threadCount;
+};
+
+#endif
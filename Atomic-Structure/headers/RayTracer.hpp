@@ -0,0 +1,149 @@
+#pragma once
+#ifndef RAY_TRACER_HPP
+#define RAY_TRACER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "FrameArena.hpp"
+#include "RenderBackend.hpp"
+#include "WorkerPool.hpp"
+
+/**
+* Offline renderer for the atom scenes: every primitive is a sphere, a line (traced as a
+* thin capsule) or the ground square, so everything is intersected analytically and no
+* tessellation is involved.
+*
+* EndFrame builds a binned-SAH BVH over the frame's primitives, then 16x16 tiles are traced
+* across a WorkerPool. Rays travel in 2x2 packets through the BVH (4-wide slab and sphere
+* tests), and the shadow and ambient occlusion rays spawned at the hits are traced as
+* packets as well. Any number of point lights is supported, each with a hard shadow.
+*
+* Output is RGBA8 (top row first). Lit surfaces are shaded linearly and gamma encoded; the
+* clear colour and line colours are taken as display values, like in the GL path.
+*/
+class RayTracer : public RenderBackend {
+public:
+    struct Settings {
+        int samplesPerPixel;  // jittered, 1 = pixel centres
+        int aoSamples;        // per hit, 0 disables ambient occlusion
+        float aoRadius;
+        float ambient;        // strength of the occluded ambient term
+        float lineRadius;     // world-space radius of line capsules
+        bool shadows;
+    };
+
+    // threads = 0 uses every hardware thread
+    RayTracer(int width, int height, int threads = 0);
+
+    RayTracer(const RayTracer&) = delete;
+    RayTracer& operator=(const RayTracer&) = delete;
+
+    void SetSettings(const Settings& settings) { this->settings = settings; }
+    const Settings& GetSettings() const { return settings; }
+
+    void Resize(int width, int height) override;
+    void BeginFrame(const RenderCamera& camera, const float clearColor[3]) override;
+    // Replaces all lights with a single white one
+    void SetLight(const float position[3], bool viewSpace) override;
+    void SetLighting(bool enabled) override;
+    void DrawSphere(const float center[3], float radius, const float color[3]) override;
+    void DrawLine(const float a[3], const float b[3], const float color[3]) override;
+    void DrawGround(float height, float halfSize, const float color[3]) override;
+    void SetPickID(uint32_t id) override { pickID = id; }
+    void EndFrame() override;
+
+    // Pick ID of the nearest primitive through pixel (x, y) of the last finished frame (top
+    // row first, pixel centres at +0.5): one ray through the frame's BVH, 0 for nothing
+    uint32_t Pick(float x, float y) const;
+
+    void AddLight(const float position[3], const float color[3], bool viewSpace);
+    void ClearLights() { lights.clear(); }
+
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+    int GetThreadCount() const { return pool.GetThreadCount(); }
+    size_t GetNodeCount() const { return nodes.size(); }
+    // Same as SoftwareRasterizer::SetTarget: frames go to caller memory until Resize()
+    bool SetTarget(uint8_t* memory, size_t rowBytes);
+    const uint8_t* GetPixels() const { return target; }
+    size_t GetRowBytes() const { return targetRowBytes; }
+    bool WritePPM(const std::string& path) const;
+
+private:
+    static const int kTileSize = 16;
+    static const int kLeafSize = 4;
+    // Nodes this deep become leaves whatever their size, so degenerate input (atoms spaced
+    // geometrically) can't grow the tree past the fixed traversal stacks
+    static const int kMaxDepth = 64;
+    static const int kStackSize = 128;
+    // traversal holds the far child of every interior node above the current one plus the
+    // two children it pushes, at most kMaxDepth + 1 entries
+    static_assert(kStackSize >= kMaxDepth + 1, "BVH deeper than the traversal stack");
+
+    struct Primitive {
+        float a[3];      // sphere centre or line start
+        float b[3];      // line end
+        float radius;
+        float color[3];
+        uint32_t pickID;
+        bool line;
+    };
+
+    struct Node {
+        float bmin[3];
+        uint32_t leftFirst; // first child, or first primitive for leaves
+        float bmax[3];
+        uint32_t count;     // 0 for interior nodes
+    };
+
+    struct Light {
+        float position[3];  // as given
+        float color[3];
+        float world[3];     // resolved for the frame
+        bool viewSpace;
+    };
+
+    struct Packet;
+    struct PacketHit;
+
+    void primitiveBounds(const Primitive& p, float bmin[3], float bmax[3]) const;
+    void buildBVH();
+    void subdivide(uint32_t nodeIndex, const float* centroids, int depth);
+    void updateBounds(Node& node);
+
+    void intersect(const Packet& packet, PacketHit& hit) const;
+    int occluded(const Packet& packet) const;
+    void intersectLeaf(const Node& node, const Packet& packet, int mask, PacketHit& hit) const;
+
+    void traceTile(int tile);
+    void shadePacket(const Packet& packet, const PacketHit& hit, uint32_t pixelSeed[4], uint32_t sample, float out[4][3]) const;
+
+    int width, height;
+    std::vector<uint8_t> pixels;
+    uint8_t* target;  // pixels, or the caller's memory
+    size_t targetRowBytes;
+    Settings settings;
+
+    float eye[3], right[3], up[3], forward[3];
+    float tanX, tanY;
+    float clearColor[3];
+    bool lighting;
+    std::vector<Light> lights;
+
+    bool hasGround;
+    float groundHeight, groundHalfSize, groundColor[3];
+
+    std::vector<Primitive> primitives;
+    uint32_t pickID;
+    std::vector<uint32_t> primitiveIndex;
+    std::vector<Node> nodes;
+    // the BVH build's scratch: centroids from the arena, and the primitives in leaf order,
+    // swapped with primitives so both keep their capacity from frame to frame
+    FrameArena scratch;
+    std::vector<Primitive> orderedPrimitives;
+
+    WorkerPool pool;
+};
+
+#endif
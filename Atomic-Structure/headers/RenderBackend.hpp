@@ -0,0 +1,47 @@
+#pragma once
+#ifndef RENDER_BACKEND_HPP
+#define RENDER_BACKEND_HPP
+
+#include <cstdint>
+
+/**
+* Minimal scene-level renderer interface: spheres, lines and a ground plane, which is
+* everything the atom view draws. It deliberately uses plain float arrays so it can be
+* driven from the GLUT path (no glm) as well as from the core-profile classes.
+*/
+
+struct RenderCamera {
+    float eye[3];
+    float target[3];
+    float up[3];
+    float fovY;        // degrees
+    float nearPlane;
+    float farPlane;
+};
+
+class RenderBackend {
+public:
+    virtual ~RenderBackend() = default;
+
+    virtual void Resize(int width, int height) = 0;
+
+    virtual void BeginFrame(const RenderCamera& camera, const float clearColor[3]) = 0;
+
+    // viewSpace = true behaves like a fixed-function light set under an identity modelview
+    virtual void SetLight(const float position[3], bool viewSpace) = 0;
+    virtual void SetLighting(bool enabled) = 0;
+
+    virtual void DrawSphere(const float center[3], float radius, const float color[3]) = 0;
+    virtual void DrawLine(const float a[3], const float b[3], const float color[3]) = 0;
+    // square of 2*halfSize centred under the origin at y = height
+    virtual void DrawGround(float height, float halfSize, const float color[3]) = 0;
+
+    // Pick ID (see PickBuffer.hpp) of the spheres and lines drawn after it, for backends that
+    // can tell what is under a pixel; BeginFrame resets it to 0
+    virtual void SetPickID(uint32_t id) { (void)id; }
+
+    // Completes the frame; results are available once this returns
+    virtual void EndFrame() = 0;
+};
+
+#endif
@@ -0,0 +1,114 @@
+#pragma once
+#ifndef SCENE_FILE_HPP
+#define SCENE_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One atom as the instance attributes read it: centre and display radius, a vec4
+struct SceneAtom {
+    float position[3];
+    float radius;
+};
+
+// A run of atoms, e.g. the ones a trajectory frame moved: [first, first + count)
+struct AtomRange {
+    size_t first;
+    size_t count;
+};
+
+enum SceneFileFlags : uint32_t {
+    SCENE_HAS_COLORS = 1 << 0,  // per-atom RGBA8 colour overrides follow the elements
+    SCENE_PERIODIC = 1 << 1     // cell holds the three lattice vectors
+};
+
+/**
+* On-disk header of a .atoms scene (little endian, 256 bytes). The arrays it points at are
+* stored exactly as they are uploaded, each aligned to 16 bytes:
+*   atoms     SceneAtom[atomCount]  -> vec4 instance attribute
+*   elements  uint16_t[atomCount]   -> atomic numbers, uint instance attribute
+*   colors    uint32_t[atomCount]   -> optional RGBA8 overrides, alpha 0 = element colour
+*/
+struct SceneFileHeader {
+    char magic[8];          // "ATOMSCN\0"
+    uint32_t version;
+    uint32_t flags;         // SceneFileFlags
+    uint64_t atomCount;
+    uint64_t atomsOffset;
+    uint64_t elementsOffset;
+    uint64_t colorsOffset;  // 0 without SCENE_HAS_COLORS
+    uint64_t fileSize;
+    float transform[16];    // column-major model matrix applied to every atom
+    float boundsMin[3];     // of the atoms including their radii, before the transform
+    float boundsMax[3];
+    float cell[9];          // lattice vectors a, b, c when SCENE_PERIODIC
+    uint8_t reserved[256 - 56 - 64 - 24 - 36];
+};
+static_assert(sizeof(SceneFileHeader) == 256, "scene header layout changed");
+
+// Non-owning view of a scene, wherever its arrays live (a mapped file or a SceneData)
+struct SceneView {
+    const SceneAtom* atoms;
+    const uint16_t* elements;
+    const uint32_t* colors;  // may be null
+    size_t atomCount;
+    const float* transform;
+    const float* cell;       // null unless periodic
+};
+
+// A scene being built in memory, e.g. by an importer, before it is written out
+struct SceneData {
+    std::vector<SceneAtom> atoms;
+    std::vector<uint16_t> elements;
+    std::vector<uint32_t> colors;  // empty, or one per atom
+    float transform[16];
+    float cell[9];
+    bool periodic;
+
+    SceneData();
+    // radius <= 0 uses half the element's covalent radius
+    void AddAtom(int atomicNumber, float x, float y, float z, float radius = 0.0f);
+    void Clear();
+    SceneView GetView() const;
+};
+
+/**
+* Read-only memory mapping of a .atoms file. Open() validates the header and array bounds
+* and nothing else: no parsing and no per-atom allocation, the arrays are used in place and
+* the OS pages them in on first touch. A scene of any size opens in about the same time.
+*/
+class SceneFile {
+public:
+    static const uint32_t kVersion = 1;
+
+    SceneFile();
+    ~SceneFile();
+
+    SceneFile(const SceneFile&) = delete;
+    SceneFile& operator=(const SceneFile&) = delete;
+
+    bool Open(const std::string& path);
+    void Close();
+    bool IsOpen() const { return header != nullptr; }
+
+    const SceneFileHeader& GetHeader() const { return *header; }
+    size_t GetAtomCount() const { return header ? size_t(header->atomCount) : 0; }
+    SceneView GetView() const;
+
+    static bool Write(const std::string& path, const SceneView& scene);
+
+private:
+    const SceneFileHeader* header;
+    const uint8_t* base;
+    size_t mappedSize;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fd;
+#endif
+};
+
+#endif
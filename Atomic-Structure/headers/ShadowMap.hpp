@@ -0,0 +1,83 @@
+#pragma once
+#ifndef SHADOW_MAP_HPP
+#define SHADOW_MAP_HPP
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+#include "shaders.hpp"
+
+class Sphere;
+
+/**
+* Cascaded shadow maps for a directional key light, split in two layers:
+*  - static: nuclei. Rendered only when the light, the static casters or a cascade's
+*    placement changes. Cascades are "sticky": each one covers its view slice with
+*    some margin and is only re-fitted once the slice leaves it.
+*  - dynamic: moving electrons, re-rendered every frame at lower resolution.
+* Casters are spheres drawn instanced from a Sphere's mesh (see Sphere::DrawInstanced)
+* with a depth-only program, one draw per cascade.
+*/
+class ShadowMap {
+public:
+    static const int kMaxCascades = 4; // must match the arrays in Ground.frag
+
+    ShadowMap(int resolution = 2048, int cascadeCount = 3, float shadowDistance = 60.0f,
+        const char* vertPath = "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\ShadowDepth.vert",
+        const char* fragPath = "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\ShadowDepth.frag");
+    ~ShadowMap();
+
+    ShadowMap(const ShadowMap&) = delete;
+    ShadowMap& operator=(const ShadowMap&) = delete;
+
+    // Direction the light travels in; defaults to the sphere key light at (2, 5, 2)
+    void SetLightDirection(const glm::vec3& direction);
+    // xyz = center, w = radius
+    void SetStaticCasters(const std::vector<glm::vec4>& casters);
+    void SetDynamicCasters(const std::vector<glm::vec4>& casters);
+
+    // Fits cascades to the camera frustum and renders whatever is out of date.
+    void Update(const glm::mat4& view, float fovY, float aspect, float nearPlane, Sphere& casterMesh);
+
+    // Binds both maps and the cascade uniforms on a shader that samples them (Ground.frag).
+    void Apply(const Shader& shader, int firstTextureUnit = 8) const;
+
+    // How many static cascade renders happened so far, to check the cache is hit
+    unsigned long GetStaticRenderCount() const { return staticRenders; }
+
+private:
+    struct Cascade {
+        glm::vec3 center;   // light space, snapped to texels
+        float radius;
+        float end;          // view-space distance where the cascade stops
+        glm::mat4 lightSpace;
+        bool valid;         // placed at least once
+        bool dirty;         // static layer needs re-rendering
+    };
+
+    GLuint createDepthArray(int size);
+    void renderLayer(GLuint fbo, GLuint depthArray, int size, GLuint casterBuffer, size_t casterCount,
+        int cascade, Sphere& casterMesh);
+    void uploadCasters(GLuint buffer, const std::vector<glm::vec4>& casters, size_t& capacity);
+
+    int resolution, dynamicResolution;
+    int cascadeCount;
+    float shadowDistance;
+    glm::vec3 lightDirection;
+    glm::mat4 lightView;
+
+    GLuint staticFBO, dynamicFBO;
+    GLuint staticDepth, dynamicDepth;
+    GLuint staticCasterBuffer, dynamicCasterBuffer;
+    size_t staticCapacity, dynamicCapacity;
+    std::vector<glm::vec4> staticCasters, dynamicCasters;
+
+    Cascade cascades[kMaxCascades];
+    unsigned long staticRenders;
+
+    std::unique_ptr<Shader> depthShader;
+    bool initialized;
+};
+
+#endif
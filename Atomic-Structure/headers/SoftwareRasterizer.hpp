@@ -0,0 +1,117 @@
+#pragma once
+#ifndef SOFTWARE_RASTERIZER_HPP
+#define SOFTWARE_RASTERIZER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "RenderBackend.hpp"
+#include "WorkerPool.hpp"
+
+/**
+* Multithreaded tile-based CPU renderer for machines without a GPU.
+*
+* Draw calls only record primitives. EndFrame transforms them, bins each one into the
+* 64x64 tiles its screen bounds touch, then all threads pull tiles off a shared counter and
+* rasterize them independently (tiles never overlap, so there are no locks on the frame).
+* Triangles (ground, lines as 1 px quads) use edge functions evaluated 4 pixels at a time
+* with SSE; spheres are not tessellated at all but ray-intersected per pixel, which gives
+* exact silhouettes, depth and normals for a fraction of the cost.
+*
+* Shading matches the fixed-function GLUT path: Gouraud for triangles, per-pixel Lambert for
+* spheres, with the same 0.06 ambient term. Output is RGBA8, top row first.
+*/
+class SoftwareRasterizer : public RenderBackend {
+public:
+    // threads = 0 uses every hardware thread
+    SoftwareRasterizer(int width, int height, int threads = 0);
+
+    SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+    SoftwareRasterizer& operator=(const SoftwareRasterizer&) = delete;
+
+    void Resize(int width, int height) override;
+    void BeginFrame(const RenderCamera& camera, const float clearColor[3]) override;
+    void SetLight(const float position[3], bool viewSpace) override;
+    void SetLighting(bool enabled) override;
+    void DrawSphere(const float center[3], float radius, const float color[3]) override;
+    void DrawLine(const float a[3], const float b[3], const float color[3]) override;
+    void DrawGround(float height, float halfSize, const float color[3]) override;
+    void EndFrame() override;
+
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+    int GetThreadCount() const { return pool.GetThreadCount(); }
+    // Frames go straight to caller memory (a mapped frame buffer, shared memory) instead of
+    // the internal copy: rowBytes >= GetWidth() * 4, kept until the next Resize().
+    // nullptr goes back to the internal buffer, and so does a shorter row (returns false).
+    bool SetTarget(uint8_t* memory, size_t rowBytes);
+    // RGBA8, GetHeight() rows of GetRowBytes() bytes
+    const uint8_t* GetPixels() const { return target; }
+    size_t GetRowBytes() const { return targetRowBytes; }
+    bool WritePPM(const std::string& path) const;
+
+private:
+    static const int kTileSize = 64;
+
+    struct SpherePrim {
+        float center[3]; // view space
+        float radius;
+        float color[3];
+        int x0, y0, x1, y1; // screen bounds, inclusive-exclusive
+    };
+
+    struct TrianglePrim {
+        float edge[3][3];  // A, B, C of each edge function, scaled so they give barycentrics
+        float invW[3];
+        float colorW[3][3]; // color / w per vertex for perspective-correct interpolation
+        int x0, y0, x1, y1;
+    };
+
+    struct ViewVertex {
+        float p[3];
+        float color[3];
+    };
+
+    struct ScreenVertex {
+        float x, y, invW;
+        float color[3];
+    };
+
+    void toView(const float world[3], float out[3]) const;
+    ScreenVertex project(const ViewVertex& v) const;
+    void addScreenTriangle(const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c);
+    void addClippedPolygon(const ViewVertex* vertices, int count);
+    void shadeVertex(const float viewPos[3], const float normal[3], const float color[3], float out[3]) const;
+    void binPrimitives();
+    void rasterTile(int tile);
+    void rasterSphere(const SpherePrim& s, int tx0, int ty0, int tx1, int ty1);
+    void rasterTriangle(const TrianglePrim& t, int tx0, int ty0, int tx1, int ty1);
+
+    int width, height, stride, tilesX, tilesY;
+    std::vector<uint32_t> color;  // RGBA8, stride wide so 4-pixel groups never run off a row
+    std::vector<float> depth;     // 1 / w, 0 = far
+    std::vector<uint8_t> pixels;  // tightly packed copy handed out by GetPixels
+    uint8_t* target;              // pixels, or the caller's memory
+    size_t targetRowBytes;
+
+    // camera for the frame
+    float viewRight[3], viewUp[3], viewBack[3], eye[3];
+    float tanX, tanY, nearPlane;
+    uint32_t clearValue;
+    float lightPos[3];   // view space
+    float lightWorld[3];
+    bool lightInViewSpace;
+    bool lighting;
+
+    std::vector<SpherePrim> spheres;
+    std::vector<TrianglePrim> triangles;
+    std::vector<uint32_t> submitted;       // submission order, high bit marks a sphere
+    // bins of every tile in one array: tile t holds binEntries[binStart[t], binStart[t + 1])
+    std::vector<uint32_t> binStart;    // tilesX * tilesY + 1, sized in Resize
+    std::vector<uint32_t> binFill;     // write cursor per tile while binning
+    std::vector<uint32_t> binEntries;  // only grows, with headroom
+
+    WorkerPool pool;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#pragma once
+#ifndef SPHERE_MESH_HPP
+#define SPHERE_MESH_HPP
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// Tessellation used to build a unit sphere
+enum class SphereType {
+    UV,         // latitude/longitude rings (sectors x stacks)
+    Icosphere,  // subdivided icosahedron, near-uniform triangles
+    CubeSphere  // spherified cube, six N x N grids
+};
+
+// Compressed sphere vertex: unit position as normalized shorts (w is padding).
+// The normal of a unit sphere is its position, so it is rebuilt in the vertex shader.
+struct SphereVertex {
+    int16_t x, y, z, w;
+};
+
+// Post-transform cache statistics for an index buffer
+struct VertexCacheStats {
+    unsigned int vertexCount;      // unique vertices in the mesh
+    unsigned int triangleCount;
+    unsigned int shaderInvocations; // simulated vertex shader runs (cache misses)
+    float acmr;                    // average cache miss ratio: invocations / triangles (0.5 is optimal)
+    float atvr;                    // average transformed vertex ratio: invocations / vertices (1.0 is optimal)
+    size_t vertexBytes;
+    size_t indexBytes;
+};
+
+// CPU-side generation and optimization of unit sphere meshes.
+// Every generator welds duplicate vertices (poles, seams, cube edges) and the
+// result is reordered for the post-transform cache and for linear vertex fetch.
+class SphereMesh {
+public:
+    // FIFO size used by the cache simulation; typical for desktop GPUs
+    static const int kCacheSize = 16;
+
+    SphereMesh(SphereType type, int sectors, int stacks);
+
+    const std::vector<SphereVertex>& GetVertices() const { return vertices; }
+    const std::vector<uint32_t>& GetIndices() const { return indices; }
+
+    // true when every index fits in 16 bits
+    bool FitsShortIndices() const { return vertices.size() <= 0xFFFF; }
+
+    VertexCacheStats Analyze() const;
+
+    static VertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices,
+        unsigned int vertexCount, int cacheSize = kCacheSize);
+
+private:
+    void createUV(int sectors, int stacks);
+    void createIcosphere(int subdivisions);
+    void createCubeSphere(int gridSize);
+
+    void weldVertices();
+    void optimizeVertexCache();
+    void optimizeVertexFetch();
+
+    std::vector<glm::vec3> positions; // unit-length positions before compression
+    std::vector<SphereVertex> vertices;
+    std::vector<uint32_t> indices;
+};
+
+#endif
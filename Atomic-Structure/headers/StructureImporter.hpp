@@ -0,0 +1,105 @@
+#pragma once
+#ifndef STRUCTURE_IMPORTER_HPP
+#define STRUCTURE_IMPORTER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "SceneFile.hpp"
+
+/**
+* Background loader for XYZ, PDB and CIF (small-molecule and mmCIF) structure files.
+*
+* The file is read in large chunks on a worker thread and split into lines in place; numbers
+* are parsed from a small copy on the stack, so nothing is allocated per line and no
+* iostreams are involved.
+* Atoms are published in batches as they are parsed and Poll() moves whatever arrived into a
+* SceneData, so a huge file is on screen long before it has been read to the end.
+*
+* Small-molecule CIFs list the asymmetric unit only; it is expanded with the file's symmetry
+* operations to fill the unit cell.
+*
+* Only the first frame (XYZ frame, PDB MODEL, mmCIF model) becomes the scene. Later frames
+* are skipped without parsing their atoms, but their byte offsets are recorded so a
+* trajectory player can seek to them.
+*/
+class StructureImporter {
+public:
+    enum class Format { Unknown, XYZ, PDB, CIF };
+
+    StructureImporter();
+    ~StructureImporter();
+
+    StructureImporter(const StructureImporter&) = delete;
+    StructureImporter& operator=(const StructureImporter&) = delete;
+
+    // Picks the format from the extension (.xyz, .pdb/.ent, .cif/.mmcif)
+    static Format DetectFormat(const std::string& path);
+
+    // firstFrameOnly stops reading at the second frame, for files a trajectory player plays
+    bool Start(const std::string& path, Format format = Format::Unknown, bool firstFrameOnly = false);
+    void Cancel();
+
+    // Appends the atoms parsed since the last call to scene (and sets its cell, if the file
+    // has one). Returns how many atoms were added.
+    size_t Poll(SceneData& scene);
+    // Blocks until the whole file has been read
+    void Wait();
+
+    bool IsDone() const { return done; }
+    bool Failed() const { return failed; }
+    Format GetFormat() const { return format; }
+    uint64_t GetBytesRead() const { return bytesRead; }
+    uint64_t GetFileSize() const { return fileSize; }
+    // Frames seen so far and where each starts in the file (frame 0 included)
+    std::vector<uint64_t> GetFrameOffsets();
+
+private:
+    static const size_t kChunkSize = 4 << 20;
+    static const size_t kBatchSize = 16384;  // atoms per publish
+
+    struct CifState;
+
+    void run(std::string path);
+    void parseLine(const char* line, size_t length, uint64_t offset);
+    void parseXYZ(const char* line, size_t length, uint64_t offset);
+    void parsePDB(const char* line, size_t length, uint64_t offset);
+    void parseCIF(const char* line, size_t length, uint64_t offset);
+    void cifRow();
+
+    void addAtom(int atomicNumber, float x, float y, float z);
+    void setCell(const float vectors[9]);
+    void beginFrame(uint64_t offset);
+    void publish(bool force);
+
+    Format format;
+    std::thread worker;
+    std::atomic<bool> cancelled, done, failed;
+    std::atomic<uint64_t> bytesRead;
+    uint64_t fileSize;
+
+    // worker-side state
+    int frame;            // current frame index, -1 before the first
+    bool firstFrame;      // atoms still belong to the scene
+    bool firstFrameOnly;
+    long long xyzRemaining; // XYZ: atom lines left in the frame, -1 = count line next, -2 = comment next
+    long long xyzCount;
+    CifState* cif;
+    std::vector<SceneAtom> localAtoms;
+    std::vector<uint16_t> localElements;
+    bool cellKnown;
+    float cell[9];
+
+    // shared with Poll()
+    std::mutex mutex;
+    std::vector<SceneAtom> pendingAtoms;
+    std::vector<uint16_t> pendingElements;
+    std::vector<uint64_t> frameOffsets;
+    bool cellPending;
+    float pendingCell[9];
+};
+
+#endif
@@ -0,0 +1,98 @@
+#pragma once
+#ifndef TILE_DELTA_HPP
+#define TILE_DELTA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "WorkerPool.hpp"
+
+/**
+* Frame messages of the streaming server (little endian):
+*
+*   uint32 magic "ATD1", uint32 frame, uint16 width, uint16 height, uint16 tileSize,
+*   uint16 flags (TILE_DELTA_KEYFRAME), uint32 tileCount,
+*   then per tile: uint16 tileX, uint16 tileY, uint32 bytes | TILE_DELTA_RAW, and that
+*   many bytes of the tile's pixels as RGB, row by row, run-length coded:
+*     op 0..127     the next 3 bytes, repeated op + 1 times
+*     op 128..255   op - 127 literal pixels follow, 3 bytes each
+*
+* A keyframe holds every tile as it is. Otherwise only the tiles that changed are sent,
+* XORed with the tile the client already has, so the pixels that stayed the same become
+* long zero runs: an electron crossing a tile costs a few dozen bytes, not the tile. A
+* tile that changed all over (the camera moved) codes smaller as it is, and is sent raw.
+*/
+enum TileDeltaFlags : uint32_t {
+    TILE_DELTA_KEYFRAME = 1u << 0,  // message flags
+    TILE_DELTA_RAW = 1u << 31       // in a tile's byte count: pixels as they are, not XORed
+};
+
+class TileDeltaEncoder {
+public:
+    static const int kTileSize = 32;
+    static const size_t kHeaderBytes = 20;
+    static const size_t kTileHeaderBytes = 8;
+
+    // threads = 0 uses every hardware thread
+    TileDeltaEncoder(int width, int height, int threads = 0);
+
+    TileDeltaEncoder(const TileDeltaEncoder&) = delete;
+    TileDeltaEncoder& operator=(const TileDeltaEncoder&) = delete;
+
+    // Also makes the next message a keyframe
+    void Resize(int width, int height);
+    // A client joined or lost frames; it needs whole tiles again
+    void RequestKeyframe() { keyframePending = true; }
+
+    // Compares rgba (RGBA8, height rows of rowBytes) against the last frame and codes the
+    // changed tiles in parallel. The message stays valid until the next call
+    const std::vector<uint8_t>& Encode(const uint8_t* rgba, size_t rowBytes);
+
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+    int GetTileCount() const { return tilesX * tilesY; }
+    // Of the last message
+    int GetDirtyTiles() const { return dirtyTiles; }
+    bool WasKeyframe() const { return lastKeyframe; }
+    double GetLastMs() const { return lastMs; }
+    uint32_t GetFrame() const { return frame; }
+
+private:
+    void encodeTile(int tile, const uint8_t* rgba, size_t rowBytes, bool keyframe);
+
+    int width, height, tilesX, tilesY;
+    std::vector<uint8_t> previous;    // RGB of the last frame, what the clients have
+    std::vector<uint8_t> tileBytes;   // kMaxTileBytes per tile
+    std::vector<uint32_t> tileLength; // coded bytes per tile, 0 = unchanged
+    std::vector<uint8_t> message;
+    uint32_t frame;
+    bool keyframePending, lastKeyframe;
+    int dirtyTiles;
+    double lastMs;
+    WorkerPool pool;
+};
+
+/**
+* Client side: applies messages to an RGBA8 frame. Rejects anything malformed or out of
+* order (a delta against a frame it never had) until the next keyframe.
+*/
+class TileDeltaDecoder {
+public:
+    TileDeltaDecoder();
+
+    bool Apply(const uint8_t* data, size_t size);
+
+    bool HasFrame() const { return synced; }
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+    uint32_t GetFrame() const { return frame; }
+    const uint8_t* GetPixels() const { return pixels.data(); }
+
+private:
+    int width, height;
+    uint32_t frame;
+    bool synced;
+    std::vector<uint8_t> pixels;
+};
+
+#endif
@@ -0,0 +1,111 @@
+#pragma once
+#ifndef TRAJECTORY_PLAYER_HPP
+#define TRAJECTORY_PLAYER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "SceneFile.hpp"
+
+/**
+* Plays molecular dynamics trajectories (multi-frame XYZ or CHARMM/NAMD DCD) without
+* loading them into memory.
+*
+* Frames are read with positioned reads into a small ring of position buffers by loader
+* threads, which keep the frames just ahead of the play position (in whichever direction
+* playback or scrubbing is going) ready. DCD frames have a fixed size so any frame can be
+* read at once; XYZ frames are indexed by byte offset on the loaders' idle time, and only
+* the frames indexed so far can be shown.
+*
+* Apply() copies a frame into the scene's atom array and reports which runs of atoms
+* actually moved, so only those need to be uploaded or recompiled. A frame that isn't
+* ready yet is skipped over rather than waited for, unless the caller asks to wait.
+*/
+class TrajectoryPlayer {
+public:
+    enum class Format { Unknown, XYZ, DCD };
+
+    TrajectoryPlayer();
+    ~TrajectoryPlayer();
+
+    TrajectoryPlayer(const TrajectoryPlayer&) = delete;
+    TrajectoryPlayer& operator=(const TrajectoryPlayer&) = delete;
+
+    // .xyz/.extxyz or .dcd
+    static Format DetectFormat(const std::string& path);
+
+    bool Open(const std::string& path, int slotCount = 16, int loaderCount = 2);
+    void Close();
+    bool IsOpen() const { return format != Format::Unknown; }
+
+    size_t GetAtomCount() const { return atomCount; }
+    // Frames that can be shown so far; grows while an XYZ file is being indexed
+    long long GetFrameCount() const { return frameCount; }
+    bool IsIndexed() const { return indexed; }
+
+    // Tells the loaders which frame (0 to GetFrameCount() - 1) comes next; the direction of
+    // travel is taken from the previous call. Once indexing is done the prefetch window wraps
+    // around the ends, so looping playback doesn't stall.
+    void Seek(long long frame);
+    // If frame is in the ring, writes its positions into atoms[0, count) and appends the
+    // runs that differ from what was there to changed. Returns false if the frame isn't
+    // loaded yet (wait = true blocks until it is).
+    bool Apply(long long frame, SceneAtom* atoms, size_t count, std::vector<AtomRange>& changed, bool wait = false);
+
+private:
+    static const size_t kChunkSize = 4 << 20;
+    static const size_t kMergeGap = 32;  // unchanged atoms bridged when merging changed runs
+
+    struct Slot {
+        long long frame = -1;  // -1 = empty
+        bool loading = false;
+        std::vector<float> positions;  // x y z per atom
+    };
+
+    bool openDCD(FILE* file, const std::string& path);
+    bool openXYZ(FILE* file, const std::string& path);
+
+    void loaderLoop();
+    bool wanted(long long frame) const;
+    bool loadXYZ(const char* data, size_t size, std::vector<float>& positions);
+    bool loadDCD(const char* data, std::vector<float>& positions);
+    void indexChunk();
+
+    Format format;
+    std::string path;
+    size_t atomCount;
+    uint64_t fileSize;
+    std::atomic<long long> frameCount;
+    std::atomic<bool> indexed;
+
+    // DCD layout
+    uint64_t dcdHeaderSize;
+    uint64_t dcdFrameSize;
+    bool dcdHasCell;
+    bool dcdSwapped;
+
+    // XYZ index: frame f spans [frameOffsets[f], frameOffsets[f + 1])
+    std::vector<uint64_t> frameOffsets;
+    FILE* indexFile;
+    std::vector<char> indexBuffer;
+    size_t indexCarried;
+    uint64_t indexBufferOffset;
+    long long indexLine;  // line within the frame being indexed, 0 = count line
+
+    std::vector<Slot> slots;
+    std::vector<std::thread> loaders;
+    std::mutex mutex;
+    std::condition_variable workReady, frameReady;
+    bool closing;
+    bool indexing;
+    bool reported;         // "cannot read frame" printed once
+    long long target;      // frame the main thread shows next
+    int direction;         // +1 forward, -1 backward
+};
+
+#endif
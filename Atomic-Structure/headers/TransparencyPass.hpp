@@ -0,0 +1,53 @@
+#pragma once
+#ifndef TRANSPARENCY_PASS_HPP
+#define TRANSPARENCY_PASS_HPP
+
+#include <glad/glad.h>
+#include <memory>
+#include "shaders.hpp"
+
+/**
+* Weighted blended order-independent transparency.
+*
+* Translucent geometry is drawn in any order into an accumulation target (RGBA16F)
+* and a revealage target (R8), depth tested against the opaque scene but without
+* writing depth. Composite() then resolves both onto the current framebuffer.
+* Two passes total no matter how many shells overlap, and no CPU sorting.
+*
+* Usage per frame, after the opaque geometry:
+*   Begin(opaqueFramebuffer);  draw translucent things with OITAccumulate.frag;  End();
+*   Composite();
+*/
+class TransparencyPass {
+public:
+    TransparencyPass(int width, int height,
+        const char* compositeVertPath = "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\Fullscreen.vert",
+        const char* compositeFragPath = "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\OITComposite.frag");
+    ~TransparencyPass();
+
+    TransparencyPass(const TransparencyPass&) = delete;
+    TransparencyPass& operator=(const TransparencyPass&) = delete;
+
+    void Resize(int width, int height);
+
+    // Copies the opaque depth from sourceFramebuffer (0 = default) and binds the OIT targets.
+    void Begin(GLuint sourceFramebuffer = 0);
+    void End();
+    // Blends the resolved transparency onto targetFramebuffer.
+    void Composite(GLuint targetFramebuffer = 0);
+
+private:
+    void createTargets();
+    void destroyTargets();
+
+    int width, height;
+    GLuint fbo;
+    GLuint accumTexture, revealageTexture, depthTexture;
+    GLuint sourceFramebuffer;
+    GLuint emptyVAO;
+    std::unique_ptr<Shader> compositeShader;
+    bool cullFaceWasEnabled; // Begin() turns culling off, End() puts it back
+    bool initialized;
+};
+
+#endif
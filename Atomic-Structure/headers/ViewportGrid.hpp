@@ -0,0 +1,96 @@
+#pragma once
+#ifndef VIEWPORT_GRID_HPP
+#define VIEWPORT_GRID_HPP
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+#include "camera.hpp"
+#include "shaders.hpp"
+#include "RadialSolver.hpp"
+
+// Per-instance data, laid out exactly as the vertex attributes read it
+struct GridInstance {
+    glm::vec4 position;  // spheres: center, radius; rings: orbital plane normal, orbit radius
+    glm::vec4 color;
+    GLuint viewport;
+};
+
+/**
+* Several atoms side by side in one window, e.g. a group of the periodic table, each in
+* its own cell of a grid with its own Camera. The cells share everything on the GPU: one
+* sphere mesh, one program for the spheres and one for the orbit rings, and one uniform
+* block per frame holding every cell's matrices. All nucleons and electrons of all cells
+* are a single instanced draw and all rings another, so sixteen atoms cost two draw calls,
+* like one.
+*
+* Each instance carries its cell index. The vertex shader projects with that cell's
+* camera and moves the result into the cell in clip space, clipping it to the cell with
+* four clip distances. Unlike gl_ViewportIndex this needs neither a geometry shader nor
+* an extension to write it from the vertex shader.
+*/
+class ViewportGrid {
+public:
+    static const int kMaxViewports = 16;  // the array size in ViewportGrid.vert
+    static const int kRingSegments = 64;
+    static const int kGutter = 2;         // pixels between cells
+
+    ViewportGrid(
+        const char* vertPath = "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\ViewportGrid.vert",
+        const char* fragPath = "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\ViewportGrid.frag",
+        const char* ringVertPath = "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\ViewportGridRing.vert",
+        const char* ringFragPath = "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\ViewportGridRing.frag");
+    ~ViewportGrid();
+
+    ViewportGrid(const ViewportGrid&) = delete;
+    ViewportGrid& operator=(const ViewportGrid&) = delete;
+
+    // Splits the window into count cells, as square a grid as fits; cells past the old
+    // count start empty. Call again when the window is resized
+    bool SetLayout(int count, int width, int height);
+    int GetViewportCount() const { return viewportCount; }
+    // Cell at window coordinates with the origin top left (as GLFW reports the cursor),
+    // -1 on a gutter or outside
+    int GetViewportAt(double x, double y) const;
+    // x, y (from the bottom left), width, height of a cell in pixels
+    const glm::ivec4& GetViewportRect(int viewport) const { return rects[viewport]; }
+
+    // Shows an element in a cell, laid out from its solved subshells, and fits the cell's
+    // camera around its outermost orbit
+    void SetElement(int viewport, int atomicNumber, const ElementShells& shells);
+    int GetElement(int viewport) const;
+    Camera& GetCamera(int viewport) { return cameras[viewport]; }
+
+    // Moves the electrons of every cell by one frame
+    void Update();
+    // Draws every cell into the whole of the bound framebuffer, which must have depth
+    void Render(const glm::vec3& lightPos);
+
+    size_t GetSphereCount() const { return spheres.size(); }
+    size_t GetRingCount() const { return rings.size(); }
+
+private:
+    void uploadInstances();
+
+    struct ViewportAtom;  // kept in ViewportGrid.cpp, its Electron is not the core profile's
+
+    GLuint sphereVAO, meshVBO, meshEBO, sphereVBO, ringVAO, ringVBO, frameUBO;
+    unsigned int meshIndexCount;
+    int viewportCount, width, height, columns, rows;
+    glm::ivec4 rects[kMaxViewports];
+    Camera cameras[kMaxViewports];
+    std::unique_ptr<ViewportAtom[]> atoms;
+
+    // nucleons of every cell first, then the electrons, which are rewritten each frame
+    std::vector<GridInstance> spheres;
+    std::vector<GridInstance> rings;
+    size_t nucleonInstances;
+    bool instancesStale;
+
+    std::unique_ptr<Shader> shader;
+    std::unique_ptr<Shader> ringShader;
+    bool initialized;
+};
+
+#endif
@@ -0,0 +1,55 @@
+#pragma once
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+* Persistent threads for the CPU renderers. Run() hands out job indices from a shared
+* counter, the calling thread works too, and it returns once every job is done. Workers
+* sleep between calls, so a pool per renderer costs nothing while idle.
+*/
+class WorkerPool {
+public:
+    // threads = 0 uses every hardware thread (the caller counts as one)
+    explicit WorkerPool(int threads = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Calls job(i) for every i in [0, jobCount). The job is called by reference, not
+    // wrapped in a std::function, so a lambda with any captures costs no allocation
+    template <typename Job>
+    void Run(int jobCount, const Job& job) {
+        run(jobCount, &job, [](const void* function, int index) { (*static_cast<const Job*>(function))(index); });
+    }
+
+    int GetThreadCount() const { return static_cast<int>(workers.size()) + 1; }
+
+private:
+    typedef void (*JobThunk)(const void* job, int index);
+
+    void run(int jobCount, const void* job, JobThunk thunk);
+    void workerLoop();
+    void drain();
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, finished;
+    uint64_t generation;
+    int busyWorkers;
+    bool quit;
+
+    const void* currentJob;
+    JobThunk currentThunk;
+    int jobCount;
+    std::atomic<int> nextJob;
+};
+
+#endif
@@ -111,6 +111,16 @@ public:
             Zoom = 45.0f;
     }
 
+    // sets the full camera state at once, e.g. from a recorded capture
+    void SetState(const glm::vec3& position, float yaw, float pitch, float zoom)
+    {
+        Position = position;
+        Yaw = yaw;
+        Pitch = pitch;
+        Zoom = zoom;
+        updateCameraVectors();
+    }
+
 private:
     // calculates the front vector from the Camera's (updated) Euler Angles
     void updateCameraVectors()
@@ -2,19 +2,26 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
+#include <memory>
 #include <vector>
 #include "headers/shaders.hpp"
+#include "headers/SphereMesh.hpp"
 
 class Sphere {
 public:
     Sphere(float radius = 1.0f, int sectors = 32, int stacks = 32,
         const char* vertPath = "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\Sphere.vert",
-        const char* fragPath = "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\Sphere.frag");
+        const char* fragPath = "C:\\Users\\Akhil\\source\\repos\\Atomic-Structure\\Atomic-Structure\\assets\\shaders\\Sphere.frag",
+        SphereType type = SphereType::UV);
     ~Sphere();
 
     void render(const glm::mat4& view, const glm::mat4& projection,
         const glm::vec3& viewPos, const glm::mat4& model = glm::mat4(1.0f));
     Shader& GetShader() { return *shader; }
+    // Draws the bare mesh with whatever program is bound, e.g. instanced depth-only passes
+    void DrawInstanced(GLsizei instanceCount) const;
+    // vertex cache and memory figures of the uploaded mesh
+    const VertexCacheStats& GetStats() const { return stats; }
     Sphere(const Sphere&) = delete;            // Disable copy
     Sphere& operator=(const Sphere&) = delete; // Disable assignment
 
@@ -24,14 +31,18 @@ public:
 
 
 private:
-    void createSphere(float radius, int sectors, int stacks);
+    void createSphere(int sectors, int stacks, SphereType type);
     void setupBuffers();
 
     GLuint VAO, VBO, EBO;
     unsigned int indexCount;
+    GLenum indexType;
+    float radius; // mesh is a unit sphere, scaled in render()
     std::unique_ptr<Shader> shader;
     bool initialized;
+    VertexCacheStats stats;
 
-    std::vector<float> vertices;
-    std::vector<unsigned int> indices;
+    std::vector<SphereVertex> vertices;
+    std::vector<uint16_t> shortIndices;
+    std::vector<uint32_t> indices;
 };
\ No newline at end of file